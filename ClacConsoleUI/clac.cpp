@@ -3,6 +3,7 @@
  *  \author  Peter Chapin <chapinp@proton.me> and Peter Nikolaidis
  */
 
+#include <csignal>
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
@@ -20,6 +21,7 @@
 #include "IntegerEntity.hpp"
 #include "StringEntity.hpp"
 #include "convert.hpp"
+#include "prime.hpp"
 #include "support.hpp"
 
 // ClacEngine library.
@@ -138,6 +140,13 @@ namespace {
             Entity* (Entity::*conversion)() const =
                 convert_table[left->my_type()][right->my_type()];
 
+            // A binary shifted or rotated by an integer count stays a binary. The count is not a
+            // value to be combined with the binary, so it keeps its own type.
+            if ((binary_operation == &Entity::rotate || binary_operation == &Entity::shift) &&
+                left->my_type() == BINARY && right->my_type() == INTEGER) {
+                conversion = &Entity::duplicate;
+            }
+
             if (conversion == nullptr) {
                 error_message("Required implicit conversion not implemented!");
                 return;
@@ -182,9 +191,23 @@ namespace {
                                     {">", &Entity::is_greater}, {">=", &Entity::is_greaterorequal},
                                     {"<", &Entity::is_less},    {"<=", &Entity::is_lessorequal},
                                     {"mod", &Entity::modulo},   {"^", &Entity::power},
+                                    {"modular", &Entity::modular},
+                                    {"primes", &Entity::primes},
+                                    {"comb", &Entity::binomial},
+                                    {"iroot", &Entity::integer_root},
+                                    {"gcd", &Entity::gcd},      {"lcm", &Entity::lcm},
+                                    {"and", &Entity::logical_and},
+                                    {"or", &Entity::logical_or},
+                                    {"xor", &Entity::logical_xor},
+                                    {"rotate", &Entity::rotate},
+                                    {"shift", &Entity::shift},
+                                    {"leading", &Entity::leading_digits},
+                                    {"trailing", &Entity::trailing_digits},
                                     {nullptr, nullptr}};
 
-    BuiltinUnary unary_words[] = {{"abs", &Entity::abs},
+    BuiltinUnary unary_words[] = {{"!", &Entity::factorial},
+                                  {"!!", &Entity::double_factorial},
+                                  {"abs", &Entity::abs},
                                   {"acos", &Entity::acos},
                                   {"alog", &Entity::exp10},
                                   {"asin", &Entity::asin},
@@ -192,12 +215,28 @@ namespace {
                                   {"conj", &Entity::complex_conjugate},
                                   {"cos", &Entity::cos},
                                   {"exp", &Entity::exp},
+                                  {"factor", &Entity::factor},
+                                  {"fib", &Entity::fibonacci},
                                   {"frac", &Entity::fractional_part},
+                                  {"gamma", &Entity::gamma},
+                                  {"ilog10", &Entity::integer_log10},
+                                  {"ilog2", &Entity::integer_log2},
                                   {"im", &Entity::imaginary_part},
                                   {"inv", &Entity::inv},
+                                  {"isqrt", &Entity::integer_sqrt},
                                   {"ln", &Entity::ln},
+                                  {"lgamma", &Entity::log_gamma},
                                   {"log", &Entity::log},
+                                  {"lucas", &Entity::lucas},
+                                  {"nbits", &Entity::bit_length},
+                                  {"ndigits", &Entity::digit_count},
                                   {"neg", &Entity::neg},
+                                  {"nextprime", &Entity::next_prime},
+                                  {"not", &Entity::logical_not},
+                                  {"popcount", &Entity::population_count},
+                                  {"power?", &Entity::is_perfect_power},
+                                  {"prime?", &Entity::is_prime},
+                                  {"primepi", &Entity::prime_count},
                                   {"re", &Entity::real_part},
                                   {"sgn", &Entity::sign},
                                   {"sin", &Entity::sin},
@@ -205,6 +244,7 @@ namespace {
                                   {"sqrt", &Entity::sqrt},
                                   {"tan", &Entity::tan},
 
+                                  {">BFL", &Entity::to_bigfloat},
                                   {">BIN", &Entity::to_binary},
                                   {">CPX", &Entity::to_complex},
                                   {">FLT", &Entity::to_float},
@@ -225,14 +265,18 @@ namespace {
         {"dropn", do_dropn},
         {"dup", do_dup},
         {"dupn", do_dupn},
+        {"eager", do_eager},
         {"eng", do_eng},
         {"eval", do_eval},
         {"fix", do_fix},
         {"grad", do_grad},
         {"hex", do_hex},
         {"info", do_info},
+        {"lazy", do_lazy},
         {"oct", do_oct},
         {"polar", do_polar},
+        {"powmod", do_powmod},
+        {"prec", do_prec},
         {"purge", do_purge},
         {"rad", do_rad},
         {"read", do_read},
@@ -249,6 +293,8 @@ namespace {
         {"write", do_write},
 
         // Unary actions.
+        {"rl", do_rotate_left},
+        {"rr", do_rotate_right},
         {"sl", do_shift_left},
         {"sr", do_shift_right},
         //{ "asr", do_ashift_right },
@@ -379,9 +425,10 @@ namespace clac {
 
         // Map entity types to names for the UI.
         map<EntityType, string> type_abbreviation = {
-            {BINARY, "BIN"},  {COMPLEX, "CPX"},  {DIRECTORY, "DIR"}, {FLOAT, "FLT"},
-            {INTEGER, "INT"}, {LABELED, "LBL"},  {LIST, "LST"},      {MATRIX, "MAT"},
-            {PROGRAM, "PGM"}, {RATIONAL, "RAT"}, {STRING, "STR"},    {VECTOR, "VEC"}};
+            {BIGFLOAT, "BFL"}, {BINARY, "BIN"},  {COMPLEX, "CPX"},  {DIRECTORY, "DIR"},
+            {FLOAT, "FLT"},    {INTEGER, "INT"}, {LABELED, "LBL"},  {LIST, "LST"},
+            {MATRIX, "MAT"},   {MODULAR, "MOD"}, {PROGRAM, "PGM"},  {RATIONAL, "RAT"},
+            {STRING, "STR"},   {VECTOR, "VEC"}};
 
         // Command line analysis.
         // TODO: Improve and generalize the handling of the command line.
@@ -429,10 +476,20 @@ namespace clac {
 //           The real main
 //===================================
 
+//! Control-C stops a factorization or prime search in progress. Otherwise it ends the program.
+extern "C" void interrupt_handler(int signal_number)
+{
+    if (!clac::arithmetic::request_cancel()) {
+        signal(signal_number, SIG_DFL);
+        raise(signal_number);
+    }
+}
+
 int main(int argc, char** argv)
 {
     // Set the default exit status in case an unhandled exception propagates through main.
     int return_value = EXIT_FAILURE;
+    signal(SIGINT, interrupt_handler);
 
     try {
         return_value = clac::Main(argc, argv);
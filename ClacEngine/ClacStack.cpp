@@ -7,7 +7,6 @@
 #include "support.hpp"
 
 using namespace std;
-using namespace spica; // TODO: Remove this using directive.
 
 namespace clac::engine {
     ClacStack::~ClacStack()
@@ -33,12 +32,12 @@ namespace clac::engine {
         return return_value;
     }
 
-    entity::Entity* ClacStack::get(const VeryLong& index)
+    entity::Entity* ClacStack::get(size_t index)
     {
         entity::Entity* return_value = nullptr;
 
         if (index < data.size()) {
-            return_value = data[index.to_long()];
+            return_value = data[index];
         }
         return return_value;
     }
@@ -74,9 +73,9 @@ namespace clac::engine {
         return data.size();
     }
 
-    void ClacStack::roll_down(const VeryLong& count)
+    void ClacStack::roll_down(size_t count)
     {
-        auto raw_count = static_cast<size_t>(count.to_long());
+        size_t raw_count = count;
         if (raw_count == 0)
             raw_count = 1;
         if (raw_count > height())
@@ -90,9 +89,9 @@ namespace clac::engine {
         }
     }
 
-    void ClacStack::roll_up(const VeryLong& count)
+    void ClacStack::roll_up(size_t count)
     {
-        auto raw_count = static_cast<size_t>(count.to_long());
+        size_t raw_count = count;
         if (raw_count == 0)
             raw_count = 1;
         if (raw_count > height())
@@ -7,8 +7,8 @@
 #define CLACSTACK_HPP
 
 #include "Entity.hpp"
+#include <cstddef>
 #include <deque>
-#include <spicacpp/VeryLong.hpp>
 
 namespace clac::engine {
     /*! A class holding a stack of Entity values used during computations.
@@ -21,9 +21,8 @@ namespace clac::engine {
      * to be implemented first.
      *
      * Note that the first level of the stack (the "top" of the stack) is level zero. Stack index
-     * values are represented using VeryLong because those values typically come from entities on
-     * the parameter stack. It is recognized, however, that the type VeryLong is extreme overkill
-     * and potentially inefficient to use in this way.
+     * values typically come from integer entities on the parameter stack. Those entities hold
+     * small values as machine integers, so the indices are passed as std::size_t.
      */
     class ClacStack {
     private:
@@ -47,7 +46,7 @@ namespace clac::engine {
         entity::Entity* pop();
 
         //! Get a copy of an entity from the stack. Return nullptr if index out of bounds.
-        entity::Entity* get(const spica::VeryLong& index);
+        entity::Entity* get(std::size_t index);
 
         //! Put a copy of the argument into stack level zero. The old object, if present, is deleted.
         void put(entity::Entity* new_object);
@@ -60,16 +59,16 @@ namespace clac::engine {
 
         // TODO: Implement ClacStack::dup.
         //! Make a copy of the entity at 'level' and push it onto level 0. Return false on error.
-        bool dup(const spica::VeryLong& level = 0);
+        bool dup(std::size_t level = 0);
 
         //! Return the total height of the stack.
         size_t height();
 
         //! Rotates the top 'count' levels "down" (meaning toward lower level numbers).
-        void roll_down(const spica::VeryLong& count);
+        void roll_down(std::size_t count);
 
         //! Rotates the top 'count' levels "up" (meaning toward higher level numbers).
-        void roll_up(const spica::VeryLong& count);
+        void roll_up(std::size_t count);
 
         //! Equivalent to "3 roll_up".
         void rotate();
@@ -4,20 +4,24 @@
  */
 
 #include "Global.hpp"
-
-using namespace spica; // TODO: Remove this using directive.
+#include "BinaryEntity.hpp"
 
 namespace clac::global {
 
     // The global variables themselves.
-    VeryLong current_bit_count;
     engine::MasterStream current_word_source;
     engine::ClacStack current_stack;
 
-    // Accessor functions.
-    void set_bit_count(const VeryLong& new_bit_count)
+    // Accessor functions. The word size is kept by the entity library, which sizes binaries
+    // without depending on the engine.
+    int get_bit_count()
+    {
+        return static_cast<int>(entity::BinaryEntity::get_bit_count());
+    }
+
+    void set_bit_count(int new_bit_count)
     {
-        current_bit_count = new_bit_count;
+        entity::BinaryEntity::set_bit_count(static_cast<std::size_t>(new_bit_count));
     }
 
     engine::MasterStream& word_source()
@@ -6,14 +6,16 @@
 #ifndef GLOBAL_HPP
 #define GLOBAL_HPP
 
-#include <spicacpp/VeryLong.hpp>
-
 #include "ClacStack.hpp"
 #include "WordStream.hpp"
 
 namespace clac::global {
 
-    void set_bit_count(const spica::VeryLong& new_bit_count);
+    //! Returns the word size of binary objects.
+    int get_bit_count();
+
+    //! Sets the word size of binary objects created from now on.
+    void set_bit_count(int new_bit_count);
 
     engine::MasterStream& word_source();
     engine::ClacStack& the_stack();
@@ -9,7 +9,9 @@
 #include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 
+#include "BigFloatEntity.hpp"
 #include "BinaryEntity.hpp"
 #include "ComplexEntity.hpp"
 #include "DisplayState.hpp"
@@ -67,9 +69,16 @@ namespace {
         return buffer;
     }
 
-    VeryLong pop_int(clac::engine::ClacStack& the_stack)
+    /*!
+     * Pops an integer argument such as a count or a stack level. The value is read directly from
+     * the small form of the integer, so no VeryLong is involved.
+     *
+     * \param the_stack The stack holding the argument. \return The argument, or zero if there is
+     * no suitable argument. In that case an error message has been displayed.
+     */
+    long pop_int(clac::engine::ClacStack& the_stack)
     {
-        VeryLong return_value;
+        long return_value = 0;
 
         clac::entity::Entity* temp = the_stack.pop();
         if (temp == nullptr)
@@ -80,9 +89,17 @@ namespace {
                 clac::entity::error_message("Integer argument expected");
                 the_stack.push(temp);
             }
+            else if (!integer_temp->is_small() ||
+                     integer_temp->get_small() < numeric_limits<long>::min() ||
+                     integer_temp->get_small() > numeric_limits<long>::max()) {
+                clac::entity::error_message("Integer argument out of range");
+                the_stack.push(temp);
+                delete integer_temp;
+            }
             else {
-                return_value = integer_temp->get_value();
+                return_value = static_cast<long>(integer_temp->get_small());
                 delete integer_temp;
+                delete temp;
             }
         }
         return return_value;
@@ -118,11 +135,11 @@ namespace clac::engine {
 
     void do_dropn(ClacStack& the_stack)
     {
-        VeryLong count = pop_int(the_stack);
+        long count = pop_int(the_stack);
 
         if (count == 0)
             return;
-        for (VeryLong i = 0; i < count; ++i)
+        for (long i = 0; i < count; ++i)
             the_stack.drop();
     }
 
@@ -139,12 +156,12 @@ namespace clac::engine {
 
     void do_dupn(ClacStack& the_stack)
     {
-        VeryLong count = pop_int(the_stack);
+        long count = pop_int(the_stack);
 
         if (count == 0)
             return;
-        for (VeryLong i = 0; i < count; ++i) {
-            entity::Entity* new_copy = the_stack.get(count - 1);
+        for (long i = 0; i < count; ++i) {
+            entity::Entity* new_copy = the_stack.get(static_cast<size_t>(count - 1));
             if (new_copy != nullptr) {
                 new_copy = new_copy->duplicate();
 
@@ -154,13 +171,18 @@ namespace clac::engine {
         }
     }
 
+    void do_eager(ClacStack&)
+    {
+        display_state::set_rational_mode(display_state::EAGER);
+    }
+
     void do_eng(ClacStack& the_stack)
     {
-        VeryLong count = pop_int(the_stack);
+        long count = pop_int(the_stack);
 
         if (count == 0)
             return;
-        display_state::set_decimal_count(count.to_long());
+        display_state::set_decimal_count(static_cast<int>(count));
         display_state::set_display_mode(display_state::ENGINEERING);
     }
 
@@ -187,8 +209,8 @@ namespace clac::engine {
 
     void do_fix(ClacStack& the_stack)
     {
-        VeryLong count = pop_int(the_stack);
-        display_state::set_decimal_count(count.to_long());
+        long count = pop_int(the_stack);
+        display_state::set_decimal_count(static_cast<int>(count));
         display_state::set_display_mode(display_state::FIXED);
     }
 
@@ -213,11 +235,61 @@ namespace clac::engine {
         display_state::set_base(display_state::OCTAL);
     }
 
+    void do_lazy(ClacStack&)
+    {
+        display_state::set_rational_mode(display_state::LAZY);
+    }
+
     void do_polar(ClacStack&)
     {
         display_state::set_complex_mode(display_state::POLAR);
     }
 
+    //
+    // Replaces the base, exponent, and modulus on levels 2, 1, and 0 with base^exponent mod
+    // modulus. The power itself is never formed, so the exponent may be as large as desired.
+    //
+    void do_powmod(ClacStack& the_stack)
+    {
+        entity::Entity* base = the_stack.get(2);
+        entity::Entity* exponent = the_stack.get(1);
+        entity::Entity* modulus = the_stack.get(0);
+        if (base == nullptr || exponent == nullptr || modulus == nullptr) {
+            entity::error_message("Too few arguments");
+            return;
+        }
+
+        auto* integer_base = dynamic_cast<entity::IntegerEntity*>(base);
+        auto* integer_exponent = dynamic_cast<entity::IntegerEntity*>(exponent);
+        auto* integer_modulus = dynamic_cast<entity::IntegerEntity*>(modulus);
+        if (integer_base == nullptr || integer_exponent == nullptr || integer_modulus == nullptr) {
+            entity::error_message("Integer arguments expected");
+            return;
+        }
+
+        entity::Entity* result = integer_base->power_mod(*integer_exponent, *integer_modulus);
+        the_stack.drop();
+        the_stack.drop();
+        the_stack.drop();
+        the_stack.push(result);
+    }
+
+    void do_prec(ClacStack& the_stack)
+    {
+        long count = pop_int(the_stack);
+
+        if (count < 1) {
+            entity::error_message("Precision must be at least one digit");
+        }
+        else if (count > entity::BigFloatEntity::MAXIMUM_DIGITS) {
+            entity::error_message("Precision must be no more than %d digits",
+                                  entity::BigFloatEntity::MAXIMUM_DIGITS);
+        }
+        else {
+            display_state::set_precision(static_cast<int>(count));
+        }
+    }
+
     void do_purge(ClacStack& the_stack)
     {
         entity::Entity* temp = the_stack.pop();
@@ -354,14 +426,14 @@ namespace clac::engine {
 
     void do_roll_up(ClacStack& the_stack)
     {
-        VeryLong count = pop_int(the_stack);
-        the_stack.roll_up(count);
+        long count = pop_int(the_stack);
+        the_stack.roll_up(static_cast<size_t>(count));
     }
 
     void do_roll_down(ClacStack& the_stack)
     {
-        VeryLong count = pop_int(the_stack);
-        the_stack.roll_down(count);
+        long count = pop_int(the_stack);
+        the_stack.roll_down(static_cast<size_t>(count));
     }
 
     void do_rot(ClacStack& the_stack)
@@ -394,8 +466,8 @@ namespace clac::engine {
 
     void do_sci(ClacStack& the_stack)
     {
-        VeryLong count = pop_int(the_stack);
-        display_state::set_decimal_count(count.to_long());
+        long count = pop_int(the_stack);
+        display_state::set_decimal_count(static_cast<int>(count));
         display_state::set_display_mode(display_state::SCIENTIFIC);
     }
 
@@ -431,16 +503,17 @@ namespace clac::engine {
 
     void do_stws(ClacStack& the_stack)
     {
-        VeryLong count = pop_int(the_stack);
+        long count = pop_int(the_stack);
 
         if (count < 1) {
             entity::error_message("Word size must be at least one bit");
         }
-        else if (count > 32) {
-            entity::error_message("Word size must be no more than 32 bits");
+        else if (count > static_cast<long>(entity::BinaryEntity::MAXIMUM_BIT_COUNT)) {
+            entity::error_message("Word size must be no more than %zu bits",
+                                  entity::BinaryEntity::MAXIMUM_BIT_COUNT);
         }
         else {
-            global::set_bit_count(count);
+            global::set_bit_count(static_cast<int>(count));
         }
     }
 
@@ -545,14 +618,44 @@ namespace clac::engine {
         return;
     }
 
-    void do_shift_left(ClacStack&)
+    void do_rotate_left(ClacStack& the_stack)
     {
-        return;
+        entity::Entity* thing = the_stack.get(0);
+        if (thing == nullptr) {
+            entity::error_message("Too few arguments");
+            return;
+        }
+        the_stack.put(thing->rotate_left());
     }
 
-    void do_shift_right(ClacStack&)
+    void do_rotate_right(ClacStack& the_stack)
     {
-        return;
+        entity::Entity* thing = the_stack.get(0);
+        if (thing == nullptr) {
+            entity::error_message("Too few arguments");
+            return;
+        }
+        the_stack.put(thing->rotate_right());
+    }
+
+    void do_shift_left(ClacStack& the_stack)
+    {
+        entity::Entity* thing = the_stack.get(0);
+        if (thing == nullptr) {
+            entity::error_message("Too few arguments");
+            return;
+        }
+        the_stack.put(thing->shift_left());
+    }
+
+    void do_shift_right(ClacStack& the_stack)
+    {
+        entity::Entity* thing = the_stack.get(0);
+        if (thing == nullptr) {
+            entity::error_message("Too few arguments");
+            return;
+        }
+        the_stack.put(thing->shift_right());
     }
 
     void do_ashift_right(ClacStack&)
@@ -17,14 +17,18 @@ namespace clac::engine {
     extern void do_dropn(ClacStack&);
     extern void do_dup(ClacStack&);
     extern void do_dupn(ClacStack&);
+    extern void do_eager(ClacStack&);
     extern void do_fix(ClacStack&);
     extern void do_eng(ClacStack&);
     extern void do_eval(ClacStack&);
     extern void do_grad(ClacStack&);
     extern void do_hex(ClacStack&);
     extern void do_info(ClacStack&);
+    extern void do_lazy(ClacStack&);
     extern void do_oct(ClacStack&);
     extern void do_polar(ClacStack&);
+    extern void do_powmod(ClacStack&);
+    extern void do_prec(ClacStack&);
     extern void do_purge(ClacStack&);
     extern void do_rad(ClacStack&);
     extern void do_read(ClacStack&);
@@ -40,6 +44,8 @@ namespace clac::engine {
     // extern void do_sys         ( ClacStack & );
     extern void do_write(ClacStack&);
 
+    extern void do_rotate_left(ClacStack&);
+    extern void do_rotate_right(ClacStack&);
     extern void do_shift_left(ClacStack&);
     extern void do_shift_right(ClacStack&);
     // extern void do_ashift_right( ClacStack & );
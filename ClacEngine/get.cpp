@@ -5,11 +5,13 @@
 
 #include <cctype>
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <numbers>
 #include <string>
+#include <string_view>
 
 #include <spicacpp/Rational.hpp>
 
@@ -23,6 +25,7 @@
 #include "MatrixEntity.hpp"
 #include "RationalEntity.hpp"
 #include "StringEntity.hpp"
+#include "arithmetic.hpp"
 #include "support.hpp"
 
 #include "Global.hpp"
@@ -96,76 +99,76 @@ namespace {
 
         display_state::BaseType input_base = display_state::get_base();
 
-        string::size_type trailing = word_buffer.length() - 1;
-        switch (word_buffer[trailing]) {
+        // A trailing base letter overrides the display base. Hex digits are upper case, so the
+        // letters can't be mistaken for digits.
+        string::size_type length = word_buffer.length();
+        if (length == 0) {
+            error_message("Binary expected");
+            return nullptr;
+        }
+        switch (word_buffer[length - 1]) {
         case 'h':
             input_base = display_state::HEX;
+            --length;
             break;
         case 'b':
             input_base = display_state::BINARY;
+            --length;
             break;
         case 'd':
             input_base = display_state::DECIMAL;
+            --length;
             break;
         case 'o':
         case 'q':
             input_base = display_state::OCTAL;
+            --length;
             break;
         }
-        unsigned long value = 0UL;
-        string value_buffer(word_buffer.substr(0, trailing));
-        const char* pointer = value_buffer.c_str();
-
-        bool error = false;
-        while (*pointer && !error) {
-            switch (input_base) {
-            case display_state::DECIMAL:
-                if (!isdigit(*pointer))
-                    error = true;
-                else {
-                    value *= 10;
-                    value += *pointer - '0';
-                }
-                break;
+        const string digits(word_buffer.substr(0, length));
 
-            case display_state::BINARY:
-                if (!(*pointer == '0' || *pointer == '1'))
-                    error = true;
-                else {
-                    value *= 2;
-                    value += *pointer - '0';
-                }
-                break;
-
-            case display_state::OCTAL:
-                if (!isdigit(*pointer) || *pointer == '8' || *pointer == '9')
-                    error = true;
-                else {
-                    value *= 8;
-                    value += *pointer - '0';
-                }
-                break;
-
-            case display_state::HEX:
-                if (!(isdigit(*pointer) || (*pointer >= 'A' && *pointer <= 'F')))
-                    error = true;
-                else {
-                    value *= 16;
-                    if (!isdigit(*pointer))
-                        value += *pointer - 'A' + 10;
-                    else
-                        value += *pointer - '0';
-                }
-                break;
-            }
-            pointer++;
+        unsigned digit_bits = 0;
+        string_view legal;
+        switch (input_base) {
+        case display_state::DECIMAL:
+            legal = "0123456789";
+            break;
+        case display_state::BINARY:
+            digit_bits = 1;
+            legal = "01";
+            break;
+        case display_state::OCTAL:
+            digit_bits = 3;
+            legal = "01234567";
+            break;
+        case display_state::HEX:
+            digit_bits = 4;
+            legal = "0123456789ABCDEF";
+            break;
         }
-        if (error) {
+        if (digits.empty() || digits.find_first_not_of(legal) != string::npos) {
             error_message("%s is not a legal binary in the selected base", word_buffer.c_str());
             return nullptr;
         }
-        else
-            return new BinaryEntity(value);
+        if (input_base == display_state::DECIMAL)
+            return new BinaryEntity(arithmetic::from_decimal(digits));
+
+        // In the other bases each digit gives a fixed group of bits, which are placed directly,
+        // starting from the least significant digit.
+        const size_t bit_count = digits.size() * digit_bits;
+        const size_t word_count = (bit_count + arithmetic::LIMB_BITS - 1) / arithmetic::LIMB_BITS;
+        arithmetic::natural_t value(word_count, 0);
+        for (size_t i = 0; i < digits.size(); ++i) {
+            const arithmetic::limb_t digit = legal.find(digits[digits.size() - 1 - i]);
+            const size_t position = i * digit_bits;
+            const size_t index = position / arithmetic::LIMB_BITS;
+            const unsigned offset = position % arithmetic::LIMB_BITS;
+            value[index] |= digit << offset;
+            if (offset + digit_bits > arithmetic::LIMB_BITS)
+                value[index + 1] |= digit >> (arithmetic::LIMB_BITS - offset);
+        }
+        arithmetic::normalize(value);
+        return new BinaryEntity(value);
     }
 
     /*!
@@ -239,7 +242,16 @@ namespace {
             workspace = workspace.substr(1);
         }
 
-        VeryLong value(workspace);
+        // Eighteen decimal digits always fit in 64 bits.
+        if (workspace.size() <= 18) {
+            int64_t small_value = 0;
+            for (char digit : workspace) {
+                small_value = 10 * small_value + (digit - '0');
+            }
+            return new IntegerEntity(sign_flag * small_value);
+        }
+
+        VeryLong value = arithmetic::from_string(workspace);
         if (sign_flag == -1)
             value = -value;
         return new IntegerEntity(value);
@@ -351,7 +363,7 @@ namespace {
         if (sign_flag == -1)
             vl_numerator = -vl_numerator;
 
-        return new RationalEntity(Rational<VeryLong>(vl_numerator, vl_denominator));
+        return new RationalEntity(vl_numerator, vl_denominator);
     }
 
     /*!
@@ -0,0 +1,310 @@
+/*! \file    BigFloatEntity.cpp
+ *  \brief   Implementation of the Clac numeric type BigFloatEntity.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * The value is held in binary, with enough bits for the precision in decimal digits, and is
+ * converted to decimal only for display. The digits shown are the value rounded to that many
+ * significant decimal digits, with trailing zeros after the decimal point removed.
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <utility>
+
+#include "DisplayState.hpp"
+#include "Entities.hpp"
+#include "arithmetic.hpp"
+
+using namespace std;
+
+namespace {
+
+    using clac::arithmetic::BigFloat;
+
+    //! The fixed format is used for decimal exponents down to this one.
+    constexpr int64_t SMALLEST_FIXED_EXPONENT = -6;
+
+    //! Removes trailing zeros from a string of fraction digits, leaving at least one digit. An
+    //! empty fraction, when every digit is before the point, becomes "0".
+    string trimmed(string fraction)
+    {
+        const size_t last = fraction.find_last_not_of('0');
+        if (last == string::npos)
+            return "0";
+        fraction.erase(last + 1);
+        return fraction;
+    }
+
+    //! Returns d.ddd followed by an exponent of at least two digits.
+    string exponent_form(const string& digits, int64_t exponent, size_t whole_count)
+    {
+        string result = digits.substr(0, whole_count) + "." + trimmed(digits.substr(whole_count));
+        const int64_t shown = exponent - static_cast<int64_t>(whole_count) + 1;
+        string exponent_digits = to_string(std::abs(shown));
+        if (exponent_digits.size() < 2)
+            exponent_digits.insert(0, 1, '0');
+        return result + "E" + (shown < 0 ? "-" : "+") + exponent_digits;
+    }
+
+    string format(const BigFloat& number, int digit_count)
+    {
+        namespace display_state = clac::display_state;
+
+        const auto count = static_cast<size_t>(digit_count);
+        int64_t exponent = 0;
+        string digits(count, '0');
+        if (!number.mantissa.empty())
+            digits = clac::arithmetic::to_decimal(number, count, exponent);
+
+        // The exponent and engineering forms need at least three digits to work with.
+        if (digits.size() < 3)
+            digits.append(3 - digits.size(), '0');
+
+        string result;
+        switch (display_state::get_display_mode()) {
+        case display_state::FIXED:
+            if (exponent >= static_cast<int64_t>(digits.size()) ||
+                exponent < SMALLEST_FIXED_EXPONENT) {
+                result = exponent_form(digits, exponent, 1);
+            }
+            else if (exponent >= 0) {
+                const auto whole_count = static_cast<size_t>(exponent) + 1;
+                result =
+                    digits.substr(0, whole_count) + "." + trimmed(digits.substr(whole_count));
+            }
+            else {
+                result = "0." + string(static_cast<size_t>(-exponent - 1), '0') + trimmed(digits);
+            }
+            break;
+
+        case display_state::SCIENTIFIC:
+            result = exponent_form(digits, exponent, 1);
+            break;
+
+        case display_state::ENGINEERING: {
+            // The exponent shown is a multiple of three.
+            const int64_t excess = ((exponent % 3) + 3) % 3;
+            result = exponent_form(digits, exponent, static_cast<size_t>(excess) + 1);
+        } break;
+
+        default:
+            result = "INTERNAL ERROR: Bad display mode";
+            break;
+        }
+        return number.negative ? "-" + result : result;
+    }
+
+} // namespace
+
+namespace clac::entity {
+
+    size_t BigFloatEntity::bits_for(int digits) noexcept
+    {
+        return static_cast<size_t>(std::ceil(digits * 3.321928094887362)); // log2(10)
+    }
+
+    BigFloatEntity::BigFloatEntity(const BigFloat& number)
+        : digits(display_state::get_precision())
+    {
+        value = arithmetic::round_float(number, bits_for(digits));
+    }
+
+    BigFloatEntity::BigFloatEntity(BigFloat number, int digit_count) noexcept
+        : value(std::move(number)), digits(digit_count)
+    {
+    }
+
+    EntityType BigFloatEntity::my_type() const noexcept
+    {
+        return BIGFLOAT;
+    }
+
+    std::string BigFloatEntity::display() const
+    {
+        return format(value, digits);
+    }
+
+    Entity* BigFloatEntity::duplicate() const
+    {
+        return new BigFloatEntity(value, digits);
+    }
+
+    //
+    // Unary operations
+    //
+
+    Entity* BigFloatEntity::abs() const
+    {
+        BigFloat result = value;
+        result.negative = false;
+        return new BigFloatEntity(std::move(result), digits);
+    }
+
+    Entity* BigFloatEntity::inv() const
+    {
+        if (value.mantissa.empty())
+            throw Error("Can't divide by zero");
+        const int precision = display_state::get_precision();
+        const BigFloat one{arithmetic::natural_t{1}};
+        return new BigFloatEntity(
+            arithmetic::divide(one, value, bits_for(precision)), precision);
+    }
+
+    Entity* BigFloatEntity::neg() const
+    {
+        BigFloat result = value;
+        result.negative = !result.negative && !result.mantissa.empty();
+        return new BigFloatEntity(std::move(result), digits);
+    }
+
+    Entity* BigFloatEntity::sign() const
+    {
+        BigFloat result;
+        if (!value.mantissa.empty()) {
+            result.mantissa = arithmetic::natural_t{1};
+            result.negative = value.negative;
+        }
+        return new BigFloatEntity(std::move(result), digits);
+    }
+
+    Entity* BigFloatEntity::sq() const
+    {
+        const int precision = display_state::get_precision();
+        return new BigFloatEntity(
+            arithmetic::multiply(value, value, bits_for(precision)), precision);
+    }
+
+    Entity* BigFloatEntity::sqrt() const
+    {
+        if (value.negative)
+            throw Error("Can't take the square root of a negative big float");
+        const int precision = display_state::get_precision();
+        return new BigFloatEntity(arithmetic::square_root(value, bits_for(precision)), precision);
+    }
+
+    //
+    // Binary operations
+    //
+
+    Entity* BigFloatEntity::divide(const Entity* R) const
+    {
+        const BigFloatEntity* right = dynamic_cast<const BigFloatEntity*>(R);
+        if (right->value.mantissa.empty())
+            throw Error("Can't divide by zero");
+        const int precision = display_state::get_precision();
+        return new BigFloatEntity(
+            arithmetic::divide(value, right->value, bits_for(precision)), precision);
+    }
+
+    Entity* BigFloatEntity::minus(const Entity* R) const
+    {
+        const BigFloatEntity* right = dynamic_cast<const BigFloatEntity*>(R);
+        const int precision = display_state::get_precision();
+        return new BigFloatEntity(
+            arithmetic::subtract(value, right->value, bits_for(precision)), precision);
+    }
+
+    Entity* BigFloatEntity::multiply(const Entity* R) const
+    {
+        const BigFloatEntity* right = dynamic_cast<const BigFloatEntity*>(R);
+        const int precision = display_state::get_precision();
+        return new BigFloatEntity(
+            arithmetic::multiply(value, right->value, bits_for(precision)), precision);
+    }
+
+    Entity* BigFloatEntity::plus(const Entity* R) const
+    {
+        const BigFloatEntity* right = dynamic_cast<const BigFloatEntity*>(R);
+        const int precision = display_state::get_precision();
+        return new BigFloatEntity(
+            arithmetic::add(value, right->value, bits_for(precision)), precision);
+    }
+
+    //
+    // Relational operations
+    //
+
+    Entity* BigFloatEntity::is_equal(const Entity* R) const
+    {
+        const BigFloatEntity* right = dynamic_cast<const BigFloatEntity*>(R);
+        return new IntegerEntity(arithmetic::compare(value, right->value) == 0);
+    }
+
+    Entity* BigFloatEntity::is_notequal(const Entity* R) const
+    {
+        const BigFloatEntity* right = dynamic_cast<const BigFloatEntity*>(R);
+        return new IntegerEntity(arithmetic::compare(value, right->value) != 0);
+    }
+
+    Entity* BigFloatEntity::is_less(const Entity* R) const
+    {
+        const BigFloatEntity* right = dynamic_cast<const BigFloatEntity*>(R);
+        return new IntegerEntity(arithmetic::compare(value, right->value) < 0);
+    }
+
+    Entity* BigFloatEntity::is_lessorequal(const Entity* R) const
+    {
+        const BigFloatEntity* right = dynamic_cast<const BigFloatEntity*>(R);
+        return new IntegerEntity(arithmetic::compare(value, right->value) <= 0);
+    }
+
+    Entity* BigFloatEntity::is_greater(const Entity* R) const
+    {
+        const BigFloatEntity* right = dynamic_cast<const BigFloatEntity*>(R);
+        return new IntegerEntity(arithmetic::compare(value, right->value) > 0);
+    }
+
+    Entity* BigFloatEntity::is_greaterorequal(const Entity* R) const
+    {
+        const BigFloatEntity* right = dynamic_cast<const BigFloatEntity*>(R);
+        return new IntegerEntity(arithmetic::compare(value, right->value) >= 0);
+    }
+
+    //
+    // Conversions from BigFloatEntity
+    //
+
+    //
+    // The value is rounded to the current precision, which may be lower than the one it was
+    // computed with.
+    //
+    Entity* BigFloatEntity::to_bigfloat() const
+    {
+        return new BigFloatEntity(value);
+    }
+
+    Entity* BigFloatEntity::to_float() const
+    {
+        const double result = arithmetic::to_double(value);
+        if (std::isinf(result))
+            throw Error("Overflow: Can't convert such a large big float to a float");
+        return new FloatEntity(result);
+    }
+
+    //
+    // The value is rounded to the nearest integer, with halfway cases rounded to even.
+    //
+    Entity* BigFloatEntity::to_integer() const
+    {
+        const arithmetic::natural_t magnitude = arithmetic::nearest_integer(value);
+        return new IntegerEntity(arithmetic::to_verylong(magnitude, value.negative));
+    }
+
+    //
+    // Every big float is a rational number with a power of two as its denominator.
+    //
+    Entity* BigFloatEntity::to_rational() const
+    {
+        arithmetic::natural_t numerator = value.mantissa;
+        arithmetic::natural_t denominator{1};
+        if (value.exponent >= 0)
+            numerator = arithmetic::shift_left(numerator, static_cast<size_t>(value.exponent));
+        else
+            denominator = arithmetic::shift_left(denominator, static_cast<size_t>(-value.exponent));
+        return new RationalEntity(
+            arithmetic::to_verylong(numerator, value.negative),
+            arithmetic::to_verylong(denominator));
+    }
+}
@@ -0,0 +1,79 @@
+/*! \file    BigFloatEntity.hpp
+ *  \brief   Interface to the Clac numeric type BigFloatEntity.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ */
+
+#ifndef BIGFLOATENTITY_HPP
+#define BIGFLOATENTITY_HPP
+
+#include <cstddef>
+
+#include "Entity.hpp"
+#include "bigfloat.hpp"
+
+namespace clac::entity {
+    /*!
+     * A binary floating point number with as many significant decimal digits as the precision
+     * (see display_state::get_precision) in force when it was computed. Each operation rounds its
+     * exact result to the current precision, and each value is displayed with the number of
+     * digits it was computed with.
+     */
+    class BigFloatEntity : public Entity {
+    public:
+        //! The largest precision, in decimal digits, that may be set.
+        static constexpr int MAXIMUM_DIGITS = 10000000;
+
+        //! Returns the number of bits needed to hold 'digits' significant decimal digits.
+        static std::size_t bits_for(int digits) noexcept;
+
+        // Rounds 'number' to the current precision.
+        explicit BigFloatEntity(const arithmetic::BigFloat& number);
+
+        const arithmetic::BigFloat& get_value() const noexcept
+        {
+            return value;
+        }
+
+        // Functions for maintaining a member of the Entity family.
+        EntityType my_type() const noexcept override;
+        std::string display() const override;
+        Entity* duplicate() const override;
+
+        // Unary operations.
+        Entity* abs() const override;
+        Entity* inv() const override;
+        Entity* neg() const override;
+        Entity* sign() const override;
+        Entity* sq() const override;
+        Entity* sqrt() const override;
+
+        // Conversion functions.
+        Entity* to_bigfloat() const override;
+        Entity* to_float() const override;
+        Entity* to_integer() const override;
+        Entity* to_rational() const override;
+
+        // Binary operations.
+        Entity* divide(const Entity*) const override;
+        Entity* minus(const Entity*) const override;
+        Entity* multiply(const Entity*) const override;
+        Entity* plus(const Entity*) const override;
+
+        // Relational operations.
+        Entity* is_equal(const Entity*) const override;
+        Entity* is_notequal(const Entity*) const override;
+        Entity* is_less(const Entity*) const override;
+        Entity* is_lessorequal(const Entity*) const override;
+        Entity* is_greater(const Entity*) const override;
+        Entity* is_greaterorequal(const Entity*) const override;
+
+    private:
+        // Takes a value that is already rounded to 'digits' decimal digits.
+        BigFloatEntity(arithmetic::BigFloat number, int digits) noexcept;
+
+        arithmetic::BigFloat value;
+        int digits; // The precision the value was computed with.
+    };
+}
+
+#endif
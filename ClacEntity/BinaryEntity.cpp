@@ -2,132 +2,238 @@
  *  \brief   Implementation of the Clac numeric type BinaryEntity.
  *  \author  Peter Chapin <spicacality@kelseymountain.org>
  *
- * Objects of this class are unsigned integers which can be manipulated on a bitwise bases. The
- * current implementation allows for a maximum of 32 bits. The actual number of bits being used
- * is controlled by the user and available through Global::get_bit_count. Every time an
- * operation is applied to a BinaryEntity, the most significant bits (which are unused) are
- * masked to zero by the function normalize.
+ * Objects of this class are unsigned integers which can be manipulated on a bitwise basis. The
+ * number of bits, the word size, is controlled by the user with the stws action and may be
+ * anything up to MAXIMUM_BIT_COUNT. The bits are packed into 64-bit words so that arithmetic,
+ * logic, shifts, and rotations all work a word at a time, using the limb kernels of the integer
+ * arithmetic where they apply.
+ *
+ * The number of words and the mask of the bits used in the top word are computed once, when the
+ * word size changes. Every operation produces its result at the current word size and then masks
+ * the top word to zero the unused bits. Only the top word needs it: carries and shifts out of the
+ * lower words land in words that are part of the result.
  */
 
+#include <algorithm>
+#include <memory>
+
 #include "DisplayState.hpp"
 #include "Entities.hpp"
+#include "kernels.hpp"
 #include "support.hpp"
-#include <memory>
 
 using namespace std;
 
-// Number of decimal digits required to display the binaries with bit counts from 1 to 32. This
-// is used in the display method. (currently not used)
-//
-#ifdef NEVER
-static int power_sizes[] = {1, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 4,  5,  5, 5,
-                            6, 6, 6, 7, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10, 10};
-#endif
-
-// Zero out most significant bits depending on the number of bits in the entity.
-static unsigned long bit_mask[] = {
-    0x00000000UL, 0x00000001UL, 0x00000003UL, 0x00000007UL, 0x0000000FUL, 0x0000001FUL,
-    0x0000003FUL, 0x0000007FUL, 0x000000FFUL, 0x000001FFUL, 0x000003FFUL, 0x000007FFUL,
-    0x00000FFFUL, 0x00001FFFUL, 0x00003FFFUL, 0x00007FFFUL, 0x0000FFFFUL, 0x0001FFFFUL,
-    0x0003FFFFUL, 0x0007FFFFUL, 0x000FFFFFUL, 0x001FFFFFUL, 0x003FFFFFUL, 0x007FFFFFUL,
-    0x00FFFFFFUL, 0x01FFFFFFUL, 0x03FFFFFFUL, 0x07FFFFFFUL, 0x0FFFFFFFUL, 0x1FFFFFFFUL,
-    0x3FFFFFFFUL, 0x7FFFFFFFUL, 0xFFFFFFFFUL};
+namespace clac::entity {
 
-#ifdef NEVER
+    using arithmetic::limb_t;
+    using arithmetic::LIMB_BITS;
+    using arithmetic::natural_t;
 
-// The following function was used in the original Clac to format binary entities. It needs to
-// be updated for the current system.
+    namespace {
 
-static char* format_binary(unsigned long number)
-{
-    // Contains the final string. String is loaded in reverse order.
-    static char number_buffer[128];
+        size_t word_count(size_t bit_count) noexcept
+        {
+            return (bit_count + LIMB_BITS - 1) / LIMB_BITS;
+        }
 
-    char* buffer_pointer = number_buffer;
-    int digit_count;
+        limb_t top_mask(size_t bit_count) noexcept
+        {
+            const size_t extra = bit_count % LIMB_BITS;
+            return (extra == 0) ? ~limb_t{0} : (limb_t{1} << extra) - 1;
+        }
 
-    switch (display_state::get_base()) {
+        // The word size of new binaries, the number of words it takes, and the bits it uses in
+        // the top word.
+        size_t current_bit_count = 16;
+        size_t current_word_count = 1;
+        limb_t current_top_mask = 0xFFFF;
+
+        //! r = a << count for n word arrays. The bits shifted past the top of r are lost.
+        void shift_words_left(limb_t* r, const limb_t* a, size_t n, size_t count) noexcept
+        {
+            const size_t word_shift = count / LIMB_BITS;
+            const unsigned bit_shift = count % LIMB_BITS;
+            if (word_shift >= n) {
+                fill(r, r + n, limb_t{0});
+                return;
+            }
+            copy(a, a + n - word_shift, r + word_shift);
+            fill(r, r + word_shift, limb_t{0});
+            if (bit_shift != 0)
+                arithmetic::lshift(r + word_shift, r + word_shift, n - word_shift, bit_shift);
+        }
 
-    case display_state::HEX: {
+        //! r = a >> count for n word arrays.
+        void shift_words_right(limb_t* r, const limb_t* a, size_t n, size_t count) noexcept
+        {
+            const size_t word_shift = count / LIMB_BITS;
+            const unsigned bit_shift = count % LIMB_BITS;
+            if (word_shift >= n) {
+                fill(r, r + n, limb_t{0});
+                return;
+            }
+            copy(a + word_shift, a + n, r);
+            fill(r + n - word_shift, r + n, limb_t{0});
+            if (bit_shift != 0)
+                arithmetic::rshift(r, r, n - word_shift, bit_shift);
+        }
 
-        // In HEX, there are four bits per digit.
-        digit_count = (Global::get_bit_count() - 1) / 4 + 1;
+        //
+        // r = a rotated left by count places within a word of bit_count bits, where
+        // count < bit_count and the bits of a above bit_count are zero. The rotation is the or of
+        // a shifted left by count and a shifted right by bit_count - count.
+        //
+        void rotate_words_left(
+            limb_t* r, const limb_t* a, size_t n, size_t bit_count, size_t count)
+        {
+            if (count == 0) {
+                copy(a, a + n, r);
+                return;
+            }
+            natural_t low(n);
+            shift_words_left(r, a, n, count);
+            shift_words_right(low.data(), a, n, bit_count - count);
+            for (size_t i = 0; i < n; ++i) {
+                r[i] |= low[i];
+            }
+        }
 
-        // Install suffix character and loop over all required digits.
-        *buffer_pointer++ = 'h';
-        for (int counter = 0; counter < digit_count; counter++) {
+        //
+        // Reads a shift or rotation count from a binary, taken as a two's complement number of
+        // the binary's own word size. Returns the magnitude and sets 'negative'.
+        //
+        natural_t signed_count(const BinaryEntity& count, bool& negative)
+        {
+            natural_t bits = count.get_value();
+            const size_t sign_bit = count.bit_count() - 1;
+            negative = sign_bit / LIMB_BITS < bits.size() &&
+                       ((bits[sign_bit / LIMB_BITS] >> (sign_bit % LIMB_BITS)) & 1) != 0;
+            if (negative) {
+                const natural_t modulus = arithmetic::shift_left(natural_t{1}, count.bit_count());
+                return arithmetic::subtract(modulus, bits);
+            }
+            return bits;
+        }
 
-            // Compute digit and install in number_buffer.
-            int digit = static_cast<int>(number % 16);
-            if (digit >= 10)
-                *buffer_pointer++ = static_cast<char>(digit + 'A' - 10);
-            else
-                *buffer_pointer++ = static_cast<char>(digit + '0');
-            number /= 16;
+        //
+        // Reads a shift or rotation count from a binary as above, or from an integer, which keeps
+        // its own sign. An unevaluated integer is far too large to be a count.
+        //
+        natural_t signed_count(const Entity* count, bool& negative)
+        {
+            if (const BinaryEntity* binary = dynamic_cast<const BinaryEntity*>(count))
+                return signed_count(*binary, negative);
+
+            const IntegerEntity* integer = dynamic_cast<const IntegerEntity*>(count);
+            if (integer->is_deferred())
+                throw Entity::Error("Count is too large");
+            negative = integer->is_negative();
+            const spica::VeryLong value = integer->get_value();
+            return arithmetic::to_natural(negative ? -value : value);
         }
-    } break;
 
-    case display_state::BINARY: {
+    } // namespace
 
-        // In binary, the number of digits IS the digit count.
-        digit_count = Global::get_bit_count();
+    size_t BinaryEntity::get_bit_count() noexcept
+    {
+        return current_bit_count;
+    }
 
-        // Process digits.
-        *buffer_pointer++ = 'b';
-        for (int counter = 0; counter < digit_count; counter++) {
-            int digit = static_cast<int>(number % 2);
-            *buffer_pointer++ = static_cast<char>(digit + '0');
-            number /= 2;
-        }
-    } break;
+    void BinaryEntity::set_bit_count(size_t bit_count)
+    {
+        if (bit_count < 1 || bit_count > MAXIMUM_BIT_COUNT)
+            throw Error("Word size out of range");
+        current_bit_count = bit_count;
+        current_word_count = word_count(bit_count);
+        current_top_mask = top_mask(bit_count);
+    }
 
-    case display_state::OCTAL: {
+    BinaryEntity::BinaryEntity() : words(current_word_count, 0), width(current_bit_count)
+    {
+    }
 
-        // In octal, the are three bits per digit.
-        digit_count = (Global::get_bit_count() - 1) / 3 + 1;
+    BinaryEntity::BinaryEntity(unsigned long number) : BinaryEntity()
+    {
+        words[0] = number;
+        normalize();
+    }
 
-        // Process digits.
-        *buffer_pointer++ = 'o';
-        for (int counter = 0; counter < digit_count; counter++) {
-            int digit = static_cast<int>(number % 8);
-            *buffer_pointer++ = static_cast<char>(digit + '0');
-            number /= 8;
-        }
-    } break;
+    BinaryEntity::BinaryEntity(const natural_t& number) : BinaryEntity()
+    {
+        copy_n(number.begin(), min(number.size(), words.size()), words.begin());
+        normalize();
+    }
 
-    case display_state::DECIMAL: {
+    natural_t BinaryEntity::get_value() const
+    {
+        natural_t result(words);
+        arithmetic::normalize(result);
+        return result;
+    }
 
-        // In decimal, look up the required number of digits in power_sizes.
-        digit_count = power_sizes[Global::get_bit_count()];
+    // This is only applied to binaries of the current word size.
+    void BinaryEntity::normalize() noexcept
+    {
+        words.back() &= current_top_mask;
+    }
 
-        // Process digits.
-        *buffer_pointer++ = 'd';
-        for (int counter = 0; counter < digit_count; counter++) {
-            int digit = static_cast<int>(number % 10);
-            *buffer_pointer++ = static_cast<char>(digit + '0');
-            number /= 10;
-        }
-    } break;
+    const natural_t& BinaryEntity::current_words(natural_t& scratch) const
+    {
+        if (width == current_bit_count)
+            return words;
+        scratch.assign(current_word_count, 0);
+        copy_n(words.begin(), min(words.size(), scratch.size()), scratch.begin());
+        scratch.back() &= current_top_mask;
+        return scratch;
     }
 
-    // Install the "# " prefix.
-    *buffer_pointer++ = ' ';
-    *buffer_pointer++ = '#';
-    *buffer_pointer++ = '\0';
+    //
+    // Applies 'operation', which computes r from a and b, all n words long, to this binary and
+    // the binary 'R' at the current word size.
+    //
+    template<typename Operation>
+    Entity* BinaryEntity::combine(const Entity* R, Operation operation) const
+    {
+        const BinaryEntity* right = dynamic_cast<const BinaryEntity*>(R);
+        natural_t left_scratch, right_scratch;
+        const natural_t& a = current_words(left_scratch);
+        const natural_t& b = right->current_words(right_scratch);
 
-    // Reverse the string so that the number is displayed properly.
-    strrev(number_buffer);
-    return number_buffer;
-}
-#endif
+        unique_ptr<BinaryEntity> result(new BinaryEntity);
+        operation(result->words.data(), a.data(), b.data(), current_word_count);
+        result->normalize();
+        return result.release();
+    }
 
-namespace clac::entity {
-    void BinaryEntity::normalize() noexcept
+    void BinaryEntity::divide_words(
+        const Entity* R, natural_t& quotient, natural_t& remainder) const
+    {
+        const BinaryEntity* right = dynamic_cast<const BinaryEntity*>(R);
+        natural_t left_scratch, right_scratch;
+        natural_t dividend = current_words(left_scratch);
+        natural_t divisor = right->current_words(right_scratch);
+        arithmetic::normalize(dividend);
+        arithmetic::normalize(divisor);
+        if (divisor.empty())
+            throw Error("Can't divide by zero");
+        arithmetic::divide(dividend, divisor, quotient, remainder);
+    }
+
+    //
+    // Applies 'operation', which computes r from a, both n words long, to this binary at the
+    // current word size.
+    //
+    template<typename Operation>
+    Entity* BinaryEntity::transform(Operation operation) const
     {
-        // value &= bit_mask[Global::get_bit_count( )];
-        // What should be done about global settings in the entity library?
+        natural_t scratch;
+        const natural_t& a = current_words(scratch);
 
-        value &= bit_mask[16];
+        unique_ptr<BinaryEntity> result(new BinaryEntity);
+        operation(result->words.data(), a.data(), current_word_count);
+        result->normalize();
+        return result.release();
     }
 
     EntityType BinaryEntity::my_type() const noexcept
@@ -135,14 +241,51 @@ namespace clac::entity {
         return BINARY;
     }
 
+    //
+    // Binaries are displayed in the base chosen with the bin, oct, dec, and hex actions, in the
+    // form they are entered. Apart from decimal, every digit of the word size is shown.
+    //
     string BinaryEntity::display() const
     {
-        return "BinaryEntity::display( ) not implemented!";
+        unsigned digit_bits;
+        char suffix;
+        switch (display_state::get_base()) {
+        case display_state::DECIMAL:
+            return "# " + arithmetic::to_decimal(get_value()) + "d";
+        case display_state::BINARY:
+            digit_bits = 1;
+            suffix = 'b';
+            break;
+        case display_state::OCTAL:
+            digit_bits = 3;
+            suffix = 'o';
+            break;
+        default:
+            digit_bits = 4;
+            suffix = 'h';
+            break;
+        }
+
+        const size_t digit_count = (width + digit_bits - 1) / digit_bits;
+        const limb_t digit_mask = (limb_t{1} << digit_bits) - 1;
+        string result("# ");
+        result.reserve(digit_count + 3);
+        for (size_t i = digit_count; i > 0; --i) {
+            const size_t position = (i - 1) * digit_bits;
+            const size_t index = position / LIMB_BITS;
+            const unsigned offset = position % LIMB_BITS;
+            limb_t digit = words[index] >> offset;
+            if (offset + digit_bits > LIMB_BITS && index + 1 < words.size())
+                digit |= words[index + 1] << (LIMB_BITS - offset);
+            result += "0123456789ABCDEF"[digit & digit_mask];
+        }
+        result += suffix;
+        return result;
     }
 
     Entity* BinaryEntity::duplicate() const
     {
-        return new BinaryEntity(value);
+        return new BinaryEntity(*this);
     }
 
     //
@@ -172,6 +315,11 @@ namespace clac::entity {
         return converted->atan();
     }
 
+    Entity* BinaryEntity::bit_length() const
+    {
+        return new IntegerEntity(static_cast<int64_t>(arithmetic::bit_length(get_value())));
+    }
+
     Entity* BinaryEntity::complex_conjugate() const
     {
         return duplicate();
@@ -230,17 +378,56 @@ namespace clac::entity {
 
     Entity* BinaryEntity::logical_not() const
     {
-        const unsigned long new_value = ~value;
-        BinaryEntity* result = new BinaryEntity(new_value);
-        return result;
+        return transform([](limb_t* r, const limb_t* a, size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                r[i] = ~a[i];
+            }
+        });
     }
 
+    // The two's complement: the complement plus one.
     Entity* BinaryEntity::neg() const
     {
-        unsigned long new_value = ~value;
-        new_value++;
-        BinaryEntity* result = new BinaryEntity(new_value);
-        return result;
+        return transform([](limb_t* r, const limb_t* a, size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                r[i] = ~a[i];
+            }
+            arithmetic::add_1(r, r, n, 1);
+        });
+    }
+
+    Entity* BinaryEntity::population_count() const
+    {
+        return new IntegerEntity(
+            static_cast<int64_t>(arithmetic::popcount_n(words.data(), words.size())));
+    }
+
+    Entity* BinaryEntity::rotate_left() const
+    {
+        return transform([](limb_t* r, const limb_t* a, size_t n) {
+            rotate_words_left(r, a, n, current_bit_count, 1 % current_bit_count);
+        });
+    }
+
+    Entity* BinaryEntity::rotate_right() const
+    {
+        return transform([](limb_t* r, const limb_t* a, size_t n) {
+            rotate_words_left(r, a, n, current_bit_count, current_bit_count - 1);
+        });
+    }
+
+    Entity* BinaryEntity::shift_left() const
+    {
+        return transform([](limb_t* r, const limb_t* a, size_t n) {
+            arithmetic::lshift(r, a, n, 1);
+        });
+    }
+
+    Entity* BinaryEntity::shift_right() const
+    {
+        return transform([](limb_t* r, const limb_t* a, size_t n) {
+            arithmetic::rshift(r, a, n, 1);
+        });
     }
 
     //
@@ -249,58 +436,134 @@ namespace clac::entity {
 
     Entity* BinaryEntity::divide(const Entity* R) const
     {
-        const BinaryEntity* right = dynamic_cast<const BinaryEntity*>(R);
-        const unsigned long new_value = value / right->value;
-        BinaryEntity* result = new BinaryEntity(new_value);
-        return result;
+        natural_t quotient, remainder;
+        divide_words(R, quotient, remainder);
+        return new BinaryEntity(quotient);
     }
 
     Entity* BinaryEntity::logical_and(const Entity* R) const
     {
-        const BinaryEntity* right = dynamic_cast<const BinaryEntity*>(R);
-        const unsigned long new_value = value & right->value;
-        BinaryEntity* result = new BinaryEntity(new_value);
-        return result;
+        return combine(R, [](limb_t* r, const limb_t* a, const limb_t* b, size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                r[i] = a[i] & b[i];
+            }
+        });
     }
 
     Entity* BinaryEntity::logical_or(const Entity* R) const
     {
-        const BinaryEntity* right = dynamic_cast<const BinaryEntity*>(R);
-        const unsigned long new_value = value | right->value;
-        BinaryEntity* result = new BinaryEntity(new_value);
-        return result;
+        return combine(R, [](limb_t* r, const limb_t* a, const limb_t* b, size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                r[i] = a[i] | b[i];
+            }
+        });
     }
 
     Entity* BinaryEntity::logical_xor(const Entity* R) const
     {
-        const BinaryEntity* right = dynamic_cast<const BinaryEntity*>(R);
-        const unsigned long new_value = value ^ right->value;
-        BinaryEntity* result = new BinaryEntity(new_value);
-        return result;
+        return combine(R, [](limb_t* r, const limb_t* a, const limb_t* b, size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                r[i] = a[i] ^ b[i];
+            }
+        });
     }
 
     Entity* BinaryEntity::minus(const Entity* R) const
     {
-        const BinaryEntity* right = dynamic_cast<const BinaryEntity*>(R);
-        const unsigned long new_value = value - right->value;
-        BinaryEntity* result = new BinaryEntity(new_value);
-        return result;
+        return combine(R, [](limb_t* r, const limb_t* a, const limb_t* b, size_t n) {
+            arithmetic::sub_n(r, a, b, n);
+        });
+    }
+
+    Entity* BinaryEntity::modulo(const Entity* R) const
+    {
+        natural_t quotient, remainder;
+        divide_words(R, quotient, remainder);
+        return new BinaryEntity(remainder);
     }
 
+    //
+    // Only the low n words of the product are needed, so row i of the schoolbook product is cut
+    // off at n - i words. That is about half the work of a full product.
+    //
     Entity* BinaryEntity::multiply(const Entity* R) const
     {
-        const BinaryEntity* right = dynamic_cast<const BinaryEntity*>(R);
-        const unsigned long new_value = value * right->value;
-        BinaryEntity* result = new BinaryEntity(new_value);
-        return result;
+        return combine(R, [](limb_t* r, const limb_t* a, const limb_t* b, size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                if (b[i] != 0)
+                    arithmetic::addmul_1(r + i, a, n - i, b[i]);
+            }
+        });
     }
 
     Entity* BinaryEntity::plus(const Entity* R) const
+    {
+        return combine(R, [](limb_t* r, const limb_t* a, const limb_t* b, size_t n) {
+            arithmetic::add_n(r, a, b, n);
+        });
+    }
+
+    //
+    // Rotates left by the number of places in R, or right if R is negative. A binary R is read as
+    // a two's complement number. Only the count modulo the word size matters.
+    //
+    Entity* BinaryEntity::rotate(const Entity* R) const
+    {
+        bool negative;
+        const natural_t magnitude = signed_count(R, negative);
+        size_t places = 0;
+        if (!magnitude.empty()) {
+            natural_t quotient(magnitude.size());
+            places = static_cast<size_t>(arithmetic::divrem_1(
+                quotient.data(), magnitude.data(), magnitude.size(), current_bit_count));
+        }
+        const size_t count = (negative && places != 0) ? current_bit_count - places : places;
+
+        return transform([count](limb_t* r, const limb_t* a, size_t n) {
+            rotate_words_left(r, a, n, current_bit_count, count);
+        });
+    }
+
+    //
+    // Shifts left by the number of places in R, or right if R is negative. A binary R is read as
+    // a two's complement number. Shifting by the word size or more leaves zero.
+    //
+    Entity* BinaryEntity::shift(const Entity* R) const
+    {
+        bool negative;
+        const natural_t magnitude = signed_count(R, negative);
+        size_t count = current_bit_count;
+        if (magnitude.empty())
+            count = 0;
+        else if (magnitude.size() == 1 && magnitude[0] < current_bit_count)
+            count = static_cast<size_t>(magnitude[0]);
+
+        return transform([count, negative](limb_t* r, const limb_t* a, size_t n) {
+            if (negative)
+                shift_words_right(r, a, n, count);
+            else
+                shift_words_left(r, a, n, count);
+        });
+    }
+
+    //
+    // Relational operations
+    //
+
+    Entity* BinaryEntity::is_equal(const Entity* R) const
     {
         const BinaryEntity* right = dynamic_cast<const BinaryEntity*>(R);
-        const unsigned long new_value = value + right->value;
-        BinaryEntity* result = new BinaryEntity(new_value);
-        return result;
+        natural_t left_scratch, right_scratch;
+        const natural_t& left_words = current_words(left_scratch);
+        return new IntegerEntity(left_words == right->current_words(right_scratch));
+    }
+
+    Entity* BinaryEntity::is_notequal(const Entity* R) const
+    {
+        const BinaryEntity* right = dynamic_cast<const BinaryEntity*>(R);
+        natural_t left_scratch, right_scratch;
+        const natural_t& left_words = current_words(left_scratch);
+        return new IntegerEntity(left_words != right->current_words(right_scratch));
     }
 
     //
@@ -314,16 +577,16 @@ namespace clac::entity {
 
     Entity* BinaryEntity::to_complex() const
     {
-        return new ComplexEntity(static_cast<double>(value));
+        return new ComplexEntity(arithmetic::to_double(get_value()));
     }
 
     Entity* BinaryEntity::to_float() const
     {
-        return new FloatEntity(static_cast<double>(value));
+        return new FloatEntity(arithmetic::to_double(get_value()));
     }
 
     Entity* BinaryEntity::to_integer() const
     {
-        return new IntegerEntity(value);
+        return new IntegerEntity(arithmetic::to_verylong(get_value()));
     }
 }
@@ -6,20 +6,47 @@
 #ifndef BINARYENTITY_HPP
 #define BINARYENTITY_HPP
 
-#include "Entity.hpp"
+#include <cstddef>
 #include <string>
 
+#include "Entity.hpp"
+#include "arithmetic.hpp"
+
 namespace clac::entity {
+    /*!
+     * Binaries are unsigned integers of a fixed number of bits, the word size, which the user
+     * chooses with the stws action. The bits are packed into 64-bit words, least significant word
+     * first, so every operation works a word at a time. A binary keeps the word size that was in
+     * effect when it was created, which is the size it is displayed with. Operations produce
+     * results of the current word size; operands of another size are truncated or extended with
+     * zeros first.
+     */
     class BinaryEntity : public Entity {
     public:
-        BinaryEntity() noexcept
-        {
-            value = 0UL;
-        }
-        BinaryEntity(unsigned long number) noexcept
+        //! The largest word size the user may choose.
+        static constexpr std::size_t MAXIMUM_BIT_COUNT = 65536;
+
+        //! Returns the word size of new binaries. The default is 16 bits.
+        static std::size_t get_bit_count() noexcept;
+
+        //! Sets the word size of new binaries. Requires 1 <= bit_count <= MAXIMUM_BIT_COUNT.
+        static void set_bit_count(std::size_t bit_count);
+
+        //! Zero at the current word size.
+        BinaryEntity();
+
+        //! The low order bits of 'number' at the current word size.
+        BinaryEntity(unsigned long number);
+
+        //! The low order bits of 'number' at the current word size.
+        explicit BinaryEntity(const arithmetic::natural_t& number);
+
+        //! Returns the value of the binary as a natural number.
+        arithmetic::natural_t get_value() const;
+
+        std::size_t bit_count() const noexcept
         {
-            value = number;
-            normalize();
+            return width;
         }
 
         EntityType my_type() const noexcept override;
@@ -31,6 +58,7 @@ namespace clac::entity {
         Entity* acos() const override;
         Entity* asin() const override;
         Entity* atan() const override;
+        Entity* bit_length() const override;
         Entity* complex_conjugate() const override;
         Entity* cos() const override;
         Entity* exp() const override;
@@ -43,6 +71,11 @@ namespace clac::entity {
         Entity* log() const override;
         Entity* logical_not() const override;
         Entity* neg() const override;
+        Entity* population_count() const override;
+        Entity* rotate_left() const override;
+        Entity* rotate_right() const override;
+        Entity* shift_left() const override;
+        Entity* shift_right() const override;
 
         // Binary operations.
         Entity* divide(const Entity*) const override;
@@ -50,8 +83,15 @@ namespace clac::entity {
         Entity* logical_or(const Entity*) const override;
         Entity* logical_xor(const Entity*) const override;
         Entity* minus(const Entity*) const override;
+        Entity* modulo(const Entity*) const override;
         Entity* multiply(const Entity*) const override;
         Entity* plus(const Entity*) const override;
+        Entity* rotate(const Entity*) const override;
+        Entity* shift(const Entity*) const override;
+
+        // Relational operations.
+        Entity* is_equal(const Entity*) const override;
+        Entity* is_notequal(const Entity*) const override;
 
         // Conversions.
         Entity* to_binary() const override;
@@ -60,9 +100,26 @@ namespace clac::entity {
         Entity* to_integer() const override;
 
     private:
-        unsigned long value; // The bits themselves.
+        // Exactly enough words for 'width' bits. The bits above 'width' in the top word are zero.
+        arithmetic::natural_t words;
+        std::size_t width;
+
+        // Returns the words of this binary at the current word size. They are copied into
+        // 'scratch' if this binary has a different word size.
+        const arithmetic::natural_t& current_words(arithmetic::natural_t& scratch) const;
+
+        // Divides this binary by the binary 'right', both at the current word size.
+        void divide_words(const Entity* right,
+                          arithmetic::natural_t& quotient,
+                          arithmetic::natural_t& remainder) const;
+
+        template<typename Operation>
+        Entity* combine(const Entity* right, Operation operation) const;
+
+        template<typename Operation>
+        Entity* transform(Operation operation) const;
 
-        void normalize() noexcept; // Function to zero out most significant bits.
+        void normalize() noexcept; // Zero the bits above the word size in the top word.
     };
 }
 
@@ -13,6 +13,8 @@ namespace {
     clac::display_state::ComplexModeType complex_mode = clac::display_state::RECTANGULAR;
     int decimal_count = 3;
     clac::display_state::FloatModeType display_mode = clac::display_state::FIXED;
+    int precision = 50; // Significant decimal digits of big float results.
+    clac::display_state::RationalModeType rational_mode = clac::display_state::EAGER;
 
 } // namespace
 
@@ -41,6 +43,14 @@ namespace clac::display_state {
     {
         display_mode = new_mode;
     }
+    void set_precision(int digits) noexcept
+    {
+        precision = digits;
+    }
+    void set_rational_mode(RationalModeType new_mode) noexcept
+    {
+        rational_mode = new_mode;
+    }
 
     // Getters
     // -------
@@ -65,5 +75,13 @@ namespace clac::display_state {
     {
         return display_mode;
     }
+    int get_precision() noexcept
+    {
+        return precision;
+    }
+    RationalModeType get_rational_mode() noexcept
+    {
+        return rational_mode;
+    }
 
 } // namespace clac::display_state
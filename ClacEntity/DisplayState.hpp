@@ -20,6 +20,7 @@ namespace clac::display_state {
     enum BaseType { DECIMAL, BINARY, HEX, OCTAL };
     enum ComplexModeType { RECTANGULAR, POLAR };
     enum FloatModeType { FIXED, SCIENTIFIC, ENGINEERING };
+    enum RationalModeType { EAGER, LAZY };
 
     // The following methods allow access to the display state variables.
     AngleModeType get_angle_mode() noexcept;
@@ -27,6 +28,8 @@ namespace clac::display_state {
     ComplexModeType get_complex_mode() noexcept;
     int get_decimal_count() noexcept;
     FloatModeType get_display_mode() noexcept;
+    int get_precision() noexcept;
+    RationalModeType get_rational_mode() noexcept;
 
     // The following methods allow modifications to the display state variables.
     void set_angle_mode(AngleModeType new_mode) noexcept;
@@ -34,6 +37,8 @@ namespace clac::display_state {
     void set_complex_mode(ComplexModeType new_mode) noexcept;
     void set_decimal_count(int number) noexcept;
     void set_display_mode(FloatModeType new_mode) noexcept;
+    void set_precision(int digits) noexcept;
+    void set_rational_mode(RationalModeType new_mode) noexcept;
 } // namespace clac::display_state
 
 #endif
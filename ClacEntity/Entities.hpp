@@ -17,6 +17,7 @@
 #ifndef ENTITIES_HPP
 #define ENTITIES_HPP
 
+#include "BigFloatEntity.hpp"
 #include "BinaryEntity.hpp"
 #include "ComplexEntity.hpp"
 #include "DirectoryEntity.hpp"
@@ -25,6 +26,7 @@
 #include "LabeledEntity.hpp"
 #include "ListEntity.hpp"
 #include "MatrixEntity.hpp"
+#include "ModularEntity.hpp"
 #include "ProgramEntity.hpp"
 #include "RationalEntity.hpp"
 #include "StringEntity.hpp"
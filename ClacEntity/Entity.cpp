@@ -43,6 +43,12 @@ namespace clac::entity {
         return nullptr;
     }
 
+    Entity* Entity::bit_length() const
+    {
+        throw Error("Unable to take bit length of object");
+        return nullptr;
+    }
+
     Entity* Entity::complex_conjugate() const
     {
         throw Error("Unable to take complex conjugate of object");
@@ -55,12 +61,42 @@ namespace clac::entity {
         return nullptr;
     }
 
+    Entity* Entity::digit_count() const
+    {
+        throw Error("Unable to count digits of object");
+        return nullptr;
+    }
+
+    Entity* Entity::double_factorial() const
+    {
+        throw Error("Unable to take double factorial of object");
+        return nullptr;
+    }
+
     Entity* Entity::exp() const
     {
         throw Error("Unable to exponentiate object");
         return nullptr;
     }
 
+    Entity* Entity::factor() const
+    {
+        throw Error("Unable to factor object");
+        return nullptr;
+    }
+
+    Entity* Entity::factorial() const
+    {
+        throw Error("Unable to take factorial of object");
+        return nullptr;
+    }
+
+    Entity* Entity::fibonacci() const
+    {
+        throw Error("Unable to find Fibonacci number of object");
+        return nullptr;
+    }
+
     Entity* Entity::exp10() const
     {
         throw Error("Unable to exponentiate object");
@@ -73,24 +109,60 @@ namespace clac::entity {
         return nullptr;
     }
 
+    Entity* Entity::gamma() const
+    {
+        throw Error("Unable to take gamma function of object");
+        return nullptr;
+    }
+
     Entity* Entity::imaginary_part() const
     {
         throw Error("Object has no imaginary part");
         return nullptr;
     }
 
+    Entity* Entity::integer_log10() const
+    {
+        throw Error("Unable to take integer logarithm of object");
+        return nullptr;
+    }
+
+    Entity* Entity::integer_log2() const
+    {
+        throw Error("Unable to take integer logarithm of object");
+        return nullptr;
+    }
+
     Entity* Entity::integer_part() const
     {
         throw Error("Object has no integer part");
         return nullptr;
     }
 
+    Entity* Entity::integer_sqrt() const
+    {
+        throw Error("Unable to take integer square root of object");
+        return nullptr;
+    }
+
     Entity* Entity::inv() const
     {
         throw Error("Unable to invert object");
         return nullptr;
     }
 
+    Entity* Entity::is_perfect_power() const
+    {
+        throw Error("Unable to test object for perfect power");
+        return nullptr;
+    }
+
+    Entity* Entity::is_prime() const
+    {
+        throw Error("Unable to test object for primality");
+        return nullptr;
+    }
+
     Entity* Entity::ln() const
     {
         throw Error("Unable to take natural logarithm of object");
@@ -103,18 +175,48 @@ namespace clac::entity {
         return nullptr;
     }
 
+    Entity* Entity::log_gamma() const
+    {
+        throw Error("Unable to take log gamma of object");
+        return nullptr;
+    }
+
     Entity* Entity::logical_not() const
     {
         throw Error("Unable to logically negate object");
         return nullptr;
     }
 
+    Entity* Entity::lucas() const
+    {
+        throw Error("Unable to find Lucas number of object");
+        return nullptr;
+    }
+
     Entity* Entity::neg() const
     {
         throw Error("Unable to negate object");
         return nullptr;
     }
 
+    Entity* Entity::next_prime() const
+    {
+        throw Error("Unable to find the next prime after object");
+        return nullptr;
+    }
+
+    Entity* Entity::population_count() const
+    {
+        throw Error("Unable to count the one bits of object");
+        return nullptr;
+    }
+
+    Entity* Entity::prime_count() const
+    {
+        throw Error("Unable to count the primes up to object");
+        return nullptr;
+    }
+
     Entity* Entity::real_part() const
     {
         throw Error("Object has no real part");
@@ -185,6 +287,12 @@ namespace clac::entity {
     // Conversion Functions.
     //
 
+    Entity* Entity::to_bigfloat() const
+    {
+        throw Error("Unable to convert object to a big float");
+        return nullptr;
+    }
+
     Entity* Entity::to_binary() const
     {
         throw Error("Unable to convert object to a binary");
@@ -233,6 +341,12 @@ namespace clac::entity {
         return nullptr;
     }
 
+    Entity* Entity::to_modular() const
+    {
+        throw Error("Unable to convert object to a modular integer");
+        return nullptr;
+    }
+
     Entity* Entity::to_program() const
     {
         throw Error("Unable to convert object to a program");
@@ -261,6 +375,12 @@ namespace clac::entity {
     // Binary operations.
     //
 
+    Entity* Entity::binomial(const Entity*) const
+    {
+        throw Error("Unable to take binomial coefficient of these objects");
+        return nullptr;
+    }
+
     Entity* Entity::cross(const Entity*) const
     {
         throw Error("Unable to take cross product of these objects");
@@ -279,6 +399,30 @@ namespace clac::entity {
         return nullptr;
     }
 
+    Entity* Entity::gcd(const Entity*) const
+    {
+        throw Error("Unable to take greatest common divisor of these objects");
+        return nullptr;
+    }
+
+    Entity* Entity::integer_root(const Entity*) const
+    {
+        throw Error("Unable to take integer root of these objects");
+        return nullptr;
+    }
+
+    Entity* Entity::lcm(const Entity*) const
+    {
+        throw Error("Unable to take least common multiple of these objects");
+        return nullptr;
+    }
+
+    Entity* Entity::leading_digits(const Entity*) const
+    {
+        throw Error("Unable to take leading digits of these objects");
+        return nullptr;
+    }
+
     Entity* Entity::logical_and(const Entity*) const
     {
         throw Error("Unable to logically AND these objects");
@@ -303,6 +447,12 @@ namespace clac::entity {
         return nullptr;
     }
 
+    Entity* Entity::modular(const Entity*) const
+    {
+        throw Error("Unable to form a modular integer from these objects");
+        return nullptr;
+    }
+
     Entity* Entity::modulo(const Entity*) const
     {
         throw Error("Unable to modulo these objects");
@@ -327,6 +477,30 @@ namespace clac::entity {
         return nullptr;
     }
 
+    Entity* Entity::primes(const Entity*) const
+    {
+        throw Error("Unable to list the primes between these objects");
+        return nullptr;
+    }
+
+    Entity* Entity::rotate(const Entity*) const
+    {
+        throw Error("Unable to rotate these objects");
+        return nullptr;
+    }
+
+    Entity* Entity::shift(const Entity*) const
+    {
+        throw Error("Unable to shift these objects");
+        return nullptr;
+    }
+
+    Entity* Entity::trailing_digits(const Entity*) const
+    {
+        throw Error("Unable to take trailing digits of these objects");
+        return nullptr;
+    }
+
     //
     // Relational operations.
     //
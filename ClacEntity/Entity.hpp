@@ -2,9 +2,10 @@
  *  \brief   Interface to the abstract base class Entity.
  *  \author  Peter Chapin <spicacality@kelseymountain.org>
  *
- * There are 12 entity types all derived from the class defined here. They are binary (BIN),
- * complex (CPX), directory (DIR), float (FLT), integer (INT), labeled (LBL), list (LST), matrix
- * (MAT), program (PGM), rational (RAT), string (STR), and vector (VEC).
+ * There are 14 entity types all derived from the class defined here. They are big float (BFL),
+ * binary (BIN), complex (CPX), directory (DIR), float (FLT), integer (INT), labeled (LBL), list
+ * (LST), matrix (MAT), modular integer (MOD), program (PGM), rational (RAT), string (STR), and
+ * vector (VEC).
  */
 
 #ifndef ENTITY_HPP
@@ -28,7 +29,10 @@ namespace clac::entity {
         PROGRAM,
         RATIONAL,
         STRING,
-        VECTOR
+        VECTOR,
+        // New types are added last so that the codes of the others in saved files don't change.
+        BIGFLOAT,
+        MODULAR
     };
 
     class Entity {
@@ -66,18 +70,35 @@ namespace clac::entity {
         virtual Entity* acos() const;
         virtual Entity* asin() const;
         virtual Entity* atan() const;
+        virtual Entity* bit_length() const;
         virtual Entity* complex_conjugate() const;
         virtual Entity* cos() const;
+        virtual Entity* digit_count() const;
+        virtual Entity* double_factorial() const;
         virtual Entity* exp() const;
         virtual Entity* exp10() const;
+        virtual Entity* factor() const;
+        virtual Entity* factorial() const;
+        virtual Entity* fibonacci() const;
         virtual Entity* fractional_part() const;
+        virtual Entity* gamma() const;
         virtual Entity* imaginary_part() const;
+        virtual Entity* integer_log10() const;
+        virtual Entity* integer_log2() const;
         virtual Entity* integer_part() const;
+        virtual Entity* integer_sqrt() const;
         virtual Entity* inv() const;
+        virtual Entity* is_perfect_power() const;
+        virtual Entity* is_prime() const;
         virtual Entity* ln() const;
         virtual Entity* log() const;
+        virtual Entity* log_gamma() const;
         virtual Entity* logical_not() const;
+        virtual Entity* lucas() const;
         virtual Entity* neg() const;
+        virtual Entity* next_prime() const;
+        virtual Entity* population_count() const;
+        virtual Entity* prime_count() const;
         virtual Entity* real_part() const;
         virtual Entity* rotate_left() const;
         virtual Entity* rotate_right() const;
@@ -96,6 +117,7 @@ namespace clac::entity {
         // pointer to result object; the original object is always unchanged. They throw an
         // exception if the result could not be computed.
 
+        virtual Entity* to_bigfloat() const;
         virtual Entity* to_binary() const;
         virtual Entity* to_complex() const;
         virtual Entity* to_directory() const;
@@ -104,6 +126,7 @@ namespace clac::entity {
         virtual Entity* to_labeled() const;
         virtual Entity* to_list() const;
         virtual Entity* to_matrix() const;
+        virtual Entity* to_modular() const;
         virtual Entity* to_program() const;
         virtual Entity* to_rational() const;
         virtual Entity* to_string() const;
@@ -118,17 +141,27 @@ namespace clac::entity {
         // These functions require that the right operand be an Entity* which actually points to an
         // object of the same actual type as *this. If this is not so, an exception is thrown.
 
+        virtual Entity* binomial(const Entity*) const;
         virtual Entity* cross(const Entity*) const;
         virtual Entity* divide(const Entity*) const;
         virtual Entity* dot(const Entity*) const;
+        virtual Entity* gcd(const Entity*) const;
+        virtual Entity* integer_root(const Entity*) const;
+        virtual Entity* lcm(const Entity*) const;
+        virtual Entity* leading_digits(const Entity*) const;
         virtual Entity* logical_and(const Entity*) const;
         virtual Entity* logical_or(const Entity*) const;
         virtual Entity* logical_xor(const Entity*) const;
         virtual Entity* minus(const Entity*) const;
+        virtual Entity* modular(const Entity*) const;
         virtual Entity* modulo(const Entity*) const;
         virtual Entity* multiply(const Entity*) const;
         virtual Entity* plus(const Entity*) const;
         virtual Entity* power(const Entity*) const;
+        virtual Entity* primes(const Entity*) const;
+        virtual Entity* rotate(const Entity*) const;
+        virtual Entity* shift(const Entity*) const;
+        virtual Entity* trailing_digits(const Entity*) const;
 
         // Relational operations.
         virtual Entity* is_equal(const Entity*) const;
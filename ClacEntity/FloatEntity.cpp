@@ -19,16 +19,12 @@
  * + We should improve my handling of pi and e. Should we create a constants library for clac
  *   and store carefully prepared values of various constants there? clac users will, after all,
  *   need some of these values too.
- *
- * + FloatEntity::to_integer is not as good as it should be. It uses the modf function and then
- *   converts the resulting integer part to type int. But since IntegerEntity uses VeryLong for
- *   its representation, it can do better than that. Also the way it handles rounding is a bit
- *   simple minded.
  */
 
 #include <cerrno>
 #include <cfloat>
 #include <cmath>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -37,6 +33,7 @@
 
 #include "DisplayState.hpp"
 #include "Entities.hpp"
+#include "arithmetic.hpp"
 #include "support.hpp"
 
 using namespace std;
@@ -231,12 +228,32 @@ namespace clac::entity {
         return new FloatEntity(temp);
     }
 
+    //
+    // For a float x, x! is gamma(x + 1).
+    //
+    Entity* FloatEntity::factorial() const
+    {
+        const FloatEntity shifted(value + 1.0);
+        return shifted.gamma();
+    }
+
     Entity* FloatEntity::fractional_part() const
     {
         [[maybe_unused]] double dummy; // We don't care about the integer part.
         return new FloatEntity(std::modf(value, &dummy));
     }
 
+    Entity* FloatEntity::gamma() const
+    {
+        if (value <= 0.0 && value == std::floor(value))
+            throw Error("The gamma function has poles at zero and the negative integers");
+        const double temp = std::tgamma(value);
+        if (std::isinf(temp)) {
+            throw Error("Overflow: Can't compute gamma(x) for such a large x");
+        }
+        return new FloatEntity(temp);
+    }
+
     Entity* FloatEntity::imaginary_part() const
     {
         return new FloatEntity(0.0);
@@ -282,6 +299,16 @@ namespace clac::entity {
         return new FloatEntity(std::log10(value));
     }
 
+    //
+    // This is ln |gamma(x)|, which is real even where gamma(x) is negative.
+    //
+    Entity* FloatEntity::log_gamma() const
+    {
+        if (value <= 0.0 && value == std::floor(value))
+            throw Error("The gamma function has poles at zero and the negative integers");
+        return new FloatEntity(std::lgamma(value));
+    }
+
     Entity* FloatEntity::neg() const
     {
         return new FloatEntity(-1.0 * value);
@@ -429,6 +456,16 @@ namespace clac::entity {
     // Conversions from FloatEntity
     //
 
+    //
+    // Every finite double is converted exactly, and then rounded to the current precision.
+    //
+    Entity* FloatEntity::to_bigfloat() const
+    {
+        if (!std::isfinite(value))
+            throw Error("Can't convert an infinite or undefined value to a big float");
+        return new BigFloatEntity(arithmetic::to_bigfloat(value));
+    }
+
     Entity* FloatEntity::to_complex() const
     {
         return new ComplexEntity(value);
@@ -439,18 +476,20 @@ namespace clac::entity {
         return duplicate();
     }
 
+    //
+    // The value is rounded to the nearest integer, with halfway cases rounded away from zero.
+    // Every double of magnitude 2^53 or more is already an integer, and its bits are copied
+    // directly into the result.
+    //
     Entity* FloatEntity::to_integer() const
     {
-        double I_part;
-        double fraction;
-
-        fraction = std::modf(value, &I_part);
-        if (value > 0 && fraction > 0.5)
-            I_part += 1.0;
-        if (value < 0 && fraction < 0.5)
-            I_part -= 1.0;
+        if (!std::isfinite(value))
+            throw Error("Can't convert an infinite or undefined value to an integer");
 
-        const int result = static_cast<int>(I_part);
-        return new IntegerEntity(result);
+        const double rounded = std::round(value);
+        constexpr double small_limit = 9223372036854775808.0; // 2^63
+        if (rounded > -small_limit && rounded < small_limit)
+            return new IntegerEntity(static_cast<int64_t>(rounded));
+        return new IntegerEntity(arithmetic::from_double(rounded));
     }
 }
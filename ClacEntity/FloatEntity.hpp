@@ -28,12 +28,15 @@ namespace clac::entity {
         Entity* cos() const override;
         Entity* exp() const override;
         Entity* exp10() const override;
+        Entity* factorial() const override;
         Entity* fractional_part() const override;
+        Entity* gamma() const override;
         Entity* imaginary_part() const override;
         Entity* integer_part() const override;
         Entity* inv() const override;
         Entity* ln() const override;
         Entity* log() const override;
+        Entity* log_gamma() const override;
         Entity* neg() const override;
         Entity* real_part() const override;
         Entity* sign() const override;
@@ -43,6 +46,7 @@ namespace clac::entity {
         Entity* tan() const override;
 
         // Conversion functions.
+        Entity* to_bigfloat() const override;
         Entity* to_complex() const override;
         Entity* to_float() const override;
         Entity* to_integer() const override;
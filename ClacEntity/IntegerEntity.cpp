@@ -2,22 +2,1018 @@
  *  \brief   Implementation of the Clac numeric type IntegerEntity.
  *  \author  Peter Chapin <spicacality@kelseymountain.org>
  *
- * TODO
+ * Values that fit in 64 bits are stored as std::int64_t. The arithmetic on them is checked for
+ * overflow, and only a result that overflows is computed again with VeryLong. Results are always
+ * stored in the smallest form that holds them, so a value that was promoted to VeryLong returns
+ * to the small form when it shrinks.
  *
- * + IntegerEntity::to_float doesn't deal with the possibility of overflow and it should.
+ * The bitwise operations and shifts on large values work on the limbs of the magnitude, using
+ * the word at a time operations of the arithmetic module, rather than on individual bits.
+ *
+ * A power whose result would have more than DEFERRED_BITS bits is not computed. The entity holds
+ * the base and exponent instead, and multiplying such an entity by another integer appends to
+ * its list of powers. Such a value is never evaluated to show it or to count its digits. The
+ * base 10 logarithm of the magnitude is the sum of e * log10(b) over the powers b^e, computed in
+ * fixed point with a bound on its error, and it gives the number of digits and the leading
+ * digits when the bound settles their rounding. Where it doesn't, the precision is raised, and a
+ * value exactly at a break between digit strings is recognized by comparing the factors of its
+ * powers with those of the break. Digits that can't be certified that way aren't shown. The
+ * trailing digits are the product of the b^e mod 10^n, which are modular powers.
  */
 
+#include <bit>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <list>
 #include <memory>
-#include <sstream>
+#include <numbers>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "Entities.hpp"
+#include "arithmetic.hpp"
+#include "combinatorics.hpp"
+#include "modular.hpp"
+#include "prime.hpp"
 
 using namespace std;
 using namespace spica; // TODO: Remove this using directive.
 
 namespace clac::entity {
-    IntegerEntity::IntegerEntity(const VeryLong& number) : value(number)
+    namespace {
+
+        constexpr int64_t SMALL_MIN = numeric_limits<int64_t>::min();
+        constexpr int64_t SMALL_MAX = numeric_limits<int64_t>::max();
+
+        //! A power is left unevaluated if its result would have more bits than this.
+        constexpr uint64_t DEFERRED_BITS = uint64_t{1} << 18;
+
+        constexpr double LOG10_2 = 0.301029995663981195214;
+
+        //! The number of leading digits shown for a deferred value, if that many are known.
+        constexpr uint64_t SHOWN_DIGITS = 10;
+
+        //! The precision, in bits, of the first logarithm tried for the length of a deferred
+        //! value. Each of the PRECISION_ATTEMPTS attempts doubles the one before.
+        constexpr size_t LENGTH_PRECISION = 192;
+        constexpr int PRECISION_ATTEMPTS = 5;
+
+        //! The largest factorial computed, in bits (256 MiB, or about 646 million digits).
+        constexpr double MAXIMUM_FACTORIAL_BITS = 2147483648.0;
+
+        // Checked arithmetic. Each function returns false if the result does not fit in 64 bits.
+
+        bool checked_add(int64_t left, int64_t right, int64_t& result) noexcept
+        {
+#if defined(__GNUC__)
+            return !__builtin_add_overflow(left, right, &result);
+#else
+            if ((right > 0 && left > SMALL_MAX - right) || (right < 0 && left < SMALL_MIN - right))
+                return false;
+            result = left + right;
+            return true;
+#endif
+        }
+
+        bool checked_subtract(int64_t left, int64_t right, int64_t& result) noexcept
+        {
+#if defined(__GNUC__)
+            return !__builtin_sub_overflow(left, right, &result);
+#else
+            if ((right < 0 && left > SMALL_MAX + right) || (right > 0 && left < SMALL_MIN + right))
+                return false;
+            result = left - right;
+            return true;
+#endif
+        }
+
+        bool checked_multiply(int64_t left, int64_t right, int64_t& result) noexcept
+        {
+#if defined(__GNUC__)
+            return !__builtin_mul_overflow(left, right, &result);
+#else
+            if (left != 0 && right != 0) {
+                if (left > 0 ? (right > 0 ? left > SMALL_MAX / right : right < SMALL_MIN / left)
+                             : (right > 0 ? left < SMALL_MIN / right : left < SMALL_MAX / right))
+                    return false;
+            }
+            result = left * right;
+            return true;
+#endif
+        }
+
+        //! Computes base^exponent by repeated squaring. Requires exponent >= 0.
+        bool checked_power(int64_t base, int64_t exponent, int64_t& result) noexcept
+        {
+            if (exponent == 0 || base == 1) {
+                result = 1;
+                return true;
+            }
+            if (base == 0 || base == -1) {
+                result = (base == -1 && exponent % 2 == 0) ? 1 : base;
+                return true;
+            }
+
+            // Any other base overflows after at most 63 squarings.
+            int64_t power = 1;
+            while (true) {
+                if (exponent % 2 != 0 && !checked_multiply(power, base, power))
+                    return false;
+                exponent /= 2;
+                if (exponent == 0)
+                    break;
+                if (!checked_multiply(base, base, base))
+                    return false;
+            }
+            result = power;
+            return true;
+        }
+
+        //! Converts a small value to a VeryLong.
+        VeryLong promote(int64_t number)
+        {
+            if (number >= numeric_limits<long>::min() && number <= numeric_limits<long>::max())
+                return VeryLong(static_cast<long>(number));
+
+            // Only reached where long is narrower than 64 bits.
+            const uint64_t magnitude = (number < 0) ? 0 - static_cast<uint64_t>(number)
+                                                    : static_cast<uint64_t>(number);
+            return arithmetic::to_verylong(arithmetic::natural_t{magnitude}, number < 0);
+        }
+
+        //! Returns true and sets result if the value of number fits in 64 bits.
+        bool demote(const VeryLong& number, int64_t& result)
+        {
+            const VeryLong::size_type bit_count = number.number_bits();
+            if (bit_count >= 64)
+                return false;
+            if (bit_count < static_cast<VeryLong::size_type>(numeric_limits<long>::digits)) {
+                result = number.to_long();
+                return true;
+            }
+
+            uint64_t magnitude = 0;
+            for (VeryLong::size_type i = bit_count; i > 0; --i) {
+                magnitude = (magnitude << 1) | static_cast<uint64_t>(number.get_bit(i - 1));
+            }
+            result = static_cast<int64_t>(magnitude);
+            if (number < VeryLong::zero)
+                result = -result;
+            return true;
+        }
+
+        //! Returns a negative, zero, or positive value as left is less than, equal to, or greater
+        //! than right.
+        int compare(const IntegerEntity& left, const IntegerEntity& right)
+        {
+            if (left.is_small() && right.is_small()) {
+                const int64_t l = left.get_small();
+                const int64_t r = right.get_small();
+                return (l < r) ? -1 : (l > r);
+            }
+            const VeryLong l = left.get_value();
+            const VeryLong r = right.get_value();
+            return (l < r) ? -1 : (l > r);
+        }
+
+        //! Returns the magnitude of an integer as a natural_t.
+        arithmetic::natural_t magnitude(const IntegerEntity& number)
+        {
+            if (number.is_small()) {
+                const int64_t value = number.get_small();
+                const uint64_t result =
+                    (value < 0) ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+                return (result == 0) ? arithmetic::natural_t() : arithmetic::natural_t{result};
+            }
+            return arithmetic::to_natural(number.get_value());
+        }
+
+        //! Returns the number of decimal digits in a nonzero magnitude.
+        uint64_t decimal_digits(uint64_t number) noexcept
+        {
+            uint64_t count = 1;
+            while (number >= 10) {
+                number /= 10;
+                ++count;
+            }
+            return count;
+        }
+
+        arithmetic::natural_t power_of_ten(uint64_t exponent)
+        {
+            return arithmetic::power(arithmetic::natural_t{10}, exponent);
+        }
+
+        //! Returns the count of a digits operation, which must be positive.
+        uint64_t digit_argument(const IntegerEntity& number)
+        {
+            if (number.is_negative() || !number.is_small() || number.get_small() == 0)
+                throw Entity::Error("The number of digits must be a positive integer");
+            return static_cast<uint64_t>(number.get_small());
+        }
+
+        //! Returns a bound for the prime sieve, treating negative numbers as zero.
+        uint64_t sieve_bound(const IntegerEntity& number)
+        {
+            if (number.is_negative())
+                return 0;
+            if (!number.is_small() ||
+                static_cast<uint64_t>(number.get_small()) > arithmetic::SIEVE_LIMIT)
+                throw Entity::Error("Prime sieve bounds can be at most 2^50");
+            return static_cast<uint64_t>(number.get_small());
+        }
+
+        //
+        // Returns the argument n of a factorial, or of a double factorial if step is 2. The size
+        // of the result, log2(n!)/step bits, is estimated from the log-gamma function before
+        // anything is sieved, and arguments whose results would be too large to compute in
+        // reasonable time and memory are rejected.
+        //
+        uint64_t factorial_argument(const IntegerEntity& number, unsigned step = 1)
+        {
+            if (number.is_negative())
+                throw Entity::Error("The factorial of a negative integer is undefined");
+            if (!number.is_small() ||
+                static_cast<uint64_t>(number.get_small()) > arithmetic::SIEVE_LIMIT)
+                throw Entity::Error("Factorial argument is too large");
+
+            const auto n = static_cast<uint64_t>(number.get_small());
+            const double bits = std::lgamma(static_cast<double>(n) + 1.0) / numbers::ln2 / step;
+            if (bits > MAXIMUM_FACTORIAL_BITS)
+                throw Entity::Error("Factorial argument is too large");
+            return n;
+        }
+
+        //! Returns the magnitude of the index of a Fibonacci or Lucas number.
+        uint64_t sequence_index(const IntegerEntity& number)
+        {
+            if (!number.is_small())
+                throw Entity::Error("Sequence index is too large");
+            const arithmetic::natural_t index = magnitude(number);
+            return index.empty() ? 0 : index[0];
+        }
+
+        //! Returns a new integer with the given magnitude and sign.
+        IntegerEntity* make_integer(const arithmetic::natural_t& magnitude, bool negative)
+        {
+            if (magnitude.empty())
+                return new IntegerEntity(int64_t{0});
+            if (magnitude.size() == 1 && magnitude[0] <= static_cast<uint64_t>(SMALL_MAX)) {
+                const auto value = static_cast<int64_t>(magnitude[0]);
+                return new IntegerEntity(negative ? -value : value);
+            }
+            return new IntegerEntity(arithmetic::to_verylong(magnitude, negative));
+        }
+
+        enum class BitwiseOperation { AND, OR, XOR };
+
+        //
+        // A negative integer -m has the bits of ~(m - 1). Each operand is represented by its
+        // magnitude, less one if it is negative, and the signs decide whether the bits of the
+        // result are those of a natural number w, making the result w, or those of ~w, making
+        // the result -(w + 1). For example, ~a & b is b & ~a, and ~a | ~b is ~(a & b).
+        //
+        IntegerEntity* bitwise(
+            const IntegerEntity& left, const IntegerEntity& right, BitwiseOperation operation)
+        {
+            if (left.is_small() && right.is_small()) {
+                const int64_t l = left.get_small();
+                const int64_t r = right.get_small();
+                switch (operation) {
+                case BitwiseOperation::AND: return new IntegerEntity(l & r);
+                case BitwiseOperation::OR:  return new IntegerEntity(l | r);
+                case BitwiseOperation::XOR: return new IntegerEntity(l ^ r);
+                }
+            }
+
+            const arithmetic::natural_t one{1};
+            const bool l_negative = left.is_negative();
+            const bool r_negative = right.is_negative();
+            arithmetic::natural_t l = magnitude(left);
+            arithmetic::natural_t r = magnitude(right);
+            if (l_negative)
+                l = arithmetic::subtract(l, one);
+            if (r_negative)
+                r = arithmetic::subtract(r, one);
+
+            arithmetic::natural_t bits;
+            bool complemented = false;
+            switch (operation) {
+            case BitwiseOperation::AND:
+                complemented = l_negative && r_negative;
+                if (l_negative == r_negative)
+                    bits = complemented ? arithmetic::bit_or(l, r) : arithmetic::bit_and(l, r);
+                else
+                    bits = l_negative ? arithmetic::bit_and_not(r, l)
+                                      : arithmetic::bit_and_not(l, r);
+                break;
+            case BitwiseOperation::OR:
+                complemented = l_negative || r_negative;
+                if (l_negative == r_negative)
+                    bits = complemented ? arithmetic::bit_and(l, r) : arithmetic::bit_or(l, r);
+                else
+                    bits = l_negative ? arithmetic::bit_and_not(l, r)
+                                      : arithmetic::bit_and_not(r, l);
+                break;
+            case BitwiseOperation::XOR:
+                complemented = l_negative != r_negative;
+                bits = arithmetic::bit_xor(l, r);
+                break;
+            }
+            if (complemented)
+                return make_integer(arithmetic::add(bits, one), true);
+            return make_integer(bits, false);
+        }
+
+        //
+        // Returns number * 2^count if count is not negative. Otherwise returns the floor of
+        // number / 2^-count, which is what an arithmetic right shift of the two's complement
+        // bits gives: -m shifted right is ~((m - 1) >> n), or -(((m - 1) >> n) + 1).
+        //
+        IntegerEntity* shift_integer(const IntegerEntity& number, int64_t count)
+        {
+            if (number.is_small()) {
+                const int64_t value = number.get_small();
+                if (count < 0)
+                    return new IntegerEntity(value >> ((count < -63) ? 63 : -count));
+                if (count < 64) {
+                    const auto result = static_cast<int64_t>(static_cast<uint64_t>(value) << count);
+                    if ((result >> count) == value)
+                        return new IntegerEntity(result);
+                }
+            }
+
+            const bool negative = number.is_negative();
+            if (count >= 0) {
+                const auto places = static_cast<size_t>(count);
+                return make_integer(arithmetic::shift_left(magnitude(number), places), negative);
+            }
+            const size_t places = static_cast<size_t>(0 - static_cast<uint64_t>(count));
+            if (!negative)
+                return make_integer(arithmetic::shift_right(magnitude(number), places), false);
+
+            const arithmetic::natural_t one{1};
+            return make_integer(
+                arithmetic::add(
+                    arithmetic::shift_right(arithmetic::subtract(magnitude(number), one), places),
+                    one),
+                true);
+        }
+
+        //
+        // Fixed point numbers for the logarithms of deferred values. A real x is held as
+        // floor(x * 2^w) for a precision of w bits, together with a bound on how far that is from
+        // x * 2^w. The bounds count every truncation as a whole unit.
+        //
+        struct Fixed {
+            arithmetic::natural_t value;
+            arithmetic::natural_t error;
+        };
+
+        arithmetic::natural_t natural(uint64_t number)
+        {
+            return (number == 0) ? arithmetic::natural_t() : arithmetic::natural_t{number};
+        }
+
+        //! Returns a count held in a natural_t, which must be less than the largest uint64_t.
+        uint64_t to_count(const arithmetic::natural_t& number)
+        {
+            if (number.empty())
+                return 0;
+            if (number.size() > 1 || number[0] == numeric_limits<uint64_t>::max())
+                throw Entity::Error("The value is too large to count its digits");
+            return number[0];
+        }
+
+        //! Returns true if the value held by left is certainly less than that held by right.
+        bool certainly_less(const Fixed& left, const Fixed& right)
+        {
+            const arithmetic::natural_t upper =
+                arithmetic::add(arithmetic::add(left.value, left.error), right.error);
+            return arithmetic::compare(upper, right.value) < 0;
+        }
+
+        //
+        // Sets floor to the floor of the largest value x may have, and returns true if the
+        // smallest value x may have has the same floor.
+        //
+        bool certain_floor(const Fixed& x, size_t w, arithmetic::natural_t& floor)
+        {
+            floor = arithmetic::shift_right(arithmetic::add(x.value, x.error), w);
+            if (arithmetic::compare(x.value, x.error) < 0)
+                return floor.empty();
+            const arithmetic::natural_t lower = arithmetic::subtract(x.value, x.error);
+            return arithmetic::compare(arithmetic::shift_right(lower, w), floor) == 0;
+        }
+
+        //
+        // Returns atanh(z) = z + z^3/3 + z^5/5 + ... for z in [0, 1/3]. The powers of z fall by
+        // a factor of at least nine, so each term is off by less than two units.
+        //
+        Fixed fixed_atanh(const arithmetic::natural_t& z, size_t w)
+        {
+            const arithmetic::natural_t z2 = arithmetic::shift_right(arithmetic::square(z), w);
+            arithmetic::natural_t power = z;
+            arithmetic::natural_t quotient;
+            arithmetic::natural_t remainder;
+            Fixed result;
+            uint64_t terms = 0;
+            for (uint64_t k = 1; !power.empty(); k += 2, ++terms) {
+                arithmetic::divide(power, natural(k), quotient, remainder);
+                result.value = arithmetic::add(result.value, quotient);
+                power = arithmetic::shift_right(arithmetic::multiply(power, z2), w);
+            }
+            result.error = natural(2 * terms + 2);
+            return result;
+        }
+
+        //! Returns ln 2 = 2 atanh(1/3).
+        Fixed fixed_ln2(size_t w)
+        {
+            arithmetic::natural_t third;
+            arithmetic::natural_t remainder;
+            arithmetic::divide(arithmetic::shift_left(natural(1), w), natural(3), third, remainder);
+            Fixed result = fixed_atanh(third, w);
+            result.value = arithmetic::shift_left(result.value, 1);
+            result.error = arithmetic::add(arithmetic::shift_left(result.error, 1), natural(3));
+            return result;
+        }
+
+        //
+        // Returns log2 of a nonzero number. With 2^t <= m < 2^(t + 1) it is t + ln(m / 2^t) / ln 2,
+        // where ln(m / 2^t) = 2 atanh((m - 2^t) / (m + 2^t)) has an argument in [0, 1/3). Only the
+        // top w + 8 bits of the number affect the result.
+        //
+        Fixed fixed_log2(const arithmetic::natural_t& number, size_t w)
+        {
+            const size_t t = arithmetic::bit_length(number) - 1;
+            const size_t dropped = (t > w + 8) ? t - (w + 8) : 0;
+            const arithmetic::natural_t m = arithmetic::shift_right(number, dropped);
+            const arithmetic::natural_t low = arithmetic::shift_left(natural(1), t - dropped);
+
+            arithmetic::natural_t z;
+            arithmetic::natural_t remainder;
+            arithmetic::divide(arithmetic::shift_left(arithmetic::subtract(m, low), w),
+                               arithmetic::add(m, low), z, remainder);
+            Fixed ln = fixed_atanh(z, w);
+            ln.value = arithmetic::shift_left(ln.value, 1);
+            ln.error = arithmetic::add(arithmetic::shift_left(ln.error, 1), natural(4));
+
+            const Fixed ln2 = fixed_ln2(w);
+            Fixed result;
+            arithmetic::divide(
+                arithmetic::shift_left(ln.value, w), ln2.value, result.value, remainder);
+            result.value = arithmetic::add(result.value, arithmetic::shift_left(natural(t), w));
+            result.error = arithmetic::add(
+                arithmetic::shift_left(arithmetic::add(ln.error, ln2.error), 1), natural(2));
+            return result;
+        }
+
+        //! Converts a base 2 logarithm to base 10, given log2(10) at the same precision.
+        Fixed to_log10(const Fixed& log2, const Fixed& ten, size_t w)
+        {
+            Fixed result;
+            arithmetic::natural_t remainder;
+            arithmetic::divide(
+                arithmetic::shift_left(log2.value, w), ten.value, result.value, remainder);
+
+            // Since log2(10) > 3, dividing by it shrinks the errors of both inputs.
+            const arithmetic::natural_t spread = arithmetic::add(
+                log2.error,
+                arithmetic::shift_right(arithmetic::multiply(result.value, ten.error), w));
+            arithmetic::divide(spread, natural(3), result.error, remainder);
+            result.error = arithmetic::add(result.error, natural(3));
+            return result;
+        }
+
+        //
+        // Returns roughly floor(10^(count - 1 + f)) for f in [0, 1], from the Taylor series of
+        // exp(f ln 10 / 2^8) squared eight times. It is only a starting point for the search of
+        // IntegerEntity::Deferred::find_leading.
+        //
+        arithmetic::natural_t approximate_digits(const arithmetic::natural_t& f,
+                                                 const arithmetic::natural_t& ln10,
+                                                 uint64_t count,
+                                                 size_t w)
+        {
+            const arithmetic::natural_t a =
+                arithmetic::shift_right(arithmetic::multiply(f, ln10), w + 8);
+            arithmetic::natural_t sum = arithmetic::shift_left(natural(1), w);
+            arithmetic::natural_t term = sum;
+            arithmetic::natural_t quotient;
+            arithmetic::natural_t remainder;
+            for (uint64_t k = 1; !term.empty(); ++k) {
+                const arithmetic::natural_t product =
+                    arithmetic::shift_right(arithmetic::multiply(term, a), w);
+                arithmetic::divide(product, natural(k), term, remainder);
+                sum = arithmetic::add(sum, term);
+            }
+            for (int i = 0; i < 8; ++i) {
+                sum = arithmetic::shift_right(arithmetic::square(sum), w);
+            }
+            return arithmetic::shift_right(arithmetic::multiply(sum, power_of_ten(count - 1)), w);
+        }
+
+        //! Returns the number of decimal digits in a nonzero natural.
+        uint64_t decimal_digits(const arithmetic::natural_t& number)
+        {
+            auto k = static_cast<uint64_t>(arithmetic::log2(number) * LOG10_2);
+            if (k > 0 && arithmetic::compare(number, power_of_ten(k)) < 0)
+                --k;
+            else if (arithmetic::compare(number, power_of_ten(k + 1)) >= 0)
+                ++k;
+            return k + 1;
+        }
+
+        //! Removes the factors of two and five from number and returns how many there were.
+        pair<uint64_t, uint64_t> remove_two_five(arithmetic::natural_t& number)
+        {
+            const uint64_t twos = arithmetic::trailing_zeros(number);
+            number = arithmetic::shift_right(number, twos);
+            uint64_t fives = 0;
+            arithmetic::natural_t quotient;
+            arithmetic::natural_t remainder;
+            while (true) {
+                arithmetic::divide(number, natural(5), quotient, remainder);
+                if (!remainder.empty())
+                    break;
+                number = std::move(quotient);
+                ++fives;
+            }
+            return {twos, fives};
+        }
+
+    } // namespace
+
+    //
+    // The value (-1)^negative * b1^e1 * b2^e2 * ..., where each b is at least two. It is shared
+    // by the copies of an entity, and the value computed for one of them serves them all.
+    //
+    struct IntegerEntity::Deferred {
+        bool negative = false;
+        vector<pair<arithmetic::natural_t, uint64_t>> powers;
+        mutable optional<VeryLong> computed;
+
+        // The lengths and the first_count shown digits, found when they are first asked for. A
+        // length of zero, or empty digits, means they couldn't be certified, and the value has
+        // at least fewest_digits digits.
+        mutable optional<uint64_t> bits;
+        mutable optional<uint64_t> digits;
+        mutable optional<arithmetic::natural_t> first;
+        mutable uint64_t first_count = 0;
+        mutable uint64_t fewest_digits = 0;
+
+        const VeryLong& evaluate() const;
+        double log2(double& error) const;
+        Fixed fixed_log2(size_t w) const;
+        bool equals(const arithmetic::natural_t& number, uint64_t scale) const;
+        optional<bool> below_power_of_ten(const arithmetic::natural_t& k) const;
+        uint64_t bit_count() const;
+        uint64_t digit_count() const;
+        const arithmetic::natural_t& shown() const;
+        arithmetic::natural_t leading(uint64_t count) const;
+        shared_ptr<const Deferred> with_sign(bool negative) const;
+
+    private:
+        arithmetic::natural_t find_leading(uint64_t count, uint64_t total) const;
+    };
+
+    const VeryLong& IntegerEntity::Deferred::evaluate() const
+    {
+        if (!computed) {
+            arithmetic::natural_t product{1};
+            for (const auto& [base, exponent] : powers) {
+                product = arithmetic::multiply(product, arithmetic::power(base, exponent));
+            }
+            computed = arithmetic::to_verylong(product, negative);
+        }
+        return *computed;
+    }
+
+    //! Returns log2 of the magnitude and sets error to a bound on how far it may be off.
+    double IntegerEntity::Deferred::log2(double& error) const
+    {
+        double result = 0.0;
+        for (const auto& [base, exponent] : powers) {
+            result += static_cast<double>(exponent) * arithmetic::log2(base);
+        }
+        error = 4 * DBL_EPSILON * (result + static_cast<double>(powers.size()));
+        return result;
+    }
+
+    //! Returns log2 of the magnitude with w fraction bits.
+    Fixed IntegerEntity::Deferred::fixed_log2(size_t w) const
+    {
+        Fixed result;
+        for (const auto& [base, exponent] : powers) {
+            const Fixed term = clac::entity::fixed_log2(base, w);
+            arithmetic::addmul(result.value, term.value, natural(exponent));
+            arithmetic::addmul(result.error, term.error, natural(exponent));
+        }
+        return result;
+    }
+
+    //
+    // Returns true if the magnitude is exactly number * 10^scale. The factors of two and five
+    // are counted apart from the rest of each base, and the rest is only multiplied out while it
+    // is no larger than the rest of number, so the test is quick for the large powers.
+    //
+    bool IntegerEntity::Deferred::equals(const arithmetic::natural_t& number, uint64_t scale) const
+    {
+        arithmetic::natural_t rest = number;
+        const auto [number_twos, number_fives] = remove_two_five(rest);
+        const size_t limit = arithmetic::bit_length(rest);
+
+        arithmetic::natural_t twos;
+        arithmetic::natural_t fives;
+        arithmetic::natural_t product{1};
+        for (const auto& [base, exponent] : powers) {
+            arithmetic::natural_t odd = base;
+            const auto [base_twos, base_fives] = remove_two_five(odd);
+            arithmetic::addmul(twos, natural(base_twos), natural(exponent));
+            arithmetic::addmul(fives, natural(base_fives), natural(exponent));
+            if (arithmetic::bit_length(odd) > 1) {
+                // The odd part is at least three, so its power has more than exponent bits.
+                if (exponent >= limit)
+                    return false;
+                product = arithmetic::multiply(product, arithmetic::power(odd, exponent));
+                if (arithmetic::bit_length(product) > limit)
+                    return false;
+            }
+        }
+        const arithmetic::natural_t s = natural(scale);
+        return arithmetic::compare(product, rest) == 0 &&
+               arithmetic::compare(twos, arithmetic::add(s, natural(number_twos))) == 0 &&
+               arithmetic::compare(fives, arithmetic::add(s, natural(number_fives))) == 0;
+    }
+
+    //
+    // The bit length is one more than the floor of log2 of the magnitude. If the bound on the
+    // logarithm straddles an integer k, the magnitude may be exactly 2^k, which it is when every
+    // base is a power of two and the exponents of two add up to k.
+    //
+    uint64_t IntegerEntity::Deferred::bit_count() const
+    {
+        if (bits)
+            return *bits;
+
+        bits = 0;
+        size_t w = LENGTH_PRECISION;
+        for (int attempt = 0; attempt < PRECISION_ATTEMPTS; ++attempt, w *= 2) {
+            arithmetic::natural_t floor;
+            if (!certain_floor(fixed_log2(w), w, floor)) {
+                bool exact = true;
+                arithmetic::natural_t twos;
+                for (const auto& [base, exponent] : powers) {
+                    const size_t zeros = arithmetic::trailing_zeros(base);
+                    exact = exact && arithmetic::bit_length(base) == zeros + 1;
+                    arithmetic::addmul(twos, natural(zeros), natural(exponent));
+                }
+                if (!exact || arithmetic::compare(twos, floor) != 0)
+                    continue;
+            }
+            bits = to_count(floor) + 1;
+            break;
+        }
+        return *bits;
+    }
+
+    //
+    // Returns whether the magnitude is below 10^k, if the lengths of the bases decide it. A base
+    // b of d digits lies in [10^(d - 1), 10^d), so the magnitude is at least 10^k when k is the
+    // sum of e * (d - 1) over the powers b^e, and less than 10^k when k is the sum of e * d. That
+    // settles the powers of numbers just below or above a power of ten, such as (10^n - 1)^e,
+    // whose logarithms are too close to k for any precision to decide.
+    //
+    optional<bool> IntegerEntity::Deferred::below_power_of_ten(const arithmetic::natural_t& k) const
+    {
+        arithmetic::natural_t lower;
+        arithmetic::natural_t upper;
+        for (const auto& [base, exponent] : powers) {
+            const uint64_t length = decimal_digits(base);
+            arithmetic::addmul(lower, natural(length - 1), natural(exponent));
+            arithmetic::addmul(upper, natural(length), natural(exponent));
+        }
+        if (arithmetic::compare(k, lower) == 0)
+            return false;
+        if (arithmetic::compare(k, upper) == 0)
+            return true;
+        return nullopt;
+    }
+
+    //
+    // The number of digits is one more than the floor of log10 of the magnitude. When the bound
+    // on the logarithm straddles an integer k, the magnitude is compared with 10^k by its factors.
+    //
+    uint64_t IntegerEntity::Deferred::digit_count() const
+    {
+        if (digits)
+            return *digits;
+
+        digits = 0;
+        size_t w = LENGTH_PRECISION;
+        for (int attempt = 0; attempt < PRECISION_ATTEMPTS; ++attempt, w *= 2) {
+            const Fixed ten = clac::entity::fixed_log2(natural(10), w);
+            const Fixed log10 = to_log10(fixed_log2(w), ten, w);
+            arithmetic::natural_t floor;
+            if (certain_floor(log10, w, floor) || equals(natural(1), to_count(floor))) {
+                digits = to_count(floor) + 1;
+                break;
+            }
+            if (const optional<bool> below = below_power_of_ten(floor)) {
+                digits = to_count(floor) + (*below ? 0 : 1);
+                break;
+            }
+            const arithmetic::natural_t lower = arithmetic::compare(log10.value, log10.error) > 0
+                ? arithmetic::subtract(log10.value, log10.error)
+                : arithmetic::natural_t();
+            fewest_digits = to_count(arithmetic::shift_right(lower, w)) + 1;
+        }
+        return *digits;
+    }
+
+    //
+    // The first 'count' of the 'total' digits are the D with log10(D) <= y < log10(D + 1), where
+    // y = log10 |x| - (total - count). A candidate from 10^y moves a step at a time while y is
+    // certainly outside those bounds, and is the result once y is certainly inside them, or the
+    // magnitude is exactly D or D + 1 times 10^(total - count). Otherwise the precision is raised,
+    // and the result is empty if the last precision doesn't settle it either, unless the value
+    // has been evaluated.
+    //
+    arithmetic::natural_t IntegerEntity::Deferred::find_leading(
+        uint64_t count, uint64_t total) const
+    {
+        const uint64_t scale = total - count;
+        const arithmetic::natural_t one = natural(1);
+        const arithmetic::natural_t smallest = power_of_ten(count - 1);
+        const arithmetic::natural_t largest = power_of_ten(count);
+        size_t w = 4 * count + LENGTH_PRECISION;
+        for (int attempt = 0; attempt < PRECISION_ATTEMPTS; ++attempt, w *= 2) {
+            const Fixed ten = clac::entity::fixed_log2(natural(10), w);
+            const Fixed log10 = to_log10(fixed_log2(w), ten, w);
+            const arithmetic::natural_t offset = arithmetic::shift_left(natural(scale), w);
+
+            // The candidate comes from the fraction part of the logarithm, y - (count - 1).
+            const arithmetic::natural_t whole = arithmetic::shift_left(natural(total - 1), w);
+            arithmetic::natural_t fraction;
+            if (arithmetic::compare(log10.value, whole) > 0)
+                fraction = arithmetic::subtract(log10.value, whole);
+            const arithmetic::natural_t ln10 =
+                arithmetic::shift_right(arithmetic::multiply(ten.value, fixed_ln2(w).value), w);
+            arithmetic::natural_t candidate = approximate_digits(fraction, ln10, count, w);
+            if (arithmetic::compare(candidate, smallest) < 0)
+                candidate = smallest;
+            if (arithmetic::compare(candidate, largest) >= 0)
+                candidate = arithmetic::subtract(largest, one);
+
+            for (int step = 0; step < 4 && !candidate.empty(); ++step) {
+                const arithmetic::natural_t next = arithmetic::add(candidate, one);
+                Fixed low = to_log10(clac::entity::fixed_log2(candidate, w), ten, w);
+                Fixed high = to_log10(clac::entity::fixed_log2(next, w), ten, w);
+                low.value = arithmetic::add(low.value, offset);
+                high.value = arithmetic::add(high.value, offset);
+                // The bounds at 10^(count - 1) and 10^count are those of the number of digits.
+                const bool at_smallest = arithmetic::compare(candidate, smallest) == 0;
+                const bool at_largest = arithmetic::compare(next, largest) == 0;
+                if (!at_smallest && certainly_less(log10, low)) {
+                    candidate = arithmetic::subtract(candidate, one);
+                    continue;
+                }
+                if (!at_largest && certainly_less(high, log10)) {
+                    candidate = next;
+                    continue;
+                }
+                if ((at_smallest || certainly_less(low, log10)) &&
+                    (at_largest || certainly_less(log10, high)))
+                    return candidate;
+                if (equals(candidate, scale))
+                    return candidate;
+                if (equals(next, scale))
+                    return next;
+                break;
+            }
+        }
+
+        // A value that was evaluated for some other reason can still give its digits.
+        if (!computed)
+            return arithmetic::natural_t();
+        arithmetic::natural_t quotient;
+        arithmetic::natural_t remainder;
+        arithmetic::divide(
+            arithmetic::to_natural(*computed), power_of_ten(scale), quotient, remainder);
+        return quotient;
+    }
+
+    //! Returns the leading digits shown for the value, as many as SHOWN_DIGITS that are certain.
+    const arithmetic::natural_t& IntegerEntity::Deferred::shown() const
     {
+        if (!first) {
+            first = arithmetic::natural_t();
+            const uint64_t total = digit_count();
+            const uint64_t most = (total == 0) ? 0 : std::min(SHOWN_DIGITS, total - 1);
+            for (uint64_t count = most; first->empty() && count > 0; --count) {
+                *first = find_leading(count, total);
+                first_count = count;
+            }
+        }
+        return *first;
+    }
+
+    //
+    // Returns the first 'count' digits of the magnitude, which has more than 'count' digits, or
+    // an empty value if they can't be certified. They are cut from the shown digits when those
+    // are enough.
+    //
+    arithmetic::natural_t IntegerEntity::Deferred::leading(uint64_t count) const
+    {
+        const uint64_t total = digit_count();
+        if (total == 0 || count >= total)
+            return arithmetic::natural_t();
+
+        const arithmetic::natural_t& known = shown();
+        if (known.empty() || count > first_count)
+            return find_leading(count, total);
+        arithmetic::natural_t quotient;
+        arithmetic::natural_t remainder;
+        arithmetic::divide(known, power_of_ten(first_count - count), quotient, remainder);
+        return quotient;
+    }
+
+    shared_ptr<const IntegerEntity::Deferred> IntegerEntity::Deferred::with_sign(bool sign) const
+    {
+        auto result = make_shared<Deferred>();
+        result->negative = sign;
+        result->powers = powers;
+        if (computed)
+            result->computed = (sign == negative) ? *computed : -*computed;
+        result->bits = bits;
+        result->digits = digits;
+        result->first = first;
+        result->first_count = first_count;
+        result->fewest_digits = fewest_digits;
+        return result;
+    }
+
+
+    IntegerEntity::IntegerEntity(int64_t number) : value(number)
+    {
+    }
+
+    IntegerEntity::IntegerEntity(shared_ptr<const Deferred> deferred) noexcept
+        : value(std::move(deferred))
+    {
+    }
+
+    IntegerEntity::IntegerEntity(const VeryLong& number)
+    {
+        int64_t small;
+        if (demote(number, small))
+            value = small;
+        else
+            value = number;
+    }
+
+    VeryLong IntegerEntity::get_value() const
+    {
+        if (is_small())
+            return promote(get_small());
+        if (is_deferred())
+            return deferred().evaluate();
+        return *get_if<VeryLong>(&value);
+    }
+
+    bool IntegerEntity::is_negative() const
+    {
+        if (is_small())
+            return get_small() < 0;
+        if (is_deferred())
+            return deferred().negative;
+        return *get_if<VeryLong>(&value) < VeryLong::zero;
+    }
+
+    //
+    // The logarithm of a large value is found from its bit length and top bits, or from the
+    // powers of a deferred value, so it takes the same time for any size. Requires a value that
+    // isn't zero.
+    //
+    double IntegerEntity::log2_magnitude(double& error) const
+    {
+        if (is_deferred())
+            return deferred().log2(error);
+
+        const double result = is_small() ? std::log2(std::fabs(static_cast<double>(get_small())))
+                                         : arithmetic::log2(*get_if<VeryLong>(&value));
+        error = 4 * DBL_EPSILON * (result + 1.0);
+        return result;
+    }
+
+    //
+    // The lengths of a deferred value come from its logarithm. If they can't be certified that
+    // way, the value is evaluated once, as the other exact operations do.
+    //
+    uint64_t IntegerEntity::count_bits() const
+    {
+        if (is_small()) {
+            const uint64_t m = static_cast<uint64_t>(get_small());
+            return static_cast<uint64_t>(bit_width(get_small() < 0 ? 0 - m : m));
+        }
+        if (!is_deferred())
+            return get_if<VeryLong>(&value)->number_bits();
+
+        const Deferred& d = deferred();
+        if (d.bit_count() == 0)
+            d.bits = get_value().number_bits();
+        return *d.bits;
+    }
+
+    //
+    // The number of digits is one more than the floor of the logarithm. If the logarithm of a
+    // value that isn't deferred is too close to an integer k to be sure of its floor, the value
+    // is compared with 10^k.
+    //
+    uint64_t IntegerEntity::count_digits() const
+    {
+        if (is_small()) {
+            const uint64_t m = static_cast<uint64_t>(get_small());
+            return decimal_digits(get_small() < 0 ? 0 - m : m);
+        }
+        if (is_deferred()) {
+            const Deferred& d = deferred();
+            if (d.digit_count() == 0) {
+                const IntegerEntity exact(get_value());
+                d.digits = exact.count_digits();
+                d.first.reset();
+            }
+            return *d.digits;
+        }
+
+        double error;
+        const double log10 = log2_magnitude(error) * LOG10_2;
+        error = error * LOG10_2 + 2 * DBL_EPSILON * log10;
+        const double upper = std::floor(log10 + error);
+        const auto k = static_cast<uint64_t>(upper);
+        if (std::floor(log10 - error) == upper)
+            return k + 1;
+        return (arithmetic::compare(magnitude(*this), power_of_ten(k)) >= 0) ? k + 1 : k;
+    }
+
+    //
+    // Returns the first 'count' of the 'total' digits of the magnitude, or all of them if there
+    // are no more than 'count'. A deferred value is evaluated.
+    //
+    arithmetic::natural_t IntegerEntity::leading(uint64_t count, uint64_t total) const
+    {
+        if (count >= total)
+            return magnitude(*this);
+
+        arithmetic::natural_t quotient;
+        arithmetic::natural_t remainder;
+        arithmetic::divide(magnitude(*this), power_of_ten(total - count), quotient, remainder);
+        return quotient;
+    }
+
+    //! Returns the magnitude mod 10^count.
+    arithmetic::natural_t IntegerEntity::trailing(uint64_t count) const
+    {
+        const arithmetic::natural_t modulus = power_of_ten(count);
+        arithmetic::natural_t quotient;
+        arithmetic::natural_t result;
+        if (!is_deferred()) {
+            arithmetic::divide(magnitude(*this), modulus, quotient, result);
+            return result;
+        }
+
+        result = arithmetic::natural_t{1};
+        for (const auto& [base, exponent] : deferred().powers) {
+            const arithmetic::natural_t term =
+                arithmetic::power_mod(base, arithmetic::natural_t{exponent}, modulus);
+            arithmetic::divide(arithmetic::multiply(result, term), modulus, quotient, result);
+        }
+        return result;
+    }
+
+    //
+    // Only residues are multiplied, so the size of the exponent doesn't matter. A negative base
+    // gives the negative of the power of its magnitude when the exponent is odd.
+    //
+    Entity* IntegerEntity::power_mod(
+        const IntegerEntity& exponent, const IntegerEntity& modulus) const
+    {
+        if (exponent.is_negative())
+            throw Error("The exponent of a modular power must not be negative");
+        const arithmetic::natural_t m = magnitude(modulus);
+        if (m.empty() || modulus.is_negative())
+            throw Error("The modulus must be positive");
+
+        const arithmetic::natural_t e = magnitude(exponent);
+        arithmetic::natural_t result = arithmetic::power_mod(magnitude(*this), e, m);
+        if (is_negative() && !e.empty() && (e[0] & 1) != 0 && !result.empty())
+            result = arithmetic::subtract(m, result);
+        return make_integer(result, false);
     }
 
     EntityType IntegerEntity::my_type() const noexcept
@@ -25,12 +1021,32 @@ namespace clac::entity {
         return INTEGER;
     }
 
+    //
+    // A deferred value is shown by its leading and trailing digits and its length, since
+    // converting all of its digits would take longer than computing it. Leading digits that
+    // can't be certified are left out, and a length that can't be is shown by its lower bound.
+    //
     std::string IntegerEntity::display() const
     {
-        std::ostringstream formatter;
+        if (is_small())
+            return std::to_string(get_small());
+        if (!is_deferred())
+            return arithmetic::to_string(get_value());
+
+        const Deferred& d = deferred();
+        std::string last = arithmetic::to_decimal(trailing(SHOWN_DIGITS));
+        last.insert(0, SHOWN_DIGITS - last.size(), '0');
 
-        formatter << value;
-        return formatter.str();
+        std::string result = d.negative ? "-" : "";
+        if (const arithmetic::natural_t& first = d.shown(); !first.empty())
+            result += arithmetic::to_decimal(first);
+        result += "...";
+        result += last;
+        if (const uint64_t total = d.digit_count(); total != 0)
+            result += " (" + std::to_string(total) + " digits)";
+        else
+            result += " (at least " + std::to_string(d.fewest_digits) + " digits)";
+        return result;
     }
 
     Entity* IntegerEntity::duplicate() const
@@ -44,11 +1060,17 @@ namespace clac::entity {
 
     Entity* IntegerEntity::abs() const
     {
+        if (is_small() && get_small() != SMALL_MIN)
+            return new IntegerEntity(get_small() < 0 ? -get_small() : get_small());
+        if (is_deferred())
+            return new IntegerEntity(deferred().with_sign(false));
+
+        const VeryLong number = get_value();
         IntegerEntity* result;
-        if (value < VeryLong::zero)
-            result = new IntegerEntity(-value);
+        if (number < VeryLong::zero)
+            result = new IntegerEntity(-number);
         else
-            result = new IntegerEntity(value);
+            result = new IntegerEntity(number);
         return result;
     }
 
@@ -70,6 +1092,15 @@ namespace clac::entity {
         return converted->atan();
     }
 
+    //
+    // The bit length and population count are those of the magnitude. The bit length of zero is
+    // zero.
+    //
+    Entity* IntegerEntity::bit_length() const
+    {
+        return new IntegerEntity(static_cast<int64_t>(count_bits()));
+    }
+
     Entity* IntegerEntity::complex_conjugate() const
     {
         return duplicate();
@@ -81,6 +1112,21 @@ namespace clac::entity {
         return converted->cos();
     }
 
+    Entity* IntegerEntity::digit_count() const
+    {
+        return new IntegerEntity(static_cast<int64_t>(count_digits()));
+    }
+
+    //
+    // The double factorial is extended to -1 by (-1)!! = 1!! / 1 = 1.
+    //
+    Entity* IntegerEntity::double_factorial() const
+    {
+        if (is_small() && get_small() == -1)
+            return new IntegerEntity(int64_t{1});
+        return make_integer(arithmetic::double_factorial(factorial_argument(*this, 2)), false);
+    }
+
     Entity* IntegerEntity::exp() const
     {
         unique_ptr<Entity> converted(to_float());
@@ -89,18 +1135,90 @@ namespace clac::entity {
 
     Entity* IntegerEntity::exp10() const
     {
-        unique_ptr<IntegerEntity> base(new IntegerEntity(VeryLong::ten));
+        unique_ptr<IntegerEntity> base(new IntegerEntity(int64_t{10}));
         return base->power(this);
     }
 
+    //
+    // The factors are returned as a list in increasing order, each repeated according to its
+    // multiplicity. A negative integer has -1 as its first factor.
+    //
+    Entity* IntegerEntity::factor() const
+    {
+        if (is_small() && get_small() == 0)
+            throw Error("Zero has no factorization");
+
+        vector<arithmetic::natural_t> factors;
+        try {
+            factors = arithmetic::factor(magnitude(*this));
+        }
+        catch (const arithmetic::Cancelled&) {
+            throw Error("Factorization interrupted");
+        }
+
+        list<Entity*> items;
+        try {
+            if (is_negative())
+                items.push_back(new IntegerEntity(int64_t{-1}));
+            for (const arithmetic::natural_t& item : factors) {
+                items.push_back(make_integer(item, false));
+            }
+            return new ListEntity(items);
+        }
+        catch (...) {
+            for (Entity* item : items) {
+                delete item;
+            }
+            throw;
+        }
+    }
+
+    Entity* IntegerEntity::factorial() const
+    {
+        return make_integer(arithmetic::factorial(factorial_argument(*this)), false);
+    }
+
+    //
+    // F(-n) = (-1)^(n + 1) F(n).
+    //
+    Entity* IntegerEntity::fibonacci() const
+    {
+        const uint64_t n = sequence_index(*this);
+        return make_integer(arithmetic::fibonacci(n), is_negative() && n % 2 == 0);
+    }
+
     Entity* IntegerEntity::fractional_part() const
     {
-        return new IntegerEntity(VeryLong::zero);
+        return new IntegerEntity(int64_t{0});
+    }
+
+    Entity* IntegerEntity::gamma() const
+    {
+        unique_ptr<Entity> converted(to_float());
+        return converted->gamma();
     }
 
     Entity* IntegerEntity::imaginary_part() const
     {
-        return new IntegerEntity(VeryLong::zero);
+        return new IntegerEntity(int64_t{0});
+    }
+
+    //
+    // The integer logarithms are floor(log2 |x|) and floor(log10 |x|), which are one less than
+    // the number of bits and of digits.
+    //
+    Entity* IntegerEntity::integer_log10() const
+    {
+        if (is_small() && get_small() == 0)
+            throw Error("Can't take the log of zero");
+        return new IntegerEntity(static_cast<int64_t>(count_digits() - 1));
+    }
+
+    Entity* IntegerEntity::integer_log2() const
+    {
+        if (is_small() && get_small() == 0)
+            throw Error("Can't take the log of zero");
+        return new IntegerEntity(static_cast<int64_t>(count_bits() - 1));
     }
 
     Entity* IntegerEntity::integer_part() const
@@ -108,6 +1226,14 @@ namespace clac::entity {
         return duplicate();
     }
 
+    Entity* IntegerEntity::integer_sqrt() const
+    {
+        if (is_negative())
+            throw Error("Can't take the integer square root of a negative number");
+        bool exact;
+        return make_integer(arithmetic::root(magnitude(*this), 2, exact), false);
+    }
+
     //
     // Would it be better to have inv return a RationalEntity? My guess is no. I think Rationals
     // will only be used in specialized situations and in a vast majority of cases the user will
@@ -120,21 +1246,117 @@ namespace clac::entity {
         return converted->inv();
     }
 
+    Entity* IntegerEntity::is_perfect_power() const
+    {
+        const bool negative = is_negative();
+        return new IntegerEntity(arithmetic::is_perfect_power(magnitude(*this), negative));
+    }
+
+    //! Primes are positive, so a negative integer is never prime.
+    Entity* IntegerEntity::is_prime() const
+    {
+        return new IntegerEntity(!is_negative() && arithmetic::is_prime(magnitude(*this)));
+    }
+
+    //
+    // The logarithms of a large integer don't convert it to a float, so they are finite for any
+    // size. A negative integer has the complex logarithm ln|x| + i pi.
+    //
     Entity* IntegerEntity::ln() const
     {
-        unique_ptr<Entity> converted(to_float());
-        return converted->ln();
+        if (is_small()) {
+            unique_ptr<Entity> converted(to_float());
+            return converted->ln();
+        }
+        double error;
+        const double result = log2_magnitude(error) * numbers::ln2;
+        if (is_negative())
+            return new ComplexEntity(result, numbers::pi);
+        return new FloatEntity(result);
     }
 
     Entity* IntegerEntity::log() const
+    {
+        if (is_small()) {
+            unique_ptr<Entity> converted(to_float());
+            return converted->log();
+        }
+        double error;
+        const double result = log2_magnitude(error) * LOG10_2;
+        if (is_negative())
+            return new ComplexEntity(result, numbers::pi * numbers::log10e);
+        return new FloatEntity(result);
+    }
+
+    Entity* IntegerEntity::log_gamma() const
     {
         unique_ptr<Entity> converted(to_float());
-        return converted->log();
+        return converted->log_gamma();
+    }
+
+    //
+    // The complement of x is -x - 1.
+    //
+    Entity* IntegerEntity::logical_not() const
+    {
+        if (is_small())
+            return new IntegerEntity(~get_small());
+
+        const arithmetic::natural_t one{1};
+        if (is_negative())
+            return make_integer(arithmetic::subtract(magnitude(*this), one), false);
+        return make_integer(arithmetic::add(magnitude(*this), one), true);
+    }
+
+    //
+    // L(-n) = (-1)^n L(n).
+    //
+    Entity* IntegerEntity::lucas() const
+    {
+        const uint64_t n = sequence_index(*this);
+        return make_integer(arithmetic::lucas(n), is_negative() && n % 2 != 0);
     }
 
     Entity* IntegerEntity::neg() const
     {
-        return new IntegerEntity(-value);
+        if (is_small() && get_small() != SMALL_MIN)
+            return new IntegerEntity(-get_small());
+        if (is_deferred())
+            return new IntegerEntity(deferred().with_sign(!deferred().negative));
+        return new IntegerEntity(-get_value());
+    }
+
+    Entity* IntegerEntity::next_prime() const
+    {
+        if (is_negative())
+            return new IntegerEntity(int64_t{2});
+        try {
+            return make_integer(arithmetic::next_prime(magnitude(*this)), false);
+        }
+        catch (const arithmetic::Cancelled&) {
+            throw Error("Prime search interrupted");
+        }
+    }
+
+    Entity* IntegerEntity::population_count() const
+    {
+        if (is_small()) {
+            const int64_t value = get_small();
+            const uint64_t m = static_cast<uint64_t>(value);
+            return new IntegerEntity(static_cast<int64_t>(popcount((value < 0) ? 0 - m : m)));
+        }
+        return new IntegerEntity(static_cast<int64_t>(arithmetic::popcount(magnitude(*this))));
+    }
+
+    Entity* IntegerEntity::prime_count() const
+    {
+        try {
+            return new IntegerEntity(
+                static_cast<int64_t>(arithmetic::prime_count(sieve_bound(*this))));
+        }
+        catch (const arithmetic::Cancelled&) {
+            throw Error("Prime count interrupted");
+        }
     }
 
     Entity* IntegerEntity::real_part() const
@@ -142,20 +1364,25 @@ namespace clac::entity {
         return duplicate();
     }
 
-    Entity* IntegerEntity::sign() const
+    Entity* IntegerEntity::shift_left() const
     {
-        IntegerEntity* result;
-
-        if (value == VeryLong::zero)
-            result = new IntegerEntity(VeryLong::zero);
+        return shift_integer(*this, 1);
+    }
 
-        else if (value > VeryLong::zero)
-            result = new IntegerEntity(VeryLong::one);
+    Entity* IntegerEntity::shift_right() const
+    {
+        return shift_integer(*this, -1);
+    }
 
-        else /* value < 0 */
-            result = new IntegerEntity(VeryLong::negative_one);
+    Entity* IntegerEntity::sign() const
+    {
+        if (is_small()) {
+            const int64_t number = get_small();
+            return new IntegerEntity(int64_t{(number > 0) - (number < 0)});
+        }
 
-        return result;
+        // A large value is never zero.
+        return new IntegerEntity(int64_t{is_negative() ? -1 : 1});
     }
 
     Entity* IntegerEntity::sin() const
@@ -166,13 +1393,27 @@ namespace clac::entity {
 
     Entity* IntegerEntity::sq() const
     {
-        unique_ptr<IntegerEntity> temp(dynamic_cast<IntegerEntity*>(duplicate()));
-        temp->value *= value;
-        return temp.release();
+        int64_t result;
+        if (is_small() && checked_multiply(get_small(), get_small(), result))
+            return new IntegerEntity(result);
+        return new IntegerEntity(arithmetic::square(get_value()));
     }
 
+    //
+    // The square root of a perfect square is an integer. Other roots are floats. When the root
+    // has more than 64 bits, its integer part determines the float, and the value itself might
+    // be too large to convert.
+    //
     Entity* IntegerEntity::sqrt() const
     {
+        if (!is_negative()) {
+            bool exact;
+            const arithmetic::natural_t root = arithmetic::root(magnitude(*this), 2, exact);
+            if (exact)
+                return make_integer(root, false);
+            if (arithmetic::bit_length(root) > 64)
+                return new FloatEntity(arithmetic::to_double(root));
+        }
         unique_ptr<Entity> converted(to_float());
         return converted->sqrt();
     }
@@ -186,78 +1427,291 @@ namespace clac::entity {
     //
     // Binary operations.
     //
+    // Machine division truncates toward zero and gives the remainder the sign of the dividend,
+    // as VeryLong does. It is only skipped for a zero divisor, so that VeryLong reports the
+    // error, and for the one quotient that overflows.
+    //
 
     Entity* IntegerEntity::divide(const Entity* R) const
     {
         const IntegerEntity* right = dynamic_cast<const IntegerEntity*>(R);
-        unique_ptr<IntegerEntity> copy(dynamic_cast<IntegerEntity*>(duplicate()));
-        copy->value /= right->value;
-        return copy.release();
+        if (is_small() && right->is_small() && right->get_small() != 0 &&
+            !(get_small() == SMALL_MIN && right->get_small() == -1)) {
+            return new IntegerEntity(get_small() / right->get_small());
+        }
+        VeryLong::vldiv_t result;
+        arithmetic::divide(get_value(), right->get_value(), &result);
+        return new IntegerEntity(result.quot);
+    }
+
+    //
+    // The binomial coefficient (n choose k) is zero for negative k and for k > n >= 0, however
+    // large k is, and for negative n it is (-1)^k (k - n - 1 choose k). A deferred k is larger
+    // than any n that is not deferred.
+    //
+    Entity* IntegerEntity::binomial(const Entity* R) const
+    {
+        const IntegerEntity* right = dynamic_cast<const IntegerEntity*>(R);
+        if (right->is_negative())
+            return new IntegerEntity(int64_t{0});
+        if (!is_negative() && !is_deferred() &&
+            (right->is_deferred() || compare(*this, *right) < 0))
+            return new IntegerEntity(int64_t{0});
+        if (!right->is_small() ||
+            static_cast<uint64_t>(right->get_small()) > arithmetic::SIEVE_LIMIT)
+            throw Error("Binomial coefficient index is too large");
+
+        const auto k = static_cast<uint64_t>(right->get_small());
+        if (k == 0)
+            return new IntegerEntity(int64_t{1});
+        if (!is_negative())
+            return make_integer(arithmetic::binomial(magnitude(*this), k), false);
+
+        arithmetic::natural_t n = magnitude(*this);
+        if (k > 1)
+            n = arithmetic::add(n, arithmetic::natural_t{k - 1});
+        return make_integer(arithmetic::binomial(n, k), k % 2 != 0);
+    }
+
+    //
+    // The GCD and LCM are always nonnegative. The GCD of zero and zero is zero.
+    //
+    Entity* IntegerEntity::gcd(const Entity* R) const
+    {
+        const IntegerEntity* right = dynamic_cast<const IntegerEntity*>(R);
+        return make_integer(arithmetic::gcd(magnitude(*this), magnitude(*right)), false);
+    }
+
+    Entity* IntegerEntity::lcm(const Entity* R) const
+    {
+        const IntegerEntity* right = dynamic_cast<const IntegerEntity*>(R);
+        const arithmetic::natural_t l = magnitude(*this);
+        const arithmetic::natural_t r = magnitude(*right);
+        if (l.empty() || r.empty())
+            return new IntegerEntity(int64_t{0});
+
+        return make_integer(
+            arithmetic::multiply(arithmetic::divide_exact(l, arithmetic::gcd(l, r)), r), false);
+    }
+
+    //
+    // The leading and trailing digits are those of the magnitude. Asking for at least as many
+    // digits as there are gives the whole magnitude. A deferred value is evaluated only if its
+    // logarithm doesn't settle the digits, or all of them are asked for.
+    //
+    Entity* IntegerEntity::leading_digits(const Entity* R) const
+    {
+        const IntegerEntity* right = dynamic_cast<const IntegerEntity*>(R);
+        const uint64_t count = digit_argument(*right);
+        if (is_deferred() && count < deferred().digit_count()) {
+            arithmetic::natural_t result = deferred().leading(count);
+            if (!result.empty())
+                return make_integer(result, false);
+        }
+        return make_integer(leading(count, count_digits()), false);
+    }
+
+    Entity* IntegerEntity::integer_root(const Entity* R) const
+    {
+        const IntegerEntity* right = dynamic_cast<const IntegerEntity*>(R);
+        if (!right->is_small() || right->get_small() <= 0)
+            throw Error("The index of a root must be a positive integer");
+
+        const auto k = static_cast<size_t>(right->get_small());
+        const bool negative = is_negative();
+        if (negative && k % 2 == 0)
+            throw Error("Can't take an even root of a negative number");
+        bool exact;
+        return make_integer(arithmetic::root(magnitude(*this), k, exact), negative);
+    }
+
+    Entity* IntegerEntity::logical_and(const Entity* R) const
+    {
+        const IntegerEntity* right = dynamic_cast<const IntegerEntity*>(R);
+        return bitwise(*this, *right, BitwiseOperation::AND);
+    }
+
+    Entity* IntegerEntity::logical_or(const Entity* R) const
+    {
+        const IntegerEntity* right = dynamic_cast<const IntegerEntity*>(R);
+        return bitwise(*this, *right, BitwiseOperation::OR);
+    }
+
+    Entity* IntegerEntity::logical_xor(const Entity* R) const
+    {
+        const IntegerEntity* right = dynamic_cast<const IntegerEntity*>(R);
+        return bitwise(*this, *right, BitwiseOperation::XOR);
     }
 
     Entity* IntegerEntity::minus(const Entity* R) const
     {
         const IntegerEntity* right = dynamic_cast<const IntegerEntity*>(R);
-        unique_ptr<IntegerEntity> copy(dynamic_cast<IntegerEntity*>(duplicate()));
-        copy->value -= right->value;
-        return copy.release();
+        int64_t result;
+        if (is_small() && right->is_small() &&
+            checked_subtract(get_small(), right->get_small(), result)) {
+            return new IntegerEntity(result);
+        }
+        return new IntegerEntity(get_value() - right->get_value());
+    }
+
+    //
+    // The residue of this integer with the modulus R, which must be positive.
+    //
+    Entity* IntegerEntity::modular(const Entity* R) const
+    {
+        const IntegerEntity* right = dynamic_cast<const IntegerEntity*>(R);
+        if (right->is_negative())
+            throw Error("The modulus must be positive");
+        return new ModularEntity(magnitude(*this), is_negative(), magnitude(*right));
     }
 
     Entity* IntegerEntity::modulo(const Entity* R) const
     {
         const IntegerEntity* right = dynamic_cast<const IntegerEntity*>(R);
-        unique_ptr<IntegerEntity> copy(dynamic_cast<IntegerEntity*>(duplicate()));
-        copy->value %= right->value;
-        return copy.release();
+        if (is_small() && right->is_small() && right->get_small() != 0) {
+            // The remainder of SMALL_MIN / -1 is zero, but computing it can trap.
+            if (right->get_small() == -1)
+                return new IntegerEntity(int64_t{0});
+            return new IntegerEntity(get_small() % right->get_small());
+        }
+        VeryLong::vldiv_t result;
+        arithmetic::divide(get_value(), right->get_value(), &result);
+        return new IntegerEntity(result.rem);
     }
 
+    //
+    // A product with a deferred factor is deferred as well. Its list of powers is the two lists
+    // together, where a factor that is not deferred is a power with exponent one.
+    //
     Entity* IntegerEntity::multiply(const Entity* R) const
     {
         const IntegerEntity* right = dynamic_cast<const IntegerEntity*>(R);
-        unique_ptr<IntegerEntity> copy(dynamic_cast<IntegerEntity*>(duplicate()));
-        copy->value *= right->value;
-        return copy.release();
+        int64_t result;
+        if (is_small() && right->is_small() &&
+            checked_multiply(get_small(), right->get_small(), result)) {
+            return new IntegerEntity(result);
+        }
+
+        if (is_deferred() || right->is_deferred()) {
+            auto product = make_shared<Deferred>();
+            for (const IntegerEntity* factor : {this, right}) {
+                product->negative = product->negative != factor->is_negative();
+                if (factor->is_deferred()) {
+                    const auto& powers = factor->deferred().powers;
+                    product->powers.insert(product->powers.end(), powers.begin(), powers.end());
+                    continue;
+                }
+                arithmetic::natural_t m = magnitude(*factor);
+                if (m.empty())
+                    return new IntegerEntity(int64_t{0});
+                if (m.size() > 1 || m[0] > 1)
+                    product->powers.emplace_back(std::move(m), 1);
+            }
+            return new IntegerEntity(std::move(product));
+        }
+        return new IntegerEntity(arithmetic::multiply(get_value(), right->get_value()));
     }
 
     Entity* IntegerEntity::plus(const Entity* R) const
     {
         const IntegerEntity* right = dynamic_cast<const IntegerEntity*>(R);
-        unique_ptr<IntegerEntity> copy(dynamic_cast<IntegerEntity*>(duplicate()));
-        copy->value += right->value;
-        return copy.release();
+        int64_t result;
+        if (is_small() && right->is_small() &&
+            checked_add(get_small(), right->get_small(), result)) {
+            return new IntegerEntity(result);
+        }
+        return new IntegerEntity(get_value() + right->get_value());
     }
 
     //
-    // There is a faster way of computing a power using recursion than the method I'm using here.
-    // This method is O(N) where N is the size of the exponent. The faster method is O(log(N)).
-    // Since VeryLongs can be large, I should probably change this function someday to use the more
-    // efficient method. It might make a difference for some applications.
+    // The power is computed with sliding window exponentiation, so it takes O(log(N))
+    // multiplications where N is the exponent. A power with more than DEFERRED_BITS bits is
+    // deferred instead, and a power of a deferred value multiplies each of its exponents.
     //
     Entity* IntegerEntity::power(const Entity* R) const
     {
         const IntegerEntity* right = dynamic_cast<const IntegerEntity*>(R);
-        unique_ptr<IntegerEntity> result(new IntegerEntity(VeryLong::one));
-        VeryLong exponent(right->value);
 
         // If we are using a negative exponent, compute the appropriate power and then invert it. Note
         // that inv currently returns a (pointer to a) FloatEntity. Most likely this is what the user
         // wants when applying a negative exponent to an integer anyway.
         //
-        if (exponent < VeryLong::zero) {
-            while (exponent < VeryLong::zero) {
-                result->value *= value;
-                ++exponent;
-            }
+        if (right->is_negative()) {
+            unique_ptr<IntegerEntity> positive(dynamic_cast<IntegerEntity*>(right->neg()));
+            unique_ptr<Entity> result(power(positive.get()));
             return result->inv();
         }
 
         // Otherwise it's a positive (or zero) exponent.
-        while (exponent > VeryLong::zero) {
-            result->value *= value;
-            --exponent;
+        int64_t result;
+        if (is_small() && right->is_small() &&
+            checked_power(get_small(), right->get_small(), result)) {
+            return new IntegerEntity(result);
         }
 
-        return result.release();
+        if (right->is_small() && right->get_small() > 1) {
+            const auto exponent = static_cast<uint64_t>(right->get_small());
+            auto power = make_shared<Deferred>();
+            power->negative = is_negative() && exponent % 2 != 0;
+            if (is_deferred()) {
+                for (const auto& [base, e] : deferred().powers) {
+                    if (e > numeric_limits<uint64_t>::max() / exponent)
+                        throw Error("Exponent is too large");
+                    power->powers.emplace_back(base, e * exponent);
+                }
+                return new IntegerEntity(std::move(power));
+            }
+            arithmetic::natural_t base = magnitude(*this);
+            const double bits = std::ceil(static_cast<double>(exponent) * arithmetic::log2(base));
+            if (arithmetic::bit_length(base) > 1 && bits > DEFERRED_BITS) {
+                power->powers.emplace_back(std::move(base), exponent);
+                return new IntegerEntity(std::move(power));
+            }
+        }
+        return new IntegerEntity(arithmetic::power(get_value(), right->get_value()));
+    }
+
+    //
+    // The primes in [this, R] are held in an integer vector, which stores them as machine words
+    // rather than as separate entities.
+    //
+    Entity* IntegerEntity::primes(const Entity* R) const
+    {
+        const IntegerEntity* right = dynamic_cast<const IntegerEntity*>(R);
+        const uint64_t low = sieve_bound(*this);
+        const uint64_t high = sieve_bound(*right);
+
+        vector<uint64_t> found;
+        try {
+            found = arithmetic::primes_between(low, high);
+        }
+        catch (const arithmetic::Cancelled&) {
+            throw Error("Prime sieve interrupted");
+        }
+        return new VectorEntity(vector<int64_t>(found.begin(), found.end()));
+    }
+
+    //
+    // Shifts left by the number of bits in R, or right if R is negative. A count too large to
+    // hold in 64 bits can only be a right shift, which leaves zero or minus one.
+    //
+    Entity* IntegerEntity::shift(const Entity* R) const
+    {
+        const IntegerEntity* right = dynamic_cast<const IntegerEntity*>(R);
+        if (right->is_small())
+            return shift_integer(*this, right->get_small());
+        if (!right->is_negative())
+            throw Error("Shift count is too large");
+        return shift_integer(*this, SMALL_MIN);
+    }
+
+    Entity* IntegerEntity::trailing_digits(const Entity* R) const
+    {
+        const IntegerEntity* right = dynamic_cast<const IntegerEntity*>(R);
+        const uint64_t count = digit_argument(*right);
+        if (!is_deferred() && count >= count_digits())
+            return make_integer(magnitude(*this), false);
+        return make_integer(trailing(count), false);
     }
 
     //
@@ -267,60 +1721,89 @@ namespace clac::entity {
     Entity* IntegerEntity::is_equal(const Entity* R) const
     {
         const IntegerEntity* right = dynamic_cast<const IntegerEntity*>(R);
-        return new IntegerEntity(value == right->value);
+        return new IntegerEntity(compare(*this, *right) == 0);
     }
 
     Entity* IntegerEntity::is_notequal(const Entity* R) const
     {
         const IntegerEntity* right = dynamic_cast<const IntegerEntity*>(R);
-        return new IntegerEntity(value != right->value);
+        return new IntegerEntity(compare(*this, *right) != 0);
     }
 
     Entity* IntegerEntity::is_less(const Entity* R) const
     {
         const IntegerEntity* right = dynamic_cast<const IntegerEntity*>(R);
-        return new IntegerEntity(value < right->value);
+        return new IntegerEntity(compare(*this, *right) < 0);
     }
 
     Entity* IntegerEntity::is_lessorequal(const Entity* R) const
     {
         const IntegerEntity* right = dynamic_cast<const IntegerEntity*>(R);
-        return new IntegerEntity(value <= right->value);
+        return new IntegerEntity(compare(*this, *right) <= 0);
     }
 
     Entity* IntegerEntity::is_greater(const Entity* R) const
     {
         const IntegerEntity* right = dynamic_cast<const IntegerEntity*>(R);
-        return new IntegerEntity(value > right->value);
+        return new IntegerEntity(compare(*this, *right) > 0);
     }
 
     Entity* IntegerEntity::is_greaterorequal(const Entity* R) const
     {
         const IntegerEntity* right = dynamic_cast<const IntegerEntity*>(R);
-        return new IntegerEntity(value >= right->value);
+        return new IntegerEntity(compare(*this, *right) >= 0);
     }
 
     //
     // Conversions from IntegerEntity
     //
 
-    Entity* IntegerEntity::to_float() const
+    Entity* IntegerEntity::to_bigfloat() const
     {
-        const VeryLong::size_type bit_count = value.number_bits();
-        double result = 0.0;
+        return new BigFloatEntity(arithmetic::BigFloat{magnitude(*this), 0, is_negative()});
+    }
 
-        for (VeryLong::size_type i = 0; i < bit_count; i++) {
-            result *= 2.0;
-            result += value.get_bit(bit_count - i - 1);
-        }
-        if (value < 0)
-            result = -result;
+    //
+    // The binary holds the low order bits of the integer at the current word size. A negative
+    // integer gives its two's complement.
+    //
+    Entity* IntegerEntity::to_binary() const
+    {
+        const BinaryEntity bits(magnitude(*this));
+        if (is_negative())
+            return bits.neg();
+        return bits.duplicate();
+    }
+
+    //
+    // Both conversions round to the nearest double, with ties to even. A large value is rounded
+    // from its top 64 bits, so the conversion takes about the same time for any value.
+    //
+    Entity* IntegerEntity::to_float() const
+    {
+        if (is_small())
+            return new FloatEntity(static_cast<double>(get_small()));
+        if (is_deferred())
+            throw Error("Integer is too large to convert to a float");
 
+        const double result = arithmetic::to_double(get_value());
+        if (std::isinf(result))
+            throw Error("Integer is too large to convert to a float");
         return new FloatEntity(result);
     }
 
+    //
+    // Converting a deferred value to an integer evaluates it.
+    //
     Entity* IntegerEntity::to_integer() const
     {
+        if (is_deferred())
+            return new IntegerEntity(get_value());
         return duplicate();
     }
+
+    Entity* IntegerEntity::to_modular() const
+    {
+        return new ModularEntity(magnitude(*this), is_negative());
+    }
 }
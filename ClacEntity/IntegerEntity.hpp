@@ -6,20 +6,66 @@
 #ifndef INTEGERENTITY_HPP
 #define INTEGERENTITY_HPP
 
+#include <cstdint>
+#include <memory>
+#include <variant>
+
 #include "Entity.hpp"
+#include "arithmetic.hpp"
 #include <spicacpp/VeryLong.hpp>
 
 namespace clac::entity {
+    /*!
+     * Integers that fit in 64 bits are held directly. Operations on such values use checked
+     * machine arithmetic and only switch to VeryLong when the result overflows. Any result that
+     * fits in 64 bits again is stored in the small form, so a VeryLong is only ever used for
+     * values that need one.
+     *
+     * The bitwise operations treat an integer as a two's complement number with infinitely many
+     * sign bits, so that they agree with the machine operations on small values.
+     *
+     * A power too large to compute cheaply, and any product involving one, is held unevaluated as
+     * a list of powers. The number of digits, the leading digits (from logarithms), and the
+     * trailing digits (from modular powers) of such a value are found without evaluating it. Any
+     * operation that needs the exact value evaluates it once and keeps the result.
+     */
     class IntegerEntity : public Entity {
+        struct Deferred;
+
     public:
         // For building an integer entity from its primitive.
+        IntegerEntity(std::int64_t number);
         IntegerEntity(const spica::VeryLong& number);
 
-        spica::VeryLong get_value() noexcept
+        //! Returns true if the value is held as a 64 bit integer.
+        bool is_small() const noexcept
+        {
+            return std::holds_alternative<std::int64_t>(value);
+        }
+
+        //! Returns the value of a small integer. Requires is_small().
+        std::int64_t get_small() const noexcept
+        {
+            return *std::get_if<std::int64_t>(&value);
+        }
+
+        //! Returns true if the value is an unevaluated product of powers.
+        bool is_deferred() const noexcept
         {
-            return value;
+            return std::holds_alternative<std::shared_ptr<const Deferred>>(value);
         }
 
+        //! Returns the value as a VeryLong, converting a small integer or evaluating a deferred
+        //! value if necessary.
+        spica::VeryLong get_value() const;
+
+        //! Returns true if the value is less than zero. A deferred value is not evaluated.
+        bool is_negative() const;
+
+        //! Returns this^exponent mod modulus, in the range [0, modulus). Throws Error if the
+        //! exponent is negative or the modulus is not positive.
+        Entity* power_mod(const IntegerEntity& exponent, const IntegerEntity& modulus) const;
+
         // Functions for maintaining a member of the Entity family.
         EntityType my_type() const noexcept override;
         std::string display() const override;
@@ -30,18 +76,38 @@ namespace clac::entity {
         Entity* acos() const override;
         Entity* asin() const override;
         Entity* atan() const override;
+        Entity* bit_length() const override;
         Entity* complex_conjugate() const override;
         Entity* cos() const override;
+        Entity* digit_count() const override;
+        Entity* double_factorial() const override;
         Entity* exp() const override;
         Entity* exp10() const override;
+        Entity* factor() const override;
+        Entity* factorial() const override;
+        Entity* fibonacci() const override;
         Entity* fractional_part() const override;
+        Entity* gamma() const override;
         Entity* imaginary_part() const override;
+        Entity* integer_log10() const override;
+        Entity* integer_log2() const override;
         Entity* integer_part() const override;
+        Entity* integer_sqrt() const override;
         Entity* inv() const override;
+        Entity* is_perfect_power() const override;
+        Entity* is_prime() const override;
         Entity* ln() const override;
         Entity* log() const override;
+        Entity* log_gamma() const override;
+        Entity* logical_not() const override;
+        Entity* lucas() const override;
         Entity* neg() const override;
+        Entity* next_prime() const override;
+        Entity* population_count() const override;
+        Entity* prime_count() const override;
         Entity* real_part() const override;
+        Entity* shift_left() const override;
+        Entity* shift_right() const override;
         Entity* sign() const override;
         Entity* sin() const override;
         Entity* sq() const override;
@@ -49,16 +115,31 @@ namespace clac::entity {
         Entity* tan() const override;
 
         // Conversion operations.
+        Entity* to_bigfloat() const override;
+        Entity* to_binary() const override;
         Entity* to_float() const override;
         Entity* to_integer() const override;
+        Entity* to_modular() const override;
 
         // Binary operations.
+        Entity* binomial(const Entity*) const override;
         Entity* divide(const Entity*) const override;
+        Entity* gcd(const Entity*) const override;
+        Entity* integer_root(const Entity*) const override;
+        Entity* lcm(const Entity*) const override;
+        Entity* leading_digits(const Entity*) const override;
+        Entity* logical_and(const Entity*) const override;
+        Entity* logical_or(const Entity*) const override;
+        Entity* logical_xor(const Entity*) const override;
         Entity* minus(const Entity*) const override;
+        Entity* modular(const Entity*) const override;
         Entity* modulo(const Entity*) const override;
         Entity* multiply(const Entity*) const override;
         Entity* plus(const Entity*) const override;
         Entity* power(const Entity*) const override;
+        Entity* primes(const Entity*) const override;
+        Entity* shift(const Entity*) const override;
+        Entity* trailing_digits(const Entity*) const override;
 
         // Relational operations.
         Entity* is_equal(const Entity*) const override;
@@ -69,7 +150,21 @@ namespace clac::entity {
         Entity* is_greaterorequal(const Entity*) const override;
 
     private:
-        spica::VeryLong value;
+        explicit IntegerEntity(std::shared_ptr<const Deferred> deferred) noexcept;
+
+        //! Returns the unevaluated value. Requires is_deferred().
+        const Deferred& deferred() const noexcept
+        {
+            return **std::get_if<std::shared_ptr<const Deferred>>(&value);
+        }
+
+        double log2_magnitude(double& error) const;
+        std::uint64_t count_bits() const;
+        std::uint64_t count_digits() const;
+        arithmetic::natural_t leading(std::uint64_t count, std::uint64_t total) const;
+        arithmetic::natural_t trailing(std::uint64_t count) const;
+
+        std::variant<std::int64_t, spica::VeryLong, std::shared_ptr<const Deferred>> value;
     };
 }
 
@@ -0,0 +1,255 @@
+/*! \file    ModularEntity.cpp
+ *  \brief   Implementation of the Clac numeric type ModularEntity.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * Sums and differences of Montgomery forms are the forms of the sums and differences, so only
+ * multiplication, squaring, and powers need to know whether a residue is in Montgomery form.
+ * Residues of an even modulus are multiplied and reduced with an ordinary division, except for
+ * powers, which use Barrett reduction (see modular.hpp). Inverses are found by extended Euclid
+ * on the residue itself, not its Montgomery form.
+ */
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "Entities.hpp"
+
+using namespace std;
+
+namespace clac::entity {
+    namespace {
+
+        //! Returns the residue of the integer with the given magnitude and sign.
+        arithmetic::natural_t reduce(
+            const arithmetic::natural_t& magnitude, bool negative,
+            const arithmetic::natural_t& modulus)
+        {
+            arithmetic::natural_t quotient, remainder;
+            arithmetic::divide(magnitude, modulus, quotient, remainder);
+            if (negative && !remainder.empty())
+                remainder = arithmetic::subtract(modulus, remainder);
+            return remainder;
+        }
+
+        //! Returns the remainder of number / modulus.
+        arithmetic::natural_t remainder_of(
+            const arithmetic::natural_t& number, const arithmetic::natural_t& modulus)
+        {
+            return reduce(number, false, modulus);
+        }
+
+    } // namespace
+
+    ModularEntity::ModularEntity(const arithmetic::natural_t& magnitude, bool negative)
+        : value(magnitude), negative(negative && !magnitude.empty())
+    {
+    }
+
+    ModularEntity::ModularEntity(
+        const arithmetic::natural_t& magnitude, bool negative,
+        const arithmetic::natural_t& modulus)
+        : modulus(modulus)
+    {
+        if (modulus.empty())
+            throw Error("The modulus must not be zero");
+        value = reduce(magnitude, negative, modulus);
+        if ((modulus[0] & 1) != 0) {
+            context = make_shared<const arithmetic::Montgomery>(modulus);
+            value = context->to_form(value);
+        }
+    }
+
+    ModularEntity::ModularEntity(
+        arithmetic::natural_t value, const arithmetic::natural_t& modulus,
+        shared_ptr<const arithmetic::Montgomery> context)
+        : value(std::move(value)), modulus(modulus), context(std::move(context))
+    {
+    }
+
+    arithmetic::natural_t ModularEntity::get_residue() const
+    {
+        return context ? context->from_form(value) : value;
+    }
+
+    EntityType ModularEntity::my_type() const noexcept
+    {
+        return MODULAR;
+    }
+
+    string ModularEntity::display() const
+    {
+        if (modulus.empty()) {
+            string result = arithmetic::to_decimal(value);
+            if (negative)
+                result.insert(0, 1, '-');
+            return result;
+        }
+        string result = arithmetic::to_decimal(get_residue());
+        result.append(" (mod ");
+        result.append(arithmetic::to_decimal(modulus));
+        result.append(1, ')');
+        return result;
+    }
+
+    Entity* ModularEntity::duplicate() const
+    {
+        return new ModularEntity(*this);
+    }
+
+    const ModularEntity& ModularEntity::ring_of(const ModularEntity& right) const
+    {
+        if (modulus.empty()) {
+            if (right.modulus.empty())
+                throw Error("A modular integer needs a modulus");
+            return right;
+        }
+        if (!right.modulus.empty() && arithmetic::compare(modulus, right.modulus) != 0)
+            throw Error("Modular integers must have the same modulus");
+        return *this;
+    }
+
+    arithmetic::natural_t ModularEntity::value_of(const ModularEntity& number) const
+    {
+        if (!number.modulus.empty())
+            return number.value;
+        const arithmetic::natural_t residue = reduce(number.value, number.negative, modulus);
+        return context ? context->to_form(residue) : residue;
+    }
+
+    Entity* ModularEntity::make(arithmetic::natural_t result) const
+    {
+        return new ModularEntity(std::move(result), modulus, context);
+    }
+
+    arithmetic::natural_t ModularEntity::product(
+        const arithmetic::natural_t& left, const arithmetic::natural_t& right) const
+    {
+        if (context)
+            return context->multiply(left, right);
+        return remainder_of(arithmetic::multiply(left, right), modulus);
+    }
+
+    arithmetic::natural_t ModularEntity::inverse_of(const arithmetic::natural_t& number) const
+    {
+        arithmetic::natural_t inverse;
+        const arithmetic::natural_t residue = context ? context->from_form(number) : number;
+        if (!arithmetic::inverse_mod(residue, modulus, inverse))
+            throw Error("The modular integer has no inverse");
+        return context ? context->to_form(inverse) : inverse;
+    }
+
+    //
+    // Unary operations
+    //
+
+    Entity* ModularEntity::inv() const
+    {
+        if (modulus.empty())
+            throw Error("A modular integer needs a modulus");
+        return make(inverse_of(value));
+    }
+
+    Entity* ModularEntity::neg() const
+    {
+        if (modulus.empty())
+            return new ModularEntity(value, !negative);
+        return make(arithmetic::subtract_mod(arithmetic::natural_t(), value, modulus));
+    }
+
+    Entity* ModularEntity::sq() const
+    {
+        if (modulus.empty())
+            throw Error("A modular integer needs a modulus");
+        if (context)
+            return make(context->square(value));
+        return make(remainder_of(arithmetic::square(value), modulus));
+    }
+
+    //
+    // Binary operations
+    //
+
+    Entity* ModularEntity::divide(const Entity* R) const
+    {
+        const ModularEntity* right = dynamic_cast<const ModularEntity*>(R);
+        const ModularEntity& ring = ring_of(*right);
+        const arithmetic::natural_t inverse = ring.inverse_of(ring.value_of(*right));
+        return ring.make(ring.product(ring.value_of(*this), inverse));
+    }
+
+    Entity* ModularEntity::minus(const Entity* R) const
+    {
+        const ModularEntity* right = dynamic_cast<const ModularEntity*>(R);
+        const ModularEntity& ring = ring_of(*right);
+        return ring.make(
+            arithmetic::subtract_mod(ring.value_of(*this), ring.value_of(*right), ring.modulus));
+    }
+
+    Entity* ModularEntity::multiply(const Entity* R) const
+    {
+        const ModularEntity* right = dynamic_cast<const ModularEntity*>(R);
+        const ModularEntity& ring = ring_of(*right);
+        return ring.make(ring.product(ring.value_of(*this), ring.value_of(*right)));
+    }
+
+    Entity* ModularEntity::plus(const Entity* R) const
+    {
+        const ModularEntity* right = dynamic_cast<const ModularEntity*>(R);
+        const ModularEntity& ring = ring_of(*right);
+        return ring.make(
+            arithmetic::add_mod(ring.value_of(*this), ring.value_of(*right), ring.modulus));
+    }
+
+    //
+    // The exponent must be an ordinary integer. Its size doesn't matter, since no intermediate
+    // value is larger than the square of the modulus. A negative exponent raises the inverse.
+    //
+    Entity* ModularEntity::power(const Entity* R) const
+    {
+        const ModularEntity* right = dynamic_cast<const ModularEntity*>(R);
+        if (modulus.empty() || !right->modulus.empty())
+            throw Error("The exponent of a modular integer must be an integer");
+
+        const arithmetic::natural_t base = right->negative ? inverse_of(value) : value;
+        if (context)
+            return make(context->power(base, right->value));
+        return make(arithmetic::Barrett(modulus).power(base, right->value));
+    }
+
+    //
+    // Relational operations
+    //
+
+    Entity* ModularEntity::is_equal(const Entity* R) const
+    {
+        const ModularEntity* right = dynamic_cast<const ModularEntity*>(R);
+        if (!modulus.empty() && !right->modulus.empty() &&
+            arithmetic::compare(modulus, right->modulus) != 0)
+            return new IntegerEntity(int64_t{0});
+        const ModularEntity& ring = ring_of(*right);
+        return new IntegerEntity(ring.value_of(*this) == ring.value_of(*right));
+    }
+
+    Entity* ModularEntity::is_notequal(const Entity* R) const
+    {
+        const unique_ptr<Entity> equal(is_equal(R));
+        return new IntegerEntity(dynamic_cast<const IntegerEntity*>(equal.get())->get_small() == 0);
+    }
+
+    //
+    // Conversions from ModularEntity
+    //
+
+    Entity* ModularEntity::to_integer() const
+    {
+        if (modulus.empty())
+            return new IntegerEntity(arithmetic::to_verylong(value, negative));
+        return new IntegerEntity(arithmetic::to_verylong(get_residue()));
+    }
+
+    Entity* ModularEntity::to_modular() const
+    {
+        return duplicate();
+    }
+}
@@ -0,0 +1,104 @@
+/*! \file    ModularEntity.hpp
+ *  \brief   Interface to the Clac numeric type ModularEntity.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ */
+
+#ifndef MODULARENTITY_HPP
+#define MODULARENTITY_HPP
+
+#include <memory>
+#include <string>
+
+#include "Entity.hpp"
+#include "arithmetic.hpp"
+#include "modular.hpp"
+
+namespace clac::entity {
+    /*!
+     * A modular integer is a residue together with its modulus. Arithmetic on two residues
+     * requires them to have the same modulus, and an integer meeting a residue is reduced by the
+     * residue's modulus. For an odd modulus the residue is held in Montgomery form, so products
+     * and powers need no divisions. Every result computed from a residue shares its Montgomery
+     * context, which is only built once.
+     *
+     * Division and negative powers use the inverse of the divisor or base, which exists only if
+     * it is relatively prime to the modulus.
+     *
+     * An integer converted to a modular integer for a mixed operation has no modulus yet. Such
+     * a value is never left on the stack; it only exists until it meets the other operand.
+     */
+    class ModularEntity : public Entity {
+    public:
+        //! An integer with the given magnitude and sign that has not been reduced.
+        ModularEntity(const arithmetic::natural_t& magnitude, bool negative);
+
+        //! The residue of the integer with the given magnitude and sign. The modulus must not be
+        //! zero.
+        ModularEntity(
+            const arithmetic::natural_t& magnitude, bool negative,
+            const arithmetic::natural_t& modulus);
+
+        //! Returns the residue, in the range [0, modulus).
+        arithmetic::natural_t get_residue() const;
+
+        const arithmetic::natural_t& get_modulus() const noexcept
+        {
+            return modulus;
+        }
+
+        EntityType my_type() const noexcept override;
+        std::string display() const override;
+        Entity* duplicate() const override;
+
+        // Unary operations.
+        Entity* inv() const override;
+        Entity* neg() const override;
+        Entity* sq() const override;
+
+        // Binary operations.
+        Entity* divide(const Entity*) const override;
+        Entity* minus(const Entity*) const override;
+        Entity* multiply(const Entity*) const override;
+        Entity* plus(const Entity*) const override;
+        Entity* power(const Entity*) const override;
+
+        // Relational operations.
+        Entity* is_equal(const Entity*) const override;
+        Entity* is_notequal(const Entity*) const override;
+
+        // Conversions.
+        Entity* to_integer() const override;
+        Entity* to_modular() const override;
+
+    private:
+        // The residue, in Montgomery form if there is a context. For a value without a modulus
+        // this is the magnitude of the integer.
+        arithmetic::natural_t value;
+        arithmetic::natural_t modulus;
+        bool negative = false; // Only for a value without a modulus.
+        std::shared_ptr<const arithmetic::Montgomery> context;
+
+        ModularEntity(
+            arithmetic::natural_t value, const arithmetic::natural_t& modulus,
+            std::shared_ptr<const arithmetic::Montgomery> context);
+
+        // Returns the operand whose modulus the result of a binary operation will have.
+        const ModularEntity& ring_of(const ModularEntity& right) const;
+
+        // Returns the value of 'number' as held by residues of this modulus.
+        arithmetic::natural_t value_of(const ModularEntity& number) const;
+
+        // Returns a new residue of this modulus holding 'result'.
+        Entity* make(arithmetic::natural_t result) const;
+
+        // Returns the product of two values held by residues of this modulus.
+        arithmetic::natural_t product(
+            const arithmetic::natural_t& left, const arithmetic::natural_t& right) const;
+
+        // Returns the inverse of a value held by residues of this modulus. Throws Error if there
+        // is none.
+        arithmetic::natural_t inverse_of(const arithmetic::natural_t& number) const;
+    };
+}
+
+#endif
@@ -3,21 +3,224 @@
  *  \author  Peter Chapin <spicacality@kelseymountain.org>
  */
 
+#include <cmath>
+#include <cstdint>
 #include <memory>
-#include <sstream>
+#include <numbers>
 #include <string>
+#include <utility>
 
+#include "DisplayState.hpp"
 #include "Entities.hpp"
+#include "arithmetic.hpp"
 
 using namespace std;
 using namespace spica; // TODO: Remove this using directive.
 
 namespace clac::entity {
+    namespace {
+
+        using arithmetic::natural_t;
+
+        // Quotients for to_float are computed to at least this many bits, two more than the
+        // 64 that arithmetic::to_double examines.
+        constexpr size_t QUOTIENT_BITS = 66;
+
+        const natural_t one = {1};
+
+        //! A ratio whose base 2 logarithm is smaller than this in magnitude fits in a double.
+        constexpr double DOUBLE_LOG2_RANGE = 1000.0;
+
+        constexpr double LOG10_2 = 0.301029995663981195214;
+
+        //! Compares numerator / denominator with 10^k.
+        int compare_power_of_ten(
+            const natural_t& numerator, const natural_t& denominator, int64_t k)
+        {
+            const uint64_t exponent = (k < 0) ? 0 - static_cast<uint64_t>(k) : k;
+            const natural_t scale = arithmetic::power(natural_t{10}, exponent);
+            if (k < 0)
+                return arithmetic::compare(arithmetic::multiply(numerator, scale), denominator);
+            return arithmetic::compare(numerator, arithmetic::multiply(denominator, scale));
+        }
+
+        //
+        // Returns x*y + z*w for signed magnitudes x and z, setting negative to the sign of the
+        // result. Only the product x*y is formed; z*w is accumulated into it with a fused
+        // operation.
+        //
+        natural_t cross_sum(bool x_negative, const natural_t& x, const natural_t& y,
+                            bool z_negative, const natural_t& z, const natural_t& w,
+                            bool& negative)
+        {
+            natural_t result = arithmetic::multiply(x, y);
+            negative = x_negative;
+            if (x_negative == z_negative)
+                arithmetic::addmul(result, z, w);
+            else if (arithmetic::submul(result, z, w))
+                negative = z_negative;
+            if (result.empty())
+                negative = false;
+            return result;
+        }
+
+        //! Returns the sum of two signed magnitudes and sets negative to the sign of the sum.
+        natural_t signed_add(const natural_t& x, bool x_negative, const natural_t& y,
+                             bool y_negative, bool& negative)
+        {
+            natural_t result;
+            if (x_negative == y_negative) {
+                result = arithmetic::add(x, y);
+                negative = x_negative;
+            }
+            else if (arithmetic::compare(x, y) >= 0) {
+                result = arithmetic::subtract(x, y);
+                negative = x_negative;
+            }
+            else {
+                result = arithmetic::subtract(y, x);
+                negative = y_negative;
+            }
+            if (result.empty())
+                negative = false;
+            return result;
+        }
+
+        //! Returns a negative value, zero, or a positive value as a/b <, ==, or > c/d. The
+        //! numerators are signed magnitudes, and zero must not be negative.
+        int compare(bool a_negative, const natural_t& a, const natural_t& b, bool c_negative,
+                    const natural_t& c, const natural_t& d)
+        {
+            if (a_negative != c_negative)
+                return a_negative ? -1 : 1;
+            natural_t difference = arithmetic::multiply(a, d);
+            int result = arithmetic::submul(difference, c, b) ? -1 : 1;
+            if (difference.empty())
+                result = 0;
+            return a_negative ? -result : result;
+        }
+
+        struct Fraction {
+            natural_t numerator;
+            natural_t denominator;
+            bool negative;
+        };
+
+        //
+        // Returns a/b + c/d. If cancel is true both fractions must be in lowest terms, and so is
+        // the result. With g = gcd(b, d), any common factor of the sum t = a(d/g) + c(b/g) and
+        // the denominator (b/g)d must divide g, so only gcd(t, g) needs to be found. The GCDs
+        // are of numbers about the size of the operands instead of the size of the result.
+        //
+        Fraction sum(bool a_negative, const natural_t& a, const natural_t& b, bool c_negative,
+                     const natural_t& c, const natural_t& d, bool cancel)
+        {
+            Fraction result;
+            if (arithmetic::compare(b, d) == 0) {
+                result.numerator = signed_add(a, a_negative, c, c_negative, result.negative);
+                result.denominator = b;
+                if (cancel) {
+                    const natural_t g = arithmetic::gcd(result.numerator, b);
+                    result.numerator = arithmetic::divide_exact(result.numerator, g);
+                    result.denominator = arithmetic::divide_exact(b, g);
+                }
+                return result;
+            }
+
+            if (!cancel) {
+                result.numerator = cross_sum(a_negative, a, d, c_negative, c, b, result.negative);
+                result.denominator = arithmetic::multiply(b, d);
+                return result;
+            }
+
+            const natural_t g = arithmetic::gcd(b, d);
+            const natural_t b_part = arithmetic::divide_exact(b, g);
+            const natural_t d_part = arithmetic::divide_exact(d, g);
+            const natural_t t =
+                cross_sum(a_negative, a, d_part, c_negative, c, b_part, result.negative);
+            if (t.empty())
+                return {natural_t(), one, false};
+            const natural_t g2 = arithmetic::gcd(t, g);
+            result.numerator = arithmetic::divide_exact(t, g2);
+            result.denominator = arithmetic::multiply_divide_exact(b_part, d, g2);
+            return result;
+        }
+
+        //
+        // Returns (a/b)(c/d), ignoring signs. If cancel is true both fractions must be in lowest
+        // terms, and so is the result. Then the only common factors are between a and d and
+        // between c and b, and they are removed before multiplying.
+        //
+        Fraction product(const natural_t& a, const natural_t& b, const natural_t& c,
+                         const natural_t& d, bool cancel)
+        {
+            if (!cancel)
+                return {arithmetic::multiply(a, c), arithmetic::multiply(b, d), false};
+            if (a.empty() || c.empty())
+                return {natural_t(), one, false};
+
+            const natural_t g1 = arithmetic::gcd(a, d);
+            const natural_t g2 = arithmetic::gcd(c, b);
+            return {arithmetic::multiply(arithmetic::divide_exact(a, g1),
+                                         arithmetic::divide_exact(c, g2)),
+                    arithmetic::multiply(arithmetic::divide_exact(b, g2),
+                                         arithmetic::divide_exact(d, g1)),
+                    false};
+        }
+
+    } // namespace
+
     //
     // The constructor allows a rational entity to be initialized with a Rational object.
     //
-    RationalEntity::RationalEntity(const Rational<VeryLong>& number) : value(number)
+    RationalEntity::RationalEntity(const Rational<VeryLong>& number)
+        : RationalEntity(number.get_numerator(), number.get_denominator())
+    {
+    }
+
+    //
+    // Every operation on rationals ends by reducing its result to lowest terms, so the speed of
+    // the GCD largely decides the speed of rational arithmetic. The reduction is done here with
+    // arithmetic::gcd, which uses Lehmer's algorithm and the half-GCD, instead of by
+    // spica::Rational, which uses Euclid's algorithm. In lazy mode the reduction is put off
+    // until the value is displayed or compared.
+    //
+    RationalEntity::RationalEntity(const VeryLong& new_numerator, const VeryLong& new_denominator)
+        : numerator(arithmetic::to_natural(new_numerator)),
+          denominator(arithmetic::to_natural(new_denominator)),
+          negative((new_numerator < VeryLong::zero) != (new_denominator < VeryLong::zero)),
+          reduced(false)
+    {
+        if (denominator.empty())
+            throw Error("Can't divide by zero");
+
+        if (numerator.empty())
+            negative = false;
+        if (display_state::get_rational_mode() == display_state::EAGER)
+            reduce();
+    }
+
+    // The parts are taken by value so that the results of arithmetic are moved, not copied.
+    RationalEntity::RationalEntity(natural_t new_numerator,
+                                   natural_t new_denominator,
+                                   bool is_negative,
+                                   bool is_reduced)
+        : numerator(move(new_numerator)),
+          denominator(move(new_denominator)),
+          negative(is_negative && !numerator.empty()),
+          reduced(is_reduced)
+    {
+    }
+
+    void RationalEntity::reduce() const
     {
+        if (reduced)
+            return;
+
+        const natural_t divisor = arithmetic::gcd(numerator, denominator);
+        numerator = arithmetic::divide_exact(numerator, divisor);
+        denominator = arithmetic::divide_exact(denominator, divisor);
+        reduced = true;
     }
 
 #ifdef NEVER
@@ -51,15 +254,17 @@ namespace clac::entity {
 
     std::string RationalEntity::display() const
     {
-        std::ostringstream formatter;
-
-        formatter << value.get_numerator() << '/' << value.get_denominator();
-        return formatter.str();
+        reduce();
+        std::string result = negative ? "-" : "";
+        result.append(arithmetic::to_decimal(numerator));
+        result.append(1, '/');
+        result.append(arithmetic::to_decimal(denominator));
+        return result;
     }
 
     Entity* RationalEntity::duplicate() const
     {
-        return new RationalEntity(value);
+        return new RationalEntity(*this);
     }
 
     //
@@ -67,12 +272,7 @@ namespace clac::entity {
     //
     Entity* RationalEntity::abs() const
     {
-        VeryLong new_numerator = value.get_numerator();
-        if (new_numerator < VeryLong::zero)
-            new_numerator = -new_numerator;
-
-        Rational<VeryLong> new_value(new_numerator, value.get_denominator());
-        return new RationalEntity(new_value);
+        return new RationalEntity(numerator, denominator, false, reduced);
     }
 
     Entity* RationalEntity::acos() const
@@ -116,37 +316,106 @@ namespace clac::entity {
         return converted->exp10();
     }
 
+    Entity* RationalEntity::factorial() const
+    {
+        unique_ptr<FloatEntity> converted(static_cast<FloatEntity*>(to_float()));
+        return converted->factorial();
+    }
+
+    Entity* RationalEntity::gamma() const
+    {
+        unique_ptr<FloatEntity> converted(static_cast<FloatEntity*>(to_float()));
+        return converted->gamma();
+    }
+
     Entity* RationalEntity::imaginary_part() const
     {
-        Rational<VeryLong> new_value(VeryLong::zero, VeryLong::one);
-        return new RationalEntity(new_value);
+        return new RationalEntity(natural_t(), one, false, true);
+    }
+
+    //
+    // The bit lengths of the terms give floor(log2 |x|) to within one, and a comparison decides.
+    // The estimate of floor(log10 |x|) from their logarithms is corrected the same way.
+    //
+    Entity* RationalEntity::integer_log10() const
+    {
+        if (numerator.empty())
+            throw Error("Can't take the log of zero");
+
+        const double log2 = arithmetic::log2(numerator) - arithmetic::log2(denominator);
+        auto k = static_cast<int64_t>(std::floor(log2 * LOG10_2));
+        while (compare_power_of_ten(numerator, denominator, k) < 0)
+            --k;
+        while (compare_power_of_ten(numerator, denominator, k + 1) >= 0)
+            ++k;
+        return new IntegerEntity(k);
+    }
+
+    Entity* RationalEntity::integer_log2() const
+    {
+        if (numerator.empty())
+            throw Error("Can't take the log of zero");
+
+        const auto top_bits = static_cast<int64_t>(arithmetic::bit_length(numerator));
+        const auto bottom_bits = static_cast<int64_t>(arithmetic::bit_length(denominator));
+        const int64_t k = top_bits - bottom_bits;
+        const int order =
+            (k >= 0)
+                ? arithmetic::compare(numerator, arithmetic::shift_left(denominator, k))
+                : arithmetic::compare(arithmetic::shift_left(numerator, -k), denominator);
+        return new IntegerEntity((order >= 0) ? k : k - 1);
     }
 
     Entity* RationalEntity::inv() const
     {
-        if (value.get_numerator() == VeryLong::zero)
+        if (numerator.empty())
             throw Error("Can't divide by zero");
 
-        Rational<VeryLong> new_value(value.get_denominator(), value.get_numerator());
-        return new RationalEntity(new_value);
+        return new RationalEntity(denominator, numerator, negative, reduced);
     }
 
+    //
+    // A ratio beyond the range of a double still has a logarithm, which is the difference of the
+    // logarithms of its terms. Other ratios are converted to a float, which is more accurate for
+    // a ratio near one.
+    //
     Entity* RationalEntity::ln() const
     {
+        if (!numerator.empty()) {
+            const double log2 = arithmetic::log2(numerator) - arithmetic::log2(denominator);
+            if (std::fabs(log2) > DOUBLE_LOG2_RANGE) {
+                if (negative)
+                    return new ComplexEntity(log2 * numbers::ln2, numbers::pi);
+                return new FloatEntity(log2 * numbers::ln2);
+            }
+        }
         unique_ptr<FloatEntity> converted(static_cast<FloatEntity*>(to_float()));
         return converted->ln();
     }
 
     Entity* RationalEntity::log() const
     {
+        if (!numerator.empty()) {
+            const double log2 = arithmetic::log2(numerator) - arithmetic::log2(denominator);
+            if (std::fabs(log2) > DOUBLE_LOG2_RANGE) {
+                if (negative)
+                    return new ComplexEntity(log2 * LOG10_2, numbers::pi * numbers::log10e);
+                return new FloatEntity(log2 * LOG10_2);
+            }
+        }
         unique_ptr<FloatEntity> converted(static_cast<FloatEntity*>(to_float()));
         return converted->log();
     }
 
+    Entity* RationalEntity::log_gamma() const
+    {
+        unique_ptr<FloatEntity> converted(static_cast<FloatEntity*>(to_float()));
+        return converted->log_gamma();
+    }
+
     Entity* RationalEntity::neg() const
     {
-        Rational<VeryLong> new_value(-value.get_numerator(), value.get_denominator());
-        return new RationalEntity(new_value);
+        return new RationalEntity(numerator, denominator, !negative, reduced);
     }
 
     Entity* RationalEntity::real_part() const
@@ -156,14 +425,7 @@ namespace clac::entity {
 
     Entity* RationalEntity::sign() const
     {
-        VeryLong result(VeryLong::zero);
-
-        if (value.get_numerator() < VeryLong::zero)
-            result = VeryLong::negative_one;
-        if (value.get_numerator() > VeryLong::zero)
-            result = VeryLong::one;
-
-        return new IntegerEntity(result);
+        return new IntegerEntity(numerator.empty() ? 0 : (negative ? -1 : 1));
     }
 
     Entity* RationalEntity::sin() const
@@ -172,16 +434,11 @@ namespace clac::entity {
         return converted->sin();
     }
 
+    // The square of a fraction in lowest terms is still in lowest terms.
     Entity* RationalEntity::sq() const
     {
-        VeryLong new_numerator = value.get_numerator();
-        VeryLong new_denominator = value.get_denominator();
-
-        new_numerator *= value.get_numerator();
-        new_denominator *= value.get_denominator();
-        Rational<VeryLong> new_value(new_numerator, new_denominator);
-
-        return new RationalEntity(new_value);
+        return new RationalEntity(
+            arithmetic::square(numerator), arithmetic::square(denominator), false, reduced);
     }
 
     Entity* RationalEntity::sqrt() const
@@ -200,28 +457,73 @@ namespace clac::entity {
     // Binary operations
     //
 
+    //
+    // In eager mode the operands are reduced first, if they came from lazy mode, so that the
+    // common factors can be cancelled before the parts are multiplied together.
+    //
+
     Entity* RationalEntity::plus(const Entity* R) const
     {
         const RationalEntity* right = dynamic_cast<const RationalEntity*>(R);
-        return new RationalEntity(value + right->value);
+        const bool eager = display_state::get_rational_mode() == display_state::EAGER;
+        if (eager) {
+            reduce();
+            right->reduce();
+        }
+        Fraction result = sum(negative, numerator, denominator, right->negative, right->numerator,
+                              right->denominator, eager);
+        return new RationalEntity(
+            move(result.numerator), move(result.denominator), result.negative, eager);
     }
 
     Entity* RationalEntity::minus(const Entity* R) const
     {
         const RationalEntity* right = dynamic_cast<const RationalEntity*>(R);
-        return new RationalEntity(value - right->value);
+        const bool eager = display_state::get_rational_mode() == display_state::EAGER;
+        if (eager) {
+            reduce();
+            right->reduce();
+        }
+        Fraction result = sum(negative, numerator, denominator, !right->negative, right->numerator,
+                              right->denominator, eager);
+        return new RationalEntity(
+            move(result.numerator), move(result.denominator), result.negative, eager);
     }
 
     Entity* RationalEntity::multiply(const Entity* R) const
     {
         const RationalEntity* right = dynamic_cast<const RationalEntity*>(R);
-        return new RationalEntity(value * right->value);
-    }
-
+        const bool eager = display_state::get_rational_mode() == display_state::EAGER;
+        if (eager) {
+            reduce();
+            right->reduce();
+        }
+        Fraction result =
+            product(numerator, denominator, right->numerator, right->denominator, eager);
+        return new RationalEntity(move(result.numerator),
+                                  move(result.denominator),
+                                  negative != right->negative,
+                                  eager);
+    }
+
+    // Division multiplies by the reciprocal of the right operand.
     Entity* RationalEntity::divide(const Entity* R) const
     {
         const RationalEntity* right = dynamic_cast<const RationalEntity*>(R);
-        return new RationalEntity(value / right->value);
+        if (right->numerator.empty())
+            throw Error("Can't divide by zero");
+
+        const bool eager = display_state::get_rational_mode() == display_state::EAGER;
+        if (eager) {
+            reduce();
+            right->reduce();
+        }
+        Fraction result =
+            product(numerator, denominator, right->denominator, right->numerator, eager);
+        return new RationalEntity(move(result.numerator),
+                                  move(result.denominator),
+                                  negative != right->negative,
+                                  eager);
     }
 
     Entity* RationalEntity::power(const Entity* R) const
@@ -234,55 +536,104 @@ namespace clac::entity {
     //
     // Relational operations
     //
+    // Both operands are reduced first, so equal values have equal parts.
+    //
 
     Entity* RationalEntity::is_equal(const Entity* R) const
     {
         const RationalEntity* right = dynamic_cast<const RationalEntity*>(R);
-        return new IntegerEntity(static_cast<VeryLong>(value == right->value));
+        reduce();
+        right->reduce();
+        return new IntegerEntity(
+            negative == right->negative && numerator == right->numerator &&
+            denominator == right->denominator);
     }
 
     Entity* RationalEntity::is_notequal(const Entity* R) const
     {
         const RationalEntity* right = dynamic_cast<const RationalEntity*>(R);
-        return new IntegerEntity(static_cast<VeryLong>(value != right->value));
+        reduce();
+        right->reduce();
+        return new IntegerEntity(
+            negative != right->negative || numerator != right->numerator ||
+            denominator != right->denominator);
     }
 
     Entity* RationalEntity::is_less(const Entity* R) const
     {
         const RationalEntity* right = dynamic_cast<const RationalEntity*>(R);
-        return new IntegerEntity(static_cast<VeryLong>(value < right->value));
+        reduce();
+        right->reduce();
+        return new IntegerEntity(
+            compare(negative, numerator, denominator, right->negative, right->numerator,
+                    right->denominator) < 0);
     }
 
     Entity* RationalEntity::is_lessorequal(const Entity* R) const
     {
         const RationalEntity* right = dynamic_cast<const RationalEntity*>(R);
-        return new IntegerEntity(static_cast<VeryLong>(value <= right->value));
+        reduce();
+        right->reduce();
+        return new IntegerEntity(
+            compare(negative, numerator, denominator, right->negative, right->numerator,
+                    right->denominator) <= 0);
     }
 
     Entity* RationalEntity::is_greater(const Entity* R) const
     {
         const RationalEntity* right = dynamic_cast<const RationalEntity*>(R);
-        return new IntegerEntity(static_cast<VeryLong>(value > right->value));
+        reduce();
+        right->reduce();
+        return new IntegerEntity(
+            compare(negative, numerator, denominator, right->negative, right->numerator,
+                    right->denominator) > 0);
     }
 
     Entity* RationalEntity::is_greaterorequal(const Entity* R) const
     {
         const RationalEntity* right = dynamic_cast<const RationalEntity*>(R);
-        return new IntegerEntity(static_cast<VeryLong>(value >= right->value));
+        reduce();
+        right->reduce();
+        return new IntegerEntity(
+            compare(negative, numerator, denominator, right->negative, right->numerator,
+                    right->denominator) >= 0);
     }
 
     //
     // Conversions from RationalEntity
     //
 
-    Entity* RationalEntity::to_float() const
+    //
+    // The fraction is divided directly at the current precision, so the result is correctly
+    // rounded.
+    //
+    Entity* RationalEntity::to_bigfloat() const
     {
-        // TODO: We can do better than this but VeryLong will need a to_double( ) method first.
-        // TODO: What happens if the value of the VeryLong is outside the range of double( )?
-        long numerator = value.get_numerator().to_long();
-        long denominator = value.get_denominator().to_long();
+        const size_t bits = BigFloatEntity::bits_for(display_state::get_precision());
+        const arithmetic::BigFloat top{numerator, 0, negative};
+        const arithmetic::BigFloat bottom{denominator};
+        return new BigFloatEntity(arithmetic::divide(top, bottom, bits));
+    }
 
-        return new FloatEntity(static_cast<double>(numerator) / static_cast<double>(denominator));
+    //
+    // The numerator is scaled so that the quotient has at least QUOTIENT_BITS bits, and a
+    // nonzero remainder is folded into the lowest bit of the quotient. Converting the quotient
+    // then rounds the same way as converting the exact value would, and neither part of the
+    // fraction needs to be in the range of a double.
+    //
+    Entity* RationalEntity::to_float() const
+    {
+        const size_t top_bits = arithmetic::bit_length(numerator);
+        const size_t bottom_bits = arithmetic::bit_length(denominator);
+        const size_t shift =
+            (bottom_bits + QUOTIENT_BITS > top_bits) ? bottom_bits + QUOTIENT_BITS - top_bits : 0;
+
+        natural_t quotient, remainder;
+        arithmetic::divide(arithmetic::shift_left(numerator, shift), denominator, quotient, remainder);
+        if (!remainder.empty())
+            quotient[0] |= 1;
+        const double scaled = arithmetic::to_double(quotient, negative);
+        return new FloatEntity(std::ldexp(scaled, -static_cast<int>(shift)));
     }
 
     Entity* RationalEntity::to_rational() const
@@ -7,6 +7,7 @@
 #define RATIONALENTITY_HPP
 
 #include "Entity.hpp"
+#include "arithmetic.hpp"
 #include <spicacpp/Rational.hpp>
 #include <spicacpp/VeryLong.hpp>
 
@@ -14,6 +15,7 @@ namespace clac::entity {
     class RationalEntity : public Entity {
     public:
         RationalEntity(const spica::Rational<spica::VeryLong>&);
+        RationalEntity(const spica::VeryLong& numerator, const spica::VeryLong& denominator);
 
         EntityType my_type() const noexcept override;
         std::string display() const override;
@@ -28,10 +30,15 @@ namespace clac::entity {
         Entity* cos() const override;
         Entity* exp() const override;
         Entity* exp10() const override;
+        Entity* factorial() const override;
+        Entity* gamma() const override;
         Entity* imaginary_part() const override;
+        Entity* integer_log10() const override;
+        Entity* integer_log2() const override;
         Entity* inv() const override;
         Entity* ln() const override;
         Entity* log() const override;
+        Entity* log_gamma() const override;
         Entity* neg() const override;
         Entity* real_part() const override;
         Entity* sign() const override;
@@ -41,6 +48,7 @@ namespace clac::entity {
         Entity* tan() const override;
 
         // Conversion functions.
+        Entity* to_bigfloat() const override;
         Entity* to_float() const override;
         Entity* to_rational() const override;
 
@@ -60,7 +68,22 @@ namespace clac::entity {
         Entity* is_greaterorequal(const Entity*) const override;
 
     private:
-        spica::Rational<spica::VeryLong> value;
+        RationalEntity(arithmetic::natural_t numerator,
+                       arithmetic::natural_t denominator,
+                       bool negative,
+                       bool reduced);
+
+        //! Brings the fraction to lowest terms if it isn't there already.
+        void reduce() const;
+
+        // The parts are held as limbs, with the sign kept apart, so that arithmetic doesn't
+        // convert them from VeryLong and back on every operation. Zero is never negative. The
+        // fraction is in lowest terms unless it was computed in lazy mode, in which case it is
+        // reduced when it is displayed or compared.
+        mutable arithmetic::natural_t numerator;
+        mutable arithmetic::natural_t denominator;
+        bool negative;
+        mutable bool reduced;
     };
 }
 
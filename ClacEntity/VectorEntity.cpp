@@ -4,6 +4,7 @@
  */
 
 #include "Entities.hpp"
+#include <memory>
 
 using namespace std;
 
@@ -24,11 +25,30 @@ namespace clac::entity {
 
     string VectorEntity::display() const
     {
-        return "VectorEntity::display( ) not implemented!";
+        string workspace = "[ ";
+
+        for (int64_t element : integers) {
+            workspace.append(std::to_string(element));
+            workspace.append(" ");
+        }
+        for (const Entity* element : value) {
+            workspace.append(element->display());
+            workspace.append(" ");
+        }
+
+        workspace.append("]");
+        return workspace;
     }
 
     Entity* VectorEntity::duplicate() const
     {
-        throw Error("VectorEntity::duplicate( ) not implemented!");
+        unique_ptr<VectorEntity> copy(new VectorEntity(integers));
+        copy->value.reserve(value.size());
+        for (const Entity* element : value) {
+            unique_ptr<Entity> element_copy(element->duplicate());
+            copy->value.push_back(element_copy.get());
+            element_copy.release();
+        }
+        return copy.release();
     }
 }
@@ -7,12 +7,27 @@
 #define VECTORENTITY_HPP
 
 #include "Entity.hpp"
+#include <cstdint>
 #include <string>
 #include <vector>
 
 namespace clac::entity {
+    /*!
+     * A vector whose elements are all small integers can be held as an array of machine words
+     * instead of an array of separately allocated entities. Long results, such as the output of
+     * the primes word, are built that way.
+     */
     class VectorEntity : public Entity {
     public:
+        VectorEntity() noexcept
+        {
+        }
+        explicit VectorEntity(std::vector<std::int64_t> incoming) noexcept
+            : integers(std::move(incoming))
+        {
+        }
+        VectorEntity(const VectorEntity&) = delete;
+        VectorEntity& operator=(const VectorEntity&) = delete;
         virtual ~VectorEntity();
 
         EntityType my_type() const noexcept override;
@@ -20,7 +35,9 @@ namespace clac::entity {
         Entity* duplicate() const override;
 
     private:
+        // An integer vector keeps its elements in 'integers' and leaves 'value' empty.
         std::vector<Entity*> value;
+        std::vector<std::int64_t> integers;
     };
 }
 
@@ -0,0 +1,363 @@
+/*! \file    arithmetic.cpp
+ *  \brief   Conversions and basic operations for the limb-level arithmetic.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * The multiplication algorithms are in multiply.cpp and ntt.cpp. Division is in divide.cpp,
+ * conversion to and from decimal is in radix.cpp, greatest common divisors are in gcd.cpp, and
+ * the bitwise operations are in bitwise.cpp. The thread pool that large multiplications use is
+ * in parallel.cpp.
+ */
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "arithmetic.hpp"
+#include "kernels.hpp"
+
+using namespace std;
+
+namespace clac::arithmetic {
+
+    namespace {
+
+        constexpr int DOUBLE_DIGITS = numeric_limits<double>::digits;
+
+        // A number with more bits than this is too large for a double.
+        constexpr size_t DOUBLE_MAXIMUM_BITS = numeric_limits<double>::max_exponent;
+
+        //
+        // Converts a number given by its top 64 bits and its bit count to the nearest double.
+        // Converting the 64 bits rounds off the low 11 of them, which is correct unless those
+        // bits are exactly one half. In that case any set bit below the top 64 breaks the tie,
+        // so it is or'ed into the lowest bit. The function has_lower_bits is called only then.
+        //
+        template<typename LowerBits>
+        double round_top(limb_t top, size_t bit_count, bool negative, LowerBits has_lower_bits)
+        {
+            constexpr limb_t round_mask = (limb_t{1} << (LIMB_BITS - DOUBLE_DIGITS)) - 1;
+            constexpr limb_t half = (round_mask >> 1) + 1;
+
+            double result;
+            if (bit_count <= LIMB_BITS) {
+                result = static_cast<double>(top);
+            }
+            else {
+                if ((top & round_mask) == half && has_lower_bits())
+                    top |= 1;
+                result = ldexp(static_cast<double>(top), static_cast<int>(bit_count - LIMB_BITS));
+            }
+            return negative ? -result : result;
+        }
+
+    } // namespace
+
+
+    Thresholds& thresholds() noexcept
+    {
+        static Thresholds active = {
+            .karatsuba = 24,
+            .toom3 = 448,
+            .ntt = 3072,
+            .karatsuba_square = 48,
+            .toom3_square = 512,
+            .ntt_square = 2560,
+            .burnikel_ziegler = 192,
+            .newton = 262144,
+            .radix = 32,
+            .half_gcd = 128,
+            .parallel = 1024,
+            .verylong_bits = 2048};
+        return active;
+    }
+
+    //
+    // VeryLong only offers bit level access to its representation, so the conversions work one
+    // bit at a time. That is linear in the size of the number and cheap compared to the
+    // operations that justify a conversion.
+    //
+    natural_t to_natural(const spica::VeryLong& number)
+    {
+        const spica::VeryLong::size_type bit_count = number.number_bits();
+        natural_t result((bit_count + LIMB_BITS - 1) / LIMB_BITS, 0);
+
+        for (spica::VeryLong::size_type i = 0; i < bit_count; ++i) {
+            if (number.get_bit(i))
+                result[i / LIMB_BITS] |= limb_t{1} << (i % LIMB_BITS);
+        }
+        return result;
+    }
+
+
+    //
+    // Bits are installed from the top down so that the VeryLong is expanded only once. Only the
+    // one bits are visited; countl_zero finds each of them with a single instruction.
+    //
+    spica::VeryLong to_verylong(const natural_t& number, bool negative)
+    {
+        spica::VeryLong result;
+
+        for (size_t i = number.size(); i > 0; --i) {
+            limb_t current = number[i - 1];
+            while (current != 0) {
+                const int j = LIMB_BITS - 1 - countl_zero(current);
+                result.put_bit((i - 1) * LIMB_BITS + static_cast<size_t>(j), 1);
+                current ^= limb_t{1} << j;
+            }
+        }
+        if (negative && !number.empty())
+            result = -result;
+        return result;
+    }
+
+
+    double to_double(const natural_t& number, bool negative)
+    {
+        if (number.empty())
+            return 0.0;
+
+        const size_t size = number.size();
+        const size_t shift = static_cast<size_t>(countl_zero(number.back()));
+        const size_t bit_count = size * LIMB_BITS - shift;
+        if (bit_count > DOUBLE_MAXIMUM_BITS)
+            return negative ? -HUGE_VAL : HUGE_VAL;
+
+        // Gather the top 64 bits into one limb.
+        limb_t top = number.back();
+        if (size >= 2 && shift != 0)
+            top = (top << shift) | (number[size - 2] >> (LIMB_BITS - shift));
+
+        return round_top(top, bit_count, negative, [&]() {
+            if ((number[size - 2] & (~limb_t{0} >> shift)) != 0)
+                return true;
+            for (size_t i = size - 2; i > 0; --i) {
+                if (number[i - 1] != 0)
+                    return true;
+            }
+            return false;
+        });
+    }
+
+
+    double log2(const natural_t& number)
+    {
+        if (number.empty())
+            throw domain_error("log2: zero has no logarithm");
+
+        const size_t size = number.size();
+        const size_t shift = static_cast<size_t>(countl_zero(number.back()));
+        const size_t bit_count = size * LIMB_BITS - shift;
+        if (size == 1)
+            return std::log2(static_cast<double>(number[0]));
+
+        const limb_t top =
+            (shift == 0) ? number.back()
+                         : (number.back() << shift) | (number[size - 2] >> (LIMB_BITS - shift));
+        return std::log2(static_cast<double>(top)) + static_cast<double>(bit_count - LIMB_BITS);
+    }
+
+
+    void normalize(natural_t& number) noexcept
+    {
+        while (!number.empty() && number.back() == 0)
+            number.pop_back();
+    }
+
+
+    size_t bit_length(const natural_t& number) noexcept
+    {
+        if (number.empty())
+            return 0;
+        return number.size() * LIMB_BITS - static_cast<size_t>(countl_zero(number.back()));
+    }
+
+
+    int compare(const natural_t& left, const natural_t& right) noexcept
+    {
+        if (left.size() != right.size())
+            return (left.size() < right.size()) ? -1 : 1;
+        return compare_n(left.data(), right.data(), left.size());
+    }
+
+
+    natural_t add(const natural_t& left, const natural_t& right)
+    {
+        const natural_t& longer = (left.size() >= right.size()) ? left : right;
+        const natural_t& shorter = (left.size() >= right.size()) ? right : left;
+        natural_t result(longer.size() + 1);
+
+        limb_t carry = add_n(result.data(), longer.data(), shorter.data(), shorter.size());
+        carry = add_1(
+            result.data() + shorter.size(),
+            longer.data() + shorter.size(),
+            longer.size() - shorter.size(),
+            carry);
+        result[longer.size()] = carry;
+        normalize(result);
+        return result;
+    }
+
+
+    natural_t subtract(const natural_t& left, const natural_t& right)
+    {
+        natural_t result(left.size());
+
+        const limb_t borrow = sub_n(result.data(), left.data(), right.data(), right.size());
+        sub_1(
+            result.data() + right.size(),
+            left.data() + right.size(),
+            left.size() - right.size(),
+            borrow);
+        normalize(result);
+        return result;
+    }
+
+
+    natural_t shift_left(const natural_t& number, size_t bit_count)
+    {
+        if (number.empty())
+            return number;
+
+        const size_t limb_count = bit_count / LIMB_BITS;
+        const unsigned remainder = static_cast<unsigned>(bit_count % LIMB_BITS);
+        natural_t result(number.size() + limb_count + 1, 0);
+
+        if (remainder == 0)
+            copy(number.begin(), number.end(), result.begin() + limb_count);
+        else
+            result[number.size() + limb_count] =
+                lshift(result.data() + limb_count, number.data(), number.size(), remainder);
+        normalize(result);
+        return result;
+    }
+
+
+    natural_t shift_right(const natural_t& number, size_t bit_count)
+    {
+        const size_t limb_count = bit_count / LIMB_BITS;
+        if (limb_count >= number.size())
+            return natural_t();
+
+        const unsigned remainder = static_cast<unsigned>(bit_count % LIMB_BITS);
+        natural_t result(number.begin() + limb_count, number.end());
+
+        if (remainder != 0)
+            rshift(result.data(), result.data(), result.size(), remainder);
+        normalize(result);
+        return result;
+    }
+
+    //
+    // VeryLong operations.
+    //
+
+    double to_double(const spica::VeryLong& number)
+    {
+        const spica::VeryLong::size_type bit_count = number.number_bits();
+        const bool negative = number < spica::VeryLong::zero;
+        if (bit_count > DOUBLE_MAXIMUM_BITS)
+            return negative ? -HUGE_VAL : HUGE_VAL;
+
+        limb_t top = 0;
+        const spica::VeryLong::size_type top_count = min<size_t>(bit_count, LIMB_BITS);
+        for (spica::VeryLong::size_type i = 1; i <= top_count; ++i) {
+            top = (top << 1) | static_cast<limb_t>(number.get_bit(bit_count - i));
+        }
+
+        return round_top(top, bit_count, negative, [&]() {
+            for (spica::VeryLong::size_type i = bit_count - LIMB_BITS; i > 0; --i) {
+                if (number.get_bit(i - 1))
+                    return true;
+            }
+            return false;
+        });
+    }
+
+
+    double log2(const spica::VeryLong& number)
+    {
+        const spica::VeryLong::size_type bit_count = number.number_bits();
+        if (bit_count == 0)
+            throw domain_error("log2: zero has no logarithm");
+
+        limb_t top = 0;
+        const spica::VeryLong::size_type top_count = min<size_t>(bit_count, LIMB_BITS);
+        for (spica::VeryLong::size_type i = 1; i <= top_count; ++i) {
+            top = (top << 1) | static_cast<limb_t>(number.get_bit(bit_count - i));
+        }
+        return std::log2(static_cast<double>(top)) + static_cast<double>(bit_count - top_count);
+    }
+
+
+    spica::VeryLong from_double(double number)
+    {
+        if (!isfinite(number))
+            throw domain_error("from_double: value is not finite");
+
+        // The bounds are powers of two, so they are exact.
+        if (number > static_cast<double>(numeric_limits<long>::min()) &&
+            number < static_cast<double>(numeric_limits<long>::max())) {
+            return spica::VeryLong(static_cast<long>(number));
+        }
+
+        // The magnitude is mantissa * 2^(exponent - 53). Bits are installed from the top down
+        // so that the VeryLong is expanded only once.
+        int exponent;
+        const double fraction = frexp(fabs(number), &exponent);
+        const limb_t mantissa = static_cast<limb_t>(ldexp(fraction, DOUBLE_DIGITS));
+        spica::VeryLong result;
+        for (int j = DOUBLE_DIGITS - 1; j >= 0; --j) {
+            const int position = exponent - DOUBLE_DIGITS + j;
+            if (position >= 0 && ((mantissa >> j) & 1))
+                result.put_bit(static_cast<spica::VeryLong::size_type>(position), 1);
+        }
+        return (number < 0) ? -result : result;
+    }
+
+
+    spica::VeryLong multiply(const spica::VeryLong& left, const spica::VeryLong& right)
+    {
+        const size_t cutoff = thresholds().verylong_bits;
+        if (left.number_bits() < cutoff || right.number_bits() < cutoff)
+            return left * right;
+
+        const bool negative = (left < spica::VeryLong::zero) != (right < spica::VeryLong::zero);
+        return to_verylong(multiply(to_natural(left), to_natural(right)), negative);
+    }
+
+
+    spica::VeryLong square(const spica::VeryLong& number)
+    {
+        if (number.number_bits() < thresholds().verylong_bits)
+            return number * number;
+
+        return to_verylong(square(to_natural(number)));
+    }
+
+
+    //
+    // The numerator decides whether conversion pays off. A large numerator with a small divisor
+    // is still much faster to divide one limb at a time than one bit at a time.
+    //
+    void divide(
+        const spica::VeryLong& numerator,
+        const spica::VeryLong& denominator,
+        spica::VeryLong::vldiv_t* result)
+    {
+        if (numerator.number_bits() < thresholds().verylong_bits ||
+            denominator == spica::VeryLong::zero) {
+            spica::VeryLong::vldiv(numerator, denominator, result);
+            return;
+        }
+
+        const bool numerator_negative = numerator < spica::VeryLong::zero;
+        const bool denominator_negative = denominator < spica::VeryLong::zero;
+        natural_t quotient, remainder;
+        divide(to_natural(numerator), to_natural(denominator), quotient, remainder);
+        result->quot = to_verylong(quotient, numerator_negative != denominator_negative);
+        result->rem = to_verylong(remainder, numerator_negative);
+    }
+
+} // namespace clac::arithmetic
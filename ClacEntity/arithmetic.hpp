@@ -0,0 +1,278 @@
+/*! \file    arithmetic.hpp
+ *  \brief   Interface to the limb-level arithmetic used for large integers.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * The spica::VeryLong type uses simple schoolbook algorithms. They are fine for the modest
+ * values most users enter, but their cost grows quadratically and becomes the dominant expense
+ * when values reach many thousands of bits. The functions declared here work on natural numbers
+ * stored as vectors of 64-bit limbs (least significant limb first) and provide asymptotically
+ * faster algorithms.
+ *
+ * IntegerEntity does not use this representation directly. Instead, it calls the VeryLong
+ * overloads at the end of this file. They convert to limbs only when the operands are large
+ * enough for the faster algorithms to outweigh the cost of the conversion.
+ *
+ * A natural_t is always kept normalized: it has no high order zero limbs, and zero is the empty
+ * vector. All functions accept and return normalized values. Values of up to four limbs are
+ * stored inside the natural_t itself, so the small numbers that make up most calculations
+ * don't touch the heap (see small_vector.hpp).
+ *
+ * Multiplication, division, GCD, roots, and decimal conversion are carried out by the active
+ * backend, which is Clac's own implementation unless Clac was built with GMP (see backend.hpp).
+ * Arithmetic modulo a fixed number, which never forms values larger than the square of the
+ * modulus, is declared in modular.hpp.
+ */
+
+#ifndef ARITHMETIC_HPP
+#define ARITHMETIC_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <spicacpp/VeryLong.hpp>
+
+#include "small_vector.hpp"
+
+namespace clac::arithmetic {
+
+    using limb_t = std::uint64_t;
+
+    //! Takes the heap buffers of natural_t from the calling thread's limb pool (limb_pool.cpp).
+    struct LimbAllocator {
+        using value_type = limb_t;
+
+        limb_t* allocate(std::size_t count);
+        void deallocate(limb_t* buffer, std::size_t count) noexcept;
+    };
+
+    using natural_t = SmallVector<limb_t, 4, LimbAllocator>;
+
+    constexpr int LIMB_BITS = 64;
+
+    /*!
+     * Algorithm selection thresholds. The multiplication thresholds are operand sizes in limbs;
+     * an operation uses the named algorithm when its smaller operand has at least that many
+     * limbs. The defaults were tuned with benchmarks/verylong_speed.cpp. The values can be
+     * modified at run time, which is how the benchmark finds the crossover points.
+     */
+    struct Thresholds {
+        std::size_t karatsuba;        // Multiplication: basecase -> Karatsuba.
+        std::size_t toom3;            // Multiplication: Karatsuba -> Toom-3.
+        std::size_t ntt;              // Multiplication: Toom-3 -> NTT.
+        std::size_t karatsuba_square; // Squaring: basecase -> Karatsuba.
+        std::size_t toom3_square;     // Squaring: Karatsuba -> Toom-3.
+        std::size_t ntt_square;       // Squaring: Toom-3 -> NTT.
+        std::size_t burnikel_ziegler; // Division: basecase -> Burnikel-Ziegler (divisor limbs).
+        std::size_t newton;           // Division: Burnikel-Ziegler -> Newton (divisor limbs).
+        std::size_t radix;            // Decimal conversion: basecase -> divide and conquer.
+        std::size_t half_gcd;         // GCD: Lehmer -> half-GCD.
+        std::size_t parallel;         // Multiplication: sub-products run in parallel.
+        std::size_t verylong_bits;    // VeryLong operands of this many bits are converted.
+    };
+
+    //! Returns the active thresholds.
+    Thresholds& thresholds() noexcept;
+
+    /*!
+     * Returns the number of threads that large multiplications may use, including the calling
+     * thread. The default is the number of hardware threads.
+     */
+    std::size_t thread_count() noexcept;
+
+    /*!
+     * Sets the number of threads that large multiplications may use. A count of one makes all
+     * arithmetic sequential; zero restores the default. This must not be called while another
+     * thread is doing arithmetic.
+     */
+    void set_thread_count(std::size_t count);
+
+    //! Counts kept by the limb pool of one thread.
+    struct PoolStatistics {
+        std::size_t requests;     // Buffers requested.
+        std::size_t reused;       // Requests served from the pool rather than the heap.
+        std::size_t returned;     // Buffers given back.
+        std::size_t cached;       // Buffers held in the pool now.
+        std::size_t cached_bytes; // Their total size.
+    };
+
+    /*!
+     * Returns the statistics of the calling thread's limb pool. When Clac is built without the
+     * pool (CLAC_LIMB_POOL=OFF) requests and returns are still counted, but nothing is reused.
+     */
+    PoolStatistics pool_statistics() noexcept;
+
+    //! Sets the request, reuse, and return counts of the calling thread's pool to zero.
+    void reset_pool_statistics() noexcept;
+
+    //! Gives the buffers held in the calling thread's pool back to the heap.
+    void release_pool() noexcept;
+
+    // Conversions between spica::VeryLong and natural_t.
+    // ------------------------------------------------
+
+    //! Returns the magnitude of 'number' as a natural_t. The sign is ignored.
+    natural_t to_natural(const spica::VeryLong& number);
+
+    //! Returns the VeryLong with magnitude 'number' and the given sign.
+    spica::VeryLong to_verylong(const natural_t& number, bool negative = false);
+
+    /*!
+     * Returns the double nearest the value with the given magnitude and sign. Ties are rounded to
+     * even. Only the top 64 bits are examined, unless they are exactly halfway between two
+     * doubles. Returns plus or minus HUGE_VAL if the magnitude is too large for a double.
+     */
+    double to_double(const natural_t& number, bool negative = false);
+
+    /*!
+     * Returns the base 2 logarithm of 'number', computed from its bit length and its top 64
+     * bits, so that it takes the same time and has nearly the same relative accuracy for any
+     * size. Throws std::domain_error if 'number' is zero.
+     */
+    double log2(const natural_t& number);
+
+    //! Returns the decimal representation of 'number' without leading zeros.
+    std::string to_decimal(const natural_t& number);
+
+    //! Returns the value of a nonempty string of decimal digits.
+    natural_t from_decimal(std::string_view digits);
+
+    // Operations on natural_t.
+    // ------------------------
+
+    //! Removes high order zero limbs.
+    void normalize(natural_t& number) noexcept;
+
+    //! Returns the number of significant bits in 'number'. Zero has no significant bits.
+    std::size_t bit_length(const natural_t& number) noexcept;
+
+    //! Returns a negative value, zero, or a positive value as left <, ==, or > right.
+    int compare(const natural_t& left, const natural_t& right) noexcept;
+
+    natural_t add(const natural_t& left, const natural_t& right);
+
+    //! Requires left >= right.
+    natural_t subtract(const natural_t& left, const natural_t& right);
+
+    natural_t multiply(const natural_t& left, const natural_t& right);
+    natural_t square(const natural_t& number);
+
+    /*!
+     * Computes the quotient and remainder of numerator / denominator. Throws std::domain_error
+     * if the denominator is zero.
+     */
+    void divide(
+        const natural_t& numerator,
+        const natural_t& denominator,
+        natural_t& quotient,
+        natural_t& remainder);
+
+    // Fused operations. They produce their results with at most one temporary, where the
+    // equivalent combinations of multiply, add, subtract, and divide need a temporary for every
+    // intermediate result.
+
+    //! accumulator += left * right.
+    void addmul(natural_t& accumulator, const natural_t& left, const natural_t& right);
+
+    /*!
+     * accumulator = |accumulator - left * right|. Returns true if left * right was larger than
+     * the accumulator, that is, if the signed difference is negative.
+     */
+    bool submul(natural_t& accumulator, const natural_t& left, const natural_t& right);
+
+    /*!
+     * Returns number / divisor where the division is known to be exact. The result is
+     * unspecified if it is not. Throws std::domain_error if the divisor is zero.
+     */
+    natural_t divide_exact(const natural_t& number, const natural_t& divisor);
+
+    //! Returns left * right / divisor where the division is known to be exact.
+    natural_t multiply_divide_exact(
+        const natural_t& left, const natural_t& right, const natural_t& divisor);
+
+    natural_t shift_left(const natural_t& number, std::size_t bit_count);
+    natural_t shift_right(const natural_t& number, std::size_t bit_count);
+
+    // Bitwise operations. They work a limb at a time (see bitwise.cpp).
+
+    natural_t bit_and(const natural_t& left, const natural_t& right);
+    natural_t bit_or(const natural_t& left, const natural_t& right);
+    natural_t bit_xor(const natural_t& left, const natural_t& right);
+
+    //! Returns left & ~right.
+    natural_t bit_and_not(const natural_t& left, const natural_t& right);
+
+    //! Returns the number of one bits in 'number'.
+    std::size_t popcount(const natural_t& number) noexcept;
+
+    //! Returns the number of zero bits below the lowest one bit of 'number'. Zero has none.
+    std::size_t trailing_zeros(const natural_t& number) noexcept;
+
+    //! Returns base^exponent.
+    natural_t power(const natural_t& base, std::size_t exponent);
+
+    /*!
+     * Returns the integer part of the k-th root of 'number' and sets 'exact' to whether the root
+     * is exact. Throws std::domain_error if k is zero.
+     */
+    natural_t root(const natural_t& number, std::size_t k, bool& exact);
+
+    /*!
+     * Returns true if 'number' is a^k for some natural a and some k >= 2. If odd_only is true,
+     * only odd values of k are considered. Zero and one are perfect powers.
+     */
+    bool is_perfect_power(const natural_t& number, bool odd_only = false);
+
+    //! Returns the greatest common divisor of 'left' and 'right'. The GCD of 0 and 0 is 0.
+    natural_t gcd(const natural_t& left, const natural_t& right);
+
+    //! Returns the decimal representation of 'number' with a leading '-' if it is negative.
+    std::string to_string(const spica::VeryLong& number);
+
+    //! Returns the VeryLong with the value of a nonempty string of decimal digits.
+    spica::VeryLong from_string(const std::string& digits);
+
+    /*!
+     * Returns the double nearest 'number', rounded as by the natural_t version. Apart from the
+     * rare near tie, the time taken does not depend on the size of the number.
+     */
+    double to_double(const spica::VeryLong& number);
+
+    //! Returns the base 2 logarithm of the magnitude of 'number', as the natural_t version does.
+    //! Throws std::domain_error if 'number' is zero.
+    double log2(const spica::VeryLong& number);
+
+    //! Returns the VeryLong equal to a finite double with no fractional part.
+    spica::VeryLong from_double(double number);
+
+    // Operations on spica::VeryLong.
+    // ------------------------------
+    //
+    // These functions compute the same results as the corresponding VeryLong operators. Small
+    // operands are handed to VeryLong directly.
+
+    spica::VeryLong multiply(const spica::VeryLong& left, const spica::VeryLong& right);
+    spica::VeryLong square(const spica::VeryLong& number);
+
+    /*!
+     * Returns base^exponent. Throws std::domain_error if the exponent is negative and
+     * std::length_error if the result could not be represented.
+     */
+    spica::VeryLong power(const spica::VeryLong& base, const spica::VeryLong& exponent);
+
+    //! Returns the nonnegative greatest common divisor of 'left' and 'right'.
+    spica::VeryLong gcd(const spica::VeryLong& left, const spica::VeryLong& right);
+
+    /*!
+     * Computes the same quotient and remainder as VeryLong::vldiv. The quotient is truncated
+     * toward zero and the remainder has the sign of the numerator.
+     */
+    void divide(
+        const spica::VeryLong& numerator,
+        const spica::VeryLong& denominator,
+        spica::VeryLong::vldiv_t* result);
+
+} // namespace clac::arithmetic
+
+#endif
@@ -0,0 +1,117 @@
+/*! \file    backend.cpp
+ *  \brief   Selection of the backend that performs the costly natural_t operations.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * The functions of arithmetic.hpp that are delegated to a backend call through the active
+ * Backend. The native backend is collected here from the files that implement it.
+ */
+
+#include "backend.hpp"
+
+using namespace std;
+
+namespace clac::arithmetic {
+
+    namespace {
+
+        constexpr Backend native_backend = {
+            "native",
+            native::multiply,
+            native::square,
+            native::divide,
+            native::divide_exact,
+            native::gcd,
+            native::root,
+            native::to_decimal,
+            native::from_decimal,
+        };
+
+        //
+        // Calls made during static initialization, before the other backends have been
+        // considered, use the native backend. GMP, when it is built in, is chosen once, when
+        // this file's variables are initialized.
+        //
+        constinit const Backend* active = &native_backend;
+
+        [[maybe_unused]] const bool selected = [] {
+            if (const Backend* gmp = gmp_backend())
+                active = gmp;
+            return true;
+        }();
+
+    } // namespace
+
+
+    vector<const Backend*> available_backends()
+    {
+        vector<const Backend*> result{&native_backend};
+        if (const Backend* gmp = gmp_backend())
+            result.push_back(gmp);
+        return result;
+    }
+
+
+    const Backend& active_backend() noexcept
+    {
+        return *active;
+    }
+
+
+    void set_active_backend(const Backend& backend) noexcept
+    {
+        active = &backend;
+    }
+
+
+    natural_t multiply(const natural_t& left, const natural_t& right)
+    {
+        return active->multiply(left, right);
+    }
+
+
+    natural_t square(const natural_t& number)
+    {
+        return active->square(number);
+    }
+
+
+    void divide(
+        const natural_t& numerator,
+        const natural_t& denominator,
+        natural_t& quotient,
+        natural_t& remainder)
+    {
+        active->divide(numerator, denominator, quotient, remainder);
+    }
+
+
+    natural_t divide_exact(const natural_t& number, const natural_t& divisor)
+    {
+        return active->divide_exact(number, divisor);
+    }
+
+
+    natural_t gcd(const natural_t& left, const natural_t& right)
+    {
+        return active->gcd(left, right);
+    }
+
+
+    natural_t root(const natural_t& number, size_t k, bool& exact)
+    {
+        return active->root(number, k, exact);
+    }
+
+
+    string to_decimal(const natural_t& number)
+    {
+        return active->to_decimal(number);
+    }
+
+
+    natural_t from_decimal(string_view digits)
+    {
+        return active->from_decimal(digits);
+    }
+
+} // namespace clac::arithmetic
@@ -0,0 +1,75 @@
+/*! \file    backend.hpp
+ *  \brief   Interface to the interchangeable implementations of the costly natural_t operations.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * IntegerEntity and RationalEntity do all of their large integer arithmetic through the
+ * functions in arithmetic.hpp. The operations among those whose cost grows faster than linearly
+ * (multiplication, division, GCD, roots, and decimal conversion) are provided by a Backend, and
+ * the functions in arithmetic.hpp call through the active one. Everything else, including the
+ * powers and fused operations built on multiplication, is shared by all backends.
+ *
+ * The native backend is Clac's own: spica::VeryLong for small values and the algorithms of the
+ * arithmetic module for large ones. It is always available. When Clac is built with the CMake
+ * option CLAC_GMP and the GMP library is found, a second backend hands the same operations to
+ * GMP. Its limbs are the same 64-bit words as those of natural_t, so no conversion is needed.
+ * The GMP backend becomes the active one at startup; the native backend remains available for
+ * comparison and is the reference that the conformance tests check the others against.
+ */
+
+#ifndef BACKEND_HPP
+#define BACKEND_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "arithmetic.hpp"
+
+namespace clac::arithmetic {
+
+    //! An implementation of the operations in arithmetic.hpp that are delegated to a backend.
+    struct Backend {
+        const char* name;
+        natural_t (*multiply)(const natural_t&, const natural_t&);
+        natural_t (*square)(const natural_t&);
+        void (*divide)(const natural_t&, const natural_t&, natural_t&, natural_t&);
+        natural_t (*divide_exact)(const natural_t&, const natural_t&);
+        natural_t (*gcd)(const natural_t&, const natural_t&);
+        natural_t (*root)(const natural_t&, std::size_t, bool&);
+        std::string (*to_decimal)(const natural_t&);
+        natural_t (*from_decimal)(std::string_view);
+    };
+
+    //! Returns the backends built into this program, starting with the native backend.
+    std::vector<const Backend*> available_backends();
+
+    //! Returns the backend in use.
+    const Backend& active_backend() noexcept;
+
+    //! Makes 'backend' the one in use. This must not be called while arithmetic is in progress.
+    void set_active_backend(const Backend& backend) noexcept;
+
+    //! Returns the backend that uses GMP, or nullptr if Clac was built without it.
+    const Backend* gmp_backend() noexcept;
+
+    // The native implementations. They have the same contracts as the functions of the same
+    // names in arithmetic.hpp.
+    namespace native {
+        natural_t multiply(const natural_t& left, const natural_t& right);
+        natural_t square(const natural_t& number);
+        void divide(
+            const natural_t& numerator,
+            const natural_t& denominator,
+            natural_t& quotient,
+            natural_t& remainder);
+        natural_t divide_exact(const natural_t& number, const natural_t& divisor);
+        natural_t gcd(const natural_t& left, const natural_t& right);
+        natural_t root(const natural_t& number, std::size_t k, bool& exact);
+        std::string to_decimal(const natural_t& number);
+        natural_t from_decimal(std::string_view digits);
+    } // namespace native
+
+} // namespace clac::arithmetic
+
+#endif
@@ -0,0 +1,309 @@
+/*! \file    bigfloat.cpp
+ *  \brief   Binary floating point numbers of any precision.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * Every result goes through 'rounded', which keeps the top 'precision' bits of an exact (or
+ * nearly exact) mantissa. The bit below them decides the rounding, and the bits below that only
+ * matter when it is set. A quotient or square root that isn't exact is computed to at least two
+ * bits past the last place and marked inexact, which stands for the bits that weren't computed.
+ *
+ * A sum of operands of very different sizes would need a long mantissa to hold exactly. When the
+ * smaller operand lies entirely below a quarter of the last place of the larger (and below its
+ * lowest bit), only its sign can affect the rounding, so it is replaced by a single bit in that
+ * range.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+#include "bigfloat.hpp"
+
+using namespace std;
+
+namespace clac::arithmetic {
+    namespace {
+
+        constexpr double LOG10_2 = 0.301029995663981195214;
+
+        const natural_t one{1};
+
+        bool test_bit(const natural_t& number, size_t index) noexcept
+        {
+            const size_t limb = index / LIMB_BITS;
+            return limb < number.size() && ((number[limb] >> (index % LIMB_BITS)) & 1) != 0;
+        }
+
+        //! Returns the value with the trailing zero bits of its mantissa moved to the exponent.
+        BigFloat normal(natural_t mantissa, int64_t exponent, bool negative)
+        {
+            BigFloat result;
+            if (mantissa.empty())
+                return result;
+
+            const size_t zeros = trailing_zeros(mantissa);
+            result.mantissa = (zeros == 0) ? std::move(mantissa) : shift_right(mantissa, zeros);
+            result.exponent = exponent + static_cast<int64_t>(zeros);
+            result.negative = negative;
+            return result;
+        }
+
+        /*!
+         * Rounds mantissa * 2^exponent to 'precision' bits. If 'inexact' is true the exact value
+         * is a little larger than the one given, by less than a unit in its last place, and the
+         * mantissa has at least precision + 2 bits.
+         */
+        BigFloat rounded(
+            natural_t mantissa, int64_t exponent, bool negative, size_t precision,
+            bool inexact = false)
+        {
+            const size_t bit_count = bit_length(mantissa);
+            if (bit_count > precision) {
+                const size_t drop = bit_count - precision;
+                const bool half = test_bit(mantissa, drop - 1);
+                const bool rest = inexact || trailing_zeros(mantissa) < drop - 1;
+                mantissa = shift_right(mantissa, drop);
+                exponent += static_cast<int64_t>(drop);
+                if (half && (rest || (mantissa[0] & 1) != 0))
+                    mantissa = add(mantissa, one);
+            }
+            return normal(std::move(mantissa), exponent, negative);
+        }
+
+        //! Returns the position just above the top bit, so that |number| < 2^top.
+        int64_t top(const BigFloat& number) noexcept
+        {
+            return number.exponent + static_cast<int64_t>(bit_length(number.mantissa));
+        }
+
+        //! Returns the sum of two values, where 'right' is negated if 'negate' is true.
+        BigFloat signed_sum(BigFloat left, BigFloat right, bool negate, size_t precision)
+        {
+            right.negative = right.negative != negate;
+            if (right.mantissa.empty())
+                return round_float(left, precision);
+            if (left.mantissa.empty())
+                return round_float(right, precision);
+
+            if (top(left) < top(right))
+                swap(left, right);
+            const int64_t limit =
+                min(left.exponent, top(left) - static_cast<int64_t>(precision) - 2);
+            if (top(right) <= limit) {
+                right.mantissa = one;
+                right.exponent = limit - 1;
+            }
+
+            const int64_t exponent = min(left.exponent, right.exponent);
+            const natural_t l = shift_left(left.mantissa, left.exponent - exponent);
+            const natural_t r = shift_left(right.mantissa, right.exponent - exponent);
+            if (left.negative == right.negative)
+                return rounded(add(l, r), exponent, left.negative, precision);
+            if (compare(l, r) >= 0)
+                return rounded(subtract(l, r), exponent, left.negative, precision);
+            return rounded(subtract(r, l), exponent, right.negative, precision);
+        }
+
+    } // namespace
+
+
+    BigFloat round_float(const BigFloat& number, size_t precision)
+    {
+        return rounded(number.mantissa, number.exponent, number.negative, precision);
+    }
+
+
+    BigFloat add(const BigFloat& left, const BigFloat& right, size_t precision)
+    {
+        return signed_sum(left, right, false, precision);
+    }
+
+
+    BigFloat subtract(const BigFloat& left, const BigFloat& right, size_t precision)
+    {
+        return signed_sum(left, right, true, precision);
+    }
+
+
+    BigFloat multiply(const BigFloat& left, const BigFloat& right, size_t precision)
+    {
+        if (left.mantissa.empty() || right.mantissa.empty())
+            return BigFloat();
+
+        natural_t product = (&left == &right) ? square(left.mantissa)
+                                              : multiply(left.mantissa, right.mantissa);
+        return rounded(
+            std::move(product), left.exponent + right.exponent, left.negative != right.negative,
+            precision);
+    }
+
+
+    //
+    // The numerator is shifted so that the quotient of the mantissas has at least precision + 2
+    // bits. A nonzero remainder means the exact quotient is a little larger.
+    //
+    BigFloat divide(const BigFloat& left, const BigFloat& right, size_t precision)
+    {
+        if (right.mantissa.empty())
+            throw domain_error("divide: division by zero");
+        if (left.mantissa.empty())
+            return BigFloat();
+
+        const auto left_bits = static_cast<int64_t>(bit_length(left.mantissa));
+        const auto right_bits = static_cast<int64_t>(bit_length(right.mantissa));
+        const int64_t shift =
+            max<int64_t>(static_cast<int64_t>(precision) + 2 + right_bits - left_bits, 0);
+
+        natural_t quotient, remainder;
+        arithmetic::divide(
+            shift_left(left.mantissa, static_cast<size_t>(shift)), right.mantissa, quotient,
+            remainder);
+        return rounded(
+            std::move(quotient), left.exponent - right.exponent - shift,
+            left.negative != right.negative, precision, !remainder.empty());
+    }
+
+
+    //
+    // The mantissa is shifted so that the exponent becomes even and the integer square root has
+    // at least precision + 2 bits. An inexact root means the exact one is a little larger.
+    //
+    BigFloat square_root(const BigFloat& number, size_t precision)
+    {
+        if (number.mantissa.empty())
+            return BigFloat();
+        if (number.negative)
+            throw domain_error("square_root: negative argument");
+
+        const auto bits = static_cast<int64_t>(bit_length(number.mantissa));
+        int64_t shift = max<int64_t>(2 * (static_cast<int64_t>(precision) + 2) - bits, 0);
+        if ((number.exponent - shift) % 2 != 0)
+            ++shift;
+
+        bool exact;
+        natural_t result =
+            root(shift_left(number.mantissa, static_cast<size_t>(shift)), 2, exact);
+        return rounded(std::move(result), (number.exponent - shift) / 2, false, precision, !exact);
+    }
+
+
+    int compare(const BigFloat& left, const BigFloat& right)
+    {
+        const int left_sign = left.mantissa.empty() ? 0 : (left.negative ? -1 : 1);
+        const int right_sign = right.mantissa.empty() ? 0 : (right.negative ? -1 : 1);
+        if (left_sign != right_sign || left_sign == 0)
+            return left_sign - right_sign;
+
+        // Compare the magnitudes, then apply the common sign.
+        int order;
+        if (top(left) != top(right)) {
+            order = (top(left) < top(right)) ? -1 : 1;
+        }
+        else {
+            const int64_t exponent = min(left.exponent, right.exponent);
+            order = compare(
+                shift_left(left.mantissa, left.exponent - exponent),
+                shift_left(right.mantissa, right.exponent - exponent));
+        }
+        return left_sign * order;
+    }
+
+
+    BigFloat to_bigfloat(double number)
+    {
+        if (!isfinite(number))
+            throw domain_error("to_bigfloat: value is not finite");
+        if (number == 0.0)
+            return BigFloat();
+
+        int exponent;
+        const double fraction = frexp(std::fabs(number), &exponent);
+        const auto mantissa = static_cast<limb_t>(ldexp(fraction, 53));
+        return normal(natural_t{mantissa}, exponent - 53, number < 0.0);
+    }
+
+
+    double to_double(const BigFloat& number)
+    {
+        if (number.mantissa.empty())
+            return 0.0;
+
+        // The mantissa of the rounded value fits in a double exactly.
+        const BigFloat value = round_float(number, 53);
+        const int64_t limit = 1 << 20;
+        const int exponent = static_cast<int>(clamp(value.exponent, -limit, limit));
+        const double magnitude = ldexp(static_cast<double>(value.mantissa[0]), exponent);
+        return value.negative ? -magnitude : magnitude;
+    }
+
+
+    natural_t nearest_integer(const BigFloat& number)
+    {
+        if (number.exponent >= 0)
+            return shift_left(number.mantissa, static_cast<size_t>(number.exponent));
+        if (number.mantissa.empty())
+            return natural_t();
+
+        const size_t drop = static_cast<size_t>(-number.exponent);
+        const bool half = test_bit(number.mantissa, drop - 1);
+        const bool rest = trailing_zeros(number.mantissa) < drop - 1;
+        natural_t result = shift_right(number.mantissa, drop);
+        if (half && (rest || test_bit(result, 0)))
+            result = add(result, one);
+        return result;
+    }
+
+
+    //
+    // The digits are the integer nearest |number| / 10^(exponent - digits + 1), computed as a
+    // quotient of integers. The exponent is first estimated from the logarithm, and corrected if
+    // the quotient has the wrong number of digits.
+    //
+    string to_decimal(const BigFloat& number, size_t digits, int64_t& exponent)
+    {
+        const double bits = log2(number.mantissa) + static_cast<double>(number.exponent);
+        exponent = static_cast<int64_t>(floor(bits * LOG10_2));
+        while (true) {
+            const int64_t scale = exponent - static_cast<int64_t>(digits) + 1;
+            const natural_t ten_power =
+                power(natural_t{10}, static_cast<size_t>(scale < 0 ? -scale : scale));
+
+            natural_t numerator = number.mantissa;
+            natural_t denominator = one;
+            if (number.exponent >= 0)
+                numerator = shift_left(numerator, static_cast<size_t>(number.exponent));
+            else
+                denominator = shift_left(denominator, static_cast<size_t>(-number.exponent));
+            if (scale >= 0)
+                denominator = arithmetic::multiply(denominator, ten_power);
+            else
+                numerator = arithmetic::multiply(numerator, ten_power);
+
+            natural_t quotient, remainder;
+            arithmetic::divide(numerator, denominator, quotient, remainder);
+            const int order = compare(shift_left(remainder, 1), denominator);
+            if (order > 0 || (order == 0 && test_bit(quotient, 0)))
+                quotient = add(quotient, one);
+
+            string result = arithmetic::to_decimal(quotient);
+            if (result.size() < digits) {
+                --exponent;
+                continue;
+            }
+            if (result.size() > digits) {
+                // Rounding up to the next power of ten gives one digit too many.
+                if (result.size() == digits + 1 && result[0] == '1' &&
+                    result.find_first_not_of('0', 1) == string::npos) {
+                    result.pop_back();
+                    ++exponent;
+                    return result;
+                }
+                ++exponent;
+                continue;
+            }
+            return result;
+        }
+    }
+
+} // namespace clac::arithmetic
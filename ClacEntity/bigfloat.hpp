@@ -0,0 +1,78 @@
+/*! \file    bigfloat.hpp
+ *  \brief   Interface to binary floating point numbers of any precision.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * A BigFloat is a natural number mantissa times a power of two, with the sign kept apart. Each
+ * operation rounds its exact result to a given number of bits, to nearest with ties to even, so
+ * that the result is the one the exact operation would round to. Only as much of the exact
+ * result as the rounding needs is computed: a sum looks at the smaller operand only as far as
+ * it can reach the last place of the larger, and a quotient or square root is carried two bits
+ * past the last place, with the remainder deciding the rest.
+ *
+ * The mantissas are natural_t values, so products, quotients, and square roots of long
+ * mantissas use the subquadratic multiplication, division, and root algorithms directly.
+ *
+ * References:
+ *
+ * + Brent and Zimmermann, "Modern Computer Arithmetic," Sections 3.1 to 3.5.
+ * + Muller et al., "Handbook of Floating-Point Arithmetic," Chapter 2.
+ */
+
+#ifndef BIGFLOAT_HPP
+#define BIGFLOAT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "arithmetic.hpp"
+
+namespace clac::arithmetic {
+
+    /*!
+     * The number (-1)^negative * mantissa * 2^exponent. The functions below accept any
+     * representation, and they return values whose mantissa is odd, or empty for zero, so that
+     * each value has only one. Zero is never negative.
+     */
+    struct BigFloat {
+        natural_t mantissa;
+        std::int64_t exponent = 0;
+        bool negative = false;
+    };
+
+    //! Returns 'number' rounded to 'precision' bits, which must be at least one.
+    BigFloat round_float(const BigFloat& number, std::size_t precision);
+
+    BigFloat add(const BigFloat& left, const BigFloat& right, std::size_t precision);
+    BigFloat subtract(const BigFloat& left, const BigFloat& right, std::size_t precision);
+    BigFloat multiply(const BigFloat& left, const BigFloat& right, std::size_t precision);
+
+    //! Throws std::domain_error if the divisor is zero.
+    BigFloat divide(const BigFloat& left, const BigFloat& right, std::size_t precision);
+
+    //! Throws std::domain_error if 'number' is negative.
+    BigFloat square_root(const BigFloat& number, std::size_t precision);
+
+    //! Returns a negative, zero, or positive value as left is less than, equal to, or greater
+    //! than right.
+    int compare(const BigFloat& left, const BigFloat& right);
+
+    //! Returns the exact value of a finite double. Throws std::domain_error otherwise.
+    BigFloat to_bigfloat(double number);
+
+    //! Returns the double nearest 'number', or an infinity if it is too large for a double.
+    double to_double(const BigFloat& number);
+
+    //! Returns the magnitude of the integer nearest 'number', with ties to even.
+    natural_t nearest_integer(const BigFloat& number);
+
+    /*!
+     * Returns the first 'digits' significant decimal digits of the magnitude of 'number', which
+     * must not be zero, rounded to nearest with ties to even. Sets 'exponent' to the power of ten
+     * of the first digit, so that the magnitude is about d.ddd * 10^exponent.
+     */
+    std::string to_decimal(const BigFloat& number, std::size_t digits, std::int64_t& exponent);
+
+} // namespace clac::arithmetic
+
+#endif
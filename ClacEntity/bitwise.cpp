@@ -0,0 +1,90 @@
+/*! \file    bitwise.cpp
+ *  \brief   Bitwise operations on natural numbers.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * The operations combine whole limbs, so their cost is one machine operation per 64 bits. The
+ * length of a result is known in advance from the lengths of the operands: an and is no longer
+ * than the shorter operand, an or or an exclusive or is as long as the longer one, and left and
+ * not right is no longer than left. Only the last two can have high order zero limbs, which
+ * normalize removes.
+ *
+ * The population count uses the popcount_n kernel, which uses the POPCNT instruction where the
+ * processor has it. Trailing zeros are found a limb at a time with std::countr_zero, which is a
+ * single BSF or TZCNT instruction.
+ */
+
+#include <algorithm>
+#include <bit>
+
+#include "arithmetic.hpp"
+#include "kernels.hpp"
+
+using namespace std;
+
+namespace clac::arithmetic {
+
+    natural_t bit_and(const natural_t& left, const natural_t& right)
+    {
+        const size_t size = min(left.size(), right.size());
+        natural_t result(size);
+        for (size_t i = 0; i < size; ++i) {
+            result[i] = left[i] & right[i];
+        }
+        normalize(result);
+        return result;
+    }
+
+
+    natural_t bit_or(const natural_t& left, const natural_t& right)
+    {
+        const natural_t& longer = (left.size() >= right.size()) ? left : right;
+        const natural_t& shorter = (left.size() >= right.size()) ? right : left;
+        natural_t result(longer);
+        for (size_t i = 0; i < shorter.size(); ++i) {
+            result[i] |= shorter[i];
+        }
+        return result;
+    }
+
+
+    natural_t bit_xor(const natural_t& left, const natural_t& right)
+    {
+        const natural_t& longer = (left.size() >= right.size()) ? left : right;
+        const natural_t& shorter = (left.size() >= right.size()) ? right : left;
+        natural_t result(longer);
+        for (size_t i = 0; i < shorter.size(); ++i) {
+            result[i] ^= shorter[i];
+        }
+        normalize(result);
+        return result;
+    }
+
+
+    natural_t bit_and_not(const natural_t& left, const natural_t& right)
+    {
+        natural_t result(left);
+        const size_t size = min(left.size(), right.size());
+        for (size_t i = 0; i < size; ++i) {
+            result[i] &= ~right[i];
+        }
+        normalize(result);
+        return result;
+    }
+
+
+    size_t popcount(const natural_t& number) noexcept
+    {
+        return popcount_n(number.data(), number.size());
+    }
+
+
+    size_t trailing_zeros(const natural_t& number) noexcept
+    {
+        for (size_t i = 0; i < number.size(); ++i) {
+            if (number[i] != 0)
+                return i * LIMB_BITS + static_cast<size_t>(countr_zero(number[i]));
+        }
+        return 0;
+    }
+
+} // namespace clac::arithmetic
@@ -0,0 +1,297 @@
+/*! \file    combinatorics.cpp
+ *  \brief   Factorials, binomial coefficients, and Fibonacci numbers.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * A product of many small factors is formed as a balanced tree: the factors are packed into
+ * full limbs, and then neighboring terms are multiplied pairwise, level by level, until one
+ * remains. The pairs of a level are independent and are spread over the arithmetic threads.
+ *
+ * The factorial uses Luschny's prime swing. The swing n! / ((n/2)!)^2 is the product of a few
+ * prime powers that are read off from the digits of n in base p, and n! = ((n/2)!)^2 * swing(n).
+ * Only the odd parts are multiplied; the power of two in n!, which is n minus the number of one
+ * bits in n, is applied at the end as a shift.
+ *
+ * The binomial coefficient is assembled from its prime factorization. By Legendre's formula the
+ * exponent of p in (n choose k) is the sum over the powers q of p of n/q - k/q - (n-k)/q, each
+ * term being 0 or 1. The prime powers are combined by their exponent bits, from the top down,
+ * so that each level is one square and one product tree. When k is much smaller than n it is
+ * cheaper to divide the product of the k top factors of n! by k!.
+ *
+ * Fibonacci numbers use the doubling formulas F(2k+1) = 4F(k)^2 - F(k-1)^2 + 2(-1)^k and
+ * F(2k-1) = F(k)^2 + F(k-1)^2, which cost two squares for each bit of the index.
+ */
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "combinatorics.hpp"
+#include "kernels.hpp"
+#include "parallel.hpp"
+#include "prime.hpp"
+
+using namespace std;
+
+namespace clac::arithmetic {
+    namespace {
+
+        //! Multiplies small factors into as few limbs as possible.
+        vector<natural_t> pack(const vector<uint64_t>& factors)
+        {
+            vector<natural_t> terms;
+            limb_t word = 1;
+            for (uint64_t factor : factors) {
+                limb_t high;
+                const limb_t low = multiply_wide(word, factor, high);
+                if (high == 0) {
+                    word = low;
+                    continue;
+                }
+                terms.push_back(natural_t{word});
+                word = factor;
+            }
+            if (word != 1 || terms.empty())
+                terms.push_back(natural_t{word});
+            return terms;
+        }
+
+        //! Returns the product of the terms, multiplying neighbors pairwise until one is left.
+        natural_t product(vector<natural_t> terms)
+        {
+            if (terms.empty())
+                return natural_t{1};
+
+            while (terms.size() > 1) {
+                const size_t pairs = terms.size() / 2;
+                const size_t parts = min(pairs, max<size_t>(thread_count(), 1));
+                vector<natural_t> next(pairs + terms.size() % 2);
+
+                vector<function<void()>> tasks;
+                for (size_t part = 0; part < parts; ++part) {
+                    tasks.emplace_back([&, part] {
+                        for (size_t i = pairs * part / parts; i < pairs * (part + 1) / parts; ++i) {
+                            next[i] = multiply(terms[2 * i], terms[2 * i + 1]);
+                        }
+                    });
+                }
+                parallel_invoke(tasks);
+                if (terms.size() % 2 != 0)
+                    next.back() = std::move(terms.back());
+                terms = std::move(next);
+            }
+            return std::move(terms.front());
+        }
+
+        natural_t product(const vector<uint64_t>& factors)
+        {
+            return product(pack(factors));
+        }
+
+        uint64_t integer_sqrt(uint64_t n) noexcept
+        {
+            uint64_t root = 0;
+            for (uint64_t bit = uint64_t{1} << 31; bit != 0; bit >>= 1) {
+                const uint64_t trial = root | bit;
+                if (trial * trial <= n)
+                    root = trial;
+            }
+            return root;
+        }
+
+        //! Returns the odd part of n! / ((n/2)!)^2, given the odd primes up to at least n.
+        natural_t odd_swing(uint64_t n, const vector<uint64_t>& primes)
+        {
+            const uint64_t root = integer_sqrt(n);
+            vector<uint64_t> factors;
+            for (uint64_t p : primes) {
+                if (p > n)
+                    break;
+                if (p <= root) {
+                    // The prime power is at most n.
+                    uint64_t power = 1;
+                    for (uint64_t q = n / p; q > 0; q /= p) {
+                        if ((q & 1) != 0)
+                            power *= p;
+                    }
+                    if (power > 1)
+                        factors.push_back(power);
+                }
+                else if (p <= n / 3) {
+                    if (((n / p) & 1) != 0)
+                        factors.push_back(p);
+                }
+                else if (p > n / 2) {
+                    factors.push_back(p);
+                }
+            }
+            return product(factors);
+        }
+
+        //! Returns the odd part of n!, given the odd primes up to at least n.
+        natural_t odd_factorial(uint64_t n, const vector<uint64_t>& primes)
+        {
+            if (n < 2)
+                return natural_t{1};
+            return multiply(square(odd_factorial(n / 2, primes)), odd_swing(n, primes));
+        }
+
+        //! Returns the product of primes[i]^exponents[i].
+        natural_t power_product(const vector<uint64_t>& primes, const vector<uint64_t>& exponents)
+        {
+            const uint64_t largest = *max_element(exponents.begin(), exponents.end());
+            natural_t result{1};
+            for (int bit = 63 - countl_zero(largest); bit >= 0; --bit) {
+                vector<uint64_t> factors;
+                for (size_t i = 0; i < primes.size(); ++i) {
+                    if (((exponents[i] >> bit) & 1) != 0)
+                        factors.push_back(primes[i]);
+                }
+                result = multiply(square(result), product(factors));
+            }
+            return result;
+        }
+
+        //! Returns n choose k for 0 < k <= n / 2 from the prime factorization.
+        natural_t prime_binomial(uint64_t n, uint64_t k)
+        {
+            const vector<uint64_t> candidates = primes_between(2, n);
+            vector<uint64_t> primes;
+            vector<uint64_t> exponents;
+            for (uint64_t p : candidates) {
+                uint64_t exponent = 0;
+                if (p > n - k) {
+                    exponent = 1;
+                }
+                else if (p <= n / 2) {
+                    for (uint64_t q = p;; q *= p) {
+                        exponent += n / q - k / q - (n - k) / q;
+                        if (q > n / p)
+                            break;
+                    }
+                }
+                if (exponent != 0) {
+                    primes.push_back(p);
+                    exponents.push_back(exponent);
+                }
+            }
+            return power_product(primes, exponents);
+        }
+
+        /*!
+         * Sets f to F(n) and previous to F(n - 1), with F(-1) = 1. Each step takes the pair
+         * for k to the pair for 2k or 2k + 1.
+         */
+        void fibonacci_pair(uint64_t n, natural_t& f, natural_t& previous)
+        {
+            if (n == 0) {
+                f = natural_t();
+                previous = natural_t{1};
+                return;
+            }
+
+            f = natural_t{1};
+            previous = natural_t();
+            bool k_odd = true;
+            for (int bit = 62 - countl_zero(n); bit >= 0; --bit) {
+                const natural_t a = square(f);
+                const natural_t b = square(previous);
+                natural_t odd = subtract(shift_left(a, 2), b);
+                odd = k_odd ? subtract(odd, natural_t{2}) : add(odd, natural_t{2});
+                natural_t before = add(a, b);
+                natural_t even = subtract(odd, before);
+
+                k_odd = ((n >> bit) & 1) != 0;
+                if (k_odd) {
+                    f = std::move(odd);
+                    previous = std::move(even);
+                }
+                else {
+                    f = std::move(even);
+                    previous = std::move(before);
+                }
+            }
+        }
+
+    } // namespace
+
+
+    natural_t factorial(uint64_t n)
+    {
+        const vector<uint64_t> primes = primes_between(3, n);
+        return shift_left(odd_factorial(n, primes), n - static_cast<uint64_t>(std::popcount(n)));
+    }
+
+
+    //
+    // For n = 2m, n!! = 2^m * m!. For n = 2m + 1, n!! is the odd part of (2m + 1)! divided by
+    // the odd part of m!, which is the odd part of m! times the odd swing of 2m + 1.
+    //
+    natural_t double_factorial(uint64_t n)
+    {
+        const uint64_t m = n / 2;
+        if (n % 2 == 0)
+            return shift_left(factorial(m), m);
+
+        const vector<uint64_t> primes = primes_between(3, n);
+        return multiply(odd_factorial(m, primes), odd_swing(n, primes));
+    }
+
+
+    natural_t binomial(const natural_t& n, uint64_t k)
+    {
+        if (k == 0)
+            return natural_t{1};
+
+        // When k is small compared to n, divide n (n - 1) ... (n - k + 1) by k!.
+        if (n.size() > 1) {
+            if (k > SIEVE_LIMIT)
+                throw domain_error("binomial: k is too large");
+            vector<natural_t> factors;
+            natural_t factor = n;
+            for (uint64_t i = 0; i < k; ++i) {
+                factors.push_back(factor);
+                factor = subtract(factor, natural_t{1});
+            }
+            return divide_exact(product(std::move(factors)), factorial(k));
+        }
+
+        const uint64_t top = n.empty() ? 0 : n[0];
+        if (k > top)
+            return natural_t();
+        k = min(k, top - k);
+        if (k == 0)
+            return natural_t{1};
+        if (top / 64 < k && top <= SIEVE_LIMIT)
+            return prime_binomial(top, k);
+
+        vector<uint64_t> factors;
+        for (uint64_t i = 0; i < k; ++i) {
+            factors.push_back(top - i);
+        }
+        return divide_exact(product(factors), factorial(k));
+    }
+
+
+    natural_t fibonacci(uint64_t n)
+    {
+        natural_t f, previous;
+        fibonacci_pair(n, f, previous);
+        return f;
+    }
+
+
+    //
+    // L(n) = F(n + 1) + F(n - 1) = F(n) + 2F(n - 1).
+    //
+    natural_t lucas(uint64_t n)
+    {
+        natural_t f, previous;
+        fibonacci_pair(n, f, previous);
+        return add(f, shift_left(previous, 1));
+    }
+
+} // namespace clac::arithmetic
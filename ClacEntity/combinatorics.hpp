@@ -0,0 +1,46 @@
+/*! \file    combinatorics.hpp
+ *  \brief   Interface to factorials, binomial coefficients, and Fibonacci numbers.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * These numbers grow so quickly that nearly all of the work of computing them goes into a few
+ * very large multiplications. The functions here arrange their products so that the two
+ * operands of each multiplication are about the same size, which lets the subquadratic
+ * algorithms (and the threads) of multiply.cpp do that work. Multiplying the factors of n! into
+ * an accumulator one at a time would instead cost O(n^2) limb operations.
+ *
+ * References:
+ *
+ * + Goetgheluck, "Computing Binomial Coefficients," American Mathematical Monthly 94(4), 1987.
+ * + Luschny, "Fast Factorial Functions," http://www.luschny.de/math/factorial/, which
+ *   describes the prime swing algorithm.
+ * + Takahashi, "A Fast Algorithm for Computing Large Fibonacci Numbers," Information Processing
+ *   Letters 75(6), 2000.
+ */
+
+#ifndef COMBINATORICS_HPP
+#define COMBINATORICS_HPP
+
+#include <cstdint>
+
+#include "arithmetic.hpp"
+
+namespace clac::arithmetic {
+
+    //! Returns n!. Throws std::domain_error if n is greater than SIEVE_LIMIT (see prime.hpp).
+    natural_t factorial(std::uint64_t n);
+
+    //! Returns n!!, the product of the positive integers up to n that have the parity of n.
+    natural_t double_factorial(std::uint64_t n);
+
+    //! Returns the binomial coefficient "n choose k", which is zero when k > n.
+    natural_t binomial(const natural_t& n, std::uint64_t k);
+
+    //! Returns the nth Fibonacci number, where F(0) = 0 and F(1) = 1.
+    natural_t fibonacci(std::uint64_t n);
+
+    //! Returns the nth Lucas number, where L(0) = 2 and L(1) = 1.
+    natural_t lucas(std::uint64_t n);
+
+} // namespace clac::arithmetic
+
+#endif
@@ -14,24 +14,32 @@ using namespace std;
 // The follow array defines the automatic conversions done when operands of differing types meet
 // in a binary expression. This array must be symmetric about the diagonal.
 //
+// Two big floats are duplicated rather than converted, because converting one rounds it to the
+// current precision, which the operation does to its result anyway.
+//
+// Two integers are duplicated rather than converted, because converting an unevaluated integer
+// to an integer evaluates it.
+//
 //
 // FINISH ME! (When all the necessary conversion functions are defined).
 #define E &Entity
 
 namespace clac::entity {
     Entity *( Entity::*convert_table[type_count][type_count] )( ) const = {
-        //           Bin            Cpx            Dir      Flt            Int            Lbl      Lst      Mat      Prg      Rat             Str           Vec
-        /* Bin */  { E::to_binary,  E::to_complex, nullptr, E::to_float,   E::to_integer, nullptr, nullptr, nullptr, nullptr, nullptr,        nullptr,      nullptr },
-        /* Cpx */  { E::to_complex, E::to_complex, nullptr, E::to_complex, nullptr,       nullptr, nullptr, nullptr, nullptr, nullptr,        nullptr,      nullptr },
-        /* Dir */  { nullptr,       nullptr,       nullptr, nullptr,       nullptr,       nullptr, nullptr, nullptr, nullptr, nullptr,        nullptr,      nullptr },
-        /* Flt */  { E::to_float,   E::to_complex, nullptr, E::to_float,   E::to_float,   nullptr, nullptr, nullptr, nullptr, E::to_float,    nullptr,      nullptr },
-        /* Int */  { E::to_integer, nullptr,       nullptr, E::to_float,   E::to_integer, nullptr, nullptr, nullptr, nullptr, nullptr,        nullptr,      nullptr },
-        /* Lbl */  { nullptr,       nullptr,       nullptr, nullptr,       nullptr,       nullptr, nullptr, nullptr, nullptr, nullptr,        nullptr,      nullptr },
-        /* Lst */  { nullptr,       nullptr,       nullptr, nullptr,       nullptr,       nullptr, nullptr, nullptr, nullptr, nullptr,        nullptr,      nullptr },
-        /* Mat */  { nullptr,       nullptr,       nullptr, nullptr,       nullptr,       nullptr, nullptr, nullptr, nullptr, nullptr,        nullptr,      nullptr },
-        /* Prg */  { nullptr,       nullptr,       nullptr, nullptr,       nullptr,       nullptr, nullptr, nullptr, nullptr, nullptr,        nullptr,      nullptr },
-        /* Rat */  { nullptr,       nullptr,       nullptr, E::to_float,   nullptr,       nullptr, nullptr, nullptr, nullptr, E::to_rational, nullptr,      nullptr },
-        /* Str */  { nullptr,       nullptr,       nullptr, nullptr,       nullptr,       nullptr, nullptr, nullptr, nullptr, nullptr,        E::to_string, nullptr },
-        /* Vec */  { nullptr,       nullptr,       nullptr, nullptr,       nullptr,       nullptr, nullptr, nullptr, nullptr, nullptr,        nullptr,      nullptr }
+        //           Bin            Cpx            Dir      Flt             Int             Lbl      Lst      Mat      Prg      Rat             Str           Vec      Bfl             Mod
+        /* Bin */  { E::to_binary,  E::to_complex, nullptr, E::to_float,    E::to_integer,  nullptr, nullptr, nullptr, nullptr, nullptr,        nullptr,      nullptr, nullptr,        nullptr        },
+        /* Cpx */  { E::to_complex, E::to_complex, nullptr, E::to_complex,  nullptr,        nullptr, nullptr, nullptr, nullptr, nullptr,        nullptr,      nullptr, nullptr,        nullptr        },
+        /* Dir */  { nullptr,       nullptr,       nullptr, nullptr,        nullptr,        nullptr, nullptr, nullptr, nullptr, nullptr,        nullptr,      nullptr, nullptr,        nullptr        },
+        /* Flt */  { E::to_float,   E::to_complex, nullptr, E::to_float,    E::to_float,    nullptr, nullptr, nullptr, nullptr, E::to_float,    nullptr,      nullptr, E::to_bigfloat, nullptr        },
+        /* Int */  { E::to_integer, nullptr,       nullptr, E::to_float,    E::duplicate,   nullptr, nullptr, nullptr, nullptr, nullptr,        nullptr,      nullptr, E::to_bigfloat, E::to_modular  },
+        /* Lbl */  { nullptr,       nullptr,       nullptr, nullptr,        nullptr,        nullptr, nullptr, nullptr, nullptr, nullptr,        nullptr,      nullptr, nullptr,        nullptr        },
+        /* Lst */  { nullptr,       nullptr,       nullptr, nullptr,        nullptr,        nullptr, nullptr, nullptr, nullptr, nullptr,        nullptr,      nullptr, nullptr,        nullptr        },
+        /* Mat */  { nullptr,       nullptr,       nullptr, nullptr,        nullptr,        nullptr, nullptr, nullptr, nullptr, nullptr,        nullptr,      nullptr, nullptr,        nullptr        },
+        /* Prg */  { nullptr,       nullptr,       nullptr, nullptr,        nullptr,        nullptr, nullptr, nullptr, nullptr, nullptr,        nullptr,      nullptr, nullptr,        nullptr        },
+        /* Rat */  { nullptr,       nullptr,       nullptr, E::to_float,    nullptr,        nullptr, nullptr, nullptr, nullptr, E::to_rational, nullptr,      nullptr, E::to_bigfloat, nullptr        },
+        /* Str */  { nullptr,       nullptr,       nullptr, nullptr,        nullptr,        nullptr, nullptr, nullptr, nullptr, nullptr,        E::to_string, nullptr, nullptr,        nullptr        },
+        /* Vec */  { nullptr,       nullptr,       nullptr, nullptr,        nullptr,        nullptr, nullptr, nullptr, nullptr, nullptr,        nullptr,      nullptr, nullptr,        nullptr        },
+        /* Bfl */  { nullptr,       nullptr,       nullptr, E::to_bigfloat, E::to_bigfloat, nullptr, nullptr, nullptr, nullptr, E::to_bigfloat, nullptr,      nullptr, E::duplicate,   nullptr        },
+        /* Mod */  { nullptr,       nullptr,       nullptr, nullptr,        E::to_modular,  nullptr, nullptr, nullptr, nullptr, nullptr,        nullptr,      nullptr, nullptr,        E::to_modular  }
     };
 }
@@ -9,7 +9,7 @@
 #include "Entity.hpp"
 
 namespace clac::entity {
-    constexpr int type_count = 12;
+    constexpr int type_count = 14;
 
     extern Entity* (Entity::* convert_table[type_count][type_count])() const;
 }
@@ -0,0 +1,378 @@
+/*! \file    divide.cpp
+ *  \brief   Subquadratic division of natural numbers.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * Small divisors use schoolbook division (divrem_basecase). Larger divisors use the recursive
+ * algorithm of Burnikel and Ziegler, which reduces division to multiplication and so inherits
+ * the speed of the Karatsuba, Toom-3, and NTT multipliers. The largest divisors use Newton's
+ * iteration to compute an approximate reciprocal of the divisor once. Each block of the
+ * quotient then costs two multiplications.
+ *
+ * In both of the fast methods the numerator is processed in blocks the size of the (possibly
+ * padded) divisor, like the digits of ordinary long division. Each step divides a two block
+ * value by the one block divisor.
+ *
+ * Divisions known to be exact, such as removing a GCD, use Jebelean's method instead when the
+ * divisor is small. It works from the least significant end: each quotient limb is the low limb
+ * of the remainder times the inverse of the divisor modulo 2^64, so no quotient limb has to be
+ * estimated and corrected.
+ *
+ * References:
+ *
+ * + Knuth, "The Art of Computer Programming," Volume 2, Section 4.3.1.
+ * + Burnikel and Ziegler, "Fast Recursive Division," MPI-I-98-1-022, 1998.
+ * + Brent and Zimmermann, "Modern Computer Arithmetic," Sections 1.4 and 3.4.
+ * + Jebelean, "An Algorithm for Exact Division," Journal of Symbolic Computation 15, 1993.
+ */
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <utility>
+
+#include "arithmetic.hpp"
+#include "backend.hpp"
+#include "kernels.hpp"
+
+using namespace std;
+
+namespace clac::arithmetic {
+    namespace {
+
+        //! Returns the limbs [begin, end) of a number as a normalized value.
+        natural_t slice(const natural_t& number, size_t begin, size_t end)
+        {
+            begin = min(begin, number.size());
+            end = min(end, number.size());
+            natural_t result(number.begin() + begin, number.begin() + end);
+            normalize(result);
+            return result;
+        }
+
+        //! Returns number * B^limb_count.
+        natural_t shift_limbs(const natural_t& number, size_t limb_count)
+        {
+            if (number.empty())
+                return number;
+            natural_t result(limb_count, 0);
+            result.insert(result.end(), number.begin(), number.end());
+            return result;
+        }
+
+        //! Returns B^limb_count - 1.
+        natural_t all_ones(size_t limb_count)
+        {
+            return natural_t(limb_count, ~limb_t{0});
+        }
+
+        //! Returns B^limb_count.
+        natural_t power_of_base(size_t limb_count)
+        {
+            natural_t result(limb_count + 1, 0);
+            result[limb_count] = 1;
+            return result;
+        }
+
+        const natural_t one = {1};
+
+        //
+        // Schoolbook division. The divisor must be nonzero and its most significant bit must be
+        // set.
+        //
+        void divide_basecase(const natural_t& a, const natural_t& d, natural_t& q, natural_t& r)
+        {
+            if (compare(a, d) < 0) {
+                q.clear();
+                r = a;
+                return;
+            }
+            if (d.size() == 1) {
+                q.assign(a.size(), 0);
+                r.assign(1, divrem_1(q.data(), a.data(), a.size(), d[0]));
+            }
+            else {
+                q.assign(a.size() - d.size() + 1, 0);
+                r = a;
+                q.back() = divrem_basecase(q.data(), r.data(), r.size(), d.data(), d.size());
+            }
+            normalize(q);
+            normalize(r);
+        }
+
+        // Burnikel-Ziegler.
+        // -----------------
+
+        void divide_3n_2n(
+            const natural_t& a, const natural_t& b, size_t h, natural_t& q, natural_t& r);
+
+        //
+        // Divides a by b where b has exactly n limbs with its most significant bit set and
+        // a < b * B^n. The quotient therefore has at most n limbs.
+        //
+        void divide_2n_1n(
+            const natural_t& a, const natural_t& b, size_t n, natural_t& q, natural_t& r)
+        {
+            if (n % 2 != 0 || n < max<size_t>(thresholds().burnikel_ziegler, 2)) {
+                divide_basecase(a, b, q, r);
+                return;
+            }
+
+            const size_t h = n / 2;
+            natural_t q1, q2, r1;
+            divide_3n_2n(slice(a, h, 4 * h), b, h, q1, r1);
+            divide_3n_2n(add(shift_limbs(r1, h), slice(a, 0, h)), b, h, q2, r);
+            q = add(shift_limbs(q1, h), q2);
+        }
+
+        //
+        // Divides a by b where b has exactly 2h limbs with its most significant bit set and
+        // a < b * B^h. The top half of b produces a quotient estimate that is at most two too
+        // large.
+        //
+        void divide_3n_2n(
+            const natural_t& a, const natural_t& b, size_t h, natural_t& q, natural_t& r)
+        {
+            const natural_t b1 = slice(b, h, 2 * h);
+            const natural_t b2 = slice(b, 0, h);
+            const natural_t a12 = slice(a, h, 3 * h);
+
+            natural_t r1;
+            if (compare(slice(a, 2 * h, 3 * h), b1) < 0) {
+                divide_2n_1n(a12, b1, h, q, r1);
+            }
+            else {
+                // The quotient estimate is B^h - 1 and a12 - q*b1 = a12 - b1*B^h + b1.
+                q = all_ones(h);
+                r1 = add(subtract(a12, shift_limbs(b1, h)), b1);
+            }
+
+            const natural_t d = multiply(q, b2);
+            natural_t x = add(shift_limbs(r1, h), slice(a, 0, h));
+            while (compare(x, d) < 0) {
+                x = add(x, b);
+                q = subtract(q, one);
+            }
+            r = subtract(x, d);
+        }
+
+        // Newton's method.
+        // ----------------
+
+        //
+        // Returns an approximation to B^(2n)/d where d has n limbs with its most significant
+        // bit set. The result is within a few units of the exact value. The reciprocal of the
+        // top half of d, computed recursively, is refined with one Newton step
+        //
+        //   x' = x + x * (B^(2n) - d*x) / B^(2n)
+        //
+        // which doubles the number of correct limbs.
+        //
+        natural_t reciprocal(const natural_t& d)
+        {
+            const size_t n = d.size();
+            if (n <= max<size_t>(thresholds().burnikel_ziegler, 4)) {
+                natural_t q, r;
+                divide_basecase(power_of_base(2 * n), d, q, r);
+                return q;
+            }
+
+            // The starting value is y * B^l. The factor B^l is applied after the
+            // multiplications so that they do not spend time on its zero limbs.
+            const size_t h = (n + 1) / 2 + 1;
+            const size_t l = n - h;
+            const natural_t y = reciprocal(slice(d, l, n));
+            const natural_t x = shift_limbs(y, l);
+
+            const natural_t product = shift_limbs(multiply(d, y), l);
+            const natural_t scale = power_of_base(2 * n);
+            if (compare(product, scale) <= 0) {
+                const natural_t error = subtract(scale, product);
+                return add(x, shift_right(multiply(y, error), (2 * n - l) * LIMB_BITS));
+            }
+            const natural_t error = subtract(product, scale);
+            const natural_t correction = shift_right(multiply(y, error), (2 * n - l) * LIMB_BITS);
+            return subtract(x, add(correction, one));
+        }
+
+        //
+        // Divides a by d, where a < d * B^n and d has n limbs with its most significant bit
+        // set, using the precomputed reciprocal of d. The estimated quotient is adjusted until
+        // the remainder is in range.
+        //
+        void divide_newton(
+            const natural_t& a,
+            const natural_t& d,
+            const natural_t& inverse,
+            natural_t& q,
+            natural_t& r)
+        {
+            const size_t n = d.size();
+            const natural_t a_top = shift_right(a, (n - 1) * LIMB_BITS);
+            q = shift_right(multiply(a_top, inverse), (n + 1) * LIMB_BITS);
+
+            natural_t product = multiply(q, d);
+            while (compare(product, a) > 0) {
+                product = subtract(product, d);
+                q = subtract(q, one);
+            }
+            r = subtract(a, product);
+            while (compare(r, d) >= 0) {
+                r = subtract(r, d);
+                q = add(q, one);
+            }
+        }
+
+        //! Returns the inverse of an odd limb modulo 2^64.
+        limb_t inverse_limb(limb_t odd) noexcept
+        {
+            // Three times odd, xor 2, is correct to five bits. Newton's iteration doubles that.
+            limb_t inverse = (3 * odd) ^ 2;
+            for (int i = 0; i < 4; ++i) {
+                inverse *= 2 - odd * inverse;
+            }
+            return inverse;
+        }
+
+        //
+        // Returns number / divisor, which must be exact, using the number as working space. The
+        // divisor must be odd and, with the number, nonzero. The quotient has at most
+        // n - m + 1 limbs, so it is determined by the number modulo B^(n - m + 1), and the
+        // rows of the subtraction that fall above that are cut short.
+        //
+        natural_t divide_exact_basecase(natural_t& number, const natural_t& divisor)
+        {
+            const size_t n = number.size();
+            const size_t m = divisor.size();
+            if (n < m)
+                return natural_t();
+
+            const size_t quotient_size = n - m + 1;
+            const limb_t inverse = inverse_limb(divisor[0]);
+            natural_t quotient(quotient_size);
+            limb_t* r = number.data();
+            for (size_t i = 0; i < quotient_size; ++i) {
+                const limb_t q = r[i] * inverse;
+                quotient[i] = q;
+                const size_t row = min(m, quotient_size - i);
+                limb_t borrow = submul_1(r + i, divisor.data(), row, q);
+                for (size_t j = i + row; borrow != 0 && j < quotient_size; ++j) {
+                    const limb_t before = r[j];
+                    r[j] = before - borrow;
+                    borrow = static_cast<limb_t>(before < borrow);
+                }
+            }
+            normalize(quotient);
+            return quotient;
+        }
+
+        //! Returns number / divisor, which must be exact, consuming the number.
+        natural_t divide_exact_consuming(natural_t number, const natural_t& divisor)
+        {
+            if (divisor.empty())
+                throw domain_error("division by zero");
+            if (number.empty())
+                return natural_t();
+            if (divisor.size() == 1 && divisor[0] == 1)
+                return number;
+
+            if (divisor.size() >= max<size_t>(thresholds().burnikel_ziegler, 2)) {
+                natural_t quotient, remainder;
+                divide(number, divisor, quotient, remainder);
+                return quotient;
+            }
+
+            // Both have at least as many low order zero bits as the divisor. Removing them makes
+            // the divisor odd.
+            size_t zero_limbs = 0;
+            while (divisor[zero_limbs] == 0)
+                ++zero_limbs;
+            const size_t zero_bits =
+                zero_limbs * LIMB_BITS + static_cast<size_t>(countr_zero(divisor[zero_limbs]));
+            if (zero_bits == 0)
+                return divide_exact_basecase(number, divisor);
+            natural_t shifted = shift_right(number, zero_bits);
+            return divide_exact_basecase(shifted, shift_right(divisor, zero_bits));
+        }
+
+    } // namespace
+
+
+    void native::divide(
+        const natural_t& numerator,
+        const natural_t& denominator,
+        natural_t& quotient,
+        natural_t& remainder)
+    {
+        if (denominator.empty())
+            throw domain_error("division by zero");
+
+        if (compare(numerator, denominator) < 0) {
+            quotient.clear();
+            remainder = numerator;
+            return;
+        }
+
+        // Normalize so that the most significant bit of the divisor is set. Both operands are
+        // shifted by the same amount, which leaves the quotient unchanged.
+        const size_t shift = static_cast<size_t>(countl_zero(denominator.back()));
+        natural_t a = shift_left(numerator, shift);
+        natural_t d = shift_left(denominator, shift);
+
+        const Thresholds& limits = thresholds();
+        const bool use_newton = d.size() >= limits.newton;
+        if (!use_newton && d.size() < max<size_t>(limits.burnikel_ziegler, 2)) {
+            divide_basecase(a, d, quotient, remainder);
+            remainder = shift_right(remainder, shift);
+            return;
+        }
+
+        // Burnikel-Ziegler wants a block size that halves evenly down to the basecase, so the
+        // divisor is padded with low order zero limbs to j * 2^k limbs for a small j.
+        size_t padding = 0;
+        if (!use_newton) {
+            size_t block = d.size();
+            size_t k = 0;
+            while (block >= max<size_t>(limits.burnikel_ziegler, 2)) {
+                block = (block + 1) / 2;
+                ++k;
+            }
+            padding = (block << k) - d.size();
+            a = shift_limbs(a, padding);
+            d = shift_limbs(d, padding);
+        }
+        const size_t n = d.size();
+        const natural_t inverse = use_newton ? reciprocal(d) : natural_t();
+
+        // Long division with blocks of n limbs, starting with the top block. Each block of the
+        // quotient is less than B^n, so it can be copied directly into place.
+        const size_t block_count = (a.size() + n - 1) / n;
+        natural_t r;
+        quotient.assign(block_count * n, 0);
+        for (size_t i = block_count; i > 0; --i) {
+            const natural_t current = add(shift_limbs(r, n), slice(a, (i - 1) * n, i * n));
+            natural_t q;
+            if (use_newton)
+                divide_newton(current, d, inverse, q, r);
+            else
+                divide_2n_1n(current, d, n, q, r);
+            copy(q.begin(), q.end(), quotient.begin() + static_cast<ptrdiff_t>((i - 1) * n));
+        }
+        normalize(quotient);
+        remainder = shift_right(r, padding * LIMB_BITS + shift);
+    }
+
+
+
+    natural_t native::divide_exact(const natural_t& number, const natural_t& divisor)
+    {
+        return divide_exact_consuming(number, divisor);
+    }
+
+
+    natural_t multiply_divide_exact(
+        const natural_t& left, const natural_t& right, const natural_t& divisor)
+    {
+        return divide_exact_consuming(multiply(left, right), divisor);
+    }
+
+} // namespace clac::arithmetic
@@ -0,0 +1,465 @@
+/*! \file    gcd.cpp
+ *  \brief   Greatest common divisors of natural numbers.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * Euclid's algorithm makes a pass over both numbers for every quotient, and most quotients are
+ * small, so it needs about one pass per bit or two of the numbers. Lehmer's algorithm runs
+ * Euclid's algorithm on the leading bits of the numbers instead, for as long as those bits are
+ * enough to determine the quotients, and collects the steps in a matrix of single limb
+ * cofactors. One linear pass then applies all of those steps to the full numbers. Here the
+ * leading part is 62 bits, a double digit in terms of 31-bit half limbs, and it yields
+ * cofactors of about 30 bits, so each pass removes about 30 bits from the numbers.
+ *
+ * Lehmer's algorithm is still quadratic. For large numbers the half-GCD algorithm finds the
+ * matrix that reduces a pair of n limb numbers to about n/2 limbs using only the top halves of
+ * the numbers, computed recursively, so that the work is dominated by multiplications of the
+ * matrix entries. The whole GCD then takes O(M(n) log(n)) time.
+ *
+ * Every matrix used here has determinant plus or minus one, so applying its inverse to a pair
+ * of numbers preserves their GCD. The results are checked, and a matrix that would produce a
+ * negative number or fail to make progress is discarded in favor of an ordinary division step.
+ * Thus the GCD is correct even if the recursion stops at a different quotient than the theory
+ * says it should.
+ *
+ * A modular inverse is found by extended Euclid: the Lehmer and division steps are also applied
+ * to the cofactors that express each remainder as a multiple of the number, modulo the modulus.
+ * That keeps the cofactors no larger than the modulus, but the extra work is quadratic, so the
+ * half-GCD is not used for inverses.
+ *
+ * References:
+ *
+ * + Cohen, "A Course in Computational Algebraic Number Theory," Algorithm 1.3.7.
+ * + Jebelean, "A Double-Digit Lehmer-Euclid Algorithm for Finding the GCD of Long Integers,"
+ *   Journal of Symbolic Computation 19, 1995.
+ * + Möller, "On Schönhage's Algorithm and Subquadratic Integer GCD Computation," Mathematics of
+ *   Computation 77, 2008.
+ * + Brent and Zimmermann, "Modern Computer Arithmetic," Section 1.6.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+#include "arithmetic.hpp"
+#include "backend.hpp"
+#include "kernels.hpp"
+#include "modular.hpp"
+
+using namespace std;
+
+namespace clac::arithmetic {
+    namespace {
+
+        // Lehmer steps look at this many leading bits, which leaves room for the cofactors in the
+        // signed arithmetic of the inner loop.
+        constexpr size_t LEADING_BITS = 62;
+
+        // The half-GCD recursion is not used below this size, whatever the threshold says.
+        constexpr size_t MINIMUM_HALF_GCD = 8;
+
+        const natural_t one = {1};
+
+        //
+        // A matrix M with nonnegative entries and determinant plus or minus one. It records the
+        // reduction of a pair (a, b) to a pair (x, y) with (a, b) = M (x, y).
+        //
+        struct Matrix {
+            natural_t entry[2][2] = {{one, natural_t()}, {natural_t(), one}};
+
+            void swap_columns() noexcept
+            {
+                entry[0][0].swap(entry[0][1]);
+                entry[1][0].swap(entry[1][1]);
+            }
+        };
+
+        //
+        // The cofactors of a Lehmer step: the new pair is (A*a + B*b, C*a + D*b). In each row one
+        // entry is positive and the other is negative or zero.
+        //
+        struct Cofactors {
+            int64_t A, B, C, D;
+        };
+
+        //! Returns the 64 bits of number starting at bit 'position'.
+        limb_t bits_at(const natural_t& number, size_t position) noexcept
+        {
+            const size_t index = position / LIMB_BITS;
+            const unsigned offset = static_cast<unsigned>(position % LIMB_BITS);
+            if (index >= number.size())
+                return 0;
+            limb_t result = number[index] >> offset;
+            if (offset != 0 && index + 1 < number.size())
+                result |= number[index + 1] << (LIMB_BITS - offset);
+            return result;
+        }
+
+        //! Returns number / B^limb_count.
+        natural_t high_part(const natural_t& number, size_t limb_count)
+        {
+            if (limb_count >= number.size())
+                return natural_t();
+            return natural_t(number.begin() + static_cast<ptrdiff_t>(limb_count), number.end());
+        }
+
+        //! Sets result to s*x - t*y. Returns false if that value is negative.
+        bool multiply_subtract(
+            const natural_t& x, limb_t s, const natural_t& y, limb_t t, natural_t& result)
+        {
+            const size_t size = max(x.size(), y.size()) + 1;
+            result.assign(size, 0);
+            result[x.size()] = mul_1(result.data(), x.data(), x.size(), s);
+            limb_t borrow = submul_1(result.data(), y.data(), y.size(), t);
+            borrow = sub_1(
+                result.data() + y.size(), result.data() + y.size(), size - y.size(), borrow);
+            normalize(result);
+            return borrow == 0;
+        }
+
+        //! Returns s*x + t*y.
+        natural_t multiply_add(const natural_t& x, limb_t s, const natural_t& y, limb_t t)
+        {
+            const size_t size = max(x.size(), y.size()) + 2;
+            natural_t result(size, 0);
+            result[x.size()] = mul_1(result.data(), x.data(), x.size(), s);
+            limb_t carry = addmul_1(result.data(), y.data(), y.size(), t);
+            add_1(result.data() + y.size(), result.data() + y.size(), size - y.size(), carry);
+            normalize(result);
+            return result;
+        }
+
+        //! Sets result to p*a + q*b, where p and q have opposite signs. Returns false if negative.
+        bool combine(const natural_t& a, int64_t p, const natural_t& b, int64_t q, natural_t& result)
+        {
+            if (q <= 0)
+                return multiply_subtract(
+                    a, static_cast<limb_t>(p), b, static_cast<limb_t>(-q), result);
+            return multiply_subtract(b, static_cast<limb_t>(q), a, static_cast<limb_t>(-p), result);
+        }
+
+        //
+        // Runs Euclid's algorithm on the leading bits of a and b, where a >= b, for as long as
+        // the quotients are certain to be those of the full numbers. The bounds (x + A)/(y + C)
+        // and (x + B)/(y + D) bracket the ratio of the current remainders of the full numbers, so
+        // a quotient is certain when both bounds give it. Returns false if not even the first
+        // quotient could be determined.
+        //
+        bool lehmer_cofactors(const natural_t& a, const natural_t& b, Cofactors& m) noexcept
+        {
+            const size_t a_bits = bit_length(a);
+            const size_t shift = (a_bits > LEADING_BITS) ? a_bits - LEADING_BITS : 0;
+            int64_t x = static_cast<int64_t>(bits_at(a, shift));
+            int64_t y = static_cast<int64_t>(bits_at(b, shift));
+            int64_t A = 1, B = 0, C = 0, D = 1;
+
+            while (y + C > 0 && y + D > 0 && x + A >= 0 && x + B >= 0) {
+                const int64_t q = (x + A) / (y + C);
+                if (q != (x + B) / (y + D))
+                    break;
+                int64_t t = A - q * C;
+                A = C;
+                C = t;
+                t = B - q * D;
+                B = D;
+                D = t;
+                t = x - q * y;
+                x = y;
+                y = t;
+            }
+            m = {A, B, C, D};
+            return B != 0;
+        }
+
+        //! Applies a Lehmer step to a >= b. Returns false, changing nothing, if there is none.
+        bool lehmer_step(natural_t& a, natural_t& b, Cofactors& m)
+        {
+            natural_t x, y;
+            if (!lehmer_cofactors(a, b, m) || !combine(a, m.A, b, m.B, x) ||
+                !combine(a, m.C, b, m.D, y))
+                return false;
+            a.swap(x);
+            b.swap(y);
+            return true;
+        }
+
+        //! Replaces (a, b) with (b, a mod b).
+        void division_step(natural_t& a, natural_t& b)
+        {
+            natural_t quotient, remainder;
+            divide(a, b, quotient, remainder);
+            a.swap(b);
+            b.swap(remainder);
+        }
+
+        //! Returns the GCD of a and a single nonzero limb.
+        limb_t gcd_1(const natural_t& a, limb_t b)
+        {
+            natural_t scratch(a.size());
+            return std::gcd(divrem_1(scratch.data(), a.data(), a.size(), b), b);
+        }
+
+        //! Returns left * right.
+        Matrix multiply(const Matrix& left, const Matrix& right)
+        {
+            Matrix result;
+            for (int i = 0; i < 2; ++i) {
+                for (int j = 0; j < 2; ++j) {
+                    result.entry[i][j] = add(
+                        arithmetic::multiply(left.entry[i][0], right.entry[0][j]),
+                        arithmetic::multiply(left.entry[i][1], right.entry[1][j]));
+                }
+            }
+            return result;
+        }
+
+        //
+        // Replaces (a, b) with M^(-1) (a, b). Since the determinant is plus or minus one, the
+        // inverse is plus or minus (u11*a - u01*b, u00*b - u10*a). If M really reduces (a, b)
+        // both differences have the sign of the determinant. Returns false, changing nothing, if
+        // they do not.
+        //
+        bool apply_inverse(const Matrix& m, natural_t& a, natural_t& b)
+        {
+            const natural_t t1 = arithmetic::multiply(m.entry[1][1], a);
+            const natural_t t2 = arithmetic::multiply(m.entry[0][1], b);
+            const natural_t t3 = arithmetic::multiply(m.entry[0][0], b);
+            const natural_t t4 = arithmetic::multiply(m.entry[1][0], a);
+            const int c1 = compare(t1, t2);
+            const int c2 = compare(t3, t4);
+            if (!((c1 >= 0 && c2 >= 0) || (c1 <= 0 && c2 <= 0)))
+                return false;
+
+            a = (c1 >= 0) ? subtract(t1, t2) : subtract(t2, t1);
+            b = (c2 >= 0) ? subtract(t3, t4) : subtract(t4, t3);
+            return true;
+        }
+
+        //
+        // Takes one or more Euclidean steps on (a, b), recording them in m, provided the result
+        // still has |a - b| > B^s. Returns false if no step is possible. This is the stopping rule
+        // of Möller's formulation of the half-GCD. A Lehmer step is tried first. If it overshoots,
+        // a single quotient is taken, reduced by one if necessary to stay above the limit.
+        //
+        bool reduction_step(natural_t& a, natural_t& b, size_t s, Matrix& m)
+        {
+            if (compare(a, b) < 0) {
+                a.swap(b);
+                m.swap_columns();
+            }
+            if (a.size() <= s || b.empty())
+                return false;
+
+            Cofactors c;
+            natural_t x, y;
+            if (lehmer_cofactors(a, b, c) && combine(a, c.A, b, c.B, x) &&
+                combine(a, c.C, b, c.D, y)) {
+                const natural_t difference = (compare(x, y) >= 0) ? subtract(x, y) : subtract(y, x);
+                if (difference.size() > s) {
+                    // (a, b) = Q (x, y) where Q is the inverse of the cofactor matrix.
+                    const auto A = static_cast<limb_t>(c.A < 0 ? -c.A : c.A);
+                    const auto B = static_cast<limb_t>(c.B < 0 ? -c.B : c.B);
+                    const auto C = static_cast<limb_t>(c.C < 0 ? -c.C : c.C);
+                    const auto D = static_cast<limb_t>(c.D < 0 ? -c.D : c.D);
+                    for (int i = 0; i < 2; ++i) {
+                        natural_t first = multiply_add(m.entry[i][0], D, m.entry[i][1], C);
+                        natural_t second = multiply_add(m.entry[i][0], B, m.entry[i][1], A);
+                        m.entry[i][0].swap(first);
+                        m.entry[i][1].swap(second);
+                    }
+                    a.swap(x);
+                    b.swap(y);
+                    return true;
+                }
+            }
+
+            natural_t difference = subtract(a, b);
+            if (difference.size() <= s)
+                return false;
+
+            // a = (q + 1)*b + r. If r is too small, take one fewer b away.
+            natural_t q, r;
+            divide(difference, b, q, r);
+            if (r.size() <= s)
+                r = add(r, b);
+            else
+                q = add(q, one);
+            a.swap(r);
+            for (int i = 0; i < 2; ++i) {
+                m.entry[i][1] = add(m.entry[i][1], arithmetic::multiply(q, m.entry[i][0]));
+            }
+            return true;
+        }
+
+        //
+        // Reduces (a, b), with at most n limbs each, until |a - b| has about n/2 limbs, and sets
+        // m to the matrix of the reduction. Returns false if no reduction was possible. Above the
+        // threshold, the top halves are reduced recursively to find most of the matrix, twice,
+        // and a few single steps make up the rest.
+        //
+        bool half_gcd(natural_t& a, natural_t& b, Matrix& m)
+        {
+            m = Matrix();
+            const size_t n = max(a.size(), b.size());
+            const size_t s = n / 2 + 1;
+            if (min(a.size(), b.size()) <= s)
+                return false;
+
+            bool progress = false;
+            if (n >= max(thresholds().half_gcd, MINIMUM_HALF_GCD)) {
+                // Reduce the top n/2 limbs. That brings (a, b) down to about 3n/4 limbs.
+                natural_t a_high = high_part(a, n / 2);
+                natural_t b_high = high_part(b, n / 2);
+                Matrix m1;
+                if (half_gcd(a_high, b_high, m1) && apply_inverse(m1, a, b)) {
+                    m = move(m1);
+                    progress = true;
+                }
+                while (max(a.size(), b.size()) > 3 * n / 4 + 1) {
+                    if (!reduction_step(a, b, s, m))
+                        return progress;
+                    progress = true;
+                }
+
+                // Reduce the top limbs again, choosing the split so the stopping point is s.
+                const size_t current = max(a.size(), b.size());
+                if (current > s + 2) {
+                    const size_t p = 2 * s - current + 1;
+                    a_high = high_part(a, p);
+                    b_high = high_part(b, p);
+                    Matrix m2;
+                    if (half_gcd(a_high, b_high, m2) && apply_inverse(m2, a, b)) {
+                        m = multiply(m, m2);
+                        progress = true;
+                    }
+                }
+            }
+            while (reduction_step(a, b, s, m))
+                progress = true;
+            return progress;
+        }
+
+        //
+        // Applies the half-GCD of the top third of a and b. Returns false, changing nothing,
+        // if that doesn't make a smaller.
+        //
+        bool half_gcd_step(natural_t& a, natural_t& b)
+        {
+            const size_t p = 2 * a.size() / 3;
+            natural_t a_high = high_part(a, p);
+            natural_t b_high = high_part(b, p);
+            Matrix m;
+            if (!half_gcd(a_high, b_high, m))
+                return false;
+
+            natural_t x = a;
+            natural_t y = b;
+            if (!apply_inverse(m, x, y) || max(x.size(), y.size()) >= a.size())
+                return false;
+            a.swap(x);
+            b.swap(y);
+            if (compare(a, b) < 0)
+                a.swap(b);
+            return true;
+        }
+
+        //! Returns number mod modulus.
+        natural_t reduced(const natural_t& number, const natural_t& modulus)
+        {
+            natural_t quotient, remainder;
+            divide(number, modulus, quotient, remainder);
+            return remainder;
+        }
+
+        //! Returns (p*x + q*y) mod modulus, for x and y less than the modulus.
+        natural_t combine_mod(
+            const natural_t& x, int64_t p, const natural_t& y, int64_t q,
+            const natural_t& modulus)
+        {
+            auto scaled = [&modulus](const natural_t& number, int64_t factor) {
+                if (factor == 0 || number.empty())
+                    return natural_t();
+                const natural_t magnitude{static_cast<limb_t>(factor < 0 ? -factor : factor)};
+                const natural_t product = arithmetic::multiply(number, magnitude);
+                const natural_t remainder = reduced(product, modulus);
+                return (factor < 0) ? subtract_mod(natural_t(), remainder, modulus) : remainder;
+            };
+            return add_mod(scaled(x, p), scaled(y, q), modulus);
+        }
+
+    } // namespace
+
+
+    natural_t native::gcd(const natural_t& left, const natural_t& right)
+    {
+        natural_t a = left;
+        natural_t b = right;
+        if (compare(a, b) < 0)
+            a.swap(b);
+
+        const size_t threshold = max(thresholds().half_gcd, MINIMUM_HALF_GCD);
+        while (b.size() > 1) {
+            if (b.size() >= threshold && b.size() + 1 >= a.size() && half_gcd_step(a, b))
+                continue;
+            Cofactors m;
+            if (!lehmer_step(a, b, m))
+                division_step(a, b);
+        }
+
+        if (b.empty())
+            return a;
+        return natural_t{gcd_1(a, b[0])};
+    }
+
+
+    //
+    // The pair (a, b) starts as (modulus, number) and s*number = a, t*number = b (mod modulus)
+    // hold throughout. When b reaches zero, a is the GCD and s is the inverse if a is one.
+    //
+    bool inverse_mod(const natural_t& number, const natural_t& modulus, natural_t& inverse)
+    {
+        if (modulus.empty())
+            throw domain_error("inverse_mod: zero modulus");
+
+        natural_t a = modulus;
+        natural_t b = reduced(number, modulus);
+        natural_t s;
+        natural_t t = reduced(one, modulus);
+        while (!b.empty()) {
+            Cofactors m;
+            natural_t x, y;
+            if (lehmer_cofactors(a, b, m) && combine(a, m.A, b, m.B, x) &&
+                combine(a, m.C, b, m.D, y)) {
+                natural_t s_next = combine_mod(s, m.A, t, m.B, modulus);
+                natural_t t_next = combine_mod(s, m.C, t, m.D, modulus);
+                a.swap(x);
+                b.swap(y);
+                s.swap(s_next);
+                t.swap(t_next);
+            }
+            else {
+                natural_t quotient, remainder;
+                divide(a, b, quotient, remainder);
+                natural_t t_next =
+                    subtract_mod(s, reduced(arithmetic::multiply(quotient, t), modulus), modulus);
+                a.swap(b);
+                b.swap(remainder);
+                s.swap(t);
+                t.swap(t_next);
+            }
+        }
+
+        if (a != one)
+            return false;
+        inverse = std::move(s);
+        return true;
+    }
+
+
+    spica::VeryLong gcd(const spica::VeryLong& left, const spica::VeryLong& right)
+    {
+        return to_verylong(gcd(to_natural(left), to_natural(right)));
+    }
+
+} // namespace clac::arithmetic
@@ -0,0 +1,231 @@
+/*! \file    gmp_backend.cpp
+ *  \brief   A backend that performs the costly natural_t operations with GMP.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * GMP is used only when Clac is built with the CMake option CLAC_GMP and the library is found,
+ * in which case CLAC_HAVE_GMP is defined. Otherwise gmp_backend() reports that there is no such
+ * backend and this file contributes nothing else.
+ *
+ * A natural_t has the layout GMP's mpn functions expect: 64-bit limbs, least significant first,
+ * with no high order zeros. Multiplication and division write straight into the limbs of the
+ * result with mpn_mul, mpn_sqr, and mpn_tdiv_qr. The other operations need GMP's mpz layer; the
+ * operands are wrapped in place with mpz_roinit_n, so only the result is copied.
+ *
+ * GMP does its own memory management for its mpz temporaries and does not use the limb pool.
+ * Its multiplication is sequential, so set_thread_count has no effect while it is active.
+ *
+ * References:
+ *
+ * + The GNU Multiple Precision Arithmetic Library manual, Chapter 8, "Low-level Functions."
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "arithmetic.hpp"
+#include "backend.hpp"
+
+#if defined(CLAC_HAVE_GMP)
+#include <gmp.h>
+#endif
+
+using namespace std;
+
+namespace clac::arithmetic {
+
+#if defined(CLAC_HAVE_GMP)
+
+    namespace {
+
+        static_assert(GMP_NUMB_BITS == LIMB_BITS && sizeof(mp_limb_t) == sizeof(limb_t),
+                      "GMP limbs must be the same as Clac limbs");
+
+        mp_limb_t* limbs(natural_t& number) noexcept
+        {
+            return reinterpret_cast<mp_limb_t*>(number.data());
+        }
+
+        const mp_limb_t* limbs(const natural_t& number) noexcept
+        {
+            return reinterpret_cast<const mp_limb_t*>(number.data());
+        }
+
+        //! An mpz_t that owns its limbs.
+        class Integer {
+        public:
+            Integer() { mpz_init(value); }
+            ~Integer() { mpz_clear(value); }
+            Integer(const Integer&) = delete;
+            Integer& operator=(const Integer&) = delete;
+
+            mpz_ptr get() noexcept { return value; }
+
+            natural_t release() const
+            {
+                const mp_limb_t* first = mpz_limbs_read(value);
+                const size_t size = mpz_size(value);
+                natural_t result(size);
+                copy(first, first + size, limbs(result));
+                return result;
+            }
+
+        private:
+            mpz_t value;
+        };
+
+        //! A read-only mpz_t that shares the limbs of a natural_t.
+        class View {
+        public:
+            explicit View(const natural_t& number) noexcept
+            {
+                mpz_roinit_n(value, limbs(number), static_cast<mp_size_t>(number.size()));
+            }
+
+            mpz_srcptr get() const noexcept { return value; }
+
+        private:
+            mpz_t value;
+        };
+
+        natural_t gmp_multiply(const natural_t& left, const natural_t& right)
+        {
+            if (left.empty() || right.empty())
+                return natural_t();
+
+            const natural_t& a = (left.size() >= right.size()) ? left : right;
+            const natural_t& b = (left.size() >= right.size()) ? right : left;
+            natural_t result(a.size() + b.size());
+            mpn_mul(limbs(result),
+                    limbs(a), static_cast<mp_size_t>(a.size()),
+                    limbs(b), static_cast<mp_size_t>(b.size()));
+            normalize(result);
+            return result;
+        }
+
+
+        natural_t gmp_square(const natural_t& number)
+        {
+            if (number.empty())
+                return natural_t();
+
+            natural_t result(2 * number.size());
+            mpn_sqr(limbs(result), limbs(number), static_cast<mp_size_t>(number.size()));
+            normalize(result);
+            return result;
+        }
+
+
+        void gmp_divide(
+            const natural_t& numerator,
+            const natural_t& denominator,
+            natural_t& quotient,
+            natural_t& remainder)
+        {
+            if (denominator.empty())
+                throw domain_error("division by zero");
+
+            if (compare(numerator, denominator) < 0) {
+                quotient.clear();
+                remainder = numerator;
+                return;
+            }
+
+            natural_t q(numerator.size() - denominator.size() + 1);
+            natural_t r(denominator.size());
+            mpn_tdiv_qr(limbs(q), limbs(r), 0,
+                        limbs(numerator), static_cast<mp_size_t>(numerator.size()),
+                        limbs(denominator), static_cast<mp_size_t>(denominator.size()));
+            normalize(q);
+            normalize(r);
+            quotient = move(q);
+            remainder = move(r);
+        }
+
+
+        natural_t gmp_divide_exact(const natural_t& number, const natural_t& divisor)
+        {
+            if (divisor.empty())
+                throw domain_error("division by zero");
+
+            Integer result;
+            mpz_divexact(result.get(), View(number).get(), View(divisor).get());
+            return result.release();
+        }
+
+
+        natural_t gmp_gcd(const natural_t& left, const natural_t& right)
+        {
+            Integer result;
+            mpz_gcd(result.get(), View(left).get(), View(right).get());
+            return result.release();
+        }
+
+
+        natural_t gmp_root(const natural_t& number, size_t k, bool& exact)
+        {
+            if (k == 0)
+                throw domain_error("root: index is zero");
+            if (number.empty() || k == 1) {
+                exact = true;
+                return number;
+            }
+
+            Integer result, remainder;
+            mpz_rootrem(result.get(), remainder.get(), View(number).get(), k);
+            exact = mpz_sgn(remainder.get()) == 0;
+            return result.release();
+        }
+
+
+        string gmp_to_decimal(const natural_t& number)
+        {
+            const View value(number);
+            // mpz_sizeinbase may exceed the true length by one, and mpz_get_str adds a null.
+            string result(mpz_sizeinbase(value.get(), 10) + 1, '\0');
+            mpz_get_str(result.data(), 10, value.get());
+            result.resize(strlen(result.c_str()));
+            return result;
+        }
+
+
+        natural_t gmp_from_decimal(string_view digits)
+        {
+            Integer result;
+            mpz_set_str(result.get(), string(digits).c_str(), 10);
+            return result.release();
+        }
+
+
+        constexpr Backend backend = {
+            "gmp",
+            gmp_multiply,
+            gmp_square,
+            gmp_divide,
+            gmp_divide_exact,
+            gmp_gcd,
+            gmp_root,
+            gmp_to_decimal,
+            gmp_from_decimal,
+        };
+
+    } // namespace
+
+
+    const Backend* gmp_backend() noexcept
+    {
+        return &backend;
+    }
+
+#else
+
+    const Backend* gmp_backend() noexcept
+    {
+        return nullptr;
+    }
+
+#endif
+
+} // namespace clac::arithmetic
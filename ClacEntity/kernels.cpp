@@ -0,0 +1,326 @@
+/*! \file    kernels.cpp
+ *  \brief   Portable implementations of the low level limb kernels.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * The kernels with processor-specific versions call through the active KernelSet. Their
+ * portable versions are collected here into the fallback set.
+ */
+
+#include <bit>
+
+#include "kernels.hpp"
+
+namespace clac::arithmetic {
+
+    namespace {
+
+        limb_t portable_add_n(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n) noexcept
+        {
+            limb_t carry = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                const limb_t sum = a[i] + carry;
+                carry = static_cast<limb_t>(sum < carry);
+                r[i] = sum + b[i];
+                carry += static_cast<limb_t>(r[i] < sum);
+            }
+            return carry;
+        }
+
+
+        limb_t portable_sub_n(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n) noexcept
+        {
+            limb_t borrow = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                const limb_t subtrahend = b[i] + borrow;
+                borrow = static_cast<limb_t>(subtrahend < borrow);
+                const limb_t difference = a[i] - subtrahend;
+                borrow += static_cast<limb_t>(difference > a[i]);
+                r[i] = difference;
+            }
+            return borrow;
+        }
+
+
+        limb_t portable_mul_1(limb_t* r, const limb_t* a, std::size_t n, limb_t b) noexcept
+        {
+            limb_t carry = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                limb_t high;
+                limb_t low = multiply_wide(a[i], b, high);
+                low += carry;
+                carry = high + static_cast<limb_t>(low < carry);
+                r[i] = low;
+            }
+            return carry;
+        }
+
+
+        limb_t portable_addmul_1(limb_t* r, const limb_t* a, std::size_t n, limb_t b) noexcept
+        {
+            limb_t carry = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                limb_t high;
+                limb_t low = multiply_wide(a[i], b, high);
+                low += carry;
+                high += static_cast<limb_t>(low < carry);
+                const limb_t sum = r[i] + low;
+                carry = high + static_cast<limb_t>(sum < low);
+                r[i] = sum;
+            }
+            return carry;
+        }
+
+
+        // Without POPCNT, std::popcount compiles to a sequence of shifts, masks, and a multiply.
+        std::size_t portable_popcount_n(const limb_t* a, std::size_t n) noexcept
+        {
+            std::size_t count = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                count += static_cast<std::size_t>(std::popcount(a[i]));
+            }
+            return count;
+        }
+
+
+        constexpr KernelSet portable_kernels = {
+            "portable",
+            portable_add_n,
+            portable_sub_n,
+            portable_mul_1,
+            portable_addmul_1,
+            mul_basecase_with<portable_mul_1, portable_addmul_1>,
+            sqr_basecase_with<portable_mul_1, portable_addmul_1>,
+            portable_popcount_n,
+        };
+
+        //
+        // Calls made during static initialization, before the processor has been checked, use
+        // the portable kernels. CPUID is consulted once, when this file's variables are
+        // initialized.
+        //
+        constinit const KernelSet* active = &portable_kernels;
+
+        [[maybe_unused]] const bool selected = [] {
+            if (const KernelSet* adx = adx_kernels())
+                active = adx;
+            return true;
+        }();
+
+    } // namespace
+
+
+    limb_t add_n(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n) noexcept
+    {
+        return active->add_n(r, a, b, n);
+    }
+
+
+    limb_t sub_n(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n) noexcept
+    {
+        return active->sub_n(r, a, b, n);
+    }
+
+
+    limb_t add_1(limb_t* r, const limb_t* a, std::size_t n, limb_t b) noexcept
+    {
+        limb_t carry = b;
+        for (std::size_t i = 0; i < n; ++i) {
+            const limb_t sum = a[i] + carry;
+            carry = static_cast<limb_t>(sum < carry);
+            r[i] = sum;
+        }
+        return carry;
+    }
+
+
+    limb_t sub_1(limb_t* r, const limb_t* a, std::size_t n, limb_t b) noexcept
+    {
+        limb_t borrow = b;
+        for (std::size_t i = 0; i < n; ++i) {
+            const limb_t difference = a[i] - borrow;
+            borrow = static_cast<limb_t>(difference > a[i]);
+            r[i] = difference;
+        }
+        return borrow;
+    }
+
+
+    limb_t mul_1(limb_t* r, const limb_t* a, std::size_t n, limb_t b) noexcept
+    {
+        return active->mul_1(r, a, n, b);
+    }
+
+
+    limb_t addmul_1(limb_t* r, const limb_t* a, std::size_t n, limb_t b) noexcept
+    {
+        return active->addmul_1(r, a, n, b);
+    }
+
+
+    limb_t submul_1(limb_t* r, const limb_t* a, std::size_t n, limb_t b) noexcept
+    {
+        limb_t carry = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            limb_t high;
+            limb_t low = multiply_wide(a[i], b, high);
+            low += carry;
+            high += static_cast<limb_t>(low < carry);
+            const limb_t difference = r[i] - low;
+            carry = high + static_cast<limb_t>(difference > r[i]);
+            r[i] = difference;
+        }
+        return carry;
+    }
+
+
+    limb_t divrem_1(limb_t* q, const limb_t* a, std::size_t n, limb_t d) noexcept
+    {
+        limb_t remainder = 0;
+        while (n > 0) {
+            --n;
+            q[n] = divide_wide(remainder, a[n], d, remainder);
+        }
+        return remainder;
+    }
+
+
+    //
+    // Each quotient limb is estimated from the top two limbs of the current remainder and the
+    // top limb of the divisor, refined with the second limb of the divisor, and then corrected
+    // by adding the divisor back if the estimate was still too large. Because the divisor is
+    // normalized the estimate is never more than two too large.
+    //
+    limb_t divrem_basecase(
+        limb_t* q, limb_t* n, std::size_t n_size, const limb_t* d, std::size_t d_size) noexcept
+    {
+        const limb_t d1 = d[d_size - 1];
+        const limb_t d0 = d[d_size - 2];
+
+        limb_t high_quotient = 0;
+        limb_t* top = n + (n_size - d_size);
+        if (compare_n(top, d, d_size) >= 0) {
+            sub_n(top, top, d, d_size);
+            high_quotient = 1;
+        }
+
+        for (std::size_t j = n_size - d_size; j > 0; --j) {
+            limb_t* window = n + j - 1;
+            const limb_t n2 = window[d_size];
+            const limb_t n1 = window[d_size - 1];
+            const limb_t n0 = window[d_size - 2];
+
+            limb_t estimate;
+            if (n2 == d1) {
+                estimate = ~limb_t{0};
+            }
+            else {
+                limb_t remainder;
+                estimate = divide_wide(n2, n1, d1, remainder);
+
+                // Refine: while estimate * d0 > remainder * B + n0, the estimate is too large.
+                while (true) {
+                    limb_t product_high;
+                    const limb_t product_low = multiply_wide(estimate, d0, product_high);
+                    if (product_high < remainder ||
+                        (product_high == remainder && product_low <= n0))
+                        break;
+                    --estimate;
+                    const limb_t previous = remainder;
+                    remainder += d1;
+                    if (remainder < previous)
+                        break;
+                }
+            }
+
+            // Subtract estimate * d. The top limb of the window is tracked separately so that
+            // a negative result can be recognized and corrected.
+            limb_t borrow = submul_1(window, d, d_size, estimate);
+            while (n2 < borrow) {
+                --estimate;
+                borrow -= add_n(window, window, d, d_size);
+            }
+            window[d_size] = 0;
+            q[j - 1] = estimate;
+        }
+        return high_quotient;
+    }
+
+
+    // The loop runs from the top down so that r may be the same array as a, or may start
+    // above a, without clobbering limbs that are still needed.
+    //
+    limb_t lshift(limb_t* r, const limb_t* a, std::size_t n, unsigned count) noexcept
+    {
+        const unsigned complement = LIMB_BITS - count;
+        const limb_t shifted_out = a[n - 1] >> complement;
+        for (std::size_t i = n - 1; i > 0; --i) {
+            r[i] = (a[i] << count) | (a[i - 1] >> complement);
+        }
+        r[0] = a[0] << count;
+        return shifted_out;
+    }
+
+
+    limb_t rshift(limb_t* r, const limb_t* a, std::size_t n, unsigned count) noexcept
+    {
+        const unsigned complement = LIMB_BITS - count;
+        const limb_t shifted_out = a[0] << complement;
+        for (std::size_t i = 0; i < n - 1; ++i) {
+            r[i] = (a[i] >> count) | (a[i + 1] << complement);
+        }
+        r[n - 1] = a[n - 1] >> count;
+        return shifted_out;
+    }
+
+
+    int compare_n(const limb_t* a, const limb_t* b, std::size_t n) noexcept
+    {
+        while (n > 0) {
+            --n;
+            if (a[n] != b[n])
+                return (a[n] < b[n]) ? -1 : 1;
+        }
+        return 0;
+    }
+
+
+    std::size_t popcount_n(const limb_t* a, std::size_t n) noexcept
+    {
+        return active->popcount_n(a, n);
+    }
+
+
+    void mul_basecase(
+        limb_t* r, const limb_t* a, std::size_t a_size, const limb_t* b, std::size_t b_size) noexcept
+    {
+        active->mul_basecase(r, a, a_size, b, b_size);
+    }
+
+
+    void sqr_basecase(limb_t* r, const limb_t* a, std::size_t n) noexcept
+    {
+        active->sqr_basecase(r, a, n);
+    }
+
+
+    std::vector<const KernelSet*> supported_kernels()
+    {
+        std::vector<const KernelSet*> sets{&portable_kernels};
+        if (const KernelSet* adx = adx_kernels())
+            sets.push_back(adx);
+        return sets;
+    }
+
+
+    const KernelSet& active_kernels() noexcept
+    {
+        return *active;
+    }
+
+
+    void set_active_kernels(const KernelSet& kernels) noexcept
+    {
+        active = &kernels;
+    }
+
+} // namespace clac::arithmetic
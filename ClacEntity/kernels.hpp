@@ -0,0 +1,224 @@
+/*! \file    kernels.hpp
+ *  \brief   Interface to the low level limb kernels.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * The kernels operate on raw limb arrays in the style of GMP's mpn layer. Array lengths are
+ * given explicitly and the arrays need not be normalized. Unless otherwise noted, a result
+ * array may be the same as an input array but must not otherwise overlap it. All of the
+ * algorithms in the arithmetic module are built on these functions, so they are the place to
+ * look when tuning for a particular processor.
+ *
+ * The kernels that dominate multiplication (add_n, sub_n, mul_1, addmul_1, mul_basecase, and
+ * sqr_basecase) have processor-specific versions, as does popcount_n, which needs the POPCNT
+ * instruction to count bits a limb at a time. Each version is a KernelSet, and the best set
+ * that the processor supports is chosen at startup. The portable set is always available and
+ * is the reference that the others are tested against.
+ */
+
+#ifndef KERNELS_HPP
+#define KERNELS_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "arithmetic.hpp"
+
+namespace clac::arithmetic {
+
+    //! Returns the low limb of a * b and stores the high limb in 'high'.
+    inline limb_t multiply_wide(limb_t a, limb_t b, limb_t& high) noexcept
+    {
+#if defined(__SIZEOF_INT128__)
+        __extension__ using wide_t = unsigned __int128;
+        const wide_t product = static_cast<wide_t>(a) * b;
+        high = static_cast<limb_t>(product >> LIMB_BITS);
+        return static_cast<limb_t>(product);
+#else
+        const limb_t mask = 0xFFFFFFFFULL;
+        const limb_t a_low = a & mask;
+        const limb_t a_high = a >> 32;
+        const limb_t b_low = b & mask;
+        const limb_t b_high = b >> 32;
+
+        const limb_t low_low = a_low * b_low;
+        const limb_t high_low = a_high * b_low;
+        const limb_t low_high = a_low * b_high;
+        const limb_t high_high = a_high * b_high;
+
+        const limb_t middle = (low_low >> 32) + (high_low & mask) + (low_high & mask);
+        high = high_high + (high_low >> 32) + (low_high >> 32) + (middle >> 32);
+        return (middle << 32) | (low_low & mask);
+#endif
+    }
+
+    /*!
+     * Divides the two limb value (high, low) by divisor. Requires high < divisor so that the
+     * quotient fits in one limb. Returns the quotient and stores the remainder in 'remainder'.
+     */
+    inline limb_t divide_wide(limb_t high, limb_t low, limb_t divisor, limb_t& remainder) noexcept
+    {
+#if defined(__SIZEOF_INT128__)
+        __extension__ using wide_t = unsigned __int128;
+        const wide_t dividend = (static_cast<wide_t>(high) << LIMB_BITS) | low;
+        remainder = static_cast<limb_t>(dividend % divisor);
+        return static_cast<limb_t>(dividend / divisor);
+#else
+        limb_t quotient = 0;
+        for (int i = 0; i < LIMB_BITS; ++i) {
+            const limb_t top = high >> (LIMB_BITS - 1);
+            high = (high << 1) | (low >> (LIMB_BITS - 1));
+            low <<= 1;
+            quotient <<= 1;
+            if (top != 0 || high >= divisor) {
+                high -= divisor;
+                quotient |= 1;
+            }
+        }
+        remainder = high;
+        return quotient;
+#endif
+    }
+
+    //! r = a + b. Returns the carry out.
+    limb_t add_n(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n) noexcept;
+
+    //! r = a - b. Returns the borrow out.
+    limb_t sub_n(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n) noexcept;
+
+    //! r = a + b where b is a single limb. Returns the carry out.
+    limb_t add_1(limb_t* r, const limb_t* a, std::size_t n, limb_t b) noexcept;
+
+    //! r = a - b where b is a single limb. Returns the borrow out.
+    limb_t sub_1(limb_t* r, const limb_t* a, std::size_t n, limb_t b) noexcept;
+
+    //! r = a * b where b is a single limb. Returns the high limb of the product.
+    limb_t mul_1(limb_t* r, const limb_t* a, std::size_t n, limb_t b) noexcept;
+
+    //! r += a * b where b is a single limb. Returns the high limb that was not added.
+    limb_t addmul_1(limb_t* r, const limb_t* a, std::size_t n, limb_t b) noexcept;
+
+    //! r -= a * b where b is a single limb. Returns the high limb that was not subtracted.
+    limb_t submul_1(limb_t* r, const limb_t* a, std::size_t n, limb_t b) noexcept;
+
+    //! q = a / d where d is a single nonzero limb. Returns the remainder.
+    limb_t divrem_1(limb_t* q, const limb_t* a, std::size_t n, limb_t d) noexcept;
+
+    /*!
+     * Schoolbook division of the n_size limbs at n by the d_size limbs at d (Knuth's Algorithm
+     * D). Requires n_size >= d_size >= 2 and that the most significant bit of d is set. The
+     * low n_size - d_size limbs of the quotient are stored in q and the high limb (zero or one)
+     * is returned. The remainder replaces the low d_size limbs of n; the rest of n is zeroed.
+     */
+    limb_t divrem_basecase(
+        limb_t* q, limb_t* n, std::size_t n_size, const limb_t* d, std::size_t d_size) noexcept;
+
+    //! r = a << count for 0 < count < LIMB_BITS. Returns the bits shifted out.
+    limb_t lshift(limb_t* r, const limb_t* a, std::size_t n, unsigned count) noexcept;
+
+    //! r = a >> count for 0 < count < LIMB_BITS. Returns the bits shifted out (in the high end).
+    limb_t rshift(limb_t* r, const limb_t* a, std::size_t n, unsigned count) noexcept;
+
+    //! Compares two arrays of equal length. Returns -1, 0, or +1.
+    int compare_n(const limb_t* a, const limb_t* b, std::size_t n) noexcept;
+
+    //! Returns the number of one bits in a.
+    std::size_t popcount_n(const limb_t* a, std::size_t n) noexcept;
+
+    /*!
+     * r = a * b using the schoolbook method. The array r must have room for a_size + b_size
+     * limbs and must not overlap either input. Requires a_size >= b_size >= 1.
+     */
+    void mul_basecase(
+        limb_t* r, const limb_t* a, std::size_t a_size, const limb_t* b, std::size_t b_size) noexcept;
+
+    /*!
+     * r = a * a using the schoolbook method, computing each cross product only once. The array
+     * r must have room for 2 * n limbs and must not overlap a.
+     */
+    void sqr_basecase(limb_t* r, const limb_t* a, std::size_t n) noexcept;
+
+    //! Implementations of the kernels that have processor-specific versions.
+    struct KernelSet {
+        const char* name;
+        limb_t (*add_n)(limb_t*, const limb_t*, const limb_t*, std::size_t) noexcept;
+        limb_t (*sub_n)(limb_t*, const limb_t*, const limb_t*, std::size_t) noexcept;
+        limb_t (*mul_1)(limb_t*, const limb_t*, std::size_t, limb_t) noexcept;
+        limb_t (*addmul_1)(limb_t*, const limb_t*, std::size_t, limb_t) noexcept;
+        void (*mul_basecase)(
+            limb_t*, const limb_t*, std::size_t, const limb_t*, std::size_t) noexcept;
+        void (*sqr_basecase)(limb_t*, const limb_t*, std::size_t) noexcept;
+        std::size_t (*popcount_n)(const limb_t*, std::size_t) noexcept;
+    };
+
+    //! Returns the kernel sets that this processor supports, starting with the portable set.
+    std::vector<const KernelSet*> supported_kernels();
+
+    //! Returns the kernel set in use.
+    const KernelSet& active_kernels() noexcept;
+
+    //! Makes 'kernels' the set in use. This must not be called while arithmetic is in progress.
+    void set_active_kernels(const KernelSet& kernels) noexcept;
+
+    //! Returns the set that uses the BMI2 and ADX instructions, or nullptr if it is unsupported.
+    const KernelSet* adx_kernels() noexcept;
+
+    //! Schoolbook multiplication built on a particular set's mul_1 and addmul_1.
+    template<auto mul_1_kernel, auto addmul_1_kernel>
+    void mul_basecase_with(
+        limb_t* r, const limb_t* a, std::size_t a_size, const limb_t* b, std::size_t b_size) noexcept
+    {
+        r[a_size] = mul_1_kernel(r, a, a_size, b[0]);
+        for (std::size_t i = 1; i < b_size; ++i) {
+            r[a_size + i] = addmul_1_kernel(r + i, a, a_size, b[i]);
+        }
+    }
+
+    //
+    // The product a*a is the sum of the squares a[i]^2 at limb 2*i plus twice the sum of the
+    // cross products a[i]*a[j] (i < j) at limb i + j. The cross products are accumulated once,
+    // doubled with a shift, and then the diagonal is added.
+    //
+    template<auto mul_1_kernel, auto addmul_1_kernel>
+    void sqr_basecase_with(limb_t* r, const limb_t* a, std::size_t n) noexcept
+    {
+        if (n == 1) {
+            r[0] = multiply_wide(a[0], a[0], r[1]);
+            return;
+        }
+
+        // Cross products.
+        r[0] = 0;
+        r[n] = mul_1_kernel(r + 1, a + 1, n - 1, a[0]);
+        for (std::size_t i = 1; i < n - 1; ++i) {
+            r[n + i] = addmul_1_kernel(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+        }
+
+        // Double them.
+        r[2 * n - 1] = lshift(r + 1, r + 1, 2 * n - 2, 1);
+
+        // Add the squares on the diagonal.
+        limb_t carry = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            limb_t high;
+            limb_t low = multiply_wide(a[i], a[i], high);
+
+            low += carry;
+            high += static_cast<limb_t>(low < carry);
+            r[2 * i] += low;
+            high += static_cast<limb_t>(r[2 * i] < low);
+            r[2 * i + 1] += high;
+            carry = static_cast<limb_t>(r[2 * i + 1] < high);
+        }
+    }
+
+    /*!
+     * r = a * b using three-prime number theoretic transforms. The array r must have room for
+     * a_size + b_size limbs and must not overlap either input. Requires a_size, b_size >= 1.
+     * When a and b are the same array of the same size, only one forward transform is done.
+     */
+    void mul_ntt(
+        limb_t* r, const limb_t* a, std::size_t a_size, const limb_t* b, std::size_t b_size);
+
+} // namespace clac::arithmetic
+
+#endif
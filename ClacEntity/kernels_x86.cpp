@@ -0,0 +1,303 @@
+/*! \file    kernels_x86.cpp
+ *  \brief   Limb kernels for x86-64 processors with the BMI2, ADX, and POPCNT extensions.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * MULX multiplies without touching the flags, and ADCX and ADOX add with carry through CF and
+ * OF respectively. Together they let addmul_1 run two independent carry chains, one for the
+ * high halves of the products and one for the limbs of the destination, where the portable
+ * version has to recover each carry with a comparison. The loops are written in inline assembly
+ * because the compilers don't keep a carry flag alive across loop iterations. The loop counters
+ * are updated with LEA and tested with JRCXZ, neither of which changes the flags.
+ *
+ * The add and multiply loops handle single limbs until the remaining count is a multiple of
+ * four and then handle four limbs per iteration. The set also counts bits with POPCNT, which
+ * is compiled for that one function with a target attribute rather than for the whole file.
+ *
+ * AVX2 and AVX-512 IFMA kernels were considered but not adopted. Vector units have no carry
+ * chain between lanes and IFMA multiplies 52-bit digits, so they only pay when the operands are
+ * kept in a 52-bit radix throughout. Basecase operands are a few dozen limbs and are converted
+ * again on every call, so the conversion would cost more than the multiplication saves.
+ *
+ * References:
+ *
+ * Intel Corporation. "New Instructions Supporting Large Integer Arithmetic on Intel
+ * Architecture Processors." White paper 327831, 2012.
+ */
+
+#include "kernels.hpp"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <cpuid.h>
+#endif
+
+namespace clac::arithmetic {
+
+#if defined(__x86_64__) && defined(__GNUC__)
+
+    namespace {
+
+        limb_t adx_add_n(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n) noexcept
+        {
+            std::size_t count = n % 4;
+            limb_t scratch;
+            limb_t carry;
+
+            asm("xorl %k[scratch], %k[scratch]\n\t" // Clears CF.
+                "1:\n\t"
+                "jrcxz 2f\n\t"
+                "movq (%[a]), %[scratch]\n\t"
+                "adcq (%[b]), %[scratch]\n\t"
+                "movq %[scratch], (%[r])\n\t"
+                "leaq 8(%[a]), %[a]\n\t"
+                "leaq 8(%[b]), %[b]\n\t"
+                "leaq 8(%[r]), %[r]\n\t"
+                "leaq -1(%%rcx), %%rcx\n\t"
+                "jmp 1b\n"
+                "2:\n\t"
+                "movq %[blocks], %%rcx\n"
+                "3:\n\t"
+                "jrcxz 4f\n\t"
+                "movq (%[a]), %[scratch]\n\t"
+                "adcq (%[b]), %[scratch]\n\t"
+                "movq %[scratch], (%[r])\n\t"
+                "movq 8(%[a]), %[scratch]\n\t"
+                "adcq 8(%[b]), %[scratch]\n\t"
+                "movq %[scratch], 8(%[r])\n\t"
+                "movq 16(%[a]), %[scratch]\n\t"
+                "adcq 16(%[b]), %[scratch]\n\t"
+                "movq %[scratch], 16(%[r])\n\t"
+                "movq 24(%[a]), %[scratch]\n\t"
+                "adcq 24(%[b]), %[scratch]\n\t"
+                "movq %[scratch], 24(%[r])\n\t"
+                "leaq 32(%[a]), %[a]\n\t"
+                "leaq 32(%[b]), %[b]\n\t"
+                "leaq 32(%[r]), %[r]\n\t"
+                "leaq -1(%%rcx), %%rcx\n\t"
+                "jmp 3b\n"
+                "4:\n\t"
+                "movl $0, %k[carry]\n\t"
+                "adcl $0, %k[carry]"
+                : [r] "+r"(r), [a] "+r"(a), [b] "+r"(b), "+c"(count), [scratch] "=&r"(scratch),
+                  [carry] "=r"(carry)
+                : [blocks] "r"(n / 4)
+                : "cc", "memory");
+            return carry;
+        }
+
+
+        limb_t adx_sub_n(limb_t* r, const limb_t* a, const limb_t* b, std::size_t n) noexcept
+        {
+            std::size_t count = n % 4;
+            limb_t scratch;
+            limb_t borrow;
+
+            asm("xorl %k[scratch], %k[scratch]\n\t" // Clears CF.
+                "1:\n\t"
+                "jrcxz 2f\n\t"
+                "movq (%[a]), %[scratch]\n\t"
+                "sbbq (%[b]), %[scratch]\n\t"
+                "movq %[scratch], (%[r])\n\t"
+                "leaq 8(%[a]), %[a]\n\t"
+                "leaq 8(%[b]), %[b]\n\t"
+                "leaq 8(%[r]), %[r]\n\t"
+                "leaq -1(%%rcx), %%rcx\n\t"
+                "jmp 1b\n"
+                "2:\n\t"
+                "movq %[blocks], %%rcx\n"
+                "3:\n\t"
+                "jrcxz 4f\n\t"
+                "movq (%[a]), %[scratch]\n\t"
+                "sbbq (%[b]), %[scratch]\n\t"
+                "movq %[scratch], (%[r])\n\t"
+                "movq 8(%[a]), %[scratch]\n\t"
+                "sbbq 8(%[b]), %[scratch]\n\t"
+                "movq %[scratch], 8(%[r])\n\t"
+                "movq 16(%[a]), %[scratch]\n\t"
+                "sbbq 16(%[b]), %[scratch]\n\t"
+                "movq %[scratch], 16(%[r])\n\t"
+                "movq 24(%[a]), %[scratch]\n\t"
+                "sbbq 24(%[b]), %[scratch]\n\t"
+                "movq %[scratch], 24(%[r])\n\t"
+                "leaq 32(%[a]), %[a]\n\t"
+                "leaq 32(%[b]), %[b]\n\t"
+                "leaq 32(%[r]), %[r]\n\t"
+                "leaq -1(%%rcx), %%rcx\n\t"
+                "jmp 3b\n"
+                "4:\n\t"
+                "movl $0, %k[borrow]\n\t"
+                "adcl $0, %k[borrow]"
+                : [r] "+r"(r), [a] "+r"(a), [b] "+r"(b), "+c"(count), [scratch] "=&r"(scratch),
+                  [borrow] "=r"(borrow)
+                : [blocks] "r"(n / 4)
+                : "cc", "memory");
+            return borrow;
+        }
+
+
+        // Each step adds the high half of the previous product to the low half of this one.
+        limb_t adx_mul_1(limb_t* r, const limb_t* a, std::size_t n, limb_t b) noexcept
+        {
+            std::size_t count = n % 4;
+            limb_t carry;
+            limb_t low;
+            limb_t high;
+
+            asm("xorl %k[carry], %k[carry]\n\t" // Clears CF.
+                "1:\n\t"
+                "jrcxz 2f\n\t"
+                "mulxq (%[a]), %[low], %[high]\n\t"
+                "adcxq %[carry], %[low]\n\t"
+                "movq %[low], (%[r])\n\t"
+                "movq %[high], %[carry]\n\t"
+                "leaq 8(%[a]), %[a]\n\t"
+                "leaq 8(%[r]), %[r]\n\t"
+                "leaq -1(%%rcx), %%rcx\n\t"
+                "jmp 1b\n"
+                "2:\n\t"
+                "movq %[blocks], %%rcx\n"
+                "3:\n\t"
+                "jrcxz 4f\n\t"
+                "mulxq (%[a]), %[low], %[high]\n\t"
+                "adcxq %[carry], %[low]\n\t"
+                "movq %[low], (%[r])\n\t"
+                "mulxq 8(%[a]), %[low], %[carry]\n\t"
+                "adcxq %[high], %[low]\n\t"
+                "movq %[low], 8(%[r])\n\t"
+                "mulxq 16(%[a]), %[low], %[high]\n\t"
+                "adcxq %[carry], %[low]\n\t"
+                "movq %[low], 16(%[r])\n\t"
+                "mulxq 24(%[a]), %[low], %[carry]\n\t"
+                "adcxq %[high], %[low]\n\t"
+                "movq %[low], 24(%[r])\n\t"
+                "leaq 32(%[a]), %[a]\n\t"
+                "leaq 32(%[r]), %[r]\n\t"
+                "leaq -1(%%rcx), %%rcx\n\t"
+                "jmp 3b\n"
+                "4:\n\t"
+                "movl $0, %k[low]\n\t"
+                "adcxq %[low], %[carry]"
+                : [r] "+r"(r), [a] "+r"(a), "+c"(count), [carry] "=&r"(carry),
+                  [low] "=&r"(low), [high] "=&r"(high)
+                : [blocks] "r"(n / 4), "d"(b)
+                : "cc", "memory");
+            return carry;
+        }
+
+
+        //
+        // The high halves of the products are carried on the CF chain and the limbs of r are
+        // added on the OF chain. Both chains are folded into the returned limb at the end, which
+        // can't overflow because r + a*b < 2^(64(n + 1)).
+        //
+        limb_t adx_addmul_1(limb_t* r, const limb_t* a, std::size_t n, limb_t b) noexcept
+        {
+            std::size_t count = n % 4;
+            limb_t carry;
+            limb_t low;
+            limb_t high;
+
+            asm("xorl %k[carry], %k[carry]\n\t" // Clears CF and OF.
+                "1:\n\t"
+                "jrcxz 2f\n\t"
+                "mulxq (%[a]), %[low], %[high]\n\t"
+                "adcxq %[carry], %[low]\n\t"
+                "adoxq (%[r]), %[low]\n\t"
+                "movq %[low], (%[r])\n\t"
+                "movq %[high], %[carry]\n\t"
+                "leaq 8(%[a]), %[a]\n\t"
+                "leaq 8(%[r]), %[r]\n\t"
+                "leaq -1(%%rcx), %%rcx\n\t"
+                "jmp 1b\n"
+                "2:\n\t"
+                "movq %[blocks], %%rcx\n"
+                "3:\n\t"
+                "jrcxz 4f\n\t"
+                "mulxq (%[a]), %[low], %[high]\n\t"
+                "adcxq %[carry], %[low]\n\t"
+                "adoxq (%[r]), %[low]\n\t"
+                "movq %[low], (%[r])\n\t"
+                "mulxq 8(%[a]), %[low], %[carry]\n\t"
+                "adcxq %[high], %[low]\n\t"
+                "adoxq 8(%[r]), %[low]\n\t"
+                "movq %[low], 8(%[r])\n\t"
+                "mulxq 16(%[a]), %[low], %[high]\n\t"
+                "adcxq %[carry], %[low]\n\t"
+                "adoxq 16(%[r]), %[low]\n\t"
+                "movq %[low], 16(%[r])\n\t"
+                "mulxq 24(%[a]), %[low], %[carry]\n\t"
+                "adcxq %[high], %[low]\n\t"
+                "adoxq 24(%[r]), %[low]\n\t"
+                "movq %[low], 24(%[r])\n\t"
+                "leaq 32(%[a]), %[a]\n\t"
+                "leaq 32(%[r]), %[r]\n\t"
+                "leaq -1(%%rcx), %%rcx\n\t"
+                "jmp 3b\n"
+                "4:\n\t"
+                "movl $0, %k[low]\n\t"
+                "adcxq %[low], %[carry]\n\t"
+                "adoxq %[low], %[carry]"
+                : [r] "+r"(r), [a] "+r"(a), "+c"(count), [carry] "=&r"(carry),
+                  [low] "=&r"(low), [high] "=&r"(high)
+                : [blocks] "r"(n / 4), "d"(b)
+                : "cc", "memory");
+            return carry;
+        }
+
+
+        // Every processor with BMI2 also has POPCNT, which counts a limb in one instruction.
+        __attribute__((target("popcnt"))) std::size_t popcnt_popcount_n(
+            const limb_t* a, std::size_t n) noexcept
+        {
+            std::size_t count = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                count += static_cast<std::size_t>(__builtin_popcountll(a[i]));
+            }
+            return count;
+        }
+
+
+        constexpr KernelSet kernels = {
+            "bmi2-adx",
+            adx_add_n,
+            adx_sub_n,
+            adx_mul_1,
+            adx_addmul_1,
+            mul_basecase_with<adx_mul_1, adx_addmul_1>,
+            sqr_basecase_with<adx_mul_1, adx_addmul_1>,
+            popcnt_popcount_n,
+        };
+
+        //
+        // CPUID leaf 7, subleaf 0, reports BMI2 in bit 8 of EBX and ADX in bit 19. Leaf 1 reports
+        // POPCNT in bit 23 of ECX. It is checked as well, although no processor with BMI2 lacks
+        // it, because running the popcnt kernel without it would fault.
+        //
+        bool supported() noexcept
+        {
+            unsigned eax, ebx, ecx, edx;
+            if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || (ecx & (1U << 23)) == 0)
+                return false;
+            if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+                return false;
+            return (ebx & (1U << 8)) != 0 && (ebx & (1U << 19)) != 0;
+        }
+
+    } // namespace
+
+
+    const KernelSet* adx_kernels() noexcept
+    {
+        static const bool available = supported();
+        return available ? &kernels : nullptr;
+    }
+
+#else
+
+    const KernelSet* adx_kernels() noexcept
+    {
+        return nullptr;
+    }
+
+#endif
+
+} // namespace clac::arithmetic
@@ -0,0 +1,168 @@
+/*! \file    limb_pool.cpp
+ *  \brief   Implementation of the per-thread pool of limb buffers.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * Long computations such as powers, divisions, and radix conversions create and destroy many
+ * temporaries of the same few sizes. Rather than return each buffer to the heap, natural_t
+ * returns it to a pool belonging to the thread that frees it, where the next request of the
+ * same size class finds it. Size classes are powers of two from 8 to 65536 limbs; smaller
+ * values are stored inside the natural_t, and larger buffers go straight to the heap because
+ * the arithmetic done on them dwarfs the cost of allocation.
+ *
+ * Each class is a singly linked list threaded through the free buffers themselves. The pool
+ * belongs to one thread, so taking or returning a buffer needs no lock or atomic operation. A
+ * buffer may be freed by a different thread than the one that allocated it (the parallel
+ * multiplication does this), in which case it simply joins the freeing thread's pool. The
+ * amount cached is bounded per class and per thread, and a thread's pool is given back to the
+ * heap when the thread exits.
+ *
+ * Defining CLAC_NO_LIMB_POOL (the CMake option CLAC_LIMB_POOL=OFF) sends every request to the
+ * heap, which is useful when checking the program with a memory debugger.
+ */
+
+#include <bit>
+#include <cstddef>
+#include <new>
+
+#include "arithmetic.hpp"
+
+using namespace std;
+
+namespace clac::arithmetic {
+    namespace {
+
+        constexpr unsigned SMALLEST_CLASS_BITS = 3;
+        constexpr unsigned LARGEST_CLASS_BITS = 16;
+        constexpr size_t CLASS_COUNT = LARGEST_CLASS_BITS - SMALLEST_CLASS_BITS + 1;
+        constexpr size_t LARGEST_CLASS_LIMBS = size_t{1} << LARGEST_CLASS_BITS;
+
+        // Bounds on what one thread keeps.
+        constexpr size_t MAXIMUM_CACHED_PER_CLASS = 16;
+        constexpr size_t MAXIMUM_CACHED_BYTES = size_t{8} << 20;
+
+        //! Returns the size class of a buffer of 'count' limbs, which must fit the largest class.
+        unsigned size_class(size_t count) noexcept
+        {
+            const unsigned bits = static_cast<unsigned>(bit_width(count - 1));
+            return (bits <= SMALLEST_CLASS_BITS) ? 0 : bits - SMALLEST_CLASS_BITS;
+        }
+
+        size_t class_bytes(unsigned size_class) noexcept
+        {
+            return sizeof(limb_t) << (size_class + SMALLEST_CLASS_BITS);
+        }
+
+        struct FreeBuffer {
+            FreeBuffer* next;
+        };
+
+        //
+        // The pool is trivially destructible so that it remains usable while static objects
+        // are destroyed after the thread's destructors have run. By then 'closed' is set and
+        // buffers go straight back to the heap.
+        //
+        struct Pool {
+            FreeBuffer* free[CLASS_COUNT];
+            size_t count[CLASS_COUNT];
+            size_t cached_bytes;
+            bool closed;
+            PoolStatistics statistics;
+        };
+
+        constinit thread_local Pool pool{};
+
+        void empty_pool() noexcept
+        {
+            for (unsigned k = 0; k < CLASS_COUNT; ++k) {
+                while (FreeBuffer* buffer = pool.free[k]) {
+                    pool.free[k] = buffer->next;
+                    ::operator delete(buffer);
+                }
+                pool.count[k] = 0;
+            }
+            pool.cached_bytes = 0;
+        }
+
+        // Empties the pool when its thread exits. It is created when the first buffer is cached.
+        struct PoolCloser {
+            ~PoolCloser()
+            {
+                empty_pool();
+                pool.closed = true;
+            }
+        };
+
+        thread_local PoolCloser closer;
+
+    } // namespace
+
+
+    limb_t* LimbAllocator::allocate(size_t count)
+    {
+        ++pool.statistics.requests;
+        if (count > LARGEST_CLASS_LIMBS)
+            return static_cast<limb_t*>(::operator new(count * sizeof(limb_t)));
+
+        const unsigned k = size_class(count);
+#ifndef CLAC_NO_LIMB_POOL
+        if (FreeBuffer* buffer = pool.free[k]) {
+            pool.free[k] = buffer->next;
+            --pool.count[k];
+            pool.cached_bytes -= class_bytes(k);
+            ++pool.statistics.reused;
+            return reinterpret_cast<limb_t*>(buffer);
+        }
+#endif
+        return static_cast<limb_t*>(::operator new(class_bytes(k)));
+    }
+
+
+    void LimbAllocator::deallocate(limb_t* buffer, size_t count) noexcept
+    {
+        ++pool.statistics.returned;
+#ifndef CLAC_NO_LIMB_POOL
+        if (count <= LARGEST_CLASS_LIMBS && !pool.closed) {
+            const unsigned k = size_class(count);
+            const size_t bytes = class_bytes(k);
+            if (pool.count[k] < MAXIMUM_CACHED_PER_CLASS &&
+                pool.cached_bytes + bytes <= MAXIMUM_CACHED_BYTES) {
+                static_cast<void>(&closer);
+                FreeBuffer* free_buffer = reinterpret_cast<FreeBuffer*>(buffer);
+                free_buffer->next = pool.free[k];
+                pool.free[k] = free_buffer;
+                ++pool.count[k];
+                pool.cached_bytes += bytes;
+                return;
+            }
+        }
+#else
+        static_cast<void>(count);
+#endif
+        ::operator delete(buffer);
+    }
+
+
+    PoolStatistics pool_statistics() noexcept
+    {
+        PoolStatistics result = pool.statistics;
+        result.cached = 0;
+        for (unsigned k = 0; k < CLASS_COUNT; ++k) {
+            result.cached += pool.count[k];
+        }
+        result.cached_bytes = pool.cached_bytes;
+        return result;
+    }
+
+
+    void reset_pool_statistics() noexcept
+    {
+        pool.statistics = PoolStatistics{};
+    }
+
+
+    void release_pool() noexcept
+    {
+        empty_pool();
+    }
+
+} // namespace clac::arithmetic
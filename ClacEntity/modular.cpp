@@ -0,0 +1,284 @@
+/*! \file    modular.cpp
+ *  \brief   Montgomery and Barrett modular arithmetic.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * Montgomery reduction of a 2n limb product T adds multiples u * m * 2^(64i) for i = 0, ...,
+ * n - 1, choosing each u so that limb i becomes zero. The low n limbs are then all zero, and the
+ * high n limbs are T / R modulo m, less than 2m. Each step is one addmul_1 kernel call. The limb
+ * carried out of step i belongs at limb i + n, which no later choice of u looks at, so the
+ * carries are saved and added together in one add_n at the end.
+ *
+ * Barrett reduction estimates the quotient x / m from the top limbs of x and the precomputed
+ * mu = floor(2^(128n) / m). The estimate is never too large and is at most two too small, so at
+ * most two subtractions of m finish the reduction.
+ *
+ * Both are used with left-to-right sliding window exponentiation, as in power.cpp. Here a
+ * squaring costs nearly as much as a multiplication, so larger windows pay off sooner.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "kernels.hpp"
+#include "modular.hpp"
+
+using namespace std;
+
+namespace clac::arithmetic {
+    namespace {
+
+        //! Returns the window size that minimizes the number of multiplications.
+        int window_size(size_t exponent_bits) noexcept
+        {
+            const size_t limits[] = {7, 25, 81, 241, 673, 1793};
+            int k = 1;
+            for (size_t limit : limits) {
+                if (exponent_bits <= limit)
+                    break;
+                ++k;
+            }
+            return k;
+        }
+
+        bool test_bit(const natural_t& number, size_t index) noexcept
+        {
+            return ((number[index / LIMB_BITS] >> (index % LIMB_BITS)) & 1) != 0;
+        }
+
+        //! Returns the remainder of number / modulus.
+        natural_t remainder_of(const natural_t& number, const natural_t& modulus)
+        {
+            if (compare(number, modulus) < 0)
+                return number;
+            natural_t quotient, remainder;
+            divide(number, modulus, quotient, remainder);
+            return remainder;
+        }
+
+        //
+        // Computes x^exponent in the ring, given x and the ring's 1 in whatever representation
+        // the ring's multiply and square use.
+        //
+        template<typename Ring>
+        natural_t window_power(
+            const Ring& ring, const natural_t& x, const natural_t& exponent, const natural_t& one)
+        {
+            const size_t exponent_bits = bit_length(exponent);
+            if (exponent_bits == 0)
+                return one;
+
+            // The table holds x^1, x^3, ..., x^(2^k - 1).
+            const int k = window_size(exponent_bits);
+            vector<natural_t> odd_powers(size_t{1} << (k - 1));
+            odd_powers[0] = x;
+            if (k > 1) {
+                const natural_t x_squared = ring.square(x);
+                for (size_t i = 1; i < odd_powers.size(); ++i) {
+                    odd_powers[i] = ring.multiply(odd_powers[i - 1], x_squared);
+                }
+            }
+
+            natural_t result;
+            bool started = false;
+            long i = static_cast<long>(exponent_bits) - 1;
+            while (i >= 0) {
+                if (!test_bit(exponent, static_cast<size_t>(i))) {
+                    result = ring.square(result);
+                    --i;
+                    continue;
+                }
+
+                // Find the longest window [j, i] of at most k bits that ends with a one bit.
+                long j = max(i - k + 1, 0L);
+                while (!test_bit(exponent, static_cast<size_t>(j)))
+                    ++j;
+                size_t window = 0;
+                for (long b = i; b >= j; --b) {
+                    window = (window << 1) | static_cast<size_t>(test_bit(exponent, b));
+                }
+
+                if (started) {
+                    for (long b = i; b >= j; --b)
+                        result = ring.square(result);
+                    result = ring.multiply(result, odd_powers[window / 2]);
+                }
+                else {
+                    result = odd_powers[window / 2];
+                    started = true;
+                }
+                i = j - 1;
+            }
+            return result;
+        }
+
+    } // namespace
+
+
+    Montgomery::Montgomery(const natural_t& modulus) : m(modulus)
+    {
+        if (m.empty() || (m[0] & 1) == 0)
+            throw domain_error("Montgomery: the modulus must be odd");
+
+        // Newton's iteration for 1/m modulo 2^64. Every odd m is its own inverse modulo 8, and
+        // each step doubles the number of correct bits.
+        limb_t inverse = m[0];
+        for (int i = 0; i < 5; ++i) {
+            inverse *= 2 - m[0] * inverse;
+        }
+        m_inverse = 0 - inverse;
+
+        const size_t n = m.size();
+        r = remainder_of(shift_left(natural_t{1}, n * LIMB_BITS), m);
+        r_squared = remainder_of(shift_left(natural_t{1}, 2 * n * LIMB_BITS), m);
+    }
+
+
+    natural_t Montgomery::to_form(const natural_t& number) const
+    {
+        return multiply(remainder_of(number, m), r_squared);
+    }
+
+
+    natural_t Montgomery::from_form(const natural_t& form) const
+    {
+        natural_t product(2 * m.size(), 0);
+        copy(form.begin(), form.end(), product.begin());
+        return reduce(product);
+    }
+
+
+    natural_t Montgomery::multiply(const natural_t& left, const natural_t& right) const
+    {
+        if (left.empty() || right.empty())
+            return natural_t();
+
+        const natural_t& longer = (left.size() >= right.size()) ? left : right;
+        const natural_t& shorter = (left.size() >= right.size()) ? right : left;
+        natural_t product(2 * m.size(), 0);
+        if (shorter.size() < thresholds().karatsuba) {
+            mul_basecase(
+                product.data(), longer.data(), longer.size(), shorter.data(), shorter.size());
+        }
+        else {
+            const natural_t full = arithmetic::multiply(left, right);
+            copy(full.begin(), full.end(), product.begin());
+        }
+        return reduce(product);
+    }
+
+
+    natural_t Montgomery::square(const natural_t& form) const
+    {
+        if (form.empty())
+            return natural_t();
+
+        natural_t product(2 * m.size(), 0);
+        if (form.size() < thresholds().karatsuba_square) {
+            sqr_basecase(product.data(), form.data(), form.size());
+        }
+        else {
+            const natural_t full = arithmetic::square(form);
+            copy(full.begin(), full.end(), product.begin());
+        }
+        return reduce(product);
+    }
+
+
+    natural_t Montgomery::power(const natural_t& form, const natural_t& exponent) const
+    {
+        return window_power(*this, form, exponent, r);
+    }
+
+
+    // Requires product < mR, held in exactly 2n limbs.
+    natural_t Montgomery::reduce(natural_t& product) const
+    {
+        const size_t n = m.size();
+        natural_t carries(n);
+        for (size_t i = 0; i < n; ++i) {
+            carries[i] = addmul_1(product.data() + i, m.data(), n, product[i] * m_inverse);
+        }
+        const limb_t top = add_n(product.data() + n, product.data() + n, carries.data(), n);
+
+        natural_t result(product.begin() + static_cast<ptrdiff_t>(n), product.end());
+        if (top != 0 || compare_n(result.data(), m.data(), n) >= 0)
+            sub_n(result.data(), result.data(), m.data(), n);
+        normalize(result);
+        return result;
+    }
+
+
+    Barrett::Barrett(const natural_t& modulus) : m(modulus), n(modulus.size())
+    {
+        if (m.empty())
+            throw domain_error("Barrett: zero modulus");
+        natural_t remainder;
+        divide(shift_left(natural_t{1}, 2 * n * LIMB_BITS), m, mu, remainder);
+    }
+
+
+    natural_t Barrett::reduce(const natural_t& number) const
+    {
+        if (number.size() > 2 * n)
+            return remainder_of(number, m);
+
+        const natural_t estimate = shift_right(
+            arithmetic::multiply(shift_right(number, (n - 1) * LIMB_BITS), mu),
+            (n + 1) * LIMB_BITS);
+        natural_t result = subtract(number, arithmetic::multiply(estimate, m));
+        while (compare(result, m) >= 0)
+            result = subtract(result, m);
+        return result;
+    }
+
+
+    natural_t Barrett::multiply(const natural_t& left, const natural_t& right) const
+    {
+        return reduce(arithmetic::multiply(left, right));
+    }
+
+
+    natural_t Barrett::square(const natural_t& number) const
+    {
+        return reduce(arithmetic::square(number));
+    }
+
+
+    natural_t Barrett::power(const natural_t& number, const natural_t& exponent) const
+    {
+        return window_power(*this, number, exponent, remainder_of(natural_t{1}, m));
+    }
+
+
+    natural_t add_mod(const natural_t& left, const natural_t& right, const natural_t& modulus)
+    {
+        natural_t sum = add(left, right);
+        if (compare(sum, modulus) >= 0)
+            sum = subtract(sum, modulus);
+        return sum;
+    }
+
+
+    natural_t subtract_mod(const natural_t& left, const natural_t& right, const natural_t& modulus)
+    {
+        if (compare(left, right) >= 0)
+            return subtract(left, right);
+        return subtract(add(left, modulus), right);
+    }
+
+
+    natural_t power_mod(const natural_t& base, const natural_t& exponent, const natural_t& modulus)
+    {
+        if (modulus.empty())
+            throw domain_error("power_mod: zero modulus");
+
+        if ((modulus[0] & 1) != 0) {
+            const Montgomery ring(modulus);
+            return ring.from_form(ring.power(ring.to_form(base), exponent));
+        }
+        const Barrett ring(modulus);
+        return ring.power(ring.reduce(base), exponent);
+    }
+
+} // namespace clac::arithmetic
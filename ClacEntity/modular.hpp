@@ -0,0 +1,127 @@
+/*! \file    modular.hpp
+ *  \brief   Interface to modular arithmetic on natural numbers.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * A modular power with a large exponent can't be computed by forming the power and reducing
+ * it, because the power has about as many bits as the exponent's value. Instead every product
+ * is reduced as soon as it is formed, so no intermediate value is larger than the square of the
+ * modulus. The reductions would dominate if each were a long division. For an odd modulus they
+ * are done in Montgomery form, where a reduction costs about as much as a multiplication by one
+ * limb per limb of the modulus. An even modulus has no Montgomery form, and its reductions use
+ * Barrett's method, which replaces the division with two multiplications by a precomputed
+ * reciprocal.
+ *
+ * References:
+ *
+ * + Montgomery, "Modular Multiplication Without Trial Division," Mathematics of Computation
+ *   44(170), 1985.
+ * + Menezes, van Oorschot, and Vanstone, "Handbook of Applied Cryptography," Algorithms 14.36
+ *   (Montgomery reduction), 14.42 (Barrett reduction), and 14.85 (sliding window
+ *   exponentiation).
+ */
+
+#ifndef MODULAR_HPP
+#define MODULAR_HPP
+
+#include "arithmetic.hpp"
+
+namespace clac::arithmetic {
+
+    /*!
+     * Arithmetic modulo an odd number m of n limbs in Montgomery form. The form of x is xR mod m,
+     * where R = 2^(64n). The product of the forms of x and y, divided by R modulo m, is the form
+     * of xy; the division by R is done with one multiplication by a limb for each limb of m.
+     * Sums and differences of forms are the forms of the sums and differences, so add_mod and
+     * subtract_mod apply to forms directly.
+     */
+    class Montgomery {
+    public:
+        //! Throws std::domain_error if the modulus is even or zero.
+        explicit Montgomery(const natural_t& modulus);
+
+        const natural_t& modulus() const noexcept
+        {
+            return m;
+        }
+
+        //! Returns the form of 1.
+        const natural_t& one() const noexcept
+        {
+            return r;
+        }
+
+        //! Returns the form of 'number', which may be any natural number.
+        natural_t to_form(const natural_t& number) const;
+
+        //! Returns the number, less than the modulus, with the given form.
+        natural_t from_form(const natural_t& form) const;
+
+        //! Returns the form of xy given the forms of x and y.
+        natural_t multiply(const natural_t& left, const natural_t& right) const;
+
+        //! Returns the form of x^2 given the form of x.
+        natural_t square(const natural_t& form) const;
+
+        //! Returns the form of x^exponent given the form of x.
+        natural_t power(const natural_t& form, const natural_t& exponent) const;
+
+    private:
+        natural_t m;
+        limb_t m_inverse;    // -1/m modulo 2^64.
+        natural_t r;         // R mod m.
+        natural_t r_squared; // R^2 mod m.
+
+        natural_t reduce(natural_t& product) const;
+    };
+
+    //! Arithmetic modulo any nonzero number m using Barrett reduction.
+    class Barrett {
+    public:
+        //! Throws std::domain_error if the modulus is zero.
+        explicit Barrett(const natural_t& modulus);
+
+        const natural_t& modulus() const noexcept
+        {
+            return m;
+        }
+
+        //! Returns number mod m. Numbers of m^2 or more are divided in the ordinary way.
+        natural_t reduce(const natural_t& number) const;
+
+        //! Returns xy mod m for x and y less than m.
+        natural_t multiply(const natural_t& left, const natural_t& right) const;
+
+        //! Returns x^2 mod m for x less than m.
+        natural_t square(const natural_t& number) const;
+
+        //! Returns x^exponent mod m for x less than m.
+        natural_t power(const natural_t& number, const natural_t& exponent) const;
+
+    private:
+        natural_t m;
+        std::size_t n; // The number of limbs in m.
+        natural_t mu;  // floor(2^(128n) / m).
+    };
+
+    //! Returns (left + right) mod modulus where left and right are less than the modulus.
+    natural_t add_mod(const natural_t& left, const natural_t& right, const natural_t& modulus);
+
+    //! Returns (left - right) mod modulus where left and right are less than the modulus.
+    natural_t subtract_mod(const natural_t& left, const natural_t& right, const natural_t& modulus);
+
+    /*!
+     * Returns base^exponent mod modulus, using Montgomery multiplication if the modulus is odd
+     * and Barrett reduction if it is even. Throws std::domain_error if the modulus is zero.
+     */
+    natural_t power_mod(const natural_t& base, const natural_t& exponent, const natural_t& modulus);
+
+    /*!
+     * Sets 'inverse' to the x in [0, modulus) with number * x = 1 (mod modulus) and returns true,
+     * or returns false if the GCD of number and modulus is not one. Throws std::domain_error if
+     * the modulus is zero. See gcd.cpp.
+     */
+    bool inverse_mod(const natural_t& number, const natural_t& modulus, natural_t& inverse);
+
+} // namespace clac::arithmetic
+
+#endif
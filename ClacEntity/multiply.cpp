@@ -0,0 +1,434 @@
+/*! \file    multiply.cpp
+ *  \brief   Subquadratic multiplication and squaring of natural numbers.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * Products are computed by a recursive function that chooses an algorithm at every level
+ * according to the size of the operands: schoolbook multiplication for small operands, then
+ * Karatsuba, then Toom-3. The largest operands are handed to the number theoretic transform in
+ * ntt.cpp, which does not recurse. Squaring is recognized when both operands are the same array. In
+ * that case every level of the recursion squares its sub-products, which saves about a third
+ * of the work at the leaves, where sqr_basecase computes each cross product only once.
+ *
+ * The sub-products at each level are independent. When the smaller operand has at least
+ * thresholds().parallel limbs they are run with parallel_invoke, so the top levels of a large
+ * product spread over the thread pool while the smaller levels below them stay sequential.
+ *
+ * References:
+ *
+ * + Knuth, "The Art of Computer Programming," Volume 2, Section 4.3.3.
+ * + Bodrato and Zanoni, "Integer and Polynomial Multiplication: Towards Optimal Toom-Cook
+ *   Matrices," ISSAC 2007.
+ */
+
+#include <algorithm>
+#include <utility>
+
+#include "arithmetic.hpp"
+#include "backend.hpp"
+#include "kernels.hpp"
+#include "parallel.hpp"
+
+using namespace std;
+
+namespace clac::arithmetic {
+    namespace {
+
+        void multiply_into(limb_t* r, const limb_t* a, size_t a_size, const limb_t* b, size_t b_size);
+
+        //! Returns the number of limbs in a without its high order zeros.
+        size_t significant(const limb_t* a, size_t n) noexcept
+        {
+            while (n > 0 && a[n - 1] == 0)
+                --n;
+            return n;
+        }
+
+        //! r += a where a_size <= r_size. The sum must fit in r_size limbs.
+        void add_into(limb_t* r, size_t r_size, const limb_t* a, size_t a_size) noexcept
+        {
+            const limb_t carry = add_n(r, r, a, a_size);
+            add_1(r + a_size, r + a_size, r_size - a_size, carry);
+        }
+
+        //! r -= a where a_size <= r_size. The difference must not be negative.
+        void subtract_from(limb_t* r, size_t r_size, const limb_t* a, size_t a_size) noexcept
+        {
+            const limb_t borrow = sub_n(r, r, a, a_size);
+            sub_1(r + a_size, r + a_size, r_size - a_size, borrow);
+        }
+
+        //! r = a + b where a_size >= b_size. The array r has a_size limbs. Returns the carry.
+        limb_t add_spans(limb_t* r, const limb_t* a, size_t a_size, const limb_t* b, size_t b_size)
+        {
+            const limb_t carry = add_n(r, a, b, b_size);
+            return add_1(r + b_size, a + b_size, a_size - b_size, carry);
+        }
+
+        //! Multiplies two arrays of any size, including zero, into a normalized natural_t.
+        natural_t product(const limb_t* a, size_t a_size, const limb_t* b, size_t b_size)
+        {
+            a_size = significant(a, a_size);
+            b_size = significant(b, b_size);
+            if (a_size == 0 || b_size == 0)
+                return natural_t();
+
+            if (a_size < b_size) {
+                swap(a, b);
+                swap(a_size, b_size);
+            }
+            natural_t result(a_size + b_size);
+            multiply_into(result.data(), a, a_size, b, b_size);
+            normalize(result);
+            return result;
+        }
+
+        natural_t product(const natural_t& a, const natural_t& b)
+        {
+            return product(a.data(), a.size(), b.data(), b.size());
+        }
+
+        //
+        // A signed natural_t. Toom-3 evaluates its operands at -1 and its interpolation passes
+        // through negative intermediate values, so it needs a minimal signed arithmetic.
+        //
+        struct Signed {
+            natural_t magnitude;
+            bool negative;
+        };
+
+        Signed signed_add(const Signed& left, const Signed& right)
+        {
+            if (left.negative == right.negative)
+                return {add(left.magnitude, right.magnitude), left.negative};
+
+            if (compare(left.magnitude, right.magnitude) >= 0)
+                return {subtract(left.magnitude, right.magnitude), left.negative};
+            return {subtract(right.magnitude, left.magnitude), right.negative};
+        }
+
+        Signed signed_subtract(const Signed& left, const Signed& right)
+        {
+            return signed_add(left, {right.magnitude, !right.negative && !right.magnitude.empty()});
+        }
+
+        Signed signed_shift_left(const Signed& number, size_t bit_count)
+        {
+            return {shift_left(number.magnitude, bit_count), number.negative};
+        }
+
+        //! Divides by 2^bit_count. The division must be exact.
+        Signed signed_shift_right(const Signed& number, size_t bit_count)
+        {
+            return {shift_right(number.magnitude, bit_count), number.negative};
+        }
+
+        //! Divides by 3. The division must be exact.
+        Signed signed_divide_by_3(const Signed& number)
+        {
+            Signed result = {natural_t(number.magnitude.size()), number.negative};
+            divrem_1(result.magnitude.data(), number.magnitude.data(), number.magnitude.size(), 3);
+            normalize(result.magnitude);
+            return result;
+        }
+
+        Signed signed_multiply(const Signed& left, const Signed& right)
+        {
+            Signed result;
+            if (&left == &right)
+                result.magnitude = product(left.magnitude, left.magnitude);
+            else
+                result.magnitude = product(left.magnitude, right.magnitude);
+            result.negative = (left.negative != right.negative) && !result.magnitude.empty();
+            return result;
+        }
+
+        //
+        // Schoolbook multiplication of very unbalanced operands. The larger operand is cut into
+        // pieces the size of the smaller one so that every sub-product is balanced.
+        //
+        void multiply_unbalanced(
+            limb_t* r, const limb_t* a, size_t a_size, const limb_t* b, size_t b_size)
+        {
+            fill(r, r + a_size + b_size, 0);
+            natural_t piece(2 * b_size);
+
+            for (size_t offset = 0; offset < a_size; offset += b_size) {
+                const size_t length = min(b_size, a_size - offset);
+                if (length == b_size)
+                    multiply_into(piece.data(), a + offset, length, b, b_size);
+                else
+                    multiply_into(piece.data(), b, b_size, a + offset, length);
+                add_into(r + offset, a_size + b_size - offset, piece.data(), length + b_size);
+            }
+        }
+
+        //
+        // Karatsuba. With a = a1*B^h + a0 and b = b1*B^h + b0, the product is
+        //
+        //   z2*B^2h + (z1 - z2 - z0)*B^h + z0
+        //
+        // where z0 = a0*b0, z2 = a1*b1, and z1 = (a0 + a1)*(b0 + b1). The caller guarantees that
+        // b_size > h so that b1 is not empty.
+        //
+        void karatsuba(limb_t* r, const limb_t* a, size_t a_size, const limb_t* b, size_t b_size)
+        {
+            const bool squaring = (a == b);
+            const size_t h = (a_size + 1) / 2;
+
+            natural_t a_sum(h + 1);
+            a_sum[h] = add_spans(a_sum.data(), a, h, a + h, a_size - h);
+            natural_t b_sum;
+            if (!squaring) {
+                b_sum.resize(h + 1);
+                b_sum[h] = add_spans(b_sum.data(), b, h, b + h, b_size - h);
+            }
+            const natural_t& b_sum_ref = squaring ? a_sum : b_sum;
+
+            // The outer products go directly into place and the middle one into its own array.
+            natural_t middle;
+            auto low = [&] { multiply_into(r, a, h, b, h); };
+            auto high = [&] { multiply_into(r + 2 * h, a + h, a_size - h, b + h, b_size - h); };
+            auto center = [&] { middle = product(a_sum.data(), h + 1, b_sum_ref.data(), h + 1); };
+            if (b_size >= thresholds().parallel) {
+                parallel_invoke({low, high, center});
+            }
+            else {
+                low();
+                high();
+                center();
+            }
+
+            // Subtract the outer products and add what remains into the result.
+            const size_t high_size = a_size + b_size - 2 * h;
+            subtract_from(middle.data(), middle.size(), r, significant(r, 2 * h));
+            subtract_from(middle.data(), middle.size(), r + 2 * h, significant(r + 2 * h, high_size));
+            add_into(r + h, a_size + b_size - h, middle.data(), significant(middle.data(), middle.size()));
+        }
+
+        //
+        // Toom-3. Each operand is split into three pieces of k limbs, making it a polynomial of
+        // degree two in x = B^k. The polynomials are evaluated at 0, 1, -1, 2, and infinity, the
+        // five values are multiplied pointwise, and the product polynomial is recovered by
+        // interpolation. The caller guarantees that b_size > 2k so that b2 is not empty.
+        //
+        void toom3(limb_t* r, const limb_t* a, size_t a_size, const limb_t* b, size_t b_size)
+        {
+            const bool squaring = (a == b);
+            const size_t k = (a_size + 2) / 3;
+
+            auto piece = [](const limb_t* p, size_t begin, size_t end) -> Signed {
+                Signed result = {natural_t(p + begin, p + end), false};
+                normalize(result.magnitude);
+                return result;
+            };
+
+            // Evaluation. For p(x) = p0 + p1*x + p2*x^2 this computes p(0), p(1), p(-1), p(2),
+            // and p(infinity), using p(2) = 2*(p(1) + p2) - p0.
+            //
+            struct Values {
+                Signed at_0, at_1, at_minus_1, at_2, at_infinity;
+            };
+            auto evaluate = [&](const limb_t* p, size_t size) -> Values {
+                const Signed p0 = piece(p, 0, k);
+                const Signed p1 = piece(p, k, 2 * k);
+                const Signed p2 = piece(p, 2 * k, size);
+                const Signed p0_plus_p2 = signed_add(p0, p2);
+
+                Values result;
+                result.at_0 = p0;
+                result.at_1 = signed_add(p0_plus_p2, p1);
+                result.at_minus_1 = signed_subtract(p0_plus_p2, p1);
+                result.at_2 =
+                    signed_subtract(signed_shift_left(signed_add(result.at_1, p2), 1), p0);
+                result.at_infinity = p2;
+                return result;
+            };
+
+            // Pointwise products. When squaring, v refers to the same values as u, which
+            // signed_multiply recognizes.
+            const Values u = evaluate(a, a_size);
+            Values b_values;
+            if (!squaring)
+                b_values = evaluate(b, b_size);
+            const Values& v = squaring ? u : b_values;
+
+            Signed r0, r1, r_minus_1, r2, r_infinity;
+            auto multiply_at_0 = [&] { r0 = signed_multiply(u.at_0, v.at_0); };
+            auto multiply_at_1 = [&] { r1 = signed_multiply(u.at_1, v.at_1); };
+            auto multiply_at_minus_1 = [&] {
+                r_minus_1 = signed_multiply(u.at_minus_1, v.at_minus_1);
+            };
+            auto multiply_at_2 = [&] { r2 = signed_multiply(u.at_2, v.at_2); };
+            auto multiply_at_infinity = [&] {
+                r_infinity = signed_multiply(u.at_infinity, v.at_infinity);
+            };
+            if (b_size >= thresholds().parallel) {
+                parallel_invoke({multiply_at_0,
+                                 multiply_at_1,
+                                 multiply_at_minus_1,
+                                 multiply_at_2,
+                                 multiply_at_infinity});
+            }
+            else {
+                multiply_at_0();
+                multiply_at_1();
+                multiply_at_minus_1();
+                multiply_at_2();
+                multiply_at_infinity();
+            }
+
+            // Interpolation. With r(x) = c0 + c1*x + c2*x^2 + c3*x^3 + c4*x^4:
+            //
+            //   c0 = r(0), c4 = r(infinity)
+            //   c1 + c3 = (r(1) - r(-1))/2
+            //   c2 = (r(1) + r(-1))/2 - c0 - c4
+            //   c1 + 4*c3 = (r(2) - c0 - 4*c2 - 16*c4)/2
+            //
+            const Signed& c0 = r0;
+            const Signed& c4 = r_infinity;
+            const Signed odd = signed_shift_right(signed_subtract(r1, r_minus_1), 1);
+            const Signed c2 = signed_subtract(
+                signed_subtract(signed_shift_right(signed_add(r1, r_minus_1), 1), c0), c4);
+            Signed weighted = signed_subtract(r2, c0);
+            weighted = signed_subtract(weighted, signed_shift_left(c2, 2));
+            weighted = signed_subtract(weighted, signed_shift_left(c4, 4));
+            weighted = signed_shift_right(weighted, 1);
+            const Signed c3 = signed_divide_by_3(signed_subtract(weighted, odd));
+            const Signed c1 = signed_subtract(odd, c3);
+
+            // Recomposition. All of the coefficients are nonnegative.
+            const size_t r_size = a_size + b_size;
+            fill(r, r + r_size, 0);
+            const Signed* coefficients[] = {&c0, &c1, &c2, &c3, &c4};
+            for (size_t i = 0; i < 5; ++i) {
+                const natural_t& c = coefficients[i]->magnitude;
+                if (!c.empty())
+                    add_into(r + i * k, r_size - i * k, c.data(), c.size());
+            }
+        }
+
+        //
+        // The recursive driver. Requires a_size >= b_size >= 1. The array r must have room for
+        // a_size + b_size limbs and must not overlap either input. When a and b are the same
+        // array the product is computed as a square.
+        //
+        void multiply_into(limb_t* r, const limb_t* a, size_t a_size, const limb_t* b, size_t b_size)
+        {
+            const Thresholds& limits = thresholds();
+
+            // The small lower bounds keep the recursion finite however the thresholds are set.
+            if (a == b && a_size == b_size) {
+                if (a_size < max<size_t>(limits.karatsuba_square, 4))
+                    sqr_basecase(r, a, a_size);
+                else if (a_size < max<size_t>(limits.toom3_square, 5))
+                    karatsuba(r, a, a_size, a, a_size);
+                else if (a_size < limits.ntt_square)
+                    toom3(r, a, a_size, a, a_size);
+                else
+                    mul_ntt(r, a, a_size, a, a_size);
+                return;
+            }
+
+            if (b_size < max<size_t>(limits.karatsuba, 4))
+                mul_basecase(r, a, a_size, b, b_size);
+            else if (b_size >= limits.ntt)
+                mul_ntt(r, a, a_size, b, b_size);
+            else if (b_size >= max<size_t>(limits.toom3, 5) && b_size > 2 * ((a_size + 2) / 3))
+                toom3(r, a, a_size, b, b_size);
+            else if (b_size > (a_size + 1) / 2)
+                karatsuba(r, a, a_size, b, b_size);
+            else
+                multiply_unbalanced(r, a, a_size, b, b_size);
+        }
+
+    } // namespace
+
+
+    natural_t native::multiply(const natural_t& left, const natural_t& right)
+    {
+        return product(left.data(), left.size(), right.data(), right.size());
+    }
+
+
+    natural_t native::square(const natural_t& number)
+    {
+        return product(number.data(), number.size(), number.data(), number.size());
+    }
+
+
+
+    //
+    // Small products are accumulated row by row straight into the accumulator with addmul_1, so
+    // no product is formed at all. Larger ones are computed by the fast multipliers into one
+    // temporary, which is then added in place. The accumulator may be one of the factors, in
+    // which case the product is always formed first.
+    //
+    void addmul(natural_t& accumulator, const natural_t& left, const natural_t& right)
+    {
+        if (left.empty() || right.empty())
+            return;
+
+        const natural_t& longer = (left.size() >= right.size()) ? left : right;
+        const natural_t& shorter = (left.size() >= right.size()) ? right : left;
+        const size_t product_size = longer.size() + shorter.size();
+        const size_t old_size = accumulator.size();
+        const bool aliased = &accumulator == &left || &accumulator == &right;
+        if (aliased || shorter.size() >= max<size_t>(thresholds().karatsuba, 4)) {
+            const natural_t p = product(longer, shorter);
+            accumulator.resize(max(old_size, p.size()) + 1);
+            add_into(accumulator.data(), accumulator.size(), p.data(), p.size());
+        }
+        else {
+            accumulator.resize(max(old_size, product_size) + 1);
+            limb_t* r = accumulator.data();
+            const size_t r_size = accumulator.size();
+            for (size_t i = 0; i < shorter.size(); ++i) {
+                const limb_t carry = addmul_1(r + i, longer.data(), longer.size(), shorter[i]);
+                add_1(r + i + longer.size(), r + i + longer.size(),
+                      r_size - i - longer.size(), carry);
+            }
+        }
+        normalize(accumulator);
+    }
+
+
+    //
+    // When the accumulator has more limbs than the product could, the product is subtracted
+    // in place row by row with submul_1 (if it is small). Otherwise the product is formed, the
+    // two are compared, and the smaller is subtracted from the larger in whichever buffer holds
+    // the larger.
+    //
+    bool submul(natural_t& accumulator, const natural_t& left, const natural_t& right)
+    {
+        if (left.empty() || right.empty())
+            return false;
+
+        const natural_t& longer = (left.size() >= right.size()) ? left : right;
+        const natural_t& shorter = (left.size() >= right.size()) ? right : left;
+        const bool aliased = &accumulator == &left || &accumulator == &right;
+        if (!aliased && accumulator.size() > longer.size() + shorter.size() &&
+            shorter.size() < max<size_t>(thresholds().karatsuba, 4)) {
+            limb_t* r = accumulator.data();
+            const size_t r_size = accumulator.size();
+            for (size_t i = 0; i < shorter.size(); ++i) {
+                const limb_t borrow = submul_1(r + i, longer.data(), longer.size(), shorter[i]);
+                sub_1(r + i + longer.size(), r + i + longer.size(),
+                      r_size - i - longer.size(), borrow);
+            }
+            normalize(accumulator);
+            return false;
+        }
+
+        natural_t p = product(longer, shorter);
+        if (compare(accumulator, p) >= 0) {
+            subtract_from(accumulator.data(), accumulator.size(), p.data(), p.size());
+            normalize(accumulator);
+            return false;
+        }
+        subtract_from(p.data(), p.size(), accumulator.data(), accumulator.size());
+        normalize(p);
+        accumulator = move(p);
+        return true;
+    }
+
+} // namespace clac::arithmetic
@@ -0,0 +1,341 @@
+/*! \file    ntt.cpp
+ *  \brief   Multiplication of very large natural numbers with number theoretic transforms.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * The limbs of each operand are treated as the coefficients of a polynomial. The product of the
+ * polynomials is computed with a number theoretic transform (an FFT over the integers modulo a
+ * prime) three times, using three different primes of about 62 bits. Each coefficient of the
+ * product is less than n * 2^128 for a transform of length n, which is well below the product
+ * of the three primes, so the exact coefficients are recovered with the Chinese Remainder
+ * Theorem. Carrying the coefficients into limbs then gives the product of the numbers.
+ *
+ * All three primes have the form c * 2^40 + 1, which allows transforms of up to 2^40 points.
+ * Arithmetic modulo each prime uses Montgomery multiplication so that no division is needed.
+ *
+ * The three convolutions are independent, and so are the transforms of the two operands within
+ * each one. For operands of at least thresholds().parallel limbs they are run in parallel.
+ *
+ * References:
+ *
+ * + Knuth, "The Art of Computer Programming," Volume 2, Section 4.3.3.
+ * + Montgomery, "Modular Multiplication Without Trial Division," Mathematics of Computation
+ *   44(170), 1985.
+ */
+
+#include <stdexcept>
+#include <vector>
+
+#include "kernels.hpp"
+#include "parallel.hpp"
+
+using namespace std;
+
+namespace clac::arithmetic {
+    namespace {
+
+        //
+        // A prime modulus with its Montgomery constants. A value x is held in Montgomery form as
+        // x * 2^64 mod p. Values are always fully reduced. Because p < 2^62, sums of two reduced
+        // values never overflow a limb.
+        //
+        class Modulus {
+        public:
+            Modulus(limb_t prime, limb_t generator);
+
+            limb_t prime() const noexcept { return p; }
+
+            //! Returns (high * 2^64 + low) / 2^64 mod p. Requires high < p.
+            limb_t reduce(limb_t high, limb_t low) const noexcept
+            {
+                limb_t correction;
+                const limb_t m = low * inverse;
+                multiply_wide(m, p, correction);
+                return (high >= correction) ? high - correction : high - correction + p;
+            }
+
+            limb_t add(limb_t a, limb_t b) const noexcept
+            {
+                const limb_t sum = a + b;
+                return (sum >= p) ? sum - p : sum;
+            }
+
+            limb_t subtract(limb_t a, limb_t b) const noexcept
+            {
+                return (a >= b) ? a - b : a - b + p;
+            }
+
+            //! Montgomery product. If only one factor is in Montgomery form, the result is not.
+            limb_t multiply(limb_t a, limb_t b) const noexcept
+            {
+                limb_t high;
+                const limb_t low = multiply_wide(a, b, high);
+                return reduce(high, low);
+            }
+
+            //! Converts any limb value to Montgomery form.
+            limb_t to_montgomery(limb_t x) const noexcept { return multiply(x, r_squared); }
+
+            //! Returns base^exponent. The base and the result are in Montgomery form.
+            limb_t power(limb_t base, limb_t exponent) const noexcept;
+
+            //! Returns a primitive n-th root of unity in Montgomery form. Requires n | p - 1.
+            limb_t root_of_unity(limb_t n) const noexcept
+            {
+                return power(to_montgomery(g), (p - 1) / n);
+            }
+
+            //! Returns the inverse of the reduced value x in Montgomery form.
+            limb_t inverse_of(limb_t x) const noexcept { return power(to_montgomery(x), p - 2); }
+
+        private:
+            limb_t p;
+            limb_t g;         // A generator of the multiplicative group.
+            limb_t inverse;   // p^-1 mod 2^64.
+            limb_t r_squared; // 2^128 mod p.
+        };
+
+
+        Modulus::Modulus(limb_t prime, limb_t generator) : p(prime), g(generator)
+        {
+            // Newton's iteration doubles the number of correct low order bits at each step.
+            // Every odd p is its own inverse modulo 8, so five steps give 96 > 64 bits.
+            inverse = p;
+            for (int i = 0; i < 5; ++i) {
+                inverse *= 2 - p * inverse;
+            }
+
+            limb_t r_modulo_p;
+            divide_wide(1, 0, p, r_modulo_p);
+            limb_t high;
+            const limb_t low = multiply_wide(r_modulo_p, r_modulo_p, high);
+            divide_wide(high, low, p, r_squared);
+        }
+
+
+        limb_t Modulus::power(limb_t base, limb_t exponent) const noexcept
+        {
+            limb_t result = to_montgomery(1);
+            while (exponent != 0) {
+                if (exponent & 1)
+                    result = multiply(result, base);
+                base = multiply(base, base);
+                exponent >>= 1;
+            }
+            return result;
+        }
+
+
+        constexpr int PRIME_COUNT = 3;
+        constexpr int MAXIMUM_LOG_LENGTH = 40;
+
+        const Modulus* moduli()
+        {
+            static const Modulus primes[PRIME_COUNT] = {
+                Modulus(0x3FFFC00000000001ULL, 11),
+                Modulus(0x3FFFBE0000000001ULL, 3),
+                Modulus(0x3FFF840000000001ULL, 19)};
+            return primes;
+        }
+
+        //
+        // Builds the twiddle factors for transforms of length n with the given primitive n-th
+        // root of unity. The butterflies that combine blocks of 2*half points use the powers of
+        // a primitive (2*half)-th root, and they are stored at indices [half, 2*half). Every
+        // level is a contiguous run, which keeps the inner loops sequential in memory.
+        //
+        vector<limb_t> make_twiddles(const Modulus& m, size_t n, limb_t root)
+        {
+            vector<limb_t> twiddles(n);
+            const size_t half = n / 2;
+            limb_t power = m.to_montgomery(1);
+            for (size_t j = 0; j < half; ++j) {
+                twiddles[half + j] = power;
+                power = m.multiply(power, root);
+            }
+            for (size_t level = half / 2; level >= 1; level /= 2) {
+                for (size_t j = 0; j < level; ++j) {
+                    twiddles[level + j] = twiddles[2 * (level + j)];
+                }
+            }
+            return twiddles;
+        }
+
+        //! Decimation in frequency. The input is in natural order; the output is bit reversed.
+        void forward_transform(const Modulus& m, vector<limb_t>& a, const vector<limb_t>& twiddles)
+        {
+            const size_t n = a.size();
+            for (size_t half = n / 2; half >= 1; half /= 2) {
+                for (size_t start = 0; start < n; start += 2 * half) {
+                    limb_t* low = a.data() + start;
+                    limb_t* high = low + half;
+                    for (size_t j = 0; j < half; ++j) {
+                        const limb_t u = low[j];
+                        const limb_t v = high[j];
+                        low[j] = m.add(u, v);
+                        high[j] = m.multiply(m.subtract(u, v), twiddles[half + j]);
+                    }
+                }
+            }
+        }
+
+        //! Decimation in time. The input is bit reversed; the output is in natural order.
+        void inverse_transform(const Modulus& m, vector<limb_t>& a, const vector<limb_t>& twiddles)
+        {
+            const size_t n = a.size();
+            for (size_t half = 1; half < n; half *= 2) {
+                for (size_t start = 0; start < n; start += 2 * half) {
+                    limb_t* low = a.data() + start;
+                    limb_t* high = low + half;
+                    for (size_t j = 0; j < half; ++j) {
+                        const limb_t u = low[j];
+                        const limb_t v = m.multiply(high[j], twiddles[half + j]);
+                        low[j] = m.add(u, v);
+                        high[j] = m.subtract(u, v);
+                    }
+                }
+            }
+        }
+
+        //! Loads n limbs into a transform buffer in Montgomery form and transforms them.
+        vector<limb_t> transform(
+            const Modulus& m,
+            const limb_t* a,
+            size_t a_size,
+            size_t length,
+            const vector<limb_t>& twiddles)
+        {
+            vector<limb_t> result(length, 0);
+            for (size_t i = 0; i < a_size; ++i) {
+                result[i] = m.to_montgomery(a[i]);
+            }
+            forward_transform(m, result, twiddles);
+            return result;
+        }
+
+        //
+        // Computes the coefficients of the product modulo one prime. The coefficients are
+        // returned as ordinary (not Montgomery) values. The 1/n scaling of the inverse transform
+        // and the conversion out of Montgomery form are done by a single multiplication.
+        //
+        vector<limb_t> convolve(
+            const Modulus& m,
+            const limb_t* a,
+            size_t a_size,
+            const limb_t* b,
+            size_t b_size,
+            size_t length,
+            int log_length)
+        {
+            const limb_t root = m.root_of_unity(length);
+            const vector<limb_t> twiddles = make_twiddles(m, length, root);
+
+            vector<limb_t> result;
+            if (a == b && a_size == b_size) {
+                result = transform(m, a, a_size, length, twiddles);
+                for (limb_t& x : result) {
+                    x = m.multiply(x, x);
+                }
+            }
+            else {
+                vector<limb_t> other;
+                auto transform_a = [&] { result = transform(m, a, a_size, length, twiddles); };
+                auto transform_b = [&] { other = transform(m, b, b_size, length, twiddles); };
+                if (b_size >= thresholds().parallel) {
+                    parallel_invoke({transform_a, transform_b});
+                }
+                else {
+                    transform_a();
+                    transform_b();
+                }
+                for (size_t i = 0; i < length; ++i) {
+                    result[i] = m.multiply(result[i], other[i]);
+                }
+            }
+
+            const vector<limb_t> inverse_twiddles =
+                make_twiddles(m, length, m.inverse_of(m.multiply(root, 1)));
+            inverse_transform(m, result, inverse_twiddles);
+
+            // 1/n = p - (p - 1)/n because n divides p - 1.
+            const limb_t length_inverse = m.prime() - ((m.prime() - 1) >> log_length);
+            for (limb_t& x : result) {
+                x = m.multiply(x, length_inverse);
+            }
+            return result;
+        }
+
+    } // namespace
+
+
+    //
+    // Garner's algorithm recovers each coefficient x from its residues x0, x1, x2 as
+    //
+    //   x = x0 + p0*v1 + p0*p1*v2
+    //
+    // with v1 = (x1 - x0)/p0 mod p1 and v2 = (x2 - x0 - p0*v1)/(p0*p1) mod p2. The three limb
+    // coefficients are then added into the result with a running carry.
+    //
+    void mul_ntt(limb_t* r, const limb_t* a, size_t a_size, const limb_t* b, size_t b_size)
+    {
+        const Modulus* m = moduli();
+        const size_t coefficient_count = a_size + b_size - 1;
+        size_t length = 2;
+        int log_length = 1;
+        while (length < coefficient_count) {
+            length *= 2;
+            ++log_length;
+        }
+        // A product this large would need hundreds of terabytes of memory anyway.
+        if (log_length > MAXIMUM_LOG_LENGTH)
+            throw std::length_error("mul_ntt: operands too large");
+
+        vector<limb_t> residues[PRIME_COUNT];
+        auto find_residues = [&](int i) {
+            residues[i] = convolve(m[i], a, a_size, b, b_size, length, log_length);
+        };
+        if (b_size >= thresholds().parallel) {
+            parallel_invoke({[&] { find_residues(0); },
+                             [&] { find_residues(1); },
+                             [&] { find_residues(2); }});
+        }
+        else {
+            for (int i = 0; i < PRIME_COUNT; ++i) {
+                find_residues(i);
+            }
+        }
+
+        const limb_t p0 = m[0].prime();
+        const limb_t p1 = m[1].prime();
+        const limb_t p2 = m[2].prime();
+        const limb_t p0_inverse = m[1].inverse_of(p0 % p1);
+        const limb_t p0_modulo_p2 = m[2].to_montgomery(p0);
+        limb_t p0_p1[2];
+        p0_p1[0] = multiply_wide(p0, p1, p0_p1[1]);
+        const limb_t p0_p1_inverse = m[2].inverse_of(m[2].multiply(p0_modulo_p2, p1 % p2));
+
+        limb_t carry[3] = {0, 0, 0};
+        for (size_t i = 0; i < coefficient_count; ++i) {
+            const limb_t x0 = residues[0][i];
+            const limb_t x1 = residues[1][i];
+            const limb_t x2 = residues[2][i];
+
+            const limb_t v1 = m[1].multiply(m[1].subtract(x1, x0 % p1), p0_inverse);
+            const limb_t partial = m[2].add(x0 % p2, m[2].multiply(v1 % p2, p0_modulo_p2));
+            const limb_t v2 = m[2].multiply(m[2].subtract(x2, partial), p0_p1_inverse);
+
+            // coefficient = x0 + p0*v1 + p0*p1*v2.
+            limb_t coefficient[3];
+            coefficient[0] = multiply_wide(p0, v1, coefficient[1]);
+            coefficient[2] = add_1(coefficient, coefficient, 2, x0);
+            coefficient[2] += addmul_1(coefficient, p0_p1, 2, v2);
+
+            add_n(carry, carry, coefficient, 3);
+            r[i] = carry[0];
+            carry[0] = carry[1];
+            carry[1] = carry[2];
+            carry[2] = 0;
+        }
+        r[coefficient_count] = carry[0];
+    }
+
+} // namespace clac::arithmetic
@@ -0,0 +1,231 @@
+/*! \file    parallel.cpp
+ *  \brief   Implementation of the thread pool used by the arithmetic module.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * The pool is a set of worker threads that take tasks from a shared stack. A thread that waits
+ * in parallel_invoke for its tasks to finish runs queued tasks in the meantime, so nested calls
+ * can't deadlock even when every worker is waiting on tasks of its own. The stack gives the
+ * most recently queued task, which is usually one of the waiting thread's own sub-products.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "arithmetic.hpp"
+#include "parallel.hpp"
+
+using namespace std;
+
+namespace clac::arithmetic {
+    namespace {
+
+        // The tasks from one call to parallel_invoke share a group that counts the unfinished
+        // ones and holds the first exception thrown.
+        struct Group {
+            mutex lock;
+            condition_variable finished;
+            size_t pending;
+            exception_ptr error;
+        };
+
+        struct Task {
+            const function<void()>* body;
+            Group* group;
+        };
+
+        //! Runs a task and records its completion in its group.
+        void run(const Task& task)
+        {
+            exception_ptr error;
+            try {
+                (*task.body)();
+            }
+            catch (...) {
+                error = current_exception();
+            }
+
+            lock_guard<mutex> guard(task.group->lock);
+            if (error && !task.group->error)
+                task.group->error = error;
+            if (--task.group->pending == 0)
+                task.group->finished.notify_all();
+        }
+
+        class Pool {
+        public:
+            explicit Pool(size_t worker_count);
+            ~Pool();
+
+            Pool(const Pool&) = delete;
+            Pool& operator=(const Pool&) = delete;
+
+            void submit(const Task& task);
+
+            //! Runs one queued task. Returns false if there was none.
+            bool run_queued();
+
+        private:
+            void work();
+
+            mutex lock;
+            condition_variable available;
+            vector<Task> queue;
+            vector<thread> workers;
+            bool stopping = false;
+        };
+
+
+        Pool::Pool(size_t worker_count)
+        {
+            for (size_t i = 0; i < worker_count; ++i) {
+                workers.emplace_back(&Pool::work, this);
+            }
+        }
+
+
+        Pool::~Pool()
+        {
+            {
+                lock_guard<mutex> guard(lock);
+                stopping = true;
+            }
+            available.notify_all();
+            for (thread& worker : workers) {
+                worker.join();
+            }
+        }
+
+
+        void Pool::submit(const Task& task)
+        {
+            {
+                lock_guard<mutex> guard(lock);
+                queue.push_back(task);
+            }
+            available.notify_one();
+        }
+
+
+        bool Pool::run_queued()
+        {
+            Task task;
+            {
+                lock_guard<mutex> guard(lock);
+                if (queue.empty())
+                    return false;
+                task = queue.back();
+                queue.pop_back();
+            }
+            run(task);
+            return true;
+        }
+
+
+        void Pool::work()
+        {
+            while (true) {
+                Task task;
+                {
+                    unique_lock<mutex> guard(lock);
+                    available.wait(guard, [this] { return stopping || !queue.empty(); });
+                    if (queue.empty())
+                        return;
+                    task = queue.back();
+                    queue.pop_back();
+                }
+                run(task);
+            }
+        }
+
+
+        size_t hardware_thread_count() noexcept
+        {
+            return max<size_t>(thread::hardware_concurrency(), 1);
+        }
+
+        atomic<size_t> active_count = hardware_thread_count();
+
+        // The pool is created on first use with one worker fewer than the thread count, since
+        // the thread that calls parallel_invoke does its share of the work.
+        mutex pool_lock;
+        unique_ptr<Pool> active_pool;
+
+        Pool& pool()
+        {
+            lock_guard<mutex> guard(pool_lock);
+            if (!active_pool)
+                active_pool = make_unique<Pool>(active_count - 1);
+            return *active_pool;
+        }
+
+        //! Runs the 'count' tasks starting at 'first', as described for parallel_invoke.
+        void invoke_all(const function<void()>* first, size_t count)
+        {
+            if (active_count <= 1 || count <= 1) {
+                for (size_t i = 0; i < count; ++i) {
+                    first[i]();
+                }
+                return;
+            }
+
+            Pool& workers = pool();
+            Group group;
+            group.pending = count;
+            for (size_t i = 1; i < count; ++i) {
+                workers.submit({first + i, &group});
+            }
+            run({first, &group});
+
+            // Help with the queue until it is empty, then wait for the tasks other threads took.
+            while (true) {
+                {
+                    lock_guard<mutex> guard(group.lock);
+                    if (group.pending == 0)
+                        break;
+                }
+                if (!workers.run_queued()) {
+                    unique_lock<mutex> guard(group.lock);
+                    group.finished.wait(guard, [&group] { return group.pending == 0; });
+                    break;
+                }
+            }
+
+            if (group.error)
+                rethrow_exception(group.error);
+        }
+
+    } // namespace
+
+
+    size_t thread_count() noexcept
+    {
+        return active_count;
+    }
+
+
+    void set_thread_count(size_t count)
+    {
+        lock_guard<mutex> guard(pool_lock);
+        active_pool.reset();
+        active_count = (count == 0) ? hardware_thread_count() : count;
+    }
+
+
+    void parallel_invoke(initializer_list<function<void()>> tasks)
+    {
+        invoke_all(tasks.begin(), tasks.size());
+    }
+
+
+    void parallel_invoke(const vector<function<void()>>& tasks)
+    {
+        invoke_all(tasks.data(), tasks.size());
+    }
+
+} // namespace clac::arithmetic
@@ -0,0 +1,33 @@
+/*! \file    parallel.hpp
+ *  \brief   Interface to the thread pool used by the arithmetic module.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * The largest multiplications split into independent sub-products, and the top levels of the
+ * recursion hand those sub-products to a shared pool of worker threads. Factorization uses the
+ * same pool to run independent searches side by side. The pool is created the first time it is
+ * needed. Its size is set with arithmetic::set_thread_count.
+ */
+
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <functional>
+#include <initializer_list>
+#include <vector>
+
+namespace clac::arithmetic {
+
+    /*!
+     * Runs the tasks and returns when all of them have finished. If the pool has worker threads
+     * the tasks may run concurrently, so they must not write to the same memory. The calling
+     * thread runs tasks too, and a task may itself call parallel_invoke. If any task throws,
+     * the first exception is rethrown here after the others have finished.
+     */
+    void parallel_invoke(std::initializer_list<std::function<void()>> tasks);
+
+    //! As above, for a number of tasks known only at run time.
+    void parallel_invoke(const std::vector<std::function<void()>>& tasks);
+
+} // namespace clac::arithmetic
+
+#endif
@@ -0,0 +1,153 @@
+/*! \file    power.cpp
+ *  \brief   Integer exponentiation.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * Powers are computed with left-to-right sliding window exponentiation. The exponent is scanned
+ * from its most significant bit. Runs of zero bits cost one squaring each, and each window of
+ * up to k bits that starts and ends with a one bit costs one multiplication by a precomputed
+ * odd power of the base. An exponent e thus takes about log2(e) squarings and log2(e)/(k + 1)
+ * multiplications. The squarings and multiplications go through the VeryLong operations in
+ * arithmetic.cpp, so large intermediate values use the subquadratic algorithms.
+ *
+ * References:
+ *
+ * + Menezes, van Oorschot, and Vanstone, "Handbook of Applied Cryptography," Algorithm 14.85.
+ */
+
+#include <bit>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "arithmetic.hpp"
+
+using namespace std;
+
+namespace clac::arithmetic {
+    namespace {
+
+        //! Returns the window size that minimizes the number of multiplications.
+        int window_size(spica::VeryLong::size_type exponent_bits) noexcept
+        {
+            if (exponent_bits <= 8)
+                return 1;
+            if (exponent_bits <= 24)
+                return 3;
+            if (exponent_bits <= 80)
+                return 4;
+            if (exponent_bits <= 240)
+                return 5;
+            return 6;
+        }
+
+        //! Returns k if the magnitude of number is 2^k, or -1 otherwise.
+        long power_of_two(const spica::VeryLong& number)
+        {
+            const spica::VeryLong::size_type bit_count = number.number_bits();
+            for (spica::VeryLong::size_type i = 0; i + 1 < bit_count; ++i) {
+                if (number.get_bit(i))
+                    return -1;
+            }
+            return static_cast<long>(bit_count) - 1;
+        }
+
+    } // namespace
+
+
+    //
+    // Natural powers are used by the root functions, where the exponent is the index of the
+    // root. Plain left-to-right binary exponentiation is enough there.
+    //
+    natural_t power(const natural_t& base, size_t exponent)
+    {
+        if (exponent == 0)
+            return natural_t{1};
+
+        natural_t result = base;
+        for (int i = numeric_limits<size_t>::digits - countl_zero(exponent) - 2; i >= 0; --i) {
+            result = square(result);
+            if ((exponent >> i) & 1)
+                result = multiply(result, base);
+        }
+        return result;
+    }
+
+
+    spica::VeryLong power(const spica::VeryLong& base, const spica::VeryLong& exponent)
+    {
+        if (exponent < spica::VeryLong::zero)
+            throw domain_error("power: negative exponent");
+
+        // Special cases that do not depend on the size of the exponent.
+        const bool odd_exponent = exponent.get_bit(0) != 0;
+        if (exponent == spica::VeryLong::zero || base == spica::VeryLong::one)
+            return spica::VeryLong::one;
+        if (base == spica::VeryLong::zero)
+            return spica::VeryLong::zero;
+        if (base == spica::VeryLong::negative_one)
+            return odd_exponent ? spica::VeryLong::negative_one : spica::VeryLong::one;
+
+        // Any other base grows at least one bit per unit of the exponent.
+        const spica::VeryLong::size_type exponent_bits = exponent.number_bits();
+        if (exponent_bits >= numeric_limits<long>::digits)
+            throw length_error("power: result is too large");
+        const bool negative = (base < spica::VeryLong::zero) && odd_exponent;
+
+        // A power of two is a single bit.
+        const long shift = power_of_two(base);
+        if (shift >= 0) {
+            const long e = exponent.to_long();
+            if (e > numeric_limits<long>::max() / shift)
+                throw length_error("power: result is too large");
+            spica::VeryLong result;
+            result.put_bit(static_cast<spica::VeryLong::size_type>(shift * e), 1);
+            return negative ? -result : result;
+        }
+
+        // The table holds base^1, base^3, ..., base^(2^k - 1).
+        const int k = window_size(exponent_bits);
+        vector<spica::VeryLong> odd_powers(size_t{1} << (k - 1));
+        odd_powers[0] = base;
+        if (k > 1) {
+            const spica::VeryLong base_squared = square(base);
+            for (size_t i = 1; i < odd_powers.size(); ++i) {
+                odd_powers[i] = multiply(odd_powers[i - 1], base_squared);
+            }
+        }
+
+        spica::VeryLong result = spica::VeryLong::one;
+        bool started = false;
+        long i = static_cast<long>(exponent_bits) - 1;
+        while (i >= 0) {
+            if (!exponent.get_bit(static_cast<spica::VeryLong::size_type>(i))) {
+                if (started)
+                    result = square(result);
+                --i;
+                continue;
+            }
+
+            // Find the longest window [j, i] of at most k bits that ends with a one bit.
+            long j = max(i - k + 1, 0L);
+            while (!exponent.get_bit(static_cast<spica::VeryLong::size_type>(j)))
+                ++j;
+            unsigned long window = 0;
+            for (long m = i; m >= j; --m) {
+                window = (window << 1) | static_cast<unsigned long>(
+                    exponent.get_bit(static_cast<spica::VeryLong::size_type>(m)));
+            }
+
+            if (started) {
+                for (long m = i; m >= j; --m)
+                    result = square(result);
+                result = multiply(result, odd_powers[window / 2]);
+            }
+            else {
+                result = odd_powers[window / 2];
+                started = true;
+            }
+            i = j - 1;
+        }
+        return result;
+    }
+
+} // namespace clac::arithmetic
@@ -0,0 +1,907 @@
+/*! \file    prime.cpp
+ *  \brief   Primality testing and integer factorization.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * All arithmetic modulo the number being tested or factored is done in Montgomery form (see
+ * modular.hpp). Sums, differences, halves, and GCDs with the modulus are the same for forms as
+ * for the numbers they represent, so the forms are never converted back.
+ *
+ * The strong Lucas test uses Selfridge's parameters: D is the first of 5, -7, 9, -11, ... whose
+ * Jacobi symbol (D/n) is -1, P = 1, and Q = (1 - D) / 4. The sequences are computed from the top
+ * bit of the exponent down, doubling the index at each bit and adding one where the bit is set.
+ *
+ * Brent's rho multiplies the differences of a batch of iterates together and takes one GCD for
+ * the batch. If that GCD is the whole modulus, the batch is replayed one step at a time.
+ *
+ * The elliptic curve method uses Montgomery curves By^2 = x^3 + Ax^2 + x with Suyama's
+ * parameterization, so that the group order is divisible by 12. Points are kept as X:Z with
+ * (A + 2) / 4 as a fraction, which avoids every modular inversion. Stage 1 multiplies the point
+ * by every prime power up to B1. Stage 2 is the standard continuation: the products X_R Z_S -
+ * X_S Z_R for R = rQ and S = 2dQ vanish modulo p when r + 2d is the order of Q modulo p, and
+ * they are accumulated for every prime r + 2d up to B2.
+ *
+ * The sieve crosses off multiples p * k of each sieving prime p only for k prime to 30, since
+ * the others fall on bits that do not exist. Both p and k are then one of eight residues modulo
+ * 30, and the distance in bytes from one multiple to the next depends only on p / 30 and on the
+ * two residues. A table indexed by the residues holds the bit to clear and the part of that
+ * distance not proportional to p / 30, so the inner loop never divides.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "kernels.hpp"
+#include "modular.hpp"
+#include "parallel.hpp"
+#include "prime.hpp"
+
+using namespace std;
+
+namespace clac::arithmetic {
+    namespace {
+
+        static_assert(atomic<bool>::is_always_lock_free && atomic<int>::is_always_lock_free);
+
+        // The number of operations in progress that request_cancel can stop.
+        atomic<int> cancellable_count{0};
+        atomic<bool> cancel_requested{false};
+
+        //! Makes request_cancel apply to the operation in whose scope this object lives.
+        class CancelScope {
+        public:
+            CancelScope() noexcept
+            {
+                if (cancellable_count++ == 0)
+                    cancel_requested = false;
+            }
+
+            ~CancelScope()
+            {
+                --cancellable_count;
+            }
+
+            CancelScope(const CancelScope&) = delete;
+            CancelScope& operator=(const CancelScope&) = delete;
+        };
+
+        void check_cancel()
+        {
+            if (cancel_requested.load(memory_order_relaxed))
+                throw Cancelled();
+        }
+
+        //! Returns the primes less than 'limit' in increasing order.
+        vector<uint32_t> primes_below(uint32_t limit)
+        {
+            vector<uint32_t> result;
+            if (limit > 2)
+                result.push_back(2);
+
+            // Element i stands for the odd number 2i + 1.
+            vector<bool> composite(limit / 2, false);
+            for (uint32_t i = 1; i < limit / 2; ++i) {
+                if (composite[i])
+                    continue;
+                const uint64_t p = 2 * uint64_t{i} + 1;
+                result.push_back(static_cast<uint32_t>(p));
+                for (uint64_t j = p * p / 2; j < limit / 2; j += p) {
+                    composite[j] = true;
+                }
+            }
+            return result;
+        }
+
+        constexpr uint32_t TRIAL_LIMIT = 1U << 16;
+
+        //! Returns the primes below TRIAL_LIMIT.
+        const vector<uint32_t>& small_primes()
+        {
+            static const vector<uint32_t> table = primes_below(TRIAL_LIMIT);
+            return table;
+        }
+
+        //! Returns number mod divisor for a divisor less than 2^32.
+        uint64_t remainder_small(const natural_t& number, uint64_t divisor) noexcept
+        {
+            uint64_t remainder = 0;
+            for (size_t i = number.size(); i > 0; --i) {
+                remainder = ((remainder << 32) | (number[i - 1] >> 32)) % divisor;
+                remainder = ((remainder << 32) | (number[i - 1] & 0xFFFFFFFF)) % divisor;
+            }
+            return remainder;
+        }
+
+        bool is_one(const natural_t& number) noexcept
+        {
+            return number.size() == 1 && number[0] == 1;
+        }
+
+        bool test_bit(const natural_t& number, size_t index) noexcept
+        {
+            return ((number[index / LIMB_BITS] >> (index % LIMB_BITS)) & 1) != 0;
+        }
+
+        natural_t distance(const natural_t& left, const natural_t& right)
+        {
+            return (compare(left, right) >= 0) ? subtract(left, right) : subtract(right, left);
+        }
+
+        //! Returns the form of the small signed number 'value'.
+        natural_t signed_form(const Montgomery& ring, int64_t value)
+        {
+            const natural_t form = ring.to_form(natural_t{static_cast<limb_t>(std::abs(value))});
+            return (value < 0) ? subtract_mod(natural_t(), form, ring.modulus()) : form;
+        }
+
+        //! Returns x / 2 modulo the odd modulus n.
+        natural_t halve(const natural_t& x, const natural_t& n)
+        {
+            if (x.empty() || (x[0] & 1) == 0)
+                return shift_right(x, 1);
+            return shift_right(add(x, n), 1);
+        }
+
+        // Primality.
+        // ----------
+
+        //! Returns true if the number is a strong probable prime to the base. Requires n odd.
+        bool strong_probable_prime(const Montgomery& ring, limb_t base)
+        {
+            const natural_t& n = ring.modulus();
+            const natural_t n_minus_1 = subtract(n, natural_t{1});
+            const size_t s = trailing_zeros(n_minus_1);
+            const natural_t minus_one = ring.to_form(n_minus_1);
+
+            natural_t x = ring.power(ring.to_form(natural_t{base}), shift_right(n_minus_1, s));
+            if (x == ring.one() || x == minus_one)
+                return true;
+            for (size_t r = 1; r < s; ++r) {
+                x = ring.square(x);
+                if (x == minus_one)
+                    return true;
+                if (x == ring.one())
+                    return false;
+            }
+            return false;
+        }
+
+        //! Returns the Jacobi symbol (a/n) for odd n.
+        int jacobi_small(uint64_t a, uint64_t n) noexcept
+        {
+            int result = 1;
+            a %= n;
+            while (a != 0) {
+                while (a % 2 == 0) {
+                    a /= 2;
+                    if (n % 8 == 3 || n % 8 == 5)
+                        result = -result;
+                }
+                swap(a, n);
+                if (a % 4 == 3 && n % 4 == 3)
+                    result = -result;
+                a %= n;
+            }
+            return (n == 1) ? result : 0;
+        }
+
+        //! Returns the Jacobi symbol (a/n) for odd a with |a| < 2^32 and odd n.
+        int jacobi(int64_t a, const natural_t& n) noexcept
+        {
+            const auto magnitude = static_cast<uint64_t>(std::abs(a));
+            int result = 1;
+            if (a < 0 && (n[0] & 3) == 3)
+                result = -result;
+            if ((magnitude & 3) == 3 && (n[0] & 3) == 3)
+                result = -result;
+            return result * jacobi_small(remainder_small(n, magnitude), magnitude);
+        }
+
+        //! Returns true if n is a strong Lucas probable prime. Requires n odd and above 2^32.
+        bool strong_lucas_probable_prime(const Montgomery& ring)
+        {
+            const natural_t& n = ring.modulus();
+
+            // There is no suitable D for a square.
+            bool exact;
+            root(n, 2, exact);
+            if (exact)
+                return false;
+
+            int64_t d = 5;
+            while (true) {
+                const int symbol = jacobi(d, n);
+                if (symbol == 0)
+                    return false;
+                if (symbol == -1)
+                    break;
+                d = (d > 0) ? -(d + 2) : -d + 2;
+            }
+            const natural_t d_form = signed_form(ring, d);
+            const natural_t q_form = signed_form(ring, (1 - d) / 4);
+
+            const natural_t n_plus_1 = add(n, natural_t{1});
+            const size_t s = trailing_zeros(n_plus_1);
+            const natural_t k = shift_right(n_plus_1, s);
+
+            natural_t u = ring.one();
+            natural_t v = ring.one();
+            natural_t q_power = q_form;
+            for (size_t i = bit_length(k) - 1; i > 0; --i) {
+                u = ring.multiply(u, v);
+                v = subtract_mod(ring.square(v), add_mod(q_power, q_power, n), n);
+                q_power = ring.square(q_power);
+                if (test_bit(k, i - 1)) {
+                    const natural_t next_u = halve(add_mod(u, v, n), n);
+                    v = halve(add_mod(ring.multiply(d_form, u), v, n), n);
+                    u = next_u;
+                    q_power = ring.multiply(q_power, q_form);
+                }
+            }
+
+            if (u.empty() || v.empty())
+                return true;
+            for (size_t r = 1; r < s; ++r) {
+                v = subtract_mod(ring.square(v), add_mod(q_power, q_power, n), n);
+                if (v.empty())
+                    return true;
+                q_power = ring.square(q_power);
+            }
+            return false;
+        }
+
+        // Factorization.
+        // --------------
+
+        //! Returns g if it is a proper factor of n, otherwise zero.
+        natural_t proper(natural_t g, const natural_t& n)
+        {
+            return (is_one(g) || g == n) ? natural_t() : g;
+        }
+
+        // The longest rho walk is about twice this many steps.
+        constexpr size_t RHO_LIMIT = size_t{1} << 18;
+
+        //
+        // Brent's rho with the map y -> y^2 + c. Returns a proper factor of the modulus, or zero
+        // if the walk fails, runs past RHO_LIMIT, or another search has found a factor.
+        //
+        natural_t rho(const Montgomery& ring, limb_t c_value, const atomic<bool>& found)
+        {
+            constexpr size_t BATCH = 128;
+            const natural_t& n = ring.modulus();
+            const natural_t c = ring.to_form(natural_t{c_value});
+            auto step = [&](const natural_t& y) { return add_mod(ring.square(y), c, n); };
+
+            natural_t x;
+            natural_t y = ring.to_form(natural_t{2});
+            natural_t product = ring.one();
+            for (size_t r = 1; r <= RHO_LIMIT; r *= 2) {
+                x = y;
+                for (size_t i = 0; i < r; ++i) {
+                    y = step(y);
+                }
+                for (size_t k = 0; k < r; k += BATCH) {
+                    check_cancel();
+                    if (found)
+                        return natural_t();
+
+                    const natural_t saved = y;
+                    for (size_t i = 0; i < min(BATCH, r - k); ++i) {
+                        y = step(y);
+                        product = ring.multiply(product, distance(x, y));
+                    }
+                    natural_t g = gcd(product, n);
+                    if (is_one(g))
+                        continue;
+                    if (g != n)
+                        return g;
+
+                    // The batch overshot, so replay it one step at a time.
+                    y = saved;
+                    do {
+                        y = step(y);
+                        g = gcd(distance(x, y), n);
+                    } while (is_one(g));
+                    return proper(g, n);
+                }
+            }
+            return natural_t();
+        }
+
+        struct Point {
+            natural_t x;
+            natural_t z;
+        };
+
+        //! A Montgomery curve with Suyama's parameterization and its starting point.
+        class Curve {
+        public:
+            Curve(const Montgomery& ring, limb_t sigma);
+
+            const Point& start() const noexcept
+            {
+                return origin;
+            }
+
+            Point twice(const Point& p) const;
+            Point sum(const Point& p, const Point& q, const Point& difference) const;
+            Point multiple(const Point& p, uint64_t k) const;
+
+        private:
+            const Montgomery& ring;
+            const natural_t& n;
+            natural_t a24_numerator;
+            natural_t a24_denominator;
+            Point origin;
+
+            natural_t add(const natural_t& a, const natural_t& b) const
+            {
+                return add_mod(a, b, n);
+            }
+
+            natural_t sub(const natural_t& a, const natural_t& b) const
+            {
+                return subtract_mod(a, b, n);
+            }
+        };
+
+
+        Curve::Curve(const Montgomery& ring, limb_t sigma) : ring(ring), n(ring.modulus())
+        {
+            const natural_t s = ring.to_form(natural_t{sigma});
+            const natural_t u = sub(ring.square(s), ring.to_form(natural_t{5}));
+            const natural_t v = add(add(s, s), add(s, s));
+            const natural_t u_cubed = ring.multiply(ring.square(u), u);
+            const natural_t v_minus_u = sub(v, u);
+
+            origin = {u_cubed, ring.multiply(ring.square(v), v)};
+            a24_numerator = ring.multiply(
+                ring.multiply(ring.square(v_minus_u), v_minus_u), add(add(add(u, u), u), v));
+            a24_denominator =
+                ring.multiply(ring.multiply(u_cubed, v), ring.to_form(natural_t{16}));
+        }
+
+
+        Point Curve::twice(const Point& p) const
+        {
+            const natural_t t1 = ring.square(add(p.x, p.z));
+            const natural_t t2 = ring.square(sub(p.x, p.z));
+            const natural_t t3 = sub(t1, t2);
+            return {
+                ring.multiply(ring.multiply(t1, t2), a24_denominator),
+                ring.multiply(
+                    t3,
+                    add(ring.multiply(a24_denominator, t2), ring.multiply(a24_numerator, t3)))};
+        }
+
+
+        Point Curve::sum(const Point& p, const Point& q, const Point& difference) const
+        {
+            const natural_t u = ring.multiply(sub(p.x, p.z), add(q.x, q.z));
+            const natural_t v = ring.multiply(add(p.x, p.z), sub(q.x, q.z));
+            return {
+                ring.multiply(difference.z, ring.square(add(u, v))),
+                ring.multiply(difference.x, ring.square(sub(u, v)))};
+        }
+
+
+        // Montgomery's ladder. Requires k >= 1.
+        Point Curve::multiple(const Point& p, uint64_t k) const
+        {
+            Point low = p;
+            Point high = twice(p);
+            for (int i = 62 - countl_zero(k); i >= 0; --i) {
+                if ((k >> i) & 1) {
+                    low = sum(high, low, p);
+                    high = twice(high);
+                }
+                else {
+                    high = sum(low, high, p);
+                    low = twice(low);
+                }
+            }
+            return low;
+        }
+
+        //
+        // Runs both stages of ECM on one curve. Returns a proper factor of the modulus, or zero
+        // if the curve fails or another search has found a factor. The primes must go up to B2.
+        //
+        natural_t ecm(
+            const Montgomery& ring,
+            limb_t sigma,
+            uint32_t b1,
+            const vector<uint32_t>& primes,
+            const atomic<bool>& found)
+        {
+            constexpr uint32_t D = 100;
+            const natural_t& n = ring.modulus();
+            const Curve curve(ring, sigma);
+
+            // Stage 1. The prime powers are gathered into one word per ladder.
+            Point q = curve.start();
+            uint64_t chunk = 1;
+            for (uint32_t p : primes) {
+                if (p > b1)
+                    break;
+                uint64_t power = p;
+                while (power * p <= b1)
+                    power *= p;
+                if (chunk > UINT64_MAX / power) {
+                    check_cancel();
+                    if (found)
+                        return natural_t();
+                    q = curve.multiple(q, chunk);
+                    chunk = 1;
+                }
+                chunk *= power;
+            }
+            q = curve.multiple(q, chunk);
+            natural_t g = gcd(q.z, n);
+            if (!is_one(g))
+                return proper(g, n);
+
+            // Stage 2. s[d] = 2dQ and beta[d] = X Z of s[d].
+            vector<Point> s(D + 1);
+            s[1] = curve.twice(q);
+            s[2] = curve.twice(s[1]);
+            for (uint32_t d = 3; d <= D; ++d) {
+                s[d] = curve.sum(s[d - 1], s[1], s[d - 2]);
+            }
+            vector<natural_t> beta(D + 1);
+            for (uint32_t d = 1; d <= D; ++d) {
+                beta[d] = ring.multiply(s[d].x, s[d].z);
+            }
+
+            uint64_t r = b1 - 1 + (b1 & 1); // The largest odd number up to B1.
+            Point current = curve.multiple(q, r);
+            Point previous = curve.multiple(q, r - 2 * D);
+            auto next = upper_bound(primes.begin(), primes.end(), b1);
+            natural_t product = ring.one();
+            while (next != primes.end()) {
+                check_cancel();
+                if (found)
+                    return natural_t();
+
+                const natural_t alpha = ring.multiply(current.x, current.z);
+                for (; next != primes.end() && *next <= r + 2 * D; ++next) {
+                    const uint64_t d = (*next - r) / 2;
+                    const natural_t term = ring.multiply(
+                        subtract_mod(current.x, s[d].x, n), add_mod(current.z, s[d].z, n));
+                    product = ring.multiply(
+                        product, subtract_mod(add_mod(term, beta[d], n), alpha, n));
+                }
+                Point following = curve.sum(current, s[D], previous);
+                previous = std::move(current);
+                current = std::move(following);
+                r += 2 * D;
+            }
+            return proper(gcd(product, n), n);
+        }
+
+        //! Runs one search per thread until one finds a factor or all have failed.
+        natural_t race(
+            size_t count, const function<natural_t(size_t, const atomic<bool>&)>& search)
+        {
+            atomic<bool> found{false};
+            mutex result_lock;
+            natural_t result;
+
+            vector<function<void()>> tasks;
+            for (size_t i = 0; i < count; ++i) {
+                tasks.emplace_back([&, i] {
+                    natural_t factor = search(i, found);
+                    if (!factor.empty()) {
+                        lock_guard<mutex> guard(result_lock);
+                        if (result.empty())
+                            result = std::move(factor);
+                        found = true;
+                    }
+                });
+            }
+            parallel_invoke(tasks);
+            return result;
+        }
+
+        // B1 and the number of curves for factors of about 15, 20, 25, and 30 digits. After the
+        // last level, curves with its bound are tried until a factor turns up.
+        struct Level {
+            uint32_t b1;
+            size_t curves;
+        };
+        constexpr Level ECM_LEVELS[] = {{2000, 25}, {11000, 90}, {50000, 300}, {250000, 700}};
+        constexpr uint32_t B2_FACTOR = 50;
+
+        //! Returns a proper factor of an odd composite that is not a perfect power.
+        natural_t find_factor(const natural_t& number)
+        {
+            const Montgomery ring(number);
+            const size_t width = max<size_t>(thread_count(), 1);
+
+            natural_t result = race(width, [&](size_t i, const atomic<bool>& found) {
+                return rho(ring, 1 + i, found);
+            });
+            if (!result.empty())
+                return result;
+
+            limb_t sigma = 6;
+            for (const Level& level : ECM_LEVELS) {
+                const vector<uint32_t> primes = primes_below(level.b1 * B2_FACTOR + 1);
+                size_t tried = 0;
+                while (true) {
+                    result = race(width, [&](size_t i, const atomic<bool>& found) {
+                        return ecm(ring, sigma + i, level.b1, primes, found);
+                    });
+                    sigma += width;
+                    tried += width;
+                    if (!result.empty())
+                        return result;
+                    if (tried >= level.curves && &level != end(ECM_LEVELS) - 1)
+                        break;
+                }
+            }
+            return result;
+        }
+
+        //! Appends the prime factors of a number with no factors below TRIAL_LIMIT.
+        void split(const natural_t& number, vector<natural_t>& factors)
+        {
+            check_cancel();
+            if (is_one(number))
+                return;
+            if (is_prime(number)) {
+                factors.push_back(number);
+                return;
+            }
+
+            // The factors of a perfect power are those of its root. Every factor exceeds 2^16, so
+            // only exponents up to a sixteenth of the bit length are possible.
+            const size_t bits = bit_length(number);
+            for (uint32_t k : small_primes()) {
+                if (k > bits / 16)
+                    break;
+                bool exact;
+                const natural_t base = root(number, k, exact);
+                if (exact) {
+                    vector<natural_t> base_factors;
+                    split(base, base_factors);
+                    for (const natural_t& base_factor : base_factors) {
+                        factors.insert(factors.end(), k, base_factor);
+                    }
+                    return;
+                }
+            }
+
+            const natural_t divisor = find_factor(number);
+            split(divisor, factors);
+            split(divide_exact(number, divisor), factors);
+        }
+
+        // The residues modulo 30 that are prime to 30, and the gaps from each one to the next.
+        constexpr uint32_t WHEEL[8] = {1, 7, 11, 13, 17, 19, 23, 29};
+        constexpr uint32_t WHEEL_GAP[8] = {6, 4, 2, 4, 2, 4, 6, 2};
+
+        // The sieve is processed in segments of this many bytes (30 numbers each).
+        constexpr uint64_t SEGMENT_BYTES = 32 * 1024;
+
+        //! Returns the position in WHEEL of the smallest residue not less than 'residue'.
+        constexpr unsigned wheel_index(uint32_t residue) noexcept
+        {
+            unsigned i = 0;
+            while (i < 7 && WHEEL[i] < residue) {
+                ++i;
+            }
+            return i;
+        }
+
+        struct WheelStep {
+            uint8_t mask;  // Clears the bit of the current multiple.
+            uint8_t carry; // Bytes to the next multiple, beyond (p / 30) * gap.
+        };
+
+        // Indexed by the positions in WHEEL of p % 30 and of the current multiplier k % 30.
+        constexpr array<array<WheelStep, 8>, 8> WHEEL_STEPS = [] {
+            array<array<WheelStep, 8>, 8> steps{};
+            for (unsigned r = 0; r < 8; ++r) {
+                for (unsigned i = 0; i < 8; ++i) {
+                    const uint32_t residue = WHEEL[r] * WHEEL[i] % 30;
+                    steps[r][i].mask = static_cast<uint8_t>(~(1U << wheel_index(residue)));
+                    steps[r][i].carry =
+                        static_cast<uint8_t>((residue + WHEEL[r] * WHEEL_GAP[i]) / 30);
+                }
+            }
+            return steps;
+        }();
+
+        //! A sieving prime with the byte and the multiplier of its next multiple.
+        struct SievingPrime {
+            uint64_t byte;
+            uint32_t quotient; // p / 30
+            uint8_t residue;   // Position of p % 30 in WHEEL.
+            uint8_t index;     // Position of k % 30 in WHEEL.
+        };
+
+        //! Returns the multiples of the sieving primes that are at least max(p^2, 30 * byte).
+        vector<SievingPrime> first_multiples(const vector<uint32_t>& primes, uint64_t byte)
+        {
+            vector<SievingPrime> result;
+            result.reserve(primes.size());
+            for (uint32_t p : primes) {
+                uint64_t k = max<uint64_t>(p, (30 * byte + p - 1) / p);
+                const unsigned index = wheel_index(k % 30);
+                k += WHEEL[index] - k % 30;
+                result.push_back({p * k / 30,
+                                  p / 30,
+                                  static_cast<uint8_t>(wheel_index(p % 30)),
+                                  static_cast<uint8_t>(index)});
+            }
+            return result;
+        }
+
+        using SegmentHandler = function<void(uint64_t, const vector<uint8_t>&)>;
+
+        //! Sieves [low, high] and passes each segment to 'handle' along with its first byte.
+        void sieve_part(const vector<uint32_t>& primes,
+                        uint64_t low,
+                        uint64_t high,
+                        const SegmentHandler& handle)
+        {
+            const uint64_t first_byte = low / 30;
+            const uint64_t last_byte = high / 30;
+            vector<SievingPrime> sieving = first_multiples(primes, first_byte);
+            vector<uint8_t> segment;
+
+            for (uint64_t begin = first_byte; begin <= last_byte; begin += SEGMENT_BYTES) {
+                check_cancel();
+                const uint64_t end = min(begin + SEGMENT_BYTES, last_byte + 1);
+                segment.assign(end - begin, 0xFF);
+                for (SievingPrime& prime : sieving) {
+                    const array<WheelStep, 8>& steps = WHEEL_STEPS[prime.residue];
+                    uint64_t byte = prime.byte;
+                    unsigned index = prime.index;
+                    while (byte < end) {
+                        segment[byte - begin] &= steps[index].mask;
+                        byte += uint64_t{prime.quotient} * WHEEL_GAP[index] + steps[index].carry;
+                        index = (index + 1) & 7;
+                    }
+                    prime.byte = byte;
+                    prime.index = static_cast<uint8_t>(index);
+                }
+
+                // Remove the numbers outside [low, high], and 1, which is not prime.
+                if (begin == first_byte) {
+                    segment.front() &= static_cast<uint8_t>(0xFF << wheel_index(low % 30));
+                    if (first_byte == 0)
+                        segment.front() &= 0xFE;
+                }
+                if (end == last_byte + 1) {
+                    const unsigned above = wheel_index(high % 30 + 1);
+                    if (high % 30 < 29)
+                        segment.back() &= static_cast<uint8_t>((1U << above) - 1);
+                }
+                handle(begin, segment);
+            }
+        }
+
+        /*!
+         * Sieves the numbers in [low, high] for low >= 7 in 'parts' disjoint pieces, which may
+         * be sieved concurrently. The handler also receives the number of the piece.
+         */
+        void sieve_range(uint64_t low,
+                         uint64_t high,
+                         size_t parts,
+                         const function<void(size_t, uint64_t, const vector<uint8_t>&)>& handle)
+        {
+            if (high > SIEVE_LIMIT)
+                throw domain_error("sieve: bound is too large");
+
+            uint64_t root = static_cast<uint64_t>(std::sqrt(static_cast<double>(high)));
+            while (root * root > high) {
+                --root;
+            }
+            while ((root + 1) * (root + 1) <= high) {
+                ++root;
+            }
+            vector<uint32_t> primes = primes_below(static_cast<uint32_t>(root + 1));
+            primes.erase(primes.begin(), upper_bound(primes.begin(), primes.end(), 5U));
+
+            // Each piece is a whole number of bytes, except possibly at the ends of the range.
+            const uint64_t first_byte = low / 30;
+            const uint64_t byte_count = high / 30 - first_byte + 1;
+            vector<function<void()>> tasks;
+            for (size_t i = 0; i < parts; ++i) {
+                const uint64_t begin = first_byte + byte_count * i / parts;
+                const uint64_t end = first_byte + byte_count * (i + 1) / parts;
+                const uint64_t part_low = max(low, 30 * begin);
+                const uint64_t part_high = min(high, 30 * end - 1);
+                tasks.emplace_back([&, i, part_low, part_high] {
+                    sieve_part(primes, part_low, part_high,
+                               [&, i](uint64_t byte, const vector<uint8_t>& segment) {
+                                   handle(i, byte, segment);
+                               });
+                });
+            }
+            parallel_invoke(tasks);
+        }
+
+        //! Returns the number of pieces worth sieving [low, high] in.
+        size_t sieve_parts(uint64_t low, uint64_t high)
+        {
+            const uint64_t segments = (high / 30 - low / 30) / SEGMENT_BYTES + 1;
+            return static_cast<size_t>(min<uint64_t>(segments, max<size_t>(thread_count(), 1)));
+        }
+
+    } // namespace
+
+
+    bool request_cancel() noexcept
+    {
+        if (cancellable_count == 0)
+            return false;
+        cancel_requested = true;
+        return true;
+    }
+
+
+    bool is_prime(const natural_t& number)
+    {
+        const vector<uint32_t>& table = small_primes();
+        if (number.empty())
+            return false;
+        if (number.size() == 1 && number[0] < TRIAL_LIMIT)
+            return binary_search(table.begin(), table.end(), static_cast<uint32_t>(number[0]));
+
+        // Most composites have a small factor.
+        for (size_t i = 0; i < 64; ++i) {
+            if (remainder_small(number, table[i]) == 0)
+                return false;
+        }
+
+        const Montgomery ring(number);
+        if (number.size() == 1) {
+            for (limb_t base : {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37}) {
+                if (!strong_probable_prime(ring, base))
+                    return false;
+            }
+            return true;
+        }
+        return strong_probable_prime(ring, 2) && strong_lucas_probable_prime(ring);
+    }
+
+
+    //
+    // Candidates are sieved by the small primes before they are tested. The residues of the
+    // first candidate are computed once, and those of later candidates follow from the offset.
+    //
+    natural_t next_prime(const natural_t& number)
+    {
+        const vector<uint32_t>& table = small_primes();
+        if (number.empty() || (number.size() == 1 && number[0] < table.back())) {
+            const limb_t value = number.empty() ? 0 : number[0];
+            return natural_t{*upper_bound(table.begin(), table.end(), value)};
+        }
+
+        const CancelScope scope;
+        const natural_t first = add(number, natural_t{(number[0] & 1) != 0 ? limb_t{2} : 1});
+        constexpr size_t SIEVE_PRIMES = 256;
+        vector<uint64_t> residues(SIEVE_PRIMES);
+        for (size_t i = 1; i < SIEVE_PRIMES; ++i) {
+            residues[i] = remainder_small(first, table[i]);
+        }
+
+        for (uint64_t offset = 0;; offset += 2) {
+            bool sieved_out = false;
+            for (size_t i = 1; i < SIEVE_PRIMES && !sieved_out; ++i) {
+                sieved_out = (residues[i] + offset) % table[i] == 0;
+            }
+            if (sieved_out)
+                continue;
+
+            check_cancel();
+            const natural_t candidate = (offset == 0) ? first : add(first, natural_t{offset});
+            if (is_prime(candidate))
+                return candidate;
+        }
+    }
+
+
+    vector<natural_t> factor(const natural_t& number)
+    {
+        if (number.empty())
+            throw domain_error("factor: zero has no factorization");
+
+        const CancelScope scope;
+        vector<natural_t> factors;
+
+        // Trial division.
+        natural_t remaining = number;
+        natural_t quotient;
+        for (uint32_t p : small_primes()) {
+            if (remaining.size() == 1 && uint64_t{p} * p > remaining[0])
+                break;
+            while (remainder_small(remaining, p) == 0) {
+                factors.push_back(natural_t{p});
+                quotient.assign(remaining.size(), 0);
+                divrem_1(quotient.data(), remaining.data(), remaining.size(), p);
+                normalize(quotient);
+                swap(remaining, quotient);
+            }
+        }
+
+        split(remaining, factors);
+        sort(factors.begin(), factors.end(), [](const natural_t& left, const natural_t& right) {
+            return compare(left, right) < 0;
+        });
+        return factors;
+    }
+
+
+    vector<uint64_t> primes_between(uint64_t low, uint64_t high)
+    {
+        vector<uint64_t> result;
+        for (uint64_t p : {2, 3, 5}) {
+            if (low <= p && p <= high)
+                result.push_back(p);
+        }
+        if (low > high || high < 7)
+            return result;
+        low = max<uint64_t>(low, 7);
+
+        const CancelScope scope;
+        const size_t parts = sieve_parts(low, high);
+        vector<vector<uint64_t>> found(parts);
+        const auto collect = [&](size_t part, uint64_t byte, const vector<uint8_t>& segment) {
+            vector<uint64_t>& primes = found[part];
+            for (size_t i = 0; i < segment.size(); ++i) {
+                for (unsigned bits = segment[i]; bits != 0; bits &= bits - 1) {
+                    primes.push_back(30 * (byte + i) + WHEEL[countr_zero(bits)]);
+                }
+            }
+        };
+        sieve_range(low, high, parts, collect);
+
+        size_t total = result.size();
+        for (const vector<uint64_t>& primes : found) {
+            total += primes.size();
+        }
+        result.reserve(total);
+        for (const vector<uint64_t>& primes : found) {
+            result.insert(result.end(), primes.begin(), primes.end());
+        }
+        return result;
+    }
+
+
+    uint64_t prime_count(uint64_t limit)
+    {
+        uint64_t count = (limit >= 2) + (limit >= 3) + (limit >= 5);
+        if (limit < 7)
+            return count;
+
+        const CancelScope scope;
+        const size_t parts = sieve_parts(7, limit);
+        vector<uint64_t> counts(parts);
+        sieve_range(7, limit, parts, [&](size_t part, uint64_t, const vector<uint8_t>& segment) {
+            uint64_t ones = 0;
+            for (uint8_t bits : segment) {
+                ones += static_cast<uint64_t>(std::popcount(bits));
+            }
+            counts[part] += ones;
+        });
+
+        for (uint64_t ones : counts) {
+            count += ones;
+        }
+        return count;
+    }
+
+} // namespace clac::arithmetic
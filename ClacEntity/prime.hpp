@@ -0,0 +1,83 @@
+/*! \file    prime.hpp
+ *  \brief   Interface to primality testing and integer factorization.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * Primality is decided by trial division for small numbers, by Miller-Rabin with a fixed set of
+ * bases below 2^64 (which is exact there), and by the Baillie-PSW test above that. No composite
+ * number is known to pass Baillie-PSW, but none has been proven not to exist.
+ *
+ * Factorization proceeds in stages of increasing cost. Factors below 2^16 are removed by trial
+ * division, perfect powers are reduced to their roots, and the remaining composites are split
+ * with Pollard's rho method and then with the elliptic curve method. Several rho walks, and
+ * several curves, run side by side on the threads of the arithmetic pool (see parallel.hpp).
+ *
+ * Ranges of primes come from a segmented sieve of Eratosthenes. Each byte of the sieve covers 30
+ * consecutive numbers with one bit for each of the eight residues prime to 30, and a segment of
+ * the sieve fits in the level 1 data cache. Disjoint parts of a long range are sieved by separate
+ * threads.
+ *
+ * References:
+ *
+ * + Baillie and Wagstaff, "Lucas Pseudoprimes," Mathematics of Computation 35(152), 1980.
+ * + Brent, "An Improved Monte Carlo Factorization Algorithm," BIT 20, 1980.
+ * + Crandall and Pomerance, "Prime Numbers: A Computational Perspective," 2nd edition,
+ *   Algorithms 3.6.9 (strong Lucas test) and 7.4.4 (ECM with Montgomery curves).
+ */
+
+#ifndef PRIME_HPP
+#define PRIME_HPP
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "arithmetic.hpp"
+
+namespace clac::arithmetic {
+
+    //! Thrown by an operation that was stopped with request_cancel.
+    class Cancelled : public std::runtime_error {
+    public:
+        Cancelled() : std::runtime_error("Operation cancelled")
+        {
+        }
+    };
+
+    /*!
+     * Asks the factorizations and prime searches in progress to stop by throwing Cancelled.
+     * Returns false if there are none. This only touches lock free atomic variables, so it may
+     * be called from a signal handler or from another thread.
+     */
+    bool request_cancel() noexcept;
+
+    //! Returns true if 'number' is prime (or, above 2^64, a Baillie-PSW probable prime).
+    bool is_prime(const natural_t& number);
+
+    //! Returns the smallest prime greater than 'number'.
+    natural_t next_prime(const natural_t& number);
+
+    /*!
+     * Returns the prime factors of 'number' in increasing order, each repeated as often as it
+     * divides 'number'. The factors of one are an empty vector. Throws std::domain_error if
+     * 'number' is zero.
+     */
+    std::vector<natural_t> factor(const natural_t& number);
+
+    //! The largest bound accepted by primes_between and prime_count.
+    constexpr std::uint64_t SIEVE_LIMIT = std::uint64_t{1} << 50;
+
+    /*!
+     * Returns the primes p with low <= p <= high in increasing order. Throws std::domain_error if
+     * 'high' is greater than SIEVE_LIMIT.
+     */
+    std::vector<std::uint64_t> primes_between(std::uint64_t low, std::uint64_t high);
+
+    /*!
+     * Returns the number of primes less than or equal to 'limit'. Throws std::domain_error if
+     * 'limit' is greater than SIEVE_LIMIT.
+     */
+    std::uint64_t prime_count(std::uint64_t limit);
+
+} // namespace clac::arithmetic
+
+#endif
@@ -0,0 +1,212 @@
+/*! \file    radix.cpp
+ *  \brief   Conversions between natural numbers and decimal strings.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * Both directions use divide and conquer. To print a number, it is divided by a power of ten
+ * with about half as many digits as the number, and the quotient and remainder are printed
+ * recursively. The remainder is padded with leading zeros. To parse a string, the string is
+ * split in two, and the value of the high part is multiplied by a power of ten and added to
+ * the value of the low part. With subquadratic multiplication and division, both directions
+ * take O(M(n) log(n)) time for n digit numbers instead of O(n^2).
+ *
+ * The powers used are 10^(19 * 2^i). Ten to the 19th is the largest power of ten that fits in
+ * a limb, and it is the base of the schoolbook conversions used for small values. The powers
+ * are computed once, on demand, and cached.
+ *
+ * References:
+ *
+ * + Brent and Zimmermann, "Modern Computer Arithmetic," Section 1.7.
+ */
+
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "arithmetic.hpp"
+#include "backend.hpp"
+#include "kernels.hpp"
+
+using namespace std;
+
+namespace clac::arithmetic {
+    namespace {
+
+        constexpr limb_t LIMB_POWER = 10000000000000000000ULL; // 10^19
+        constexpr size_t LIMB_DIGITS = 19;
+
+        //
+        // Returns 10^(19 * 2^i). A deque is used so that references to the cached values remain
+        // valid when the table grows.
+        //
+        const natural_t& power_of_ten(size_t i)
+        {
+            static mutex table_lock;
+            static deque<natural_t> table;
+
+            lock_guard<mutex> guard(table_lock);
+            if (table.empty())
+                table.push_back(natural_t{LIMB_POWER});
+            while (table.size() <= i)
+                table.push_back(square(table.back()));
+            return table[i];
+        }
+
+        //! Appends the 'width' digit decimal representation of a limb value, with leading zeros.
+        void append_padded(string& out, limb_t value, size_t width)
+        {
+            char buffer[LIMB_DIGITS];
+            for (size_t i = width; i > 0; --i) {
+                buffer[i - 1] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            }
+            out.append(buffer, width);
+        }
+
+        //
+        // Schoolbook conversion. The number is divided by 10^19 repeatedly, producing its
+        // digits in groups of 19 from the least significant end.
+        //
+        void write_basecase(const natural_t& number, size_t width, string& out)
+        {
+            natural_t work = number;
+            vector<limb_t> groups;
+            while (!work.empty()) {
+                groups.push_back(divrem_1(work.data(), work.data(), work.size(), LIMB_POWER));
+                normalize(work);
+            }
+
+            size_t digit_count = 0;
+            if (!groups.empty()) {
+                limb_t top = groups.back();
+                while (top != 0) {
+                    ++digit_count;
+                    top /= 10;
+                }
+                digit_count += LIMB_DIGITS * (groups.size() - 1);
+            }
+            if (width > digit_count)
+                out.append(width - digit_count, '0');
+            if (groups.empty())
+                return;
+
+            out += std::to_string(groups.back());
+            for (size_t i = groups.size() - 1; i > 0; --i) {
+                append_padded(out, groups[i - 1], LIMB_DIGITS);
+            }
+        }
+
+        //
+        // Appends the decimal digits of number to out. If width is nonzero the number is known
+        // to have at most that many digits and is padded with leading zeros to exactly that
+        // many. A width of zero means no padding.
+        //
+        void write_decimal(const natural_t& number, size_t width, string& out)
+        {
+            if (number.size() < max<size_t>(thresholds().radix, 2)) {
+                write_basecase(number, width, out);
+                return;
+            }
+
+            // Use the largest cached power with no more than about half the limbs of number.
+            size_t i = 0;
+            while (2 * power_of_ten(i + 1).size() - 1 <= number.size())
+                ++i;
+            const size_t low_width = LIMB_DIGITS << i;
+
+            natural_t quotient, remainder;
+            divide(number, power_of_ten(i), quotient, remainder);
+            write_decimal(quotient, (width > low_width) ? width - low_width : 0, out);
+            write_decimal(remainder, low_width, out);
+        }
+
+        //! Schoolbook parsing, 19 digits at a time.
+        natural_t parse_basecase(string_view digits)
+        {
+            natural_t result;
+            size_t position = 0;
+            size_t group_size = digits.size() % LIMB_DIGITS;
+            if (group_size == 0)
+                group_size = LIMB_DIGITS;
+
+            while (position < digits.size()) {
+                limb_t group = 0;
+                for (size_t j = 0; j < group_size; ++j) {
+                    group = 10 * group + static_cast<limb_t>(digits[position + j] - '0');
+                }
+
+                // result = result * 10^19 + group. With an empty result, add_1 returns group.
+                limb_t high = mul_1(result.data(), result.data(), result.size(), LIMB_POWER);
+                high += add_1(result.data(), result.data(), result.size(), group);
+                result.push_back(high);
+
+                position += group_size;
+                group_size = LIMB_DIGITS;
+            }
+            normalize(result);
+            return result;
+        }
+
+        natural_t parse_decimal(string_view digits)
+        {
+            if (digits.size() < LIMB_DIGITS * max<size_t>(thresholds().radix, 2))
+                return parse_basecase(digits);
+
+            // Split off the largest low part of 19 * 2^i digits that leaves a nonempty high part.
+            size_t i = 0;
+            while ((LIMB_DIGITS << (i + 1)) < digits.size())
+                ++i;
+            const size_t low_width = LIMB_DIGITS << i;
+            const size_t split = digits.size() - low_width;
+
+            const natural_t high = parse_decimal(digits.substr(0, split));
+            const natural_t low = parse_decimal(digits.substr(split));
+            return add(multiply(high, power_of_ten(i)), low);
+        }
+
+    } // namespace
+
+
+    string native::to_decimal(const natural_t& number)
+    {
+        if (number.empty())
+            return "0";
+        string result;
+        write_decimal(number, 0, result);
+        return result;
+    }
+
+
+    natural_t native::from_decimal(string_view digits)
+    {
+        return parse_decimal(digits);
+    }
+
+
+    //
+    // The VeryLong conversions are used for small values. A number of verylong_bits bits has
+    // about 0.30103 * verylong_bits decimal digits.
+    //
+    string to_string(const spica::VeryLong& number)
+    {
+        if (number.number_bits() < thresholds().verylong_bits) {
+            ostringstream formatter;
+            formatter << number;
+            return formatter.str();
+        }
+
+        const string digits = to_decimal(to_natural(number));
+        return (number < spica::VeryLong::zero) ? "-" + digits : digits;
+    }
+
+
+    spica::VeryLong from_string(const string& digits)
+    {
+        if (digits.size() < thresholds().verylong_bits * 3 / 10)
+            return spica::VeryLong(digits);
+        return to_verylong(from_decimal(digits));
+    }
+
+} // namespace clac::arithmetic
@@ -0,0 +1,201 @@
+/*! \file    root.cpp
+ *  \brief   Integer roots and perfect power detection.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * The integer part of the k-th root of n is found with Newton's iteration
+ *
+ *   x' = ((k - 1) * x + n / x^(k - 1)) / k
+ *
+ * using integer division throughout. Started from any value above the root, the iteration
+ * decreases toward the integer part of the root without passing it. The starting value comes
+ * from the root of the top half of n, computed recursively, so it is already correct to about
+ * half the bits. One step at each level then usually suffices, and the total time is a small
+ * multiple of the time for one division of n.
+ *
+ * References:
+ *
+ * + Brent and Zimmermann, "Modern Computer Arithmetic," Section 1.5.
+ * + Cohen, "A Course in Computational Algebraic Number Theory," Sections 1.7.1 and 1.7.2.
+ */
+
+#include <bit>
+#include <stdexcept>
+#include <vector>
+
+#include "arithmetic.hpp"
+#include "backend.hpp"
+#include "kernels.hpp"
+
+using namespace std;
+
+namespace clac::arithmetic {
+    namespace {
+
+        // Roots with at most this many bits are found one bit at a time.
+        constexpr size_t BASECASE_BITS = 32;
+
+        // Filter moduli. 45045 = 5 * 7 * 9 * 11 * 13.
+        constexpr limb_t SQUARE_MODULUS = 64;
+        constexpr limb_t POWER_MODULUS = 45045;
+
+        const natural_t one = {1};
+
+        //! Finds the root bit by bit, from the most significant end.
+        natural_t root_basecase(const natural_t& number, size_t k, size_t root_bits)
+        {
+            limb_t result = 0;
+            for (size_t i = root_bits; i > 0; --i) {
+                const limb_t candidate = result | (limb_t{1} << (i - 1));
+                if (compare(power(natural_t{candidate}, k), number) <= 0)
+                    result = candidate;
+            }
+            return (result == 0) ? natural_t() : natural_t{result};
+        }
+
+        //! Returns ((k - 1) * x + number / x^(k - 1)) / k.
+        natural_t newton_step(const natural_t& number, const natural_t& x, size_t k)
+        {
+            natural_t quotient, remainder;
+            divide(number, (k == 2) ? x : power(x, k - 1), quotient, remainder);
+
+            natural_t scaled(x.size() + 1);
+            scaled.back() = mul_1(scaled.data(), x.data(), x.size(), k - 1);
+            normalize(scaled);
+            natural_t sum = add(scaled, quotient);
+            divrem_1(sum.data(), sum.data(), sum.size(), k);
+            normalize(sum);
+            return sum;
+        }
+
+        //! Returns the integer part of the k-th root of a nonzero number.
+        natural_t root_floor(const natural_t& number, size_t k)
+        {
+            const size_t root_bits = (bit_length(number) + k - 1) / k;
+            if (root_bits <= BASECASE_BITS)
+                return root_basecase(number, k, root_bits);
+
+            // If r is the root of number / 2^(k*s), then (r + 1) * 2^s is above the root of
+            // number, and it agrees with the root in about the top half of its bits.
+            const size_t s = root_bits / 2;
+            natural_t x = shift_left(add(root_floor(shift_right(number, k * s), k), one), s);
+
+            // Each step stays at or above the integer part of the root, so the first x with
+            // x^k <= number is the answer. Usually one step is enough.
+            while (true) {
+                x = newton_step(number, x, k);
+                if (compare((k == 2) ? square(x) : power(x, k), number) <= 0)
+                    return x;
+            }
+        }
+
+        //! Returns a table of the residues of k-th powers modulo the given modulus.
+        vector<bool> power_residues(limb_t modulus, size_t k)
+        {
+            vector<bool> table(modulus, false);
+            for (limb_t x = 0; x < modulus; ++x) {
+                limb_t value = 1;
+                for (size_t i = 0; i < k; ++i) {
+                    value = value * x % modulus;
+                }
+                table[value] = true;
+            }
+            return table;
+        }
+
+        //
+        // Returns false if the residues of number show that it is not a k-th power. Only k = 2,
+        // 3, and 5 are tested, since those are the primes that divide phi(45045). For other
+        // primes every residue modulo 45045 is a k-th power residue.
+        //
+        bool may_be_power(limb_t residue_64, limb_t residue, size_t k)
+        {
+            static const vector<bool> squares_64 = power_residues(SQUARE_MODULUS, 2);
+            static const vector<bool> squares = power_residues(POWER_MODULUS, 2);
+            static const vector<bool> cubes = power_residues(POWER_MODULUS, 3);
+            static const vector<bool> fifth_powers = power_residues(POWER_MODULUS, 5);
+
+            switch (k) {
+            case 2:
+                return squares_64[residue_64] && squares[residue];
+            case 3:
+                return cubes[residue];
+            case 5:
+                return fifth_powers[residue];
+            default:
+                return true;
+            }
+        }
+
+        //! Returns the primes up to and including limit.
+        vector<size_t> primes_up_to(size_t limit)
+        {
+            vector<bool> composite(limit + 1, false);
+            vector<size_t> primes;
+            for (size_t p = 2; p <= limit; ++p) {
+                if (composite[p])
+                    continue;
+                primes.push_back(p);
+                for (size_t multiple = p * p; multiple <= limit; multiple += p) {
+                    composite[multiple] = true;
+                }
+            }
+            return primes;
+        }
+
+    } // namespace
+
+
+    natural_t native::root(const natural_t& number, size_t k, bool& exact)
+    {
+        if (k == 0)
+            throw domain_error("root: index is zero");
+        if (number.empty() || k == 1) {
+            exact = true;
+            return number;
+        }
+
+        natural_t result = root_floor(number, k);
+        exact = compare((k == 2) ? native::square(result) : power(result, k), number) == 0;
+        return result;
+    }
+
+
+    //
+    // If number = a^m then number = (a^(m/p))^p for every prime p that divides m, so only prime
+    // exponents need to be tried. They can't exceed the bit length of number, and each must
+    // divide the number of trailing zero bits. Residues rule out most candidates for small
+    // exponents before any root is computed.
+    //
+    bool is_perfect_power(const natural_t& number, bool odd_only)
+    {
+        if (compare(number, one) <= 0)
+            return true;
+
+        size_t zero_limbs = 0;
+        while (number[zero_limbs] == 0)
+            ++zero_limbs;
+        const size_t trailing_zeros =
+            zero_limbs * LIMB_BITS + static_cast<size_t>(countr_zero(number[zero_limbs]));
+
+        natural_t scratch = number;
+        const limb_t residue =
+            divrem_1(scratch.data(), scratch.data(), scratch.size(), POWER_MODULUS);
+        const limb_t residue_64 = number[0] % SQUARE_MODULUS;
+
+        for (size_t p : primes_up_to(bit_length(number))) {
+            if (odd_only && p == 2)
+                continue;
+            if (trailing_zeros != 0 && trailing_zeros % p != 0)
+                continue;
+            if (!may_be_power(residue_64, residue, p))
+                continue;
+
+            bool exact;
+            root(number, p, exact);
+            if (exact)
+                return true;
+        }
+        return false;
+    }
+
+} // namespace clac::arithmetic
@@ -0,0 +1,265 @@
+/*! \file    small_vector.hpp
+ *  \brief   A vector that keeps short contents inside the object itself.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * Most numbers a calculator handles fit in a few limbs, and for them a heap allocation can cost
+ * more than the arithmetic. A SmallVector holds up to N elements in an array inside the object
+ * and moves them to the heap only when it grows beyond that. Moving a SmallVector whose
+ * elements are on the heap takes over its buffer; moving one whose elements are inside the
+ * object copies at most N elements.
+ *
+ * Only the parts of the std::vector interface that the arithmetic module uses are provided. The
+ * element type must be trivially copyable. As with std::vector, elements added by the sizing
+ * constructor or by resize are value initialized, and capacity is never given back except by
+ * shrink_to_fit. Heap buffers come from a stateless allocator with the std::allocator interface,
+ * which lets natural_t take them from the limb pool.
+ */
+
+#ifndef SMALL_VECTOR_HPP
+#define SMALL_VECTOR_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+
+namespace clac::arithmetic {
+
+    template<typename T, std::size_t N, typename Allocator = std::allocator<T>>
+    class SmallVector {
+        static_assert(std::is_trivially_copyable_v<T>, "SmallVector elements must be trivial");
+        static_assert(N > 0, "SmallVector needs room for at least one element");
+
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = T&;
+        using const_reference = const T&;
+        using pointer = T*;
+        using const_pointer = const T*;
+        using iterator = T*;
+        using const_iterator = const T*;
+
+        SmallVector() noexcept : elements(local), length(0), room(N) {}
+
+        explicit SmallVector(size_type count, const T& value = T()) : SmallVector()
+        {
+            assign(count, value);
+        }
+
+        template<std::input_iterator Iterator>
+        SmallVector(Iterator first, Iterator last) : SmallVector()
+        {
+            for (; first != last; ++first) {
+                push_back(*first);
+            }
+        }
+
+        SmallVector(std::initializer_list<T> values) : SmallVector(values.begin(), values.end())
+        {}
+
+        SmallVector(const SmallVector& other) : SmallVector()
+        {
+            reserve(other.length);
+            std::copy(other.begin(), other.end(), elements);
+            length = other.length;
+        }
+
+        SmallVector(SmallVector&& other) noexcept : SmallVector()
+        {
+            take(other);
+        }
+
+        ~SmallVector()
+        {
+            release();
+        }
+
+        SmallVector& operator=(const SmallVector& other)
+        {
+            if (this != &other) {
+                length = 0;
+                reserve(other.length);
+                std::copy(other.begin(), other.end(), elements);
+                length = other.length;
+            }
+            return *this;
+        }
+
+        SmallVector& operator=(SmallVector&& other) noexcept
+        {
+            if (this != &other) {
+                release();
+                elements = local;
+                length = 0;
+                room = N;
+                take(other);
+            }
+            return *this;
+        }
+
+        SmallVector& operator=(std::initializer_list<T> values)
+        {
+            length = 0;
+            reserve(values.size());
+            std::copy(values.begin(), values.end(), elements);
+            length = values.size();
+            return *this;
+        }
+
+        // Element access.
+        T& operator[](size_type index) noexcept { return elements[index]; }
+        const T& operator[](size_type index) const noexcept { return elements[index]; }
+        T& front() noexcept { return elements[0]; }
+        const T& front() const noexcept { return elements[0]; }
+        T& back() noexcept { return elements[length - 1]; }
+        const T& back() const noexcept { return elements[length - 1]; }
+        T* data() noexcept { return elements; }
+        const T* data() const noexcept { return elements; }
+
+        // Iterators.
+        iterator begin() noexcept { return elements; }
+        const_iterator begin() const noexcept { return elements; }
+        iterator end() noexcept { return elements + length; }
+        const_iterator end() const noexcept { return elements + length; }
+
+        // Capacity.
+        bool empty() const noexcept { return length == 0; }
+        size_type size() const noexcept { return length; }
+        size_type capacity() const noexcept { return room; }
+
+        //! True if the elements are stored inside the object.
+        bool is_local() const noexcept { return elements == local; }
+
+        void reserve(size_type count)
+        {
+            if (count > room)
+                reallocate(count);
+        }
+
+        void shrink_to_fit()
+        {
+            if (is_local())
+                return;
+            if (length <= N) {
+                std::copy(begin(), end(), local);
+                Allocator().deallocate(elements, room);
+                elements = local;
+                room = N;
+            }
+            else if (length < room) {
+                reallocate(length);
+            }
+        }
+
+        // Modifiers.
+        void clear() noexcept { length = 0; }
+
+        void push_back(const T& value)
+        {
+            if (length == room)
+                grow(length + 1);
+            elements[length++] = value;
+        }
+
+        void pop_back() noexcept { --length; }
+
+        void resize(size_type count, const T& value = T())
+        {
+            if (count > length) {
+                grow(count);
+                std::fill(elements + length, elements + count, value);
+            }
+            length = count;
+        }
+
+        void assign(size_type count, const T& value)
+        {
+            length = 0;
+            reserve(count);
+            std::fill(elements, elements + count, value);
+            length = count;
+        }
+
+        //! Inserts [first, last) before 'position'. The range must not be part of this vector.
+        template<std::forward_iterator Iterator>
+        iterator insert(const_iterator position, Iterator first, Iterator last)
+        {
+            const size_type offset = static_cast<size_type>(position - elements);
+            const size_type count = static_cast<size_type>(std::distance(first, last));
+            grow(length + count);
+            std::copy_backward(elements + offset, elements + length, elements + length + count);
+            std::copy(first, last, elements + offset);
+            length += count;
+            return elements + offset;
+        }
+
+        void swap(SmallVector& other) noexcept
+        {
+            SmallVector temporary(std::move(other));
+            other = std::move(*this);
+            *this = std::move(temporary);
+        }
+
+        friend void swap(SmallVector& left, SmallVector& right) noexcept
+        {
+            left.swap(right);
+        }
+
+        friend bool operator==(const SmallVector& left, const SmallVector& right) noexcept
+        {
+            return std::equal(left.begin(), left.end(), right.begin(), right.end());
+        }
+
+    private:
+        T* elements;
+        size_type length;
+        size_type room;
+        T local[N];
+
+        void release() noexcept
+        {
+            if (!is_local())
+                Allocator().deallocate(elements, room);
+        }
+
+        //! Moves the elements to a heap buffer with room for 'count' elements.
+        void reallocate(size_type count)
+        {
+            T* buffer = Allocator().allocate(count);
+            std::copy(begin(), end(), buffer);
+            release();
+            elements = buffer;
+            room = count;
+        }
+
+        //! Makes room for 'count' elements, at least doubling the capacity if it must grow.
+        void grow(size_type count)
+        {
+            if (count > room)
+                reallocate(std::max(count, 2 * room));
+        }
+
+        //! Takes the contents of 'other' into this empty, local vector and leaves 'other' empty.
+        void take(SmallVector& other) noexcept
+        {
+            if (other.is_local()) {
+                std::copy(other.begin(), other.end(), local);
+            }
+            else {
+                elements = other.elements;
+                room = other.room;
+                other.elements = other.local;
+                other.room = N;
+            }
+            length = other.length;
+            other.length = 0;
+        }
+    };
+
+} // namespace clac::arithmetic
+
+#endif
@@ -0,0 +1,207 @@
+/*! \file    allocation_count.cpp
+ *  \brief   Program to count the heap allocations made by common arithmetic operations.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * Most values a calculator handles are a few limbs long, so for them the cost of an operation
+ * is often dominated by memory allocation rather than by arithmetic. This program replaces the
+ * global operator new with one that counts calls, then reports the average number of
+ * allocations per operation for several operand sizes. Operations on RationalEntity values
+ * include the entity itself and its result. A last table runs some long computations and
+ * reports how many of their limb buffers the limb pool supplied without going to the heap. It
+ * must be linked with the ClacEntity sources.
+ */
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include "Entities.hpp"
+#include "Timer.hpp"
+#include "arithmetic.hpp"
+
+namespace {
+
+    long allocations = 0;
+
+    void* counted_allocate(std::size_t size)
+    {
+        ++allocations;
+        if (void* block = std::malloc(size == 0 ? 1 : size))
+            return block;
+        throw std::bad_alloc();
+    }
+
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    return counted_allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return counted_allocate(size);
+}
+
+void operator delete(void* block) noexcept
+{
+    std::free(block);
+}
+
+void operator delete[](void* block) noexcept
+{
+    std::free(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept
+{
+    std::free(block);
+}
+
+void operator delete[](void* block, std::size_t) noexcept
+{
+    std::free(block);
+}
+
+// The entity library requires the program to provide these.
+namespace clac::entity {
+    void error_message(const char* message, ...)
+    {
+        va_list ap;
+
+        va_start(ap, message);
+        std::vfprintf(stderr, message, ap);
+        va_end(ap);
+        std::fputc('\n', stderr);
+    }
+
+    void info_message(const std::string& message)
+    {
+        std::cout << message << std::endl;
+    }
+}
+
+namespace {
+
+    const int N_TRIALS = 1000;
+
+    using clac::arithmetic::natural_t;
+
+    // A value with n_limbs limbs, all of them nonzero.
+    natural_t sample(std::size_t n_limbs, clac::arithmetic::limb_t seed)
+    {
+        natural_t result;
+        for (std::size_t i = 0; i < n_limbs; ++i) {
+            result.push_back(seed * 0x9E3779B97F4A7C15ULL + i + 1);
+        }
+        return result;
+    }
+
+    //! Returns the average number of allocations made by one call of 'operation'.
+    template<typename Operation>
+    double count(Operation operation)
+    {
+        const long start = allocations;
+        for (int i = 0; i < N_TRIALS; ++i) {
+            operation();
+        }
+        return static_cast<double>(allocations - start) / N_TRIALS;
+    }
+
+    void count_naturals(std::size_t n_limbs)
+    {
+        const natural_t a = sample(n_limbs, 3);
+        const natural_t b = sample(n_limbs, 5);
+        const natural_t numerator = sample(2 * n_limbs, 7);
+        natural_t quotient, remainder;
+
+        std::cout << std::setw(7) << n_limbs
+                  << std::setw(8) << count([&] { clac::arithmetic::add(a, b); })
+                  << std::setw(8) << count([&] { clac::arithmetic::subtract(a, b); })
+                  << std::setw(8) << count([&] { clac::arithmetic::multiply(a, b); })
+                  << std::setw(8) << count([&] { clac::arithmetic::square(a); })
+                  << std::setw(8) << count([&] {
+                         clac::arithmetic::divide(numerator, a, quotient, remainder);
+                     })
+                  << std::setw(8) << count([&] { clac::arithmetic::gcd(a, b); })
+                  << std::setw(8) << count([&] { natural_t copy = a; }) << "\n";
+    }
+
+    void count_rationals(const char* name, long numerator, long denominator)
+    {
+        using clac::entity::Entity;
+        using clac::entity::RationalEntity;
+
+        const RationalEntity x{spica::VeryLong(numerator), spica::VeryLong(denominator)};
+        const RationalEntity y{spica::VeryLong(numerator + 1), spica::VeryLong(denominator + 2)};
+        std::cout << std::setw(12) << name
+                  << std::setw(8) << count([&] { std::unique_ptr<Entity> r(x.plus(&y)); })
+                  << std::setw(8) << count([&] { std::unique_ptr<Entity> r(x.minus(&y)); })
+                  << std::setw(8) << count([&] { std::unique_ptr<Entity> r(x.multiply(&y)); })
+                  << std::setw(8) << count([&] { std::unique_ptr<Entity> r(x.divide(&y)); })
+                  << std::setw(8) << count([&] { std::unique_ptr<Entity> r(x.duplicate()); })
+                  << "\n";
+    }
+
+    //! Runs 'operation' once and reports the calling thread's limb pool statistics.
+    template<typename Operation>
+    void count_pool(const char* name, Operation operation)
+    {
+        clac::arithmetic::release_pool();
+        clac::arithmetic::reset_pool_statistics();
+        const long start = allocations;
+        pcc::Timer stopwatch;
+        stopwatch.start();
+        operation();
+        stopwatch.stop();
+        const clac::arithmetic::PoolStatistics statistics = clac::arithmetic::pool_statistics();
+        std::cout << std::setw(32) << name << std::setw(10) << statistics.requests
+                  << std::setw(10) << statistics.reused << std::setw(14)
+                  << (allocations - start) << std::setw(10) << stopwatch.time() << "\n";
+    }
+
+} // namespace
+
+int main()
+{
+    std::cout << std::fixed << std::setprecision(1);
+
+    std::cout << "\nAllocations per clac::arithmetic operation\n";
+    std::cout <<   "==========================================\n";
+    std::cout << "n_limbs     add     sub     mul     sqr     div     gcd    copy\n";
+    for (std::size_t n_limbs : {1, 2, 4, 8}) {
+        count_naturals(n_limbs);
+    }
+
+    std::cout << "\nAllocations per RationalEntity operation\n";
+    std::cout <<   "========================================\n";
+    std::cout << "   operands    plus   minus   times  divide    copy\n";
+    count_rationals("1/3", 1, 3);
+    count_rationals("2^40/3^30", 1L << 40, 205891132094649L);
+
+    std::cout << "\nLimb pool over long computations\n";
+    std::cout <<   "================================\n";
+    std::cout << "                     computation  requests    reused  operator new  time (ms)\n";
+    clac::arithmetic::set_thread_count(1);
+    const natural_t three{3};
+    count_pool("3^200000", [&] { clac::arithmetic::power(three, 200000); });
+    const natural_t large = clac::arithmetic::power(three, 200000);
+    count_pool("3^200000 to decimal", [&] { clac::arithmetic::to_decimal(large); });
+    const std::string digits = clac::arithmetic::to_decimal(large);
+    count_pool("3^200000 from decimal", [&] { clac::arithmetic::from_decimal(digits); });
+    count_pool("3^200000 / 7^50000", [&] {
+        natural_t quotient, remainder;
+        clac::arithmetic::divide(
+            large, clac::arithmetic::power(natural_t{7}, 50000), quotient, remainder);
+    });
+    count_pool("gcd(3^200000 + 1, 2^300000 + 1)", [&] {
+        clac::arithmetic::gcd(clac::arithmetic::add(large, natural_t{1}),
+                              clac::arithmetic::add(clac::arithmetic::power(natural_t{2}, 300000),
+                                                    natural_t{1}));
+    });
+    return 0;
+}
@@ -0,0 +1,132 @@
+/*! \file    backend_speed.cpp
+ *  \brief   Program to compare the speed of the large integer backends.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * Every backend built into the program (see backend.hpp) performs the same operations on the
+ * same operands, and the table shows the time of each backend relative to the native backend.
+ * Division divides a 2n limb numerator by an n limb denominator, exact division divides a 2n
+ * limb product by one of its n limb factors, and the cube root is taken of a 3n limb number.
+ * Arithmetic is done with one thread, because only the native backend uses more. It must be
+ * linked with the arithmetic sources of ClacEntity, and with GMP when CLAC_HAVE_GMP is defined.
+ */
+
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Timer.hpp"
+#include "arithmetic.hpp"
+#include "backend.hpp"
+
+// Each measurement repeats an operation until at least this many milliseconds pass.
+const long MINIMUM_TIME = 200;
+
+namespace {
+
+    using clac::arithmetic::Backend;
+    using clac::arithmetic::natural_t;
+
+    natural_t random_natural(std::size_t n_limbs)
+    {
+        natural_t result(n_limbs);
+        for (clac::arithmetic::limb_t& limb : result) {
+            for (int i = 0; i < 4; ++i) {
+                limb = (limb << 16) | static_cast<clac::arithmetic::limb_t>(std::rand() & 0xFFFF);
+            }
+        }
+        result[n_limbs - 1] |= clac::arithmetic::limb_t{1} << 63;
+        return result;
+    }
+
+    //! Returns the average time in microseconds for one call of 'operation'.
+    double time_operation(const std::function<void()>& operation)
+    {
+        long repetitions = 1;
+        while (true) {
+            pcc::Timer stopwatch;
+            stopwatch.start();
+            for (long i = 0; i < repetitions; ++i) {
+                operation();
+            }
+            stopwatch.stop();
+            if (stopwatch.time() >= MINIMUM_TIME)
+                return 1000.0 * static_cast<double>(stopwatch.time()) /
+                       static_cast<double>(repetitions);
+            repetitions *= 2;
+        }
+    }
+
+    //! Times one operation on n_limbs operands with every backend and prints a row.
+    void compare_backends(
+        const char* name,
+        std::size_t n_limbs,
+        const std::vector<const Backend*>& backends,
+        const std::function<void()>& operation)
+    {
+        std::cout << std::setw(13) << name << std::setw(8) << n_limbs;
+        double native = 0.0;
+        for (const Backend* backend : backends) {
+            clac::arithmetic::set_active_backend(*backend);
+            const double time = time_operation(operation);
+            if (backend == backends.front()) {
+                native = time;
+                std::cout << std::setw(14) << time;
+            }
+            else {
+                std::cout << std::setw(14) << time << " (" << std::setw(5) << native / time
+                          << "x)";
+            }
+        }
+        std::cout << "\n";
+    }
+
+} // namespace
+
+int main()
+{
+    using namespace clac::arithmetic;
+
+    const std::vector<const Backend*> backends = available_backends();
+    const Backend& original = active_backend();
+    set_thread_count(1);
+
+    std::cout << "\nLarge Integer Backends\n";
+    std::cout <<   "======================\n";
+    std::cout << "Times in microseconds; the factor is the speedup over the native backend.\n\n";
+    std::cout << "    operation n_limbs";
+    for (const Backend* backend : backends) {
+        std::cout << std::setw(14) << backend->name;
+        if (backend != backends.front())
+            std::cout << std::string(9, ' ');
+    }
+    std::cout << "\n" << std::fixed << std::setprecision(2);
+
+    for (std::size_t n_limbs : {4, 64, 1024, 16384}) {
+        const natural_t a = random_natural(n_limbs);
+        const natural_t b = random_natural(n_limbs);
+        const natural_t numerator = random_natural(2 * n_limbs);
+        const natural_t product = multiply(a, b);
+        const natural_t cube = random_natural(3 * n_limbs);
+        const std::string digits = to_decimal(a);
+        natural_t quotient, remainder;
+        bool exact;
+
+        compare_backends("multiply", n_limbs, backends, [&] { multiply(a, b); });
+        compare_backends("square", n_limbs, backends, [&] { square(a); });
+        compare_backends("divide", n_limbs, backends, [&] {
+            divide(numerator, a, quotient, remainder);
+        });
+        compare_backends("divide_exact", n_limbs, backends, [&] { divide_exact(product, b); });
+        compare_backends("gcd", n_limbs, backends, [&] { gcd(a, b); });
+        compare_backends("cube root", n_limbs, backends, [&] { root(cube, 3, exact); });
+        compare_backends("to_decimal", n_limbs, backends, [&] { to_decimal(a); });
+        compare_backends("from_decimal", n_limbs, backends, [&] { from_decimal(digits); });
+        std::cout << "\n";
+    }
+
+    set_active_backend(original);
+    set_thread_count(0);
+    return 0;
+}
@@ -0,0 +1,117 @@
+/*! \file    modular_speed.cpp
+ *  \brief   Program to measure the speed of modular exponentiation.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * Each row computes x^e mod m where x, e, and m all have the given number of bits. The power
+ * itself would have about 2^bits bits, so it is never formed. The division column is the
+ * obvious square and multiply method with a long division after every step, which is what
+ * reducing each intermediate result with the mod word amounts to. The Montgomery column uses an
+ * odd modulus and the Barrett column an even one, both with sliding windows (see modular.hpp).
+ * It must be linked with the arithmetic sources of ClacEntity.
+ */
+
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include "Timer.hpp"
+#include "arithmetic.hpp"
+#include "modular.hpp"
+
+// Each measurement repeats an operation until at least this many milliseconds pass.
+const long MINIMUM_TIME = 1000;
+
+namespace {
+
+    using clac::arithmetic::natural_t;
+
+    natural_t random_natural(std::size_t n_limbs)
+    {
+        natural_t result(n_limbs);
+        for (clac::arithmetic::limb_t& limb : result) {
+            for (int i = 0; i < 4; ++i) {
+                limb = (limb << 16) | static_cast<clac::arithmetic::limb_t>(std::rand() & 0xFFFF);
+            }
+        }
+        result[n_limbs - 1] |= clac::arithmetic::limb_t{1} << 63;
+        return result;
+    }
+
+    //! Returns the average time in milliseconds for one call of 'operation'.
+    double time_operation(const std::function<void()>& operation)
+    {
+        long repetitions = 1;
+        while (true) {
+            pcc::Timer stopwatch;
+            stopwatch.start();
+            for (long i = 0; i < repetitions; ++i) {
+                operation();
+            }
+            stopwatch.stop();
+            if (stopwatch.time() >= MINIMUM_TIME)
+                return static_cast<double>(stopwatch.time()) / static_cast<double>(repetitions);
+            repetitions *= 2;
+        }
+    }
+
+    natural_t remainder_of(const natural_t& number, const natural_t& modulus)
+    {
+        natural_t quotient, remainder;
+        clac::arithmetic::divide(number, modulus, quotient, remainder);
+        return remainder;
+    }
+
+    //! Left to right binary exponentiation with a division after every product.
+    natural_t division_power_mod(
+        const natural_t& base, const natural_t& exponent, const natural_t& modulus)
+    {
+        using namespace clac::arithmetic;
+
+        const natural_t x = remainder_of(base, modulus);
+        natural_t result{1};
+        for (std::size_t i = bit_length(exponent); i > 0; --i) {
+            result = remainder_of(square(result), modulus);
+            if ((exponent[(i - 1) / LIMB_BITS] >> ((i - 1) % LIMB_BITS)) & 1)
+                result = remainder_of(multiply(result, x), modulus);
+        }
+        return result;
+    }
+
+} // namespace
+
+int main()
+{
+    using namespace clac::arithmetic;
+
+    set_thread_count(1);
+
+    std::cout << "\nModular Exponentiation\n";
+    std::cout <<   "======================\n";
+    std::cout << "Times in milliseconds; the factor is the speedup over division.\n\n";
+    std::cout << " bits      division            montgomery               barrett\n";
+    std::cout << std::fixed << std::setprecision(2);
+
+    for (std::size_t bits : {1024, 2048, 4096}) {
+        const std::size_t n_limbs = bits / LIMB_BITS;
+        const natural_t base = random_natural(n_limbs);
+        const natural_t exponent = random_natural(n_limbs);
+        natural_t odd = random_natural(n_limbs);
+        odd[0] |= 1;
+        natural_t even = odd;
+        even[0] &= ~limb_t{1};
+
+        const double division =
+            time_operation([&] { division_power_mod(base, exponent, odd); });
+        const double montgomery = time_operation([&] { power_mod(base, exponent, odd); });
+        const double barrett = time_operation([&] { power_mod(base, exponent, even); });
+
+        std::cout << std::setw(5) << bits << std::setw(14) << division;
+        std::cout << std::setw(14) << montgomery << " (" << std::setw(5) << division / montgomery
+                  << "x)";
+        std::cout << std::setw(14) << barrett << " (" << std::setw(5) << division / barrett
+                  << "x)\n";
+    }
+
+    set_thread_count(0);
+    return 0;
+}
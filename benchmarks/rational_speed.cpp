@@ -0,0 +1,110 @@
+/*! \file    rational_speed.cpp
+ *  \brief   Program to compare eager and lazy reduction of RationalEntity values.
+ *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * This program sums long series of fractions with RationalEntity, once in eager mode, where
+ * every result is reduced to lowest terms as it is computed, and once in lazy mode, where only
+ * the final sum is reduced when it is displayed. The times include displaying the sum, so both
+ * columns do the same work from the user's point of view. It must be linked with the ClacEntity
+ * sources.
+ */
+
+#include <cstdarg>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "DisplayState.hpp"
+#include "Entities.hpp"
+#include "Timer.hpp"
+
+// The entity library requires the program to provide these.
+namespace clac::entity {
+    void error_message(const char* message, ...)
+    {
+        va_list ap;
+
+        va_start(ap, message);
+        std::vfprintf(stderr, message, ap);
+        va_end(ap);
+        std::fputc('\n', stderr);
+    }
+
+    void info_message(const std::string& message)
+    {
+        std::cout << message << std::endl;
+    }
+}
+
+namespace {
+
+    using clac::entity::Entity;
+    using clac::entity::RationalEntity;
+
+    // Returns the k-th term of a series.
+    using Term = RationalEntity (*)(long k);
+
+    RationalEntity harmonic(long k)
+    {
+        return RationalEntity(spica::VeryLong::one, spica::VeryLong(k));
+    }
+
+    RationalEntity inverse_square(long k)
+    {
+        return RationalEntity(spica::VeryLong::one, spica::VeryLong(k * k));
+    }
+
+    // The sum of 1/(k(k + 1)) telescopes to n/(n + 1).
+    RationalEntity telescoping(long k)
+    {
+        return RationalEntity(spica::VeryLong::one, spica::VeryLong(k * (k + 1)));
+    }
+
+    //
+    // Sums the first n_terms terms of the series in the given mode and displays the sum. Returns
+    // the time in milliseconds and the length of the displayed sum.
+    //
+    long time_sum(Term term, long n_terms, clac::display_state::RationalModeType mode,
+                  std::string::size_type& length)
+    {
+        clac::display_state::set_rational_mode(mode);
+        pcc::Timer stopwatch;
+        stopwatch.start();
+        std::unique_ptr<Entity> sum(
+            new RationalEntity(spica::VeryLong::zero, spica::VeryLong::one));
+        for (long k = 1; k <= n_terms; ++k) {
+            const RationalEntity next = term(k);
+            sum.reset(sum->plus(&next));
+        }
+        length = sum->display().length();
+        stopwatch.stop();
+        clac::display_state::set_rational_mode(clac::display_state::EAGER);
+        return stopwatch.time();
+    }
+
+    void time_series(const char* name, Term term)
+    {
+        std::cout << "\n" << name << "\n";
+        std::cout << std::string(std::string(name).length(), '=') << "\n";
+        std::cout << "n_terms: eager -> lazy\n";
+        for (long n_terms = 1000; n_terms <= 100000; n_terms *= 10) {
+            std::string::size_type eager_length, lazy_length;
+            const long eager_time =
+                time_sum(term, n_terms, clac::display_state::EAGER, eager_length);
+            const long lazy_time = time_sum(term, n_terms, clac::display_state::LAZY, lazy_length);
+            std::cout << n_terms << " terms: " << eager_time << " ms -> " << lazy_time << " ms";
+            if (eager_length != lazy_length)
+                std::cout << " (MISMATCH)";
+            std::cout << " (sum has " << eager_length << " characters).\n";
+        }
+    }
+
+} // namespace
+
+int main()
+{
+    time_series("Harmonic Numbers: 1/k", harmonic);
+    time_series("Basel Series: 1/k^2", inverse_square);
+    time_series("Telescoping Series: 1/(k(k + 1))", telescoping);
+    return 0;
+}
@@ -1,27 +1,211 @@
 /*! \file    verylong_speed.cpp
  *  \brief   Program to test performance of spica::VeryLong integers.
  *  \author  Peter Chapin <spicacality@kelseymountain.org>
+ *
+ * In addition to timing VeryLong itself, this program times the limb-level algorithms in
+ * ClacEntity's arithmetic module and reports the operand sizes where each multiplication
+ * algorithm, up to the number theoretic transform, overtakes the previous one, and likewise
+ * for the division, decimal conversion, and GCD algorithms. Those crossover points are the
+ * values that belong in clac::arithmetic::thresholds(). The last table sums harmonic numbers as
+ * fractions, reducing the whole sum after every term, to show the effect of the GCD algorithm on
+ * rational arithmetic. See rational_speed.cpp for RationalEntity itself.
+ *
+ * The crossover points are measured with one thread and with the kernel set chosen for this
+ * processor. A separate table times the largest products with increasing numbers of threads and
+ * reports the speedup over one thread, and another compares the kernel sets the processor
+ * supports.
  */
 
+#include <algorithm>
+#include <cstdint>
 #include <cstdlib>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Rational.hpp"
 #include "Timer.hpp"
 #include "VeryLong.hpp"
+#include "arithmetic.hpp"
+#include "kernels.hpp"
 
 const int N_TRIALS = 256;
 
+// Each crossover measurement repeats an operation until at least this many milliseconds pass.
+const long MINIMUM_TIME = 200;
+
+namespace {
+
+    clac::arithmetic::natural_t random_natural(std::size_t n_limbs)
+    {
+        clac::arithmetic::natural_t result(n_limbs);
+        for (clac::arithmetic::limb_t& limb : result) {
+            for (int i = 0; i < 4; ++i) {
+                limb = (limb << 16) | static_cast<clac::arithmetic::limb_t>(std::rand() & 0xFFFF);
+            }
+        }
+        result[n_limbs - 1] |= clac::arithmetic::limb_t{1} << 63;
+        return result;
+    }
+
+    enum class Operation { MULTIPLY, SQUARE, DIVIDE, TO_DECIMAL, GCD };
+
+    //
+    // Returns the average time in microseconds for one operation on n_limbs numbers. Division
+    // divides a 2*n_limbs numerator by an n_limbs denominator.
+    //
+    double time_operation(std::size_t n_limbs, Operation operation)
+    {
+        const clac::arithmetic::natural_t a = random_natural(n_limbs);
+        const clac::arithmetic::natural_t b = random_natural(n_limbs);
+        const clac::arithmetic::natural_t numerator = random_natural(2 * n_limbs);
+        clac::arithmetic::natural_t quotient, remainder;
+
+        long repetitions = 1;
+        while (true) {
+            pcc::Timer stopwatch;
+            stopwatch.start();
+            for (long i = 0; i < repetitions; ++i) {
+                switch (operation) {
+                case Operation::MULTIPLY:
+                    clac::arithmetic::multiply(a, b);
+                    break;
+                case Operation::SQUARE:
+                    clac::arithmetic::square(a);
+                    break;
+                case Operation::DIVIDE:
+                    clac::arithmetic::divide(numerator, a, quotient, remainder);
+                    break;
+                case Operation::TO_DECIMAL:
+                    clac::arithmetic::to_decimal(a);
+                    break;
+                case Operation::GCD:
+                    clac::arithmetic::gcd(a, b);
+                    break;
+                }
+            }
+            stopwatch.stop();
+            if (stopwatch.time() >= MINIMUM_TIME)
+                return 1000.0 * static_cast<double>(stopwatch.time()) /
+                       static_cast<double>(repetitions);
+            repetitions *= 2;
+        }
+    }
+
+    //
+    // Finds the crossover for one threshold. At each size n the product is timed with the
+    // threshold just above n (so the lower algorithm runs at the top level) and at n (so the
+    // upper algorithm runs at the top level, with the lower one below it). The crossover is the
+    // first size where the upper algorithm wins twice in a row.
+    //
+    std::size_t find_threshold(
+        const char* name,
+        std::size_t clac::arithmetic::Thresholds::*field,
+        Operation operation,
+        std::size_t low,
+        std::size_t high)
+    {
+        clac::arithmetic::Thresholds& limits = clac::arithmetic::thresholds();
+        const std::size_t original = limits.*field;
+        std::size_t crossover = 0;
+        int wins = 0;
+
+        std::cout << "\n  " << name << "\n";
+        std::cout << "  n_limbs   below (us)   above (us)\n";
+        for (std::size_t n = low; n <= high && crossover == 0; n += (n / 8 > 0) ? n / 8 : 1) {
+            limits.*field = n + 1;
+            const double below = time_operation(n, operation);
+            limits.*field = n;
+            const double above = time_operation(n, operation);
+
+            std::cout << "  " << std::setw(7) << n << std::fixed << std::setprecision(2)
+                      << std::setw(13) << below << std::setw(13) << above << "\n";
+            wins = (above < below) ? wins + 1 : 0;
+            if (wins == 2)
+                crossover = n;
+        }
+        limits.*field = original;
+        std::cout << "  crossover: ";
+        if (crossover == 0)
+            std::cout << "not found (above " << high << " limbs)\n";
+        else
+            std::cout << crossover << " limbs\n";
+        return crossover;
+    }
+
+    //! Returns the average time in milliseconds for one product of two n_limbs numbers.
+    double time_product(std::size_t n_limbs, int n_trials)
+    {
+        const clac::arithmetic::natural_t a = random_natural(n_limbs);
+        const clac::arithmetic::natural_t b = random_natural(n_limbs);
+        pcc::Timer stopwatch;
+        stopwatch.start();
+        for (int i = 0; i < n_trials; ++i) {
+            clac::arithmetic::multiply(a, b);
+        }
+        stopwatch.stop();
+        return static_cast<double>(stopwatch.time()) / n_trials;
+    }
+
+    //! Euclid's algorithm on limbs, for comparison with clac::arithmetic::gcd.
+    clac::arithmetic::natural_t euclid_gcd(
+        clac::arithmetic::natural_t a, clac::arithmetic::natural_t b)
+    {
+        while (!b.empty()) {
+            clac::arithmetic::natural_t quotient, remainder;
+            clac::arithmetic::divide(a, b, quotient, remainder);
+            a.swap(b);
+            b.swap(remainder);
+        }
+        return a;
+    }
+
+    //
+    // Computes the harmonic number 1 + 1/2 + ... + 1/n_terms one term at a time, reducing the
+    // fraction with the given GCD function after every term. Returns the denominator.
+    //
+    template<typename GCD>
+    clac::arithmetic::natural_t harmonic_number(unsigned long n_terms, GCD gcd)
+    {
+        using clac::arithmetic::natural_t;
+
+        natural_t numerator;
+        natural_t denominator = {1};
+        for (unsigned long k = 1; k <= n_terms; ++k) {
+            // p/q + 1/k = (p*k + q) / (q*k).
+            const natural_t term = {k};
+            const natural_t new_numerator =
+                clac::arithmetic::add(clac::arithmetic::multiply(numerator, term), denominator);
+            const natural_t new_denominator = clac::arithmetic::multiply(denominator, term);
+
+            const natural_t divisor = gcd(new_numerator, new_denominator);
+            natural_t remainder;
+            clac::arithmetic::divide(new_numerator, divisor, numerator, remainder);
+            clac::arithmetic::divide(new_denominator, divisor, denominator, remainder);
+        }
+        return denominator;
+    }
+
+} // namespace
+
 int main()
 {
     std::cout << "\nMultiplication\n";
     std::cout <<   "==============\n";
-    for (int n_bits = 256; n_bits <= 16384; n_bits *= 2) {
+    std::cout <<   "n_bits: VeryLong -> clac::arithmetic without NTT -> clac::arithmetic\n";
+    for (int n_bits = 256; n_bits <= (1 << 24); n_bits *= 2) {
+
+        // Use fewer trials for the largest sizes to keep the run time reasonable.
+        const int n_trials = (n_bits <= 16384) ? N_TRIALS : std::max(1, N_TRIALS * 16384 / n_bits);
 
         // Allocate the necessary arrays.
-        spica::VeryLong *m1 = new spica::VeryLong[N_TRIALS];
-        spica::VeryLong *m2 = new spica::VeryLong[N_TRIALS];
+        spica::VeryLong *m1 = new spica::VeryLong[n_trials];
+        spica::VeryLong *m2 = new spica::VeryLong[n_trials];
 
         // Fill the the input arrays with random numbers, each n_bits in size.
-        for (int i = 0; i < N_TRIALS; ++i) {
+        for (int i = 0; i < n_trials; ++i) {
             for (spica::VeryLong::size_type j = 0; j < n_bits - 1; ++j) {
                 m1[i].put_bit(j, std::rand() % 2);
                 m2[i].put_bit(j, std::rand() % 2);
@@ -31,30 +215,137 @@ int main()
             m2[i].put_bit(n_bits - 1, 1);
         }
 
+        // VeryLong's own multiplication becomes unbearably slow for the largest sizes.
         pcc::Timer stopwatch;
-        stopwatch.start();
-        for (int i = 0; i < N_TRIALS; ++i) {
-            spica::VeryLong result = m1[i] * m2[i];
+        if (n_bits <= 16384) {
+            stopwatch.start();
+            for (int i = 0; i < n_trials; ++i) {
+                spica::VeryLong result = m1[i] * m2[i];
+            }
+            stopwatch.stop();
+            std::cout << n_bits << " bits: "
+                      << static_cast<double>(stopwatch.time())/n_trials << " ms -> ";
+        }
+        else {
+            std::cout << n_bits << " bits: (skipped) -> ";
         }
-        stopwatch.stop();
-        std::cout
-            << n_bits << " bits: " << stopwatch.time()/N_TRIALS << " ms.\n";
+
+        // Force the conversion to limbs so that the fast algorithms are timed at every size. The
+        // first pass disables the NTT to show what it gains over Toom-3.
+        clac::arithmetic::Thresholds& limits = clac::arithmetic::thresholds();
+        const clac::arithmetic::Thresholds original = limits;
+        limits.verylong_bits = 0;
+        for (int pass = 0; pass < 2; ++pass) {
+            limits.ntt = (pass == 0) ? SIZE_MAX : original.ntt;
+            stopwatch.start();
+            for (int i = 0; i < n_trials; ++i) {
+                spica::VeryLong result = clac::arithmetic::multiply(m1[i], m2[i]);
+            }
+            stopwatch.stop();
+            std::cout << static_cast<double>(stopwatch.time())/n_trials
+                      << ((pass == 0) ? " ms -> " : " ms.\n");
+        }
+        limits = original;
 
         // Clean up.
         delete [] m1;
         delete [] m2;
     }
 
+    // At least four thread counts are tried, even on smaller machines, to show the overhead.
+    std::cout << "\nParallel Multiplication\n";
+    std::cout <<   "=======================\n";
+    std::cout <<   "n_bits: 1 thread -> speedup with 2, 4, ... threads\n";
+    const std::size_t max_threads = std::max(4U, std::thread::hardware_concurrency());
+    for (int n_bits = (1 << 16); n_bits <= (1 << 24); n_bits *= 4) {
+        const std::size_t n_limbs = static_cast<std::size_t>(n_bits) / 64;
+        const int n_trials = std::max(1, (1 << 22) / n_bits);
+
+        clac::arithmetic::set_thread_count(1);
+        const double sequential = time_product(n_limbs, n_trials);
+        std::cout << n_bits << " bits: " << std::fixed << std::setprecision(2) << sequential
+                  << " ms";
+        for (std::size_t count = 2; count <= max_threads; count *= 2) {
+            clac::arithmetic::set_thread_count(count);
+            const double parallel = time_product(n_limbs, n_trials);
+            std::cout << ((count == 2) ? " -> " : ", ") << sequential / parallel << "x ("
+                      << count << ")";
+        }
+        std::cout << ".\n" << std::defaultfloat << std::setprecision(6);
+    }
+
+    // The portable set runs first, and each other set's time is followed by its speedup.
+    std::cout << "\nLimb Kernels\n";
+    std::cout <<   "============\n";
+    std::cout <<   "n_limbs: multiply, square with the portable kernels (us) -> other kernel sets\n";
+    const std::vector<const clac::arithmetic::KernelSet*> kernel_sets =
+        clac::arithmetic::supported_kernels();
+    const clac::arithmetic::KernelSet& best_kernels = clac::arithmetic::active_kernels();
+    clac::arithmetic::set_thread_count(1);
+    for (std::size_t n_limbs : {4, 8, 16, 24, 48, 256, 4096}) {
+        double portable[2] = {0.0, 0.0};
+        std::cout << n_limbs << " limbs: " << std::fixed << std::setprecision(2);
+        for (const clac::arithmetic::KernelSet* kernels : kernel_sets) {
+            clac::arithmetic::set_active_kernels(*kernels);
+            const double multiply = time_operation(n_limbs, Operation::MULTIPLY);
+            const double square = time_operation(n_limbs, Operation::SQUARE);
+            if (kernels == kernel_sets.front()) {
+                portable[0] = multiply;
+                portable[1] = square;
+                std::cout << multiply << ", " << square;
+            }
+            else {
+                std::cout << " -> " << kernels->name << " " << multiply << " ("
+                          << portable[0] / multiply << "x), " << square << " ("
+                          << portable[1] / square << "x)";
+            }
+        }
+        std::cout << ".\n" << std::defaultfloat << std::setprecision(6);
+    }
+    clac::arithmetic::set_active_kernels(best_kernels);
+    clac::arithmetic::set_thread_count(0);
+
+    std::cout << "\nCrossover Points\n";
+    std::cout <<   "================\n";
+    clac::arithmetic::set_thread_count(1);
+    find_threshold("Multiplication: basecase -> Karatsuba",
+                   &clac::arithmetic::Thresholds::karatsuba, Operation::MULTIPLY, 8, 128);
+    find_threshold("Multiplication: Karatsuba -> Toom-3",
+                   &clac::arithmetic::Thresholds::toom3, Operation::MULTIPLY, 64, 1024);
+    find_threshold("Squaring: basecase -> Karatsuba",
+                   &clac::arithmetic::Thresholds::karatsuba_square, Operation::SQUARE, 8, 128);
+    find_threshold("Squaring: Karatsuba -> Toom-3",
+                   &clac::arithmetic::Thresholds::toom3_square, Operation::SQUARE, 64, 1024);
+    find_threshold("Multiplication: Toom-3 -> NTT",
+                   &clac::arithmetic::Thresholds::ntt, Operation::MULTIPLY, 256, 16384);
+    find_threshold("Squaring: Toom-3 -> NTT",
+                   &clac::arithmetic::Thresholds::ntt_square, Operation::SQUARE, 256, 16384);
+    find_threshold("Division: basecase -> Burnikel-Ziegler",
+                   &clac::arithmetic::Thresholds::burnikel_ziegler, Operation::DIVIDE, 8, 256);
+    find_threshold("Division: Burnikel-Ziegler -> Newton",
+                   &clac::arithmetic::Thresholds::newton, Operation::DIVIDE, 32768, 524288);
+    find_threshold("Decimal conversion: basecase -> divide and conquer",
+                   &clac::arithmetic::Thresholds::radix, Operation::TO_DECIMAL, 4, 256);
+    find_threshold("GCD: Lehmer -> half-GCD",
+                   &clac::arithmetic::Thresholds::half_gcd, Operation::GCD, 64, 4096);
+    clac::arithmetic::set_thread_count(0);
+    find_threshold("Multiplication: sequential -> parallel",
+                   &clac::arithmetic::Thresholds::parallel, Operation::MULTIPLY, 64, 16384);
+
     std::cout << "\nDivision\n";
     std::cout <<   "========\n";
-    for (int n_bits = 256; n_bits <= 16384; n_bits *= 2) {
+    std::cout <<   "n_bits: VeryLong -> clac::arithmetic\n";
+    for (int n_bits = 256; n_bits <= (1 << 22); n_bits *= 2) {
+
+        // Use fewer trials for the largest sizes to keep the run time reasonable.
+        const int n_trials = (n_bits <= 16384) ? N_TRIALS : std::max(1, N_TRIALS * 16384 / n_bits);
 
         // Allocate the necessary arrays.
-        spica::VeryLong *m1 = new spica::VeryLong[N_TRIALS];
-        spica::VeryLong *m2 = new spica::VeryLong[N_TRIALS];
+        spica::VeryLong *m1 = new spica::VeryLong[n_trials];
+        spica::VeryLong *m2 = new spica::VeryLong[n_trials];
 
         // Fill the the input arrays with random numbers.
-        for (int i = 0; i < N_TRIALS; ++i) {
+        for (int i = 0; i < n_trials; ++i) {
 
             // Make the numerator 2*n_bits in size so division requires n_bits steps.
             for (spica::VeryLong::size_type j = 0; j < 2*n_bits - 1; ++j) {
@@ -68,19 +359,121 @@ int main()
         }
 
         pcc::Timer stopwatch;
+        if (n_bits <= 16384) {
+            stopwatch.start();
+            for (int i = 0; i < n_trials; ++i) {
+                spica::VeryLong::vldiv_t result;
+                spica::VeryLong::vldiv(m1[i], m2[i], &result);
+            }
+            stopwatch.stop();
+            std::cout << n_bits << " bits: "
+                      << static_cast<double>(stopwatch.time())/n_trials << " ms -> ";
+        }
+        else {
+            std::cout << n_bits << " bits: (skipped) -> ";
+        }
+
+        clac::arithmetic::Thresholds& limits = clac::arithmetic::thresholds();
+        const std::size_t original_cutoff = limits.verylong_bits;
+        limits.verylong_bits = 0;
         stopwatch.start();
-        for (int i = 0; i < N_TRIALS; ++i) {
+        for (int i = 0; i < n_trials; ++i) {
             spica::VeryLong::vldiv_t result;
-            spica::VeryLong::vldiv(m1[i], m2[i], &result);
+            clac::arithmetic::divide(m1[i], m2[i], &result);
         }
         stopwatch.stop();
-        std::cout
-            << n_bits << " bits: " << stopwatch.time()/N_TRIALS << " ms.\n";
+        limits.verylong_bits = original_cutoff;
+        std::cout << static_cast<double>(stopwatch.time())/n_trials << " ms.\n";
 
         // Clean up.
         delete [] m1;
         delete [] m2;
     }
 
+    std::cout << "\nDecimal Conversion\n";
+    std::cout <<   "==================\n";
+    std::cout <<   "n_digits: VeryLong print -> clac::arithmetic print, parse\n";
+    for (int n_digits = 1000; n_digits <= 1000000; n_digits *= 10) {
+        std::string digits(1, static_cast<char>('1' + std::rand() % 9));
+        for (int i = 1; i < n_digits; ++i) {
+            digits.push_back(static_cast<char>('0' + std::rand() % 10));
+        }
+        const int n_trials = std::max(1, N_TRIALS * 1000 / n_digits);
+        const spica::VeryLong value(digits);
+
+        // VeryLong's own conversion is quadratic.
+        pcc::Timer stopwatch;
+        if (n_digits <= 10000) {
+            stopwatch.start();
+            for (int i = 0; i < n_trials; ++i) {
+                std::ostringstream formatter;
+                formatter << value;
+            }
+            stopwatch.stop();
+            std::cout << n_digits << " digits: "
+                      << static_cast<double>(stopwatch.time())/n_trials << " ms -> ";
+        }
+        else {
+            std::cout << n_digits << " digits: (skipped) -> ";
+        }
+
+        const clac::arithmetic::natural_t number = clac::arithmetic::to_natural(value);
+        stopwatch.start();
+        for (int i = 0; i < n_trials; ++i) {
+            clac::arithmetic::to_decimal(number);
+        }
+        stopwatch.stop();
+        std::cout << static_cast<double>(stopwatch.time())/n_trials << " ms, ";
+
+        stopwatch.start();
+        for (int i = 0; i < n_trials; ++i) {
+            clac::arithmetic::from_decimal(digits);
+        }
+        stopwatch.stop();
+        std::cout << static_cast<double>(stopwatch.time())/n_trials << " ms.\n";
+    }
+
+    std::cout << "\nHarmonic Numbers\n";
+    std::cout <<   "================\n";
+    std::cout <<   "n_terms: Rational<VeryLong> -> Euclid on limbs -> clac::arithmetic::gcd\n";
+    for (unsigned long n_terms = 1000; n_terms <= 100000; n_terms *= 10) {
+        pcc::Timer stopwatch;
+
+        // Rational<VeryLong> reduces each sum with Euclid's algorithm on VeryLong values.
+        if (n_terms <= 1000) {
+            stopwatch.start();
+            spica::Rational<spica::VeryLong> sum;
+            for (unsigned long k = 1; k <= n_terms; ++k) {
+                sum = sum + spica::Rational<spica::VeryLong>(
+                                spica::VeryLong::one, spica::VeryLong(static_cast<long>(k)));
+            }
+            stopwatch.stop();
+            std::cout << n_terms << " terms: " << stopwatch.time() << " ms -> ";
+        }
+        else {
+            std::cout << n_terms << " terms: (skipped) -> ";
+        }
+
+        if (n_terms <= 10000) {
+            stopwatch.start();
+            harmonic_number(n_terms, euclid_gcd);
+            stopwatch.stop();
+            std::cout << stopwatch.time() << " ms -> ";
+        }
+        else {
+            std::cout << "(skipped) -> ";
+        }
+
+        stopwatch.start();
+        const clac::arithmetic::natural_t denominator = harmonic_number(
+            n_terms,
+            [](const clac::arithmetic::natural_t& a, const clac::arithmetic::natural_t& b) {
+                return clac::arithmetic::gcd(a, b);
+            });
+        stopwatch.stop();
+        std::cout << stopwatch.time() << " ms (denominator has "
+                  << clac::arithmetic::bit_length(denominator) << " bits).\n";
+    }
+
     return 0;
 }
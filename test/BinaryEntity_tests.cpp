@@ -0,0 +1,236 @@
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+
+// From SpicaCpp
+#include "UnitTestManager.hpp"
+
+// From Clac
+#include "BinaryEntity.hpp"
+#include "DisplayState.hpp"
+#include "IntegerEntity.hpp"
+#include "arithmetic.hpp"
+
+// From Check
+#include "u_tests.hpp"
+
+using namespace std;
+using clac::arithmetic::natural_t;
+
+namespace {
+
+    // Returns the value of a binary entity as a natural number.
+    natural_t value_of( Entity *result )
+    {
+        unique_ptr<Entity> owner{ result };
+        return dynamic_cast<BinaryEntity *>( owner.get( ) )->get_value( );
+    }
+
+    natural_t natural( uint64_t number )
+    {
+        natural_t result{ number };
+        clac::arithmetic::normalize( result );
+        return result;
+    }
+
+    //
+    // At word sizes of 64 bits and less, the operations must agree with the machine operations
+    // on uint64_t, reduced to the word size.
+    //
+    void machine_test( )
+    {
+        UnitTestManager::UnitTest test( "machine_test" );
+
+        const size_t original_bits = BinaryEntity::get_bit_count( );
+        mt19937_64 generator( 18 );
+        for( size_t bits : { 1, 7, 13, 32, 63, 64 } ) {
+            BinaryEntity::set_bit_count( bits );
+            const uint64_t mask = ( bits == 64 ) ? ~uint64_t{ 0 } : ( uint64_t{ 1 } << bits ) - 1;
+            for( int trial = 0; trial < 100; ++trial ) {
+                const uint64_t x = generator( ) & mask;
+                const uint64_t y = generator( ) & mask;
+                const uint64_t k = generator( ) % bits;
+                BinaryEntity left{ x }, right{ y }, count{ k };
+
+                UNIT_CHECK( value_of( left.plus( &right ) ) == natural( ( x + y ) & mask ) );
+                UNIT_CHECK( value_of( left.minus( &right ) ) == natural( ( x - y ) & mask ) );
+                UNIT_CHECK( value_of( left.multiply( &right ) ) == natural( ( x * y ) & mask ) );
+                UNIT_CHECK( value_of( left.logical_and( &right ) ) == natural( x & y ) );
+                UNIT_CHECK( value_of( left.logical_or( &right ) ) == natural( x | y ) );
+                UNIT_CHECK( value_of( left.logical_xor( &right ) ) == natural( x ^ y ) );
+                UNIT_CHECK( value_of( left.logical_not( ) ) == natural( ~x & mask ) );
+                UNIT_CHECK( value_of( left.neg( ) ) == natural( ( 0 - x ) & mask ) );
+                UNIT_CHECK( value_of( left.shift( &count ) ) == natural( ( x << k ) & mask ) );
+                const uint64_t rotated = ( k == 0 ) ? x : ( ( x << k ) | ( x >> ( bits - k ) ) );
+                UNIT_CHECK( value_of( left.rotate( &count ) ) == natural( rotated & mask ) );
+                if( y != 0 ) {
+                    UNIT_CHECK( value_of( left.divide( &right ) ) == natural( x / y ) );
+                    UNIT_CHECK( value_of( left.modulo( &right ) ) == natural( x % y ) );
+                }
+            }
+        }
+        BinaryEntity::set_bit_count( original_bits );
+    }
+
+    //
+    // Wide words must agree with integer arithmetic reduced modulo 2^bits, and the shifts and
+    // rotations must move bits across word boundaries.
+    //
+    void wide_test( )
+    {
+        UnitTestManager::UnitTest test( "wide_test" );
+        using namespace clac::arithmetic;
+        using clac::arithmetic::bit_or;
+        using clac::arithmetic::bit_xor;
+
+        const size_t original_bits = BinaryEntity::get_bit_count( );
+        mt19937_64 generator( 4096 );
+        for( size_t bits : { 65, 200, 1000, 4096 } ) {
+            BinaryEntity::set_bit_count( bits );
+            const natural_t modulus = shift_left( natural_t{ 1 }, bits );
+            auto reduce = [&]( const natural_t &number ) {
+                natural_t quotient, remainder;
+                divide( number, modulus, quotient, remainder );
+                return remainder;
+            };
+            auto random_word = [&]( ) {
+                natural_t result( ( bits + 63 ) / 64 );
+                for( limb_t &limb : result ) {
+                    limb = generator( );
+                }
+                normalize( result );
+                return reduce( result );
+            };
+
+            for( int trial = 0; trial < 20; ++trial ) {
+                const natural_t x = random_word( );
+                const natural_t y = random_word( );
+                BinaryEntity left{ x }, right{ y };
+
+                UNIT_CHECK( value_of( left.plus( &right ) ) == reduce( add( x, y ) ) );
+                UNIT_CHECK( value_of( left.multiply( &right ) ) == reduce( multiply( x, y ) ) );
+                UNIT_CHECK( value_of( left.minus( &right ) ) ==
+                            reduce( subtract( add( x, modulus ), y ) ) );
+                UNIT_CHECK( value_of( left.logical_xor( &right ) ) == bit_xor( x, y ) );
+
+                const size_t k = generator( ) % bits;
+                BinaryEntity count{ natural( k ) };
+                UNIT_CHECK( value_of( left.shift( &count ) ) == reduce( shift_left( x, k ) ) );
+                unique_ptr<Entity> back{ count.neg( ) };
+                UNIT_CHECK( value_of( left.shift( back.get( ) ) ) == shift_right( x, k ) );
+                const natural_t rotated =
+                    bit_or( reduce( shift_left( x, k ) ), shift_right( x, ( bits - k ) % bits ) );
+                UNIT_CHECK( value_of( left.rotate( &count ) ) == ( k == 0 ? x : rotated ) );
+                unique_ptr<Entity> forward{ left.rotate( &count ) };
+                UNIT_CHECK( value_of( forward->rotate( back.get( ) ) ) == x );
+            }
+
+            // All ones.
+            BinaryEntity zero;
+            unique_ptr<Entity> ones{ zero.logical_not( ) };
+            unique_ptr<Entity> count{ ones->population_count( ) };
+            UNIT_CHECK( count->display( ) == to_string( bits ) );
+            unique_ptr<Entity> rotated{ ones->rotate_right( ) };
+            const natural_t all_ones = subtract( modulus, natural_t{ 1 } );
+            UNIT_CHECK( value_of( rotated->plus( &zero ) ) == all_ones );
+        }
+        BinaryEntity::set_bit_count( original_bits );
+    }
+
+    // Binaries keep their word size, and convert to and from integers.
+    void word_size_test( )
+    {
+        UnitTestManager::UnitTest test( "word_size_test" );
+
+        const size_t original_bits = BinaryEntity::get_bit_count( );
+        const clac::display_state::BaseType original = clac::display_state::get_base( );
+        clac::display_state::set_base( clac::display_state::HEX );
+
+        BinaryEntity::set_bit_count( 12 );
+        BinaryEntity small{ 0xABCDUL };
+        UNIT_CHECK( small.display( ) == "# BCDh" );
+        BinaryEntity::set_bit_count( 72 );
+        BinaryEntity one{ 1UL };
+        unique_ptr<Entity> sum{ small.plus( &one ) };
+        UNIT_CHECK( sum->display( ) == "# 000000000000000BCEh" );
+        UNIT_CHECK( small.display( ) == "# BCDh" );
+
+        IntegerEntity minus_one{ int64_t{ -1 } };
+        unique_ptr<Entity> ones{ minus_one.to_binary( ) };
+        UNIT_CHECK( ones->display( ) == "# FFFFFFFFFFFFFFFFFFh" );
+        unique_ptr<Entity> integer{ ones->to_integer( ) };
+        UNIT_CHECK( integer->display( ) == "4722366482869645213695" );
+
+        clac::display_state::set_base( clac::display_state::OCTAL );
+        BinaryEntity::set_bit_count( 8 );
+        BinaryEntity octal{ 0377UL };
+        UNIT_CHECK( octal.display( ) == "# 377o" );
+        clac::display_state::set_base( clac::display_state::BINARY );
+        UNIT_CHECK( octal.display( ) == "# 11111111b" );
+
+        // Division truncates a wider operand to the current word size like the other operations.
+        clac::display_state::set_base( clac::display_state::HEX );
+        BinaryEntity::set_bit_count( 32 );
+        BinaryEntity wide{ 0x10000UL };
+        BinaryEntity digits{ 0x12345UL };
+        BinaryEntity::set_bit_count( 16 );
+        BinaryEntity two{ 2UL }, sixteen{ 0x10UL };
+        unique_ptr<Entity> wide_sum{ wide.plus( &two ) };
+        UNIT_CHECK( wide_sum->display( ) == "# 0002h" );
+        unique_ptr<Entity> wide_quotient{ wide.divide( &two ) };
+        UNIT_CHECK( wide_quotient->display( ) == "# 0000h" );
+        unique_ptr<Entity> quotient{ digits.divide( &sixteen ) };
+        UNIT_CHECK( quotient->display( ) == "# 0234h" );
+        unique_ptr<Entity> remainder{ digits.modulo( &sixteen ) };
+        UNIT_CHECK( remainder->display( ) == "# 0005h" );
+        bool divided = true;
+        try {
+            unique_ptr<Entity> result{ two.modulo( &wide ) };
+        }
+        catch( const Entity::Error & ) {
+            divided = false;
+        }
+        UNIT_CHECK( !divided );
+
+        // Integer counts keep their own sign and leave a binary.
+        BinaryEntity::set_bit_count( 16 );
+        clac::display_state::set_base( clac::display_state::HEX );
+        BinaryEntity bit{ 1UL };
+        IntegerEntity three{ int64_t{ 3 } }, minus_three{ int64_t{ -3 } };
+        IntegerEntity many{ spica::VeryLong( "100000000000000000000003" ) };
+        unique_ptr<Entity> rotated{ bit.rotate( &minus_three ) };
+        UNIT_CHECK( rotated->my_type( ) == BINARY && rotated->display( ) == "# 2000h" );
+        unique_ptr<Entity> shifted{ bit.shift( &three ) };
+        UNIT_CHECK( shifted->my_type( ) == BINARY && shifted->display( ) == "# 0008h" );
+        unique_ptr<Entity> back{ shifted->shift( &minus_three ) };
+        UNIT_CHECK( back->display( ) == "# 0001h" );
+        unique_ptr<Entity> far{ bit.rotate( &many ) };
+        UNIT_CHECK( far->display( ) == "# 0008h" );
+        unique_ptr<Entity> gone{ bit.shift( &many ) };
+        UNIT_CHECK( gone->display( ) == "# 0000h" );
+
+        bool thrown = false;
+        try {
+            BinaryEntity::set_bit_count( 0 );
+        }
+        catch( const Entity::Error & ) {
+            thrown = true;
+        }
+        UNIT_CHECK( thrown );
+
+        BinaryEntity::set_bit_count( original_bits );
+        clac::display_state::set_base( original );
+    }
+
+}
+
+
+bool BinaryEntity_tests( )
+{
+    machine_test( );
+    wide_test( );
+    word_size_test( );
+    return true;
+}
@@ -1,12 +1,21 @@
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <random>
+#include <string>
 
 // From SpicaCpp
 #include "VeryLong.hpp"
 #include "UnitTestManager.hpp"
 
 // From Clac
+#include "FloatEntity.hpp"
 #include "IntegerEntity.hpp"
+#include "RationalEntity.hpp"
+#include "arithmetic.hpp"
 
 // From Check
 #include "u_tests.hpp"
@@ -15,6 +24,9 @@ using namespace std;
 
 namespace {
 
+    //! Powers larger than this many bits are deferred (IntegerEntity.cpp).
+    constexpr double DEFERRED_TEST_BITS = 262144.0;
+
     void constructor_test( )
     {
         UnitTestManager::UnitTest test( "constructor_test" );
@@ -31,12 +43,659 @@ namespace {
         UNIT_CHECK( test_entity2->display( ) == "1234567890" );
     }
 
+    void power_test( )
+    {
+        UnitTestManager::UnitTest test( "power_test" );
+
+        struct TestCase {
+            long base;
+            long exponent;
+            const char *expected;
+        };
+        TestCase cases[] = {
+            {  3,    5, "243" },
+            { -2,    7, "-128" },
+            { -3,    3, "-27" },
+            {  2,   64, "18446744073709551616" },
+            { -1, 1001, "-1" },
+            {  0,    5, "0" },
+            {  7,    0, "1" },
+            { 10,   30, "1000000000000000000000000000000" },
+            {  3,   40, "12157665459056928801" }
+        };
+
+        for( const auto &test_case : cases ) {
+            IntegerEntity base{ spica::VeryLong( test_case.base ) };
+            IntegerEntity exponent{ spica::VeryLong( test_case.exponent ) };
+            unique_ptr<Entity> result{ base.power( &exponent ) };
+            UNIT_CHECK( result->my_type( ) == INTEGER );
+            UNIT_CHECK( result->display( ) == test_case.expected );
+        }
+
+        // Negative exponents produce a float.
+        IntegerEntity base{ spica::VeryLong( 2 ) };
+        IntegerEntity exponent{ spica::VeryLong( -2 ) };
+        unique_ptr<Entity> result{ base.power( &exponent ) };
+        UNIT_CHECK( result->my_type( ) == FLOAT );
+    }
+
+    void overflow_test( )
+    {
+        UnitTestManager::UnitTest test( "overflow_test" );
+
+        const int64_t maximum = numeric_limits<int64_t>::max( );
+        const int64_t minimum = numeric_limits<int64_t>::min( );
+        IntegerEntity big{ maximum };
+        IntegerEntity small{ minimum };
+        IntegerEntity one{ int64_t{ 1 } };
+        IntegerEntity minus_one{ int64_t{ -1 } };
+        UNIT_CHECK( big.is_small( ) && small.is_small( ) );
+
+        // Results that overflow are promoted.
+        unique_ptr<Entity> sum{ big.plus( &one ) };
+        UNIT_CHECK( sum->display( ) == "9223372036854775808" );
+        UNIT_CHECK( !dynamic_cast<IntegerEntity *>( sum.get( ) )->is_small( ) );
+        unique_ptr<Entity> difference{ small.minus( &one ) };
+        UNIT_CHECK( difference->display( ) == "-9223372036854775809" );
+        unique_ptr<Entity> product{ big.multiply( &big ) };
+        UNIT_CHECK( product->display( ) == "85070591730234615847396907784232501249" );
+        unique_ptr<Entity> quotient{ small.divide( &minus_one ) };
+        UNIT_CHECK( quotient->display( ) == "9223372036854775808" );
+        unique_ptr<Entity> remainder{ small.modulo( &minus_one ) };
+        UNIT_CHECK( remainder->display( ) == "0" );
+        unique_ptr<Entity> negated{ small.neg( ) };
+        UNIT_CHECK( negated->display( ) == "9223372036854775808" );
+
+        // Results that fit are demoted.
+        unique_ptr<Entity> back{ sum->minus( &one ) };
+        UNIT_CHECK( dynamic_cast<IntegerEntity *>( back.get( ) )->is_small( ) );
+        UNIT_CHECK( dynamic_cast<IntegerEntity *>( back.get( ) )->get_small( ) == maximum );
+        unique_ptr<Entity> equal{ back->is_equal( &big ) };
+        UNIT_CHECK( equal->display( ) == "1" );
+        unique_ptr<Entity> less{ big.is_less( sum.get( ) ) };
+        UNIT_CHECK( less->display( ) == "1" );
+    }
+
+    void conversion_test( )
+    {
+        UnitTestManager::UnitTest test( "conversion_test" );
+
+        // Conversion to float and back rounds to the nearest double, with ties to even.
+        struct TestCase {
+            const char *value;
+            const char *expected;
+        };
+        TestCase cases[] = {
+            { "9007199254740993", "9007199254740992" },
+            { "9007199254740995", "9007199254740996" },
+            { "-18446744073709553664", "-18446744073709551616" },
+            { "18446744073709553665", "18446744073709555712" },
+            { "1267650600228229401496703205376", "1267650600228229401496703205376" }
+        };
+
+        for( const auto &test_case : cases ) {
+            IntegerEntity value{ spica::VeryLong( test_case.value ) };
+            unique_ptr<Entity> converted{ value.to_float( ) };
+            UNIT_CHECK( converted->my_type( ) == FLOAT );
+            unique_ptr<Entity> back{ converted->to_integer( ) };
+            UNIT_CHECK( back->display( ) == test_case.expected );
+        }
+
+        // Values beyond the range of double can't be converted.
+        IntegerEntity huge{ spica::VeryLong( string( 400, '9' ) ) };
+        bool thrown = false;
+        try {
+            unique_ptr<Entity> converted{ huge.to_float( ) };
+        }
+        catch( const Entity::Error & ) {
+            thrown = true;
+        }
+        UNIT_CHECK( thrown );
+
+        // Floats are rounded to the nearest integer, with halfway cases away from zero.
+        FloatEntity half{ 2.5 };
+        unique_ptr<Entity> rounded{ half.to_integer( ) };
+        UNIT_CHECK( rounded->display( ) == "3" );
+        FloatEntity negative_half{ -2.5 };
+        rounded.reset( negative_half.to_integer( ) );
+        UNIT_CHECK( rounded->display( ) == "-3" );
+        FloatEntity negative{ -0.4 };
+        rounded.reset( negative.to_integer( ) );
+        UNIT_CHECK( rounded->display( ) == "0" );
+    }
+
+    void root_test( )
+    {
+        UnitTestManager::UnitTest test( "root_test" );
+
+        struct TestCase {
+            const char *value;
+            long index;
+            const char *expected;
+        };
+        TestCase cases[] = {
+            { "0", 2, "0" },
+            { "15", 2, "3" },
+            { "16", 2, "4" },
+            { "-27", 3, "-3" },
+            { "-28", 3, "-3" },
+            { "18446744073709551616", 64, "2" },
+            { "340282366920938463463374607431768211455", 2, "18446744073709551615" },
+            { "1000000000000000000000000000000", 5, "1000000" },
+            { "999999999999999999999999999999", 5, "999999" },
+            { "123456789", 100, "1" }
+        };
+
+        for( const auto &test_case : cases ) {
+            IntegerEntity value{ spica::VeryLong( test_case.value ) };
+            IntegerEntity index{ spica::VeryLong( test_case.index ) };
+            unique_ptr<Entity> result{ value.integer_root( &index ) };
+            UNIT_CHECK( result->my_type( ) == INTEGER );
+            UNIT_CHECK( result->display( ) == test_case.expected );
+        }
+
+        // The square root of a perfect square is an integer.
+        IntegerEntity square{ spica::VeryLong( "1524157875323883675019051998750190521" ) };
+        unique_ptr<Entity> root{ square.sqrt( ) };
+        UNIT_CHECK( root->my_type( ) == INTEGER );
+        UNIT_CHECK( root->display( ) == "1234567890123456789" );
+        unique_ptr<Entity> integer_root{ square.integer_sqrt( ) };
+        UNIT_CHECK( integer_root->display( ) == "1234567890123456789" );
+        IntegerEntity two{ int64_t{ 2 } };
+        root.reset( two.sqrt( ) );
+        UNIT_CHECK( root->my_type( ) == FLOAT );
+
+        // Perfect powers.
+        struct PowerCase {
+            const char *value;
+            const char *expected;
+        };
+        PowerCase power_cases[] = {
+            { "1", "1" },
+            { "2", "0" },
+            { "1024", "1" },
+            { "-32", "1" },
+            { "-64", "1" },
+            { "-16", "0" },
+            { "1000000007", "0" },
+            { "1853020188851841", "1" },    // 3^32
+            { "1853020188851842", "0" },
+            { "10000000000000000000000000000000000000000000000000000000000000000000000001", "0" }
+        };
+        for( const auto &test_case : power_cases ) {
+            IntegerEntity value{ spica::VeryLong( test_case.value ) };
+            unique_ptr<Entity> result{ value.is_perfect_power( ) };
+            UNIT_CHECK( result->display( ) == test_case.expected );
+        }
+    }
+
+    void gcd_test( )
+    {
+        UnitTestManager::UnitTest test( "gcd_test" );
+
+        struct TestCase {
+            const char *left;
+            const char *right;
+            const char *gcd;
+            const char *lcm;
+        };
+        TestCase cases[] = {
+            { "0", "0", "0", "0" },
+            { "0", "-5", "5", "0" },
+            { "12", "-18", "6", "36" },
+            { "-9223372036854775808", "6", "2", "27670116110564327424" },
+            { "1267650600228229401496703205376", "1152921504606846976",
+              "1152921504606846976", "1267650600228229401496703205376" },
+            { "1853020188851841", "30000000000000000000000000000000", "3",
+              "18530201888518410000000000000000000000000000000" }
+        };
+        for( const auto &test_case : cases ) {
+            IntegerEntity left{ spica::VeryLong( test_case.left ) };
+            IntegerEntity right{ spica::VeryLong( test_case.right ) };
+            unique_ptr<Entity> gcd{ left.gcd( &right ) };
+            unique_ptr<Entity> lcm{ left.lcm( &right ) };
+            UNIT_CHECK( gcd->display( ) == test_case.gcd );
+            UNIT_CHECK( lcm->display( ) == test_case.lcm );
+        }
+
+        // Numbers large enough for the half-GCD. Since 2^40000 + 1 is 2 modulo 3, the GCD of
+        // (2^40000 + 1) * g and 3^25000 * g is g.
+        IntegerEntity two{ int64_t{ 2 } };
+        IntegerEntity three{ int64_t{ 3 } };
+        IntegerEntity one{ int64_t{ 1 } };
+        IntegerEntity e1{ int64_t{ 40000 } };
+        IntegerEntity e2{ int64_t{ 25000 } };
+        IntegerEntity g{ spica::VeryLong( "1000000000000000000000000000000000000000000000000007" ) };
+        unique_ptr<Entity> power1{ two.power( &e1 ) };
+        unique_ptr<Entity> sum{ power1->plus( &one ) };
+        unique_ptr<Entity> left{ sum->multiply( &g ) };
+        unique_ptr<Entity> power2{ three.power( &e2 ) };
+        unique_ptr<Entity> right{ power2->multiply( &g ) };
+        unique_ptr<Entity> gcd{ left->gcd( right.get( ) ) };
+        UNIT_CHECK( gcd->display( ) == g.display( ) );
+    }
+
+    void parallel_multiply_test( )
+    {
+        UnitTestManager::UnitTest test( "parallel_multiply_test" );
+
+        // Operands large enough for parallel Toom-3 (x * y) and parallel NTT (z * z and z * x).
+        IntegerEntity three{ int64_t{ 3 } };
+        IntegerEntity seven{ int64_t{ 7 } };
+        IntegerEntity e1{ int64_t{ 80000 } };
+        IntegerEntity e2{ int64_t{ 50000 } };
+        IntegerEntity e3{ int64_t{ 300000 } };
+        unique_ptr<Entity> x{ three.power( &e1 ) };
+        unique_ptr<Entity> y{ seven.power( &e2 ) };
+        unique_ptr<Entity> z{ three.power( &e3 ) };
+
+        const size_t original_count = clac::arithmetic::thread_count( );
+        string expected[3], actual[3];
+        for( size_t count : { size_t{ 1 }, size_t{ 4 } } ) {
+            clac::arithmetic::set_thread_count( count );
+            unique_ptr<Entity> products[] = {
+                unique_ptr<Entity>{ x->multiply( y.get( ) ) },
+                unique_ptr<Entity>{ z->multiply( z.get( ) ) },
+                unique_ptr<Entity>{ z->multiply( x.get( ) ) }
+            };
+            for( int i = 0; i < 3; ++i ) {
+                ( count == 1 ? expected : actual )[i] = products[i]->display( );
+            }
+        }
+        clac::arithmetic::set_thread_count( original_count );
+        for( int i = 0; i < 3; ++i ) {
+            UNIT_CHECK( actual[i] == expected[i] );
+        }
+    }
+
+    // The fused operations must agree with the compositions they replace.
+    void fused_test( )
+    {
+        UnitTestManager::UnitTest test( "fused_test" );
+        using namespace clac::arithmetic;
+
+        mt19937_64 generator( 15 );
+        auto random_natural = [&generator]( size_t n_limbs ) {
+            natural_t result( n_limbs );
+            const bool all_ones = generator( ) % 4 == 0;
+            for( limb_t& limb : result ) {
+                limb = all_ones ? ~limb_t{ 0 } : generator( );
+            }
+            normalize( result );
+            return result;
+        };
+
+        const size_t sizes[] = { 0, 1, 2, 3, 7, 30, 250 };
+        for( size_t x : sizes ) {
+            for( size_t y : sizes ) {
+                for( size_t z : sizes ) {
+                    const natural_t a = random_natural( x );
+                    const natural_t b = random_natural( y );
+                    const natural_t c = random_natural( z );
+                    const natural_t ab = multiply( a, b );
+
+                    natural_t sum = c;
+                    addmul( sum, a, b );
+                    UNIT_CHECK( compare( sum, add( c, ab ) ) == 0 );
+
+                    natural_t difference = c;
+                    const bool negative = submul( difference, a, b );
+                    UNIT_CHECK( negative == ( compare( c, ab ) < 0 ) );
+                    UNIT_CHECK( compare( difference, negative ? subtract( ab, c )
+                                                              : subtract( c, ab ) ) == 0 );
+
+                    // The accumulator may also be a factor.
+                    natural_t square_sum = a;
+                    addmul( square_sum, square_sum, b );
+                    UNIT_CHECK( compare( square_sum, add( a, ab ) ) == 0 );
+
+                    if( !b.empty( ) ) {
+                        UNIT_CHECK( compare( divide_exact( ab, b ), a ) == 0 );
+                        const natural_t even = shift_left( b, 100 );
+                        UNIT_CHECK( compare( divide_exact( multiply( a, even ), even ), a ) == 0 );
+                        UNIT_CHECK(
+                            compare( multiply_divide_exact( a, multiply( b, c ), b ),
+                                     multiply( a, c ) ) == 0 );
+                    }
+                }
+            }
+        }
+    }
+
+    //
+    // The bitwise operations on large values must agree with the two's complement identities,
+    // and on small values with the machine operations.
+    //
+    void bitwise_test( )
+    {
+        UnitTestManager::UnitTest test( "bitwise_test" );
+
+        auto check = []( Entity *result, const string &expected ) {
+            unique_ptr<Entity> owner{ result };
+            return owner->display( ) == expected;
+        };
+
+        mt19937_64 generator( 17 );
+        for( int trial = 0; trial < 200; ++trial ) {
+            const int64_t x = static_cast<int64_t>( generator( ) ) >> ( generator( ) % 64 );
+            const int64_t y = static_cast<int64_t>( generator( ) ) >> ( generator( ) % 64 );
+            const int64_t k = static_cast<int64_t>( generator( ) % 80 );
+            IntegerEntity left{ x }, right{ y }, count{ -k };
+            UNIT_CHECK( check( left.logical_and( &right ), to_string( x & y ) ) );
+            UNIT_CHECK( check( left.logical_or( &right ), to_string( x | y ) ) );
+            UNIT_CHECK( check( left.logical_xor( &right ), to_string( x ^ y ) ) );
+            UNIT_CHECK( check( left.logical_not( ), to_string( ~x ) ) );
+            UNIT_CHECK( check( left.shift( &count ), to_string( x >> min( k, int64_t{ 63 } ) ) ) );
+        }
+
+        const IntegerEntity two{ int64_t{ 2 } };
+        const char *values[] = { "0", "1", "-1", "18446744073709551615", "-18446744073709551616",
+                                 "340282366920938463463374607431768211455",
+                                 "-1267650600228229401496703205376",
+                                 "-98765432109876543210987654321098765432109876543210",
+                                 "12345678901234567890123456789012345678901234567890" };
+        for( const char *a_text : values ) {
+            IntegerEntity a{ spica::VeryLong( a_text ) };
+            for( const char *b_text : values ) {
+                IntegerEntity b{ spica::VeryLong( b_text ) };
+                unique_ptr<Entity> a_and_b{ a.logical_and( &b ) };
+                unique_ptr<Entity> a_or_b{ a.logical_or( &b ) };
+                unique_ptr<Entity> a_xor_b{ a.logical_xor( &b ) };
+                unique_ptr<Entity> both{ a_and_b->plus( a_or_b.get( ) ) };
+                unique_ptr<Entity> sum{ a.plus( &b ) };
+                UNIT_CHECK( both->display( ) == sum->display( ) );
+                unique_ptr<Entity> difference{ a_or_b->minus( a_and_b.get( ) ) };
+                UNIT_CHECK( difference->display( ) == a_xor_b->display( ) );
+            }
+
+            unique_ptr<Entity> complement{ a.logical_not( ) };
+            unique_ptr<Entity> negated{ a.neg( ) };
+            IntegerEntity one{ int64_t{ 1 } };
+            UNIT_CHECK( check( negated->minus( &one ), complement->display( ) ) );
+
+            // Shifting left multiplies by a power of two; shifting right divides and rounds
+            // toward minus infinity.
+            for( int64_t k : { 1, 63, 64, 65, 200 } ) {
+                IntegerEntity places{ k }, back{ -k };
+                unique_ptr<Entity> scale{ two.power( &places ) };
+                unique_ptr<Entity> shifted{ a.shift( &places ) };
+                UNIT_CHECK( check( a.multiply( scale.get( ) ), shifted->display( ) ) );
+                UNIT_CHECK( check( shifted->shift( &back ), a.display( ) ) );
+
+                unique_ptr<Entity> quotient{ a.shift( &back ) };
+                unique_ptr<Entity> low{ quotient->multiply( scale.get( ) ) };
+                unique_ptr<Entity> next{ quotient->plus( &one ) };
+                unique_ptr<Entity> high{ next->multiply( scale.get( ) ) };
+                UNIT_CHECK( check( low->is_lessorequal( &a ), "1" ) );
+                UNIT_CHECK( check( a.is_less( high.get( ) ), "1" ) );
+            }
+        }
+
+        IntegerEntity power_of_two{ spica::VeryLong( "-1267650600228229401496703205376" ) };
+        IntegerEntity mask{ spica::VeryLong( "1267650600228229401496703205375" ) };
+        UNIT_CHECK( check( power_of_two.logical_and( &mask ), "0" ) );
+        UNIT_CHECK( check( power_of_two.bit_length( ), "101" ) );
+        UNIT_CHECK( check( mask.bit_length( ), "100" ) );
+        UNIT_CHECK( check( mask.population_count( ), "100" ) );
+        UNIT_CHECK( check( power_of_two.population_count( ), "1" ) );
+        IntegerEntity zero{ int64_t{ 0 } };
+        UNIT_CHECK( check( zero.bit_length( ), "0" ) );
+
+        // A count too large for 64 bits can only shift right.
+        IntegerEntity huge{ spica::VeryLong( "-100000000000000000000" ) };
+        UNIT_CHECK( check( power_of_two.shift( &huge ), "-1" ) );
+        UNIT_CHECK( check( mask.shift( &huge ), "0" ) );
+        bool thrown = false;
+        try {
+            unique_ptr<Entity> result{ mask.shift( &mask ) };
+        }
+        catch( const Entity::Error & ) {
+            thrown = true;
+        }
+        UNIT_CHECK( thrown );
+    }
+
+    void deferred_test( )
+    {
+        UnitTestManager::UnitTest test( "deferred_test" );
+
+        auto check = []( Entity *result, const string &expected ) {
+            unique_ptr<Entity> owner{ result };
+            return owner->display( ) == expected;
+        };
+
+        // Small and ordinary large values.
+        IntegerEntity number{ int64_t{ -12345 } };
+        IntegerEntity two{ int64_t{ 2 } };
+        IntegerEntity three{ int64_t{ 3 } };
+        IntegerEntity twenty{ int64_t{ 20 } };
+        UNIT_CHECK( check( number.digit_count( ), "5" ) );
+        UNIT_CHECK( check( number.leading_digits( &two ), "12" ) );
+        UNIT_CHECK( check( number.trailing_digits( &three ), "345" ) );
+        UNIT_CHECK( check( number.trailing_digits( &twenty ), "12345" ) );
+        IntegerEntity zero{ int64_t{ 0 } };
+        UNIT_CHECK( check( zero.digit_count( ), "1" ) );
+        UNIT_CHECK( check( zero.leading_digits( &two ), "0" ) );
+
+        // A power of two with three million digits is never computed.
+        IntegerEntity exponent{ int64_t{ 10000000 } };
+        unique_ptr<Entity> power{ two.power( &exponent ) };
+        IntegerEntity *big = dynamic_cast<IntegerEntity *>( power.get( ) );
+        UNIT_CHECK( big->is_deferred( ) );
+        UNIT_CHECK( check( big->digit_count( ), "3010300" ) );
+        UNIT_CHECK( check( big->leading_digits( &three ), "904" ) );
+        UNIT_CHECK( check( big->trailing_digits( &twenty ), "32662370891387109376" ) );
+        unique_ptr<Entity> cube{ big->power( &three ) };
+        UNIT_CHECK( check( cube->digit_count( ), "9030900" ) );
+        UNIT_CHECK( check( cube->sign( ), "1" ) );
+
+        // Products and negation stay deferred. Converting to an integer evaluates the value.
+        IntegerEntity seven{ int64_t{ -7 } };
+        IntegerEntity large_exponent{ int64_t{ 400000 } };
+        unique_ptr<Entity> factor{ three.power( &large_exponent ) };
+        unique_ptr<Entity> product{ factor->multiply( &seven ) };
+        UNIT_CHECK( dynamic_cast<IntegerEntity *>( product.get( ) )->is_deferred( ) );
+        UNIT_CHECK( check( product->sign( ), "-1" ) );
+        UNIT_CHECK( check( product->digit_count( ), "190850" ) );
+        UNIT_CHECK( product->display( ).ends_with( "4616000007 (190850 digits)" ) );
+        UNIT_CHECK( check( product->leading_digits( &twenty ), "22232377343847274778" ) );
+        UNIT_CHECK( check( product->trailing_digits( &twenty ), "24983084234616000007" ) );
+        unique_ptr<Entity> exact{ product->to_integer( ) };
+        UNIT_CHECK( !dynamic_cast<IntegerEntity *>( exact.get( ) )->is_deferred( ) );
+        UNIT_CHECK( check( exact->trailing_digits( &twenty ), "24983084234616000007" ) );
+        UNIT_CHECK( check( exact->is_equal( product.get( ) ), "1" ) );
+        unique_ptr<Entity> positive{ product->neg( ) };
+        UNIT_CHECK( check( positive->is_equal( exact.get( ) ), "0" ) );
+        UNIT_CHECK( check( product->multiply( &zero ), "0" ) );
+
+        // A power of ten is where the logarithm can't decide the number of digits.
+        IntegerEntity ten{ int64_t{ 10 } };
+        IntegerEntity one{ int64_t{ 1 } };
+        unique_ptr<Entity> ten_power{ ten.power( &large_exponent ) };
+        UNIT_CHECK( check( ten_power->digit_count( ), "400001" ) );
+        unique_ptr<Entity> nines{ ten_power->minus( &one ) };
+        UNIT_CHECK( check( nines->digit_count( ), "400000" ) );
+        UNIT_CHECK( check( nines->leading_digits( &three ), "999" ) );
+    }
+
+    //
+    // Showing a deferred value, counting its digits, and taking its leading digits never
+    // evaluate it, however large it is. The digits found agree with those of the exact value.
+    //
+    void deferred_digits_test( )
+    {
+        UnitTestManager::UnitTest test( "deferred_digits_test" );
+
+        auto check = []( Entity *result, const string &expected ) {
+            unique_ptr<Entity> owner{ result };
+            return owner->display( ) == expected;
+        };
+
+        IntegerEntity ten{ int64_t{ 10 } };
+        IntegerEntity twenty{ int64_t{ 20 } };
+        IntegerEntity exponent{ int64_t{ 30000000 } };
+        unique_ptr<Entity> ten_power{ ten.power( &exponent ) };
+        UNIT_CHECK( ten_power->display( ) == "1000000000...0000000000 (30000001 digits)" );
+        UNIT_CHECK( check( ten_power->leading_digits( &twenty ), "10000000000000000000" ) );
+
+        IntegerEntity seven{ int64_t{ 7 } };
+        IntegerEntity huge_exponent{ int64_t{ 1000000000000000000 } };
+        unique_ptr<Entity> huge{ seven.power( &huge_exponent ) };
+        UNIT_CHECK( huge->display( ) ==
+                    "5154852685...0000000001 (845098040014256831 digits)" );
+        UNIT_CHECK( check( huge->digit_count( ), "845098040014256831" ) );
+        UNIT_CHECK( check( huge->bit_length( ), "2807354922057604108" ) );
+        UNIT_CHECK( check( huge->leading_digits( &twenty ), "51548526853732574908" ) );
+
+        // The size of a power is decided by the logarithm of its base, not by its bit length.
+        IntegerEntity minus_three{ int64_t{ -3 } };
+        IntegerEntity odd_exponent{ int64_t{ 200001 } };
+        unique_ptr<Entity> odd_power{ minus_three.power( &odd_exponent ) };
+        UNIT_CHECK( dynamic_cast<IntegerEntity *>( odd_power.get( ) )->is_deferred( ) );
+        UNIT_CHECK( odd_power->display( ).starts_with( "-" ) );
+        UNIT_CHECK( odd_power->display( ).ends_with( " (95425 digits)" ) );
+
+        // Asking for all the leading digits evaluates the value.
+        IntegerEntity many{ int64_t{ 100000 } };
+        unique_ptr<Entity> all{ odd_power->leading_digits( &many ) };
+        unique_ptr<Entity> odd_exact{ odd_power->to_integer( ) };
+        unique_ptr<Entity> magnitude{ odd_exact->abs( ) };
+        UNIT_CHECK( check( all->is_equal( magnitude.get( ) ), "1" ) );
+
+        // 2^e * 5^e is exactly 10^e, where no precision of the logarithm settles the digits.
+        IntegerEntity two{ int64_t{ 2 } };
+        IntegerEntity five{ int64_t{ 5 } };
+        IntegerEntity boundary_exponent{ int64_t{ 300000 } };
+        unique_ptr<Entity> twos{ two.power( &boundary_exponent ) };
+        unique_ptr<Entity> fives{ five.power( &boundary_exponent ) };
+        unique_ptr<Entity> product{ twos->multiply( fives.get( ) ) };
+        UNIT_CHECK( dynamic_cast<IntegerEntity *>( product.get( ) )->is_deferred( ) );
+        UNIT_CHECK( product->display( ) == "1000000000...0000000000 (300001 digits)" );
+        UNIT_CHECK( check( product->integer_log10( ), "300000" ) );
+
+        // Powers of numbers next to a power of ten have logarithms too close to an integer for
+        // any precision, but the lengths of their bases settle the digits.
+        IntegerEntity one{ int64_t{ 1 } };
+        IntegerEntity thousand{ int64_t{ 1000 } };
+        IntegerEntity three_hundred{ int64_t{ 300 } };
+        IntegerEntity five_count{ int64_t{ 5 } };
+        unique_ptr<Entity> ten_thousand{ ten.power( &thousand ) };
+        unique_ptr<Entity> below_base{ ten_thousand->minus( &one ) };
+        unique_ptr<Entity> above_base{ ten_thousand->plus( &one ) };
+        unique_ptr<Entity> below{ below_base->power( &three_hundred ) };
+        unique_ptr<Entity> above{ above_base->power( &three_hundred ) };
+        UNIT_CHECK( below->display( ) == "9999999999...0000000001 (300000 digits)" );
+        UNIT_CHECK( check( below->leading_digits( &five_count ), "99999" ) );
+        UNIT_CHECK( check( below->bit_length( ), "996579" ) );
+        UNIT_CHECK( above->display( ) == "1000000000...0000000001 (300001 digits)" );
+        UNIT_CHECK( check( above->leading_digits( &five_count ), "10000" ) );
+
+        // Their product is (10^2000 - 1)^300, which is only settled by evaluating it. Until
+        // then it is shown without leading digits and with a bound on its length.
+        unique_ptr<Entity> both{ below->multiply( above.get( ) ) };
+        UNIT_CHECK( both->display( ) == "...0000000001 (at least 600000 digits)" );
+        UNIT_CHECK( check( both->digit_count( ), "600000" ) );
+        UNIT_CHECK( check( both->leading_digits( &five_count ), "99999" ) );
+        UNIT_CHECK( both->display( ) == "9999999999...0000000001 (600000 digits)" );
+
+        // Leading digits and lengths of random powers against those of their exact values.
+        mt19937_64 generator( 23 );
+        bool agree = true;
+        for( int trial = 0; trial < 12; ++trial ) {
+            const int64_t base = static_cast<int64_t>( generator( ) % 100000 ) + 3;
+            const int64_t e = static_cast<int64_t>( DEFERRED_TEST_BITS / log2( base ) ) + 1;
+            IntegerEntity b{ base };
+            IntegerEntity power_exponent{ e };
+            IntegerEntity count{ static_cast<int64_t>( generator( ) % 40 ) + 1 };
+            unique_ptr<Entity> deferred{ b.power( &power_exponent ) };
+            unique_ptr<Entity> exact{ deferred->to_integer( ) };
+            agree = agree && dynamic_cast<IntegerEntity *>( deferred.get( ) )->is_deferred( );
+            for( auto operation : { &Entity::digit_count, &Entity::bit_length } ) {
+                unique_ptr<Entity> left{ ( deferred.get( )->*operation )( ) };
+                unique_ptr<Entity> right{ ( exact.get( )->*operation )( ) };
+                agree = agree && left->display( ) == right->display( );
+            }
+            unique_ptr<Entity> left{ deferred->leading_digits( &count ) };
+            unique_ptr<Entity> right{ exact->leading_digits( &count ) };
+            agree = agree && left->display( ) == right->display( );
+        }
+        UNIT_CHECK( agree );
+    }
+
+    void logarithm_test( )
+    {
+        UnitTestManager::UnitTest test( "logarithm_test" );
+
+        auto check = []( Entity *result, const string &expected ) {
+            unique_ptr<Entity> owner{ result };
+            return owner->display( ) == expected;
+        };
+
+        // Far beyond the range of a double.
+        const spica::VeryLong googol_4( "1" + string( 400, '0' ) );
+        IntegerEntity large{ googol_4 };
+        IntegerEntity below{ googol_4 - spica::VeryLong( 1 ) };
+        UNIT_CHECK( check( large.log( ), "400.000" ) );
+        UNIT_CHECK( check( large.ln( ), "921.034" ) );
+        unique_ptr<Entity> negative{ large.neg( ) };
+        unique_ptr<Entity> complex{ negative->ln( ) };
+        UNIT_CHECK( complex->my_type( ) == COMPLEX );
+        UNIT_CHECK( check( large.integer_log10( ), "400" ) );
+        UNIT_CHECK( check( below.integer_log10( ), "399" ) );
+        UNIT_CHECK( check( below.integer_log2( ), "1328" ) );
+        UNIT_CHECK( check( negative->integer_log2( ), "1328" ) );
+
+        // A deferred power.
+        IntegerEntity two{ int64_t{ 2 } };
+        IntegerEntity exponent{ int64_t{ 10000000 } };
+        unique_ptr<Entity> power{ two.power( &exponent ) };
+        UNIT_CHECK( check( power->integer_log2( ), "10000000" ) );
+        UNIT_CHECK( check( power->bit_length( ), "10000001" ) );
+        UNIT_CHECK( check( power->integer_log10( ), "3010299" ) );
+        UNIT_CHECK( check( power->ln( ), "6931471.806" ) );
+
+        // Rationals, including ones too small for a double.
+        const spica::VeryLong googol_5( "1" + string( 500, '0' ) );
+        RationalEntity tiny{ spica::VeryLong( 1 ), googol_5 };
+        RationalEntity tinier{ spica::VeryLong( 1 ), googol_5 + spica::VeryLong( 1 ) };
+        UNIT_CHECK( check( tiny.log( ), "-500.000" ) );
+        UNIT_CHECK( check( tiny.integer_log10( ), "-500" ) );
+        UNIT_CHECK( check( tinier.integer_log10( ), "-501" ) );
+        RationalEntity ratio{ spica::VeryLong( -22 ), spica::VeryLong( 7 ) };
+        UNIT_CHECK( check( ratio.integer_log2( ), "1" ) );
+        RationalEntity third{ spica::VeryLong( 1 ), spica::VeryLong( 3 ) };
+        UNIT_CHECK( check( third.integer_log10( ), "-1" ) );
+        UNIT_CHECK( check( third.integer_log2( ), "-2" ) );
+        UNIT_CHECK( check( third.ln( ), "-1.099" ) );
+
+        IntegerEntity zero{ int64_t{ 0 } };
+        bool thrown = false;
+        try {
+            unique_ptr<Entity> result{ zero.integer_log2( ) };
+        }
+        catch( const Entity::Error & ) {
+            thrown = true;
+        }
+        UNIT_CHECK( thrown );
+    }
+
 }
 
 
 bool IntegerEntity_tests( )
 {
     constructor_test( );
+    power_test( );
+    overflow_test( );
+    conversion_test( );
+    root_test( );
+    gcd_test( );
+    parallel_multiply_test( );
+    fused_test( );
+    bitwise_test( );
+    deferred_test( );
+    deferred_digits_test( );
+    logarithm_test( );
     // TODO: Exercise the rest of the methods.
     return true;
 }
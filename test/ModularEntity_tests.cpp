@@ -0,0 +1,255 @@
+
+#include <cstdint>
+#include <memory>
+#include <random>
+
+// From SpicaCpp
+#include "UnitTestManager.hpp"
+
+// From Clac
+#include "IntegerEntity.hpp"
+#include "ModularEntity.hpp"
+#include "arithmetic.hpp"
+#include "modular.hpp"
+
+// From Check
+#include "u_tests.hpp"
+
+using namespace std;
+using namespace clac::arithmetic;
+
+namespace {
+
+    mt19937_64 generator( 19 );
+
+    natural_t random_natural( size_t limb_count )
+    {
+        natural_t result( limb_count );
+        for( limb_t &limb : result ) {
+            limb = generator( );
+        }
+        normalize( result );
+        return result;
+    }
+
+    natural_t remainder_of( const natural_t &number, const natural_t &modulus )
+    {
+        natural_t quotient, remainder;
+        divide( number, modulus, quotient, remainder );
+        return remainder;
+    }
+
+    // Square and multiply, dividing after every step.
+    natural_t reference_power_mod(
+        const natural_t &base, const natural_t &exponent, const natural_t &modulus )
+    {
+        natural_t result = remainder_of( natural_t{ 1 }, modulus );
+        const natural_t x = remainder_of( base, modulus );
+        for( size_t i = bit_length( exponent ); i > 0; --i ) {
+            result = remainder_of( square( result ), modulus );
+            if( ( exponent[( i - 1 ) / 64] >> ( ( i - 1 ) % 64 ) ) & 1 )
+                result = remainder_of( multiply( result, x ), modulus );
+        }
+        return result;
+    }
+
+    // The Montgomery and Barrett products must agree with dividing the full product.
+    void reduction_test( )
+    {
+        UnitTestManager::UnitTest test( "reduction_test" );
+
+        for( size_t limbs : { 1, 2, 3, 8, 23, 24, 30, 50 } ) {
+            for( int trial = 0; trial < 5; ++trial ) {
+                natural_t modulus = random_natural( limbs );
+                modulus[0] |= 1;
+                const Montgomery odd( modulus );
+                natural_t even_modulus = modulus;
+                even_modulus[0] &= ~limb_t{ 1 };
+                const Barrett even( even_modulus );
+
+                const natural_t x = remainder_of( random_natural( limbs ), even_modulus );
+                const natural_t y = remainder_of( random_natural( limbs ), even_modulus );
+                const natural_t product = multiply( x, y );
+
+                const natural_t form = odd.multiply( odd.to_form( x ), odd.to_form( y ) );
+                UNIT_CHECK( odd.from_form( form ) == remainder_of( product, modulus ) );
+                UNIT_CHECK( odd.from_form( odd.square( odd.to_form( x ) ) ) ==
+                            remainder_of( square( x ), modulus ) );
+                UNIT_CHECK( odd.from_form( odd.to_form( x ) ) == x );
+                UNIT_CHECK( odd.from_form( odd.one( ) ) ==
+                            remainder_of( natural_t{ 1 }, modulus ) );
+
+                UNIT_CHECK( even.multiply( x, y ) == remainder_of( product, even_modulus ) );
+                UNIT_CHECK( even.reduce( random_natural( 3 * limbs ) ).size( ) <= limbs );
+            }
+        }
+
+        // The largest residue and a modulus of one.
+        const natural_t modulus{ ~limb_t{ 0 }, ~limb_t{ 0 } };
+        const Montgomery ring( modulus );
+        const natural_t top = subtract( modulus, natural_t{ 1 } );
+        UNIT_CHECK( ring.from_form( ring.square( ring.to_form( top ) ) ) == natural_t{ 1 } );
+        const Montgomery unit( natural_t{ 1 } );
+        UNIT_CHECK( unit.from_form( unit.to_form( natural_t{ 5 } ) ).empty( ) );
+    }
+
+    void power_mod_test( )
+    {
+        UnitTestManager::UnitTest test( "power_mod_test" );
+
+        UNIT_CHECK( power_mod( natural_t{ 4 }, natural_t{ 13 }, natural_t{ 497 } ) ==
+                    natural_t{ 445 } );
+        UNIT_CHECK( power_mod( natural_t{ 3 }, natural_t{ 200 }, natural_t{ 1000 } ) ==
+                    natural_t{ 1 } );
+        UNIT_CHECK( power_mod( natural_t{ 2 }, natural_t{ 100 }, natural_t{ 1024 } ).empty( ) );
+        UNIT_CHECK( power_mod( natural_t{ 7 }, natural_t( ), natural_t{ 10 } ) == natural_t{ 1 } );
+        UNIT_CHECK( power_mod( natural_t{ 7 }, natural_t{ 3 }, natural_t{ 1 } ).empty( ) );
+
+        for( size_t limbs : { 1, 2, 5, 24, 40 } ) {
+            for( size_t exponent_limbs : { 1, 3 } ) {
+                for( limb_t parity : { 0, 1 } ) {
+                    natural_t modulus = random_natural( limbs );
+                    modulus[0] = ( modulus[0] & ~limb_t{ 1 } ) | parity;
+                    const natural_t base = random_natural( limbs + 1 );
+                    const natural_t exponent = random_natural( exponent_limbs );
+                    UNIT_CHECK( power_mod( base, exponent, modulus ) ==
+                                reference_power_mod( base, exponent, modulus ) );
+                }
+            }
+        }
+
+        bool thrown = false;
+        try {
+            power_mod( natural_t{ 2 }, natural_t{ 2 }, natural_t( ) );
+        }
+        catch( const std::domain_error & ) {
+            thrown = true;
+        }
+        UNIT_CHECK( thrown );
+    }
+
+    // An inverse exists exactly when the GCD is one, and then the product is one.
+    void inverse_test( )
+    {
+        UnitTestManager::UnitTest test( "inverse_test" );
+
+        const natural_t one{ 1 };
+        bool agree = true;
+        for( size_t limbs : { 1, 2, 5, 40 } ) {
+            for( int trial = 0; trial < 20; ++trial ) {
+                natural_t modulus = random_natural( limbs );
+                if( trial % 4 == 0 )
+                    modulus[0] &= ~limb_t{ 3 };
+                normalize( modulus );
+                if( modulus.empty( ) )
+                    continue;
+                const natural_t x = random_natural( limbs + trial % 3 );
+                natural_t inverse;
+                const bool found = inverse_mod( x, modulus, inverse );
+                const bool coprime = gcd( x, modulus ) == one;
+                agree = agree && found == coprime;
+                if( found ) {
+                    agree = agree && compare( inverse, modulus ) < 0;
+                    agree = agree && remainder_of( multiply( x, inverse ), modulus ) ==
+                                         remainder_of( one, modulus );
+                }
+            }
+        }
+        UNIT_CHECK( agree );
+
+        natural_t inverse;
+        UNIT_CHECK( inverse_mod( natural_t{ 3 }, natural_t{ 7 }, inverse ) &&
+                    inverse == natural_t{ 5 } );
+        UNIT_CHECK( !inverse_mod( natural_t{ 6 }, natural_t{ 9 }, inverse ) );
+        UNIT_CHECK( !inverse_mod( natural_t( ), natural_t{ 9 }, inverse ) );
+        UNIT_CHECK( inverse_mod( natural_t{ 5 }, one, inverse ) && inverse.empty( ) );
+    }
+
+    void entity_test( )
+    {
+        UnitTestManager::UnitTest test( "entity_test" );
+
+        ModularEntity five{ natural_t{ 5 }, false, natural_t{ 7 } };
+        ModularEntity minus_one{ natural_t{ 1 }, true, natural_t{ 7 } };
+        UNIT_CHECK( five.display( ) == "5 (mod 7)" );
+        UNIT_CHECK( minus_one.display( ) == "6 (mod 7)" );
+
+        unique_ptr<Entity> sum{ five.plus( &minus_one ) };
+        UNIT_CHECK( sum->display( ) == "4 (mod 7)" );
+        unique_ptr<Entity> difference{ minus_one.minus( &five ) };
+        UNIT_CHECK( difference->display( ) == "1 (mod 7)" );
+        unique_ptr<Entity> product{ five.multiply( &minus_one ) };
+        UNIT_CHECK( product->display( ) == "2 (mod 7)" );
+        unique_ptr<Entity> negative{ five.neg( ) };
+        UNIT_CHECK( negative->display( ) == "2 (mod 7)" );
+        unique_ptr<Entity> squared{ five.sq( ) };
+        UNIT_CHECK( squared->display( ) == "4 (mod 7)" );
+
+        // Integers meeting a residue are reduced by its modulus.
+        IntegerEntity ten{ int64_t{ 10 } };
+        unique_ptr<Entity> lifted{ ten.to_modular( ) };
+        unique_ptr<Entity> mixed{ lifted->multiply( &five ) };
+        UNIT_CHECK( mixed->display( ) == "1 (mod 7)" );
+        unique_ptr<Entity> power{ five.power( lifted.get( ) ) };
+        UNIT_CHECK( power->display( ) == "2 (mod 7)" );
+        unique_ptr<Entity> equal{ lifted->is_equal( &five ) };
+        UNIT_CHECK( equal->display( ) == "0" );
+        unique_ptr<Entity> integer{ power->to_integer( ) };
+        UNIT_CHECK( integer->display( ) == "2" );
+
+        // Division and negative powers go through the inverse.
+        unique_ptr<Entity> inverse{ five.inv( ) };
+        UNIT_CHECK( inverse->display( ) == "3 (mod 7)" );
+        unique_ptr<Entity> quotient{ minus_one.divide( &five ) };
+        UNIT_CHECK( quotient->display( ) == "4 (mod 7)" );
+        unique_ptr<Entity> by_integer{ lifted->divide( &five ) };
+        UNIT_CHECK( by_integer->display( ) == "2 (mod 7)" );
+        IntegerEntity minus_two{ int64_t{ -2 } };
+        unique_ptr<Entity> lowered{ minus_two.to_modular( ) };
+        unique_ptr<Entity> negative_power{ five.power( lowered.get( ) ) };
+        UNIT_CHECK( negative_power->display( ) == "2 (mod 7)" );
+
+        // Even moduli have no Montgomery form.
+        ModularEntity three{ natural_t{ 3 }, false, natural_t{ 8 } };
+        unique_ptr<Entity> odd_power{ three.power( lifted.get( ) ) };
+        UNIT_CHECK( odd_power->display( ) == "1 (mod 8)" );
+        unique_ptr<Entity> different{ three.is_equal( &five ) };
+        UNIT_CHECK( different->display( ) == "0" );
+        unique_ptr<Entity> even_inverse{ three.power( lowered.get( ) ) };
+        UNIT_CHECK( even_inverse->display( ) == "1 (mod 8)" );
+
+        bool thrown = false;
+        try {
+            unique_ptr<Entity> bad{ three.plus( &five ) };
+        }
+        catch( const Entity::Error & ) {
+            thrown = true;
+        }
+        UNIT_CHECK( thrown );
+        thrown = false;
+        ModularEntity four{ natural_t{ 4 }, false, natural_t{ 8 } };
+        try {
+            unique_ptr<Entity> bad{ three.divide( &four ) };
+        }
+        catch( const Entity::Error & ) {
+            thrown = true;
+        }
+        UNIT_CHECK( thrown );
+
+        // The powmod word works on integers, including negative bases.
+        IntegerEntity base{ int64_t{ -4 } }, exponent{ int64_t{ 13 } }, modulus{ int64_t{ 497 } };
+        unique_ptr<Entity> result{ base.power_mod( exponent, modulus ) };
+        UNIT_CHECK( result->display( ) == "52" );
+    }
+
+}
+
+
+bool ModularEntity_tests( )
+{
+    reduction_test( );
+    power_mod_test( );
+    inverse_test( );
+    entity_test( );
+    return true;
+}
@@ -0,0 +1,174 @@
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+
+// From SpicaCpp
+#include "UnitTestManager.hpp"
+
+// From Clac
+#include "DisplayState.hpp"
+#include "Entity.hpp"
+#include "RationalEntity.hpp"
+
+// From Check
+#include "u_tests.hpp"
+
+using namespace std;
+using namespace clac::entity;
+namespace display_state = clac::display_state;
+
+namespace {
+
+    unique_ptr<Entity> fraction( int64_t numerator, int64_t denominator )
+    {
+        return make_unique<RationalEntity>( spica::VeryLong( numerator ),
+                                            spica::VeryLong( denominator ) );
+    }
+
+    void reduction_test( )
+    {
+        UnitTestManager::UnitTest test( "reduction_test" );
+
+        UNIT_CHECK( fraction( 6, 8 )->display( ) == "3/4" );
+        UNIT_CHECK( fraction( 3, -4 )->display( ) == "-3/4" );
+        UNIT_CHECK( fraction( -3, -4 )->display( ) == "3/4" );
+        UNIT_CHECK( fraction( -12, 4 )->display( ) == "-3/1" );
+
+        // Zero is never negative and has a denominator of one, however it was written.
+        UNIT_CHECK( fraction( 0, -5 )->display( ) == "0/1" );
+        unique_ptr<Entity> zero{ fraction( 0, 7 ) };
+        unique_ptr<Entity> negated{ zero->neg( ) };
+        UNIT_CHECK( negated->display( ) == "0/1" );
+        unique_ptr<Entity> half{ fraction( 1, 2 ) };
+        unique_ptr<Entity> product{ zero->multiply( half.get( ) ) };
+        UNIT_CHECK( product->display( ) == "0/1" );
+        unique_ptr<Entity> sum{ zero->plus( half.get( ) ) };
+        UNIT_CHECK( sum->display( ) == "1/2" );
+        unique_ptr<Entity> difference{ half->minus( half.get( ) ) };
+        UNIT_CHECK( difference->display( ) == "0/1" );
+
+        bool thrown = false;
+        try {
+            unique_ptr<Entity> inverse{ zero->inv( ) };
+        }
+        catch( const Entity::Error & ) {
+            thrown = true;
+        }
+        UNIT_CHECK( thrown );
+        thrown = false;
+        try {
+            unique_ptr<Entity> quotient{ half->divide( zero.get( ) ) };
+        }
+        catch( const Entity::Error & ) {
+            thrown = true;
+        }
+        UNIT_CHECK( thrown );
+        thrown = false;
+        try {
+            fraction( 1, 0 );
+        }
+        catch( const Entity::Error & ) {
+            thrown = true;
+        }
+        UNIT_CHECK( thrown );
+    }
+
+    // Cross cancellation must still give results in lowest terms.
+    void cancellation_test( )
+    {
+        UnitTestManager::UnitTest test( "cancellation_test" );
+
+        unique_ptr<Entity> a{ fraction( 14, 15 ) };
+        unique_ptr<Entity> b{ fraction( 25, 21 ) };
+        unique_ptr<Entity> product{ a->multiply( b.get( ) ) };
+        UNIT_CHECK( product->display( ) == "10/9" );
+        unique_ptr<Entity> quotient{ a->divide( b.get( ) ) };
+        UNIT_CHECK( quotient->display( ) == "98/125" );
+        unique_ptr<Entity> c{ fraction( -3, 2 ) };
+        unique_ptr<Entity> d{ fraction( 2, 3 ) };
+        unique_ptr<Entity> one{ c->multiply( d.get( ) ) };
+        UNIT_CHECK( one->display( ) == "-1/1" );
+
+        // 1/6 + 1/10 = 4/15: the sum of the cross products shares a factor with the
+        // denominators' gcd.
+        unique_ptr<Entity> sixth{ fraction( 1, 6 ) };
+        unique_ptr<Entity> tenth{ fraction( 1, 10 ) };
+        unique_ptr<Entity> sum{ sixth->plus( tenth.get( ) ) };
+        UNIT_CHECK( sum->display( ) == "4/15" );
+        unique_ptr<Entity> difference{ sixth->minus( tenth.get( ) ) };
+        UNIT_CHECK( difference->display( ) == "1/15" );
+    }
+
+    //
+    // The same random computations in eager and in lazy mode must display the same results and
+    // compare the same way.
+    //
+    void lazy_test( )
+    {
+        UnitTestManager::UnitTest test( "lazy_test" );
+
+        const display_state::RationalModeType old_mode = display_state::get_rational_mode( );
+        mt19937_64 generator( 10 );
+        bool agree = true;
+        for( int trial = 0; trial < 200; ++trial ) {
+            const int64_t values[] = {
+                static_cast<int64_t>( generator( ) % 2001 ) - 1000,
+                static_cast<int64_t>( generator( ) % 1000 ) + 1,
+                static_cast<int64_t>( generator( ) % 2001 ) - 1000,
+                static_cast<int64_t>( generator( ) % 1000 ) + 1 };
+            const unsigned steps = generator( ) % 8 + 1;
+            const uint64_t choices = generator( );
+
+            string displays[2];
+            string relations[2];
+            const display_state::RationalModeType modes[] = { display_state::EAGER,
+                                                              display_state::LAZY };
+            for( int m = 0; m < 2; ++m ) {
+                display_state::set_rational_mode( modes[m] );
+                unique_ptr<Entity> x{ fraction( values[0], values[1] ) };
+                const unique_ptr<Entity> y{ fraction( values[2], values[3] ) };
+                for( unsigned step = 0; step < steps; ++step ) {
+                    Entity *next = nullptr;
+                    switch( ( choices >> ( 2 * step ) ) & 3 ) {
+                    case 0:  next = x->plus( y.get( ) ); break;
+                    case 1:  next = x->minus( y.get( ) ); break;
+                    case 2:  next = x->multiply( y.get( ) ); break;
+                    default:
+                        next = ( values[2] == 0 ) ? x->neg( ) : x->divide( y.get( ) );
+                        break;
+                    }
+                    x.reset( next );
+                }
+                unique_ptr<Entity> equal{ x->is_equal( y.get( ) ) };
+                unique_ptr<Entity> less{ x->is_less( y.get( ) ) };
+                relations[m] = equal->display( ) + less->display( );
+                displays[m] = x->display( );
+            }
+            agree = agree && displays[0] == displays[1] && relations[0] == relations[1];
+        }
+        UNIT_CHECK( agree );
+
+        // Equal values compare equal in lazy mode before either is reduced.
+        display_state::set_rational_mode( display_state::LAZY );
+        unique_ptr<Entity> a{ fraction( 1, 3 ) };
+        unique_ptr<Entity> b{ fraction( 1, 6 ) };
+        unique_ptr<Entity> sum{ b->plus( b.get( ) ) };
+        unique_ptr<Entity> equal{ sum->is_equal( a.get( ) ) };
+        UNIT_CHECK( equal->display( ) == "1" );
+        UNIT_CHECK( sum->display( ) == "1/3" );
+
+        display_state::set_rational_mode( old_mode );
+    }
+
+}
+
+
+bool RationalEntity_tests( )
+{
+    reduction_test( );
+    cancellation_test( );
+    lazy_test( );
+    return true;
+}
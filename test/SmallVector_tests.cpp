@@ -0,0 +1,111 @@
+
+#include <cstdint>
+#include <utility>
+
+// From SpicaCpp
+#include "UnitTestManager.hpp"
+
+// From Clac
+#include "small_vector.hpp"
+
+// From Check
+#include "u_tests.hpp"
+
+using namespace std;
+using clac::arithmetic::SmallVector;
+
+namespace {
+
+    using Vector = SmallVector<uint64_t, 4>;
+
+    void growth_test( )
+    {
+        UnitTestManager::UnitTest test( "growth_test" );
+
+        Vector v;
+        UNIT_CHECK( v.empty( ) );
+        UNIT_CHECK( v.is_local( ) );
+        UNIT_CHECK( v.capacity( ) == 4 );
+
+        // Values stay inside the object until they outgrow it.
+        for( uint64_t i = 0; i < 4; ++i ) {
+            v.push_back( i );
+        }
+        UNIT_CHECK( v.is_local( ) );
+        v.push_back( 4 );
+        UNIT_CHECK( !v.is_local( ) );
+        UNIT_CHECK( v.size( ) == 5 );
+        for( uint64_t i = 0; i < 5; ++i ) {
+            UNIT_CHECK( v[i] == i );
+        }
+
+        v.resize( 8 );
+        UNIT_CHECK( v.size( ) == 8 && v[4] == 4 && v[7] == 0 );
+        v.resize( 2 );
+        v.shrink_to_fit( );
+        UNIT_CHECK( v.is_local( ) );
+        UNIT_CHECK( v == Vector( { 0, 1 } ) );
+
+        const uint64_t tail[] = { 7, 8, 9 };
+        v.insert( v.end( ), tail, tail + 3 );
+        UNIT_CHECK( v == Vector( { 0, 1, 7, 8, 9 } ) );
+        v.insert( v.begin( ), tail, tail + 1 );
+        UNIT_CHECK( v == Vector( { 7, 0, 1, 7, 8, 9 } ) );
+
+        v.assign( 3, 6 );
+        UNIT_CHECK( v == Vector( 3, 6 ) );
+        UNIT_CHECK( Vector( v.begin( ) + 1, v.end( ) ) == Vector( 2, 6 ) );
+    }
+
+    void copy_test( )
+    {
+        UnitTestManager::UnitTest test( "copy_test" );
+
+        const Vector small{ 1, 2 };
+        const Vector large{ 1, 2, 3, 4, 5, 6 };
+
+        Vector a( small );
+        Vector b( large );
+        UNIT_CHECK( a == small && a.is_local( ) );
+        UNIT_CHECK( b == large && b.data( ) != large.data( ) );
+
+        a = large;
+        b = small;
+        UNIT_CHECK( a == large );
+        UNIT_CHECK( b == small );
+        UNIT_CHECK( a != b );
+    }
+
+    // Moving a value on the heap takes its buffer; moving a local value copies it.
+    void move_test( )
+    {
+        UnitTestManager::UnitTest test( "move_test" );
+
+        Vector large{ 1, 2, 3, 4, 5, 6 };
+        const uint64_t* buffer = large.data( );
+        Vector moved( std::move( large ) );
+        UNIT_CHECK( moved.data( ) == buffer );
+        UNIT_CHECK( moved.size( ) == 6 );
+        UNIT_CHECK( large.empty( ) && large.is_local( ) );
+
+        Vector small{ 9 };
+        small = std::move( moved );
+        UNIT_CHECK( small.data( ) == buffer );
+        moved = Vector{ 3, 4 };
+        UNIT_CHECK( moved.is_local( ) && moved == Vector( { 3, 4 } ) );
+
+        swap( small, moved );
+        UNIT_CHECK( moved.data( ) == buffer );
+        UNIT_CHECK( small == Vector( { 3, 4 } ) && small.is_local( ) );
+    }
+
+}
+
+
+bool SmallVector_tests( )
+{
+    growth_test( );
+    copy_test( );
+    move_test( );
+    return true;
+}
@@ -0,0 +1,290 @@
+
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+// From SpicaCpp
+#include "UnitTestManager.hpp"
+
+// From Clac
+#include "arithmetic.hpp"
+#include "kernels.hpp"
+
+// From Check
+#include "u_tests.hpp"
+
+using namespace std;
+using namespace clac::arithmetic;
+
+namespace {
+
+    //
+    // Random values of exactly n limbs. Some are all ones bits, which exercise long carry
+    // chains, some are powers of two, and some are mostly zero limbs.
+    //
+    natural_t random_natural( mt19937_64 &generator, size_t n )
+    {
+        natural_t result( n );
+        const auto pattern = generator( ) % 5;
+        for( limb_t &limb : result ) {
+            switch( pattern ) {
+            case 0:  limb = ~limb_t{ 0 }; break;
+            case 1:  limb = 0; break;
+            case 2:  limb = ( generator( ) % 2 == 0 ) ? 0 : generator( ); break;
+            default: limb = generator( ); break;
+            }
+        }
+        // The top limb is never zero, so that the value has exactly n limbs.
+        if( pattern == 1 )
+            result.back( ) = limb_t{ 1 } << ( generator( ) % LIMB_BITS );
+        else if( result.back( ) == 0 )
+            result.back( ) = 1;
+        return result;
+    }
+
+    //! Returns a * b computed with the schoolbook kernel alone.
+    natural_t basecase_product( const natural_t &a, const natural_t &b )
+    {
+        if( a.empty( ) || b.empty( ) )
+            return natural_t( );
+        const natural_t &longer = ( a.size( ) >= b.size( ) ) ? a : b;
+        const natural_t &shorter = ( a.size( ) >= b.size( ) ) ? b : a;
+        natural_t result( a.size( ) + b.size( ) );
+        mul_basecase( result.data( ), longer.data( ), longer.size( ),
+                      shorter.data( ), shorter.size( ) );
+        normalize( result );
+        return result;
+    }
+
+    //! Sizes one below, at, and one above each threshold.
+    vector<size_t> around( const vector<size_t> &thresholds )
+    {
+        vector<size_t> sizes;
+        for( size_t threshold : thresholds ) {
+            sizes.push_back( threshold - 1 );
+            sizes.push_back( threshold );
+            sizes.push_back( threshold + 1 );
+        }
+        return sizes;
+    }
+
+    //
+    // Karatsuba and Toom-3 products and squares, on both sides of each threshold, are compared
+    // with the schoolbook product. The unbalanced sizes exercise the splitting of a long operand
+    // into pieces of the length of the short one.
+    //
+    void karatsuba_toom3_test( )
+    {
+        UnitTestManager::UnitTest test( "karatsuba_toom3_test" );
+
+        const Thresholds &limits = thresholds( );
+        mt19937_64 generator( 1 );
+        bool agree = true;
+        for( size_t n : around( { limits.karatsuba, limits.toom3 } ) ) {
+            for( size_t m : { n, n + 1, n + n / 2, 2 * n + 1, 5 * n } ) {
+                const natural_t a = random_natural( generator, m );
+                const natural_t b = random_natural( generator, n );
+                agree = agree && multiply( a, b ) == basecase_product( a, b );
+                agree = agree && multiply( b, a ) == basecase_product( a, b );
+            }
+        }
+        UNIT_CHECK( agree );
+
+        bool squares_agree = true;
+        for( size_t n : around( { limits.karatsuba_square, limits.toom3_square } ) ) {
+            for( int trial = 0; trial < 4; ++trial ) {
+                const natural_t a = random_natural( generator, n );
+                squares_agree = squares_agree && square( a ) == basecase_product( a, a );
+                squares_agree = squares_agree && multiply( a, a ) == basecase_product( a, a );
+            }
+        }
+        UNIT_CHECK( squares_agree );
+
+        // (2^k - 1)^2 = 2^2k - 2^(k+1) + 1, and a product of powers of two is a power of two.
+        const size_t k = LIMB_BITS * limits.toom3;
+        const natural_t one{ 1 };
+        const natural_t ones = subtract( shift_left( one, k ), one );
+        UNIT_CHECK( square( ones ) == add( subtract( shift_left( one, 2 * k ),
+                                                     shift_left( one, k + 1 ) ), one ) );
+        UNIT_CHECK( multiply( shift_left( one, k ), shift_left( one, 3 * k + 5 ) ) ==
+                    shift_left( one, 4 * k + 5 ) );
+        UNIT_CHECK( multiply( ones, natural_t( ) ).empty( ) );
+    }
+
+    //
+    // NTT products on both sides of the threshold are compared with the schoolbook product.
+    // Larger ones, whose transforms have several different lengths, are compared with Toom-3,
+    // which karatsuba_toom3_test checks. All-ones operands give the largest coefficients, which
+    // must still be recovered exactly from their residues.
+    //
+    void ntt_test( )
+    {
+        UnitTestManager::UnitTest test( "ntt_test" );
+
+        Thresholds &limits = thresholds( );
+        mt19937_64 generator( 2 );
+        bool agree = true;
+        for( size_t n : around( { limits.ntt } ) ) {
+            for( size_t m : { n, 2 * n + 1 } ) {
+                const natural_t a = random_natural( generator, m );
+                const natural_t b = random_natural( generator, n );
+                agree = agree && multiply( a, b ) == basecase_product( a, b );
+            }
+        }
+        UNIT_CHECK( agree );
+
+        bool squares_agree = true;
+        for( size_t n : around( { limits.ntt_square } ) ) {
+            const natural_t a = random_natural( generator, n );
+            squares_agree = squares_agree && square( a ) == basecase_product( a, a );
+        }
+        UNIT_CHECK( squares_agree );
+
+        const natural_t ones( 20000, ~limb_t{ 0 } );
+        const natural_t a = random_natural( generator, 12289 );
+        const natural_t b = random_natural( generator, 8191 );
+        const natural_t ntt_square = square( ones );
+        const natural_t ntt_product = multiply( a, b );
+        const natural_t ntt_ones = multiply( ones, b );
+
+        const Thresholds saved = limits;
+        limits.ntt = limits.ntt_square = ~size_t{ 0 };
+        UNIT_CHECK( ntt_square == square( ones ) );
+        UNIT_CHECK( ntt_product == multiply( a, b ) );
+        UNIT_CHECK( ntt_ones == multiply( ones, b ) );
+        limits = saved;
+    }
+
+    //! Returns true if q and r are the quotient and remainder of a / b.
+    bool is_division( const natural_t &a, const natural_t &b, const natural_t &q,
+                      const natural_t &r )
+    {
+        return compare( r, b ) < 0 && add( multiply( q, b ), r ) == a;
+    }
+
+    //
+    // Divides a by each b with the thresholds as they are, checks q * b + r == a with r < b, and
+    // compares q and r with schoolbook division.
+    //
+    bool divisions_agree( mt19937_64 &generator, const vector<size_t> &divisor_sizes )
+    {
+        Thresholds &limits = thresholds( );
+        bool agree = true;
+        for( size_t n : divisor_sizes ) {
+            for( size_t m : { n, n + 1, 2 * n, 2 * n + 3, 5 * n + 7 } ) {
+                const natural_t a = random_natural( generator, m );
+                const natural_t b = random_natural( generator, n );
+                natural_t q, r;
+                divide( a, b, q, r );
+                agree = agree && is_division( a, b, q, r );
+
+                const Thresholds saved = limits;
+                limits.burnikel_ziegler = limits.newton = ~size_t{ 0 };
+                natural_t basecase_q, basecase_r;
+                divide( a, b, basecase_q, basecase_r );
+                limits = saved;
+                agree = agree && q == basecase_q && r == basecase_r;
+            }
+        }
+        return agree;
+    }
+
+    //
+    // Burnikel-Ziegler division on both sides of its threshold, and Newton division on both
+    // sides of a lowered threshold (the default is too large for a unit test). Numerators with
+    // a remainder of zero or of b - 1 catch off by one errors in the quotient.
+    //
+    void division_test( )
+    {
+        UnitTestManager::UnitTest test( "division_test" );
+
+        Thresholds &limits = thresholds( );
+        mt19937_64 generator( 3 );
+        UNIT_CHECK( divisions_agree( generator, around( { limits.burnikel_ziegler } ) ) );
+
+        const Thresholds saved = limits;
+        limits.newton = 300;
+        UNIT_CHECK( divisions_agree( generator, around( { limits.newton } ) ) );
+
+        bool edges_agree = true;
+        const natural_t one{ 1 };
+        for( size_t n : { size_t{ 299 }, size_t{ 301 }, limits.burnikel_ziegler + 1 } ) {
+            const natural_t b = random_natural( generator, n );
+            const natural_t c = random_natural( generator, 2 * n + 1 );
+            const natural_t exact = multiply( b, c );
+            const natural_t below = subtract( add( exact, b ), one );
+            natural_t q, r;
+            divide( exact, b, q, r );
+            edges_agree = edges_agree && q == c && r.empty( );
+            divide( below, b, q, r );
+            edges_agree = edges_agree && q == c && r == subtract( b, one );
+
+            // All ones divided by a power of two, and a power of two by all ones.
+            const natural_t ones( 3 * n, ~limb_t{ 0 } );
+            const natural_t power = shift_left( one, n * LIMB_BITS - 1 );
+            divide( ones, power, q, r );
+            edges_agree = edges_agree && is_division( ones, power, q, r );
+            divide( shift_left( one, 3 * n * LIMB_BITS ), natural_t( n, ~limb_t{ 0 } ), q, r );
+            edges_agree = edges_agree && is_division( shift_left( one, 3 * n * LIMB_BITS ),
+                                                      natural_t( n, ~limb_t{ 0 } ), q, r );
+        }
+        UNIT_CHECK( edges_agree );
+        limits = saved;
+    }
+
+    //
+    // Decimal conversions on both sides of the divide and conquer threshold are compared with
+    // the schoolbook conversions and must round trip. Powers of ten, and one less, have long
+    // runs of zeros and nines that must survive the padding of the low halves.
+    //
+    void radix_test( )
+    {
+        UnitTestManager::UnitTest test( "radix_test" );
+
+        Thresholds &limits = thresholds( );
+        mt19937_64 generator( 5 );
+        bool agree = true;
+        for( size_t n : around( { limits.radix, 4 * limits.radix, 64 * limits.radix } ) ) {
+            const natural_t x = random_natural( generator, n );
+            const string digits = to_decimal( x );
+            agree = agree && from_decimal( digits ) == x;
+
+            const Thresholds saved = limits;
+            limits.radix = ~size_t{ 0 } / 64;
+            agree = agree && to_decimal( x ) == digits && from_decimal( digits ) == x;
+            limits = saved;
+        }
+        UNIT_CHECK( agree );
+
+        bool powers_agree = true;
+        const natural_t one{ 1 };
+        for( size_t k : { size_t{ 19 * 64 - 1 }, size_t{ 19 * 64 }, size_t{ 19 * 64 + 1 },
+                          size_t{ 19 * 1024 }, size_t{ 20000 } } ) {
+            const natural_t ten_power = power( natural_t{ 10 }, k );
+            powers_agree = powers_agree && to_decimal( ten_power ) == "1" + string( k, '0' );
+            powers_agree =
+                powers_agree && to_decimal( subtract( ten_power, one ) ) == string( k, '9' );
+            powers_agree = powers_agree && from_decimal( "1" + string( k, '0' ) ) == ten_power;
+            powers_agree = powers_agree && from_decimal( string( k, '0' ) + "7" ) == natural_t{ 7 };
+        }
+        UNIT_CHECK( powers_agree );
+
+        const natural_t ones( 100, ~limb_t{ 0 } );
+        UNIT_CHECK( from_decimal( to_decimal( ones ) ) == ones );
+        const natural_t two_power = shift_left( one, 100 * LIMB_BITS );
+        UNIT_CHECK( from_decimal( to_decimal( two_power ) ) == two_power );
+        UNIT_CHECK( to_decimal( natural_t( ) ) == "0" && from_decimal( "0" ).empty( ) );
+    }
+
+}
+
+
+bool arithmetic_tests( )
+{
+    karatsuba_toom3_test( );
+    ntt_test( );
+    division_test( );
+    radix_test( );
+    return true;
+}
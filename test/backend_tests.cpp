@@ -0,0 +1,173 @@
+
+#include <cstddef>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// From SpicaCpp
+#include "UnitTestManager.hpp"
+
+// From Clac
+#include "backend.hpp"
+
+// From Check
+#include "u_tests.hpp"
+
+using namespace std;
+using namespace clac::arithmetic;
+
+namespace {
+
+    // Random values, some of them all ones bits, which exercise long carry chains.
+    natural_t random_natural( mt19937_64& generator, size_t n_limbs )
+    {
+        natural_t result( n_limbs );
+        const bool all_ones = generator( ) % 4 == 0;
+        for( limb_t& limb : result ) {
+            limb = all_ones ? ~limb_t{ 0 } : generator( );
+        }
+        normalize( result );
+        return result;
+    }
+
+    bool throws_domain_error( void ( *operation )( const Backend& ), const Backend& backend )
+    {
+        try {
+            operation( backend );
+        }
+        catch( const domain_error& ) {
+            return true;
+        }
+        return false;
+    }
+
+    //
+    // Every backend must satisfy the contracts in arithmetic.hpp on its own, and it must give
+    // the same results as the native backend. Sizes reach past the thresholds of the native
+    // algorithms, up to the number theoretic transform.
+    //
+    void conformance_test( )
+    {
+        UnitTestManager::UnitTest test( "conformance_test" );
+
+        const vector<const Backend*> backends = available_backends( );
+        const Backend& reference = *backends.front( );
+        const natural_t one{ 1 };
+
+        for( const Backend* backend : backends ) {
+            mt19937_64 generator( 16 );
+            const size_t sizes[] = { 0, 1, 2, 3, 7, 30, 250, 3200 };
+            for( size_t x : sizes ) {
+                for( size_t y : sizes ) {
+                    const natural_t a = random_natural( generator, x );
+                    const natural_t b = random_natural( generator, y );
+
+                    const natural_t product = backend->multiply( a, b );
+                    UNIT_CHECK( product == reference.multiply( a, b ) );
+                    UNIT_CHECK( backend->multiply( b, a ) == product );
+
+                    if( !b.empty( ) ) {
+                        natural_t quotient, remainder;
+                        const natural_t numerator = add( product, a );
+                        backend->divide( numerator, b, quotient, remainder );
+                        UNIT_CHECK( compare( remainder, b ) < 0 );
+                        UNIT_CHECK(
+                            add( reference.multiply( quotient, b ), remainder ) == numerator );
+                        UNIT_CHECK( backend->divide_exact( product, b ) == a );
+                    }
+
+                    const natural_t g = backend->gcd( a, b );
+                    UNIT_CHECK( g == reference.gcd( a, b ) );
+                    UNIT_CHECK( backend->gcd( product, a ) == a );
+                }
+
+                const natural_t a = random_natural( generator, x );
+                UNIT_CHECK( backend->square( a ) == reference.multiply( a, a ) );
+
+                const string digits = backend->to_decimal( a );
+                UNIT_CHECK( digits == reference.to_decimal( a ) );
+                UNIT_CHECK( backend->from_decimal( digits ) == a );
+
+                for( size_t k : { 1, 2, 3, 5, 64 } ) {
+                    bool exact = false;
+                    const natural_t r = backend->root( a, k, exact );
+                    bool reference_exact = true;
+                    UNIT_CHECK( r == reference.root( a, k, reference_exact ) );
+                    UNIT_CHECK( exact == reference_exact );
+                    UNIT_CHECK( compare( power( r, k ), a ) <= 0 );
+                    UNIT_CHECK( compare( power( add( r, one ), k ), a ) > 0 );
+                }
+            }
+        }
+    }
+
+    // Values at the edges of the contracts.
+    void edge_test( )
+    {
+        UnitTestManager::UnitTest test( "edge_test" );
+
+        const natural_t zero;
+        const natural_t two_64{ 0, 1 };
+        for( const Backend* backend : available_backends( ) ) {
+            UNIT_CHECK( backend->to_decimal( zero ) == "0" );
+            UNIT_CHECK( backend->to_decimal( two_64 ) == "18446744073709551616" );
+            UNIT_CHECK( backend->from_decimal( "0" ) == zero );
+            UNIT_CHECK( backend->from_decimal( "00018446744073709551616" ) == two_64 );
+            UNIT_CHECK( backend->gcd( zero, zero ) == zero );
+            UNIT_CHECK( backend->gcd( zero, two_64 ) == two_64 );
+            UNIT_CHECK( backend->square( two_64 ) == natural_t( { 0, 0, 1 } ) );
+
+            natural_t quotient{ 7 }, remainder{ 7 };
+            backend->divide( natural_t{ 5 }, two_64, quotient, remainder );
+            UNIT_CHECK( quotient == zero && remainder == natural_t{ 5 } );
+
+            bool exact = false;
+            UNIT_CHECK( backend->root( two_64, 64, exact ) == natural_t{ 2 } && exact );
+            UNIT_CHECK( backend->root( two_64, 3, exact ) == natural_t{ 2642245 } && !exact );
+
+            UNIT_CHECK( throws_domain_error( []( const Backend& b ) {
+                natural_t q, r;
+                b.divide( natural_t{ 1 }, natural_t( ), q, r );
+            }, *backend ) );
+            UNIT_CHECK( throws_domain_error( []( const Backend& b ) {
+                b.divide_exact( natural_t{ 1 }, natural_t( ) );
+            }, *backend ) );
+            UNIT_CHECK( throws_domain_error( []( const Backend& b ) {
+                bool exact;
+                b.root( natural_t{ 1 }, 0, exact );
+            }, *backend ) );
+        }
+    }
+
+    // The functions of arithmetic.hpp call through whichever backend is active.
+    void selection_test( )
+    {
+        UnitTestManager::UnitTest test( "selection_test" );
+
+        const vector<const Backend*> backends = available_backends( );
+        const Backend& original = active_backend( );
+        UNIT_CHECK( string( backends.front( )->name ) == "native" );
+        UNIT_CHECK( &original == backends.back( ) );
+        UNIT_CHECK( ( gmp_backend( ) != nullptr ) == ( backends.size( ) == 2 ) );
+
+        for( const Backend* backend : backends ) {
+            set_active_backend( *backend );
+            UNIT_CHECK( &active_backend( ) == backend );
+            UNIT_CHECK( to_decimal( multiply( from_decimal( "123456789123456789123456789" ),
+                                              from_decimal( "1000000000000000000000" ) ) ) ==
+                        "123456789123456789123456789000000000000000000000" );
+        }
+        set_active_backend( original );
+    }
+
+}
+
+
+bool backend_tests( )
+{
+    conformance_test( );
+    edge_test( );
+    selection_test( );
+    return true;
+}
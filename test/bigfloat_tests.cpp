@@ -0,0 +1,260 @@
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+// From SpicaCpp
+#include "UnitTestManager.hpp"
+
+// From Clac
+#include "BigFloatEntity.hpp"
+#include "DisplayState.hpp"
+#include "FloatEntity.hpp"
+#include "IntegerEntity.hpp"
+#include "RationalEntity.hpp"
+#include "arithmetic.hpp"
+#include "bigfloat.hpp"
+
+// From Check
+#include "u_tests.hpp"
+
+using namespace std;
+using namespace clac::arithmetic;
+
+namespace {
+
+    BigFloat make( uint64_t mantissa, int64_t exponent = 0, bool negative = false )
+    {
+        natural_t limbs{ mantissa };
+        normalize( limbs );
+        return BigFloat{ limbs, exponent, negative };
+    }
+
+    bool same( const BigFloat &left, const BigFloat &right )
+    {
+        return left.mantissa == right.mantissa && left.exponent == right.exponent &&
+               left.negative == right.negative;
+    }
+
+    void rounding_test( )
+    {
+        UnitTestManager::UnitTest test( "rounding_test" );
+
+        // 10011, 10101, 10111 to three bits: a tie rounds to even, others to nearest.
+        UNIT_CHECK( same( round_float( make( 19 ), 3 ), make( 5, 2 ) ) );
+        UNIT_CHECK( same( round_float( make( 21 ), 3 ), make( 5, 2 ) ) );
+        UNIT_CHECK( same( round_float( make( 23 ), 3 ), make( 3, 3 ) ) );
+        UNIT_CHECK( same( round_float( make( 18 ), 3 ), make( 1, 4 ) ) );
+        UNIT_CHECK( same( round_float( make( 22 ), 3 ), make( 3, 3 ) ) );
+
+        // Results are normalized to an odd mantissa.
+        UNIT_CHECK( same( round_float( make( 40, -3 ), 10 ), make( 5 ) ) );
+        UNIT_CHECK( round_float( make( 0 ), 10 ).mantissa.empty( ) );
+
+        // Every result agrees with double arithmetic at 53 bits.
+        const double values[] = { 1.0, 3.0, 0.1, -7.25, 1.0e300, 2.0e-300, 123456.789 };
+        bool agree = true;
+        for( double x : values ) {
+            for( double y : values ) {
+                const BigFloat a = to_bigfloat( x );
+                const BigFloat b = to_bigfloat( y );
+                agree = agree && to_double( add( a, b, 53 ) ) == x + y;
+                agree = agree && to_double( subtract( a, b, 53 ) ) == x - y;
+                agree = agree && to_double( multiply( a, b, 53 ) ) == x * y;
+                agree = agree && to_double( divide( a, b, 53 ) ) == x / y;
+            }
+            agree = agree && ( x < 0 || to_double( square_root( to_bigfloat( x ), 53 ) ) ==
+                                            std::sqrt( x ) );
+        }
+        UNIT_CHECK( agree );
+    }
+
+    void sum_test( )
+    {
+        UnitTestManager::UnitTest test( "sum_test" );
+
+        // 1 + 2^-1000 is 1 at any precision below 1000 bits, but just above 1 when the small
+        // operand decides a tie: 1 + 2^-10 + 2^-1000 at 10 bits rounds up.
+        const BigFloat one = make( 1 );
+        const BigFloat tiny = make( 1, -1000 );
+        UNIT_CHECK( same( add( one, tiny, 100 ), one ) );
+        const BigFloat exact{ add( shift_left( natural_t{ 1 }, 1000 ), natural_t{ 1 } ), -1000 };
+        UNIT_CHECK( same( add( one, tiny, 1001 ), exact ) );
+        const BigFloat tie = add( one, make( 1, -10 ), 20 );
+        UNIT_CHECK( same( add( tie, tiny, 10 ), make( 513, -9 ) ) );
+        UNIT_CHECK( same( subtract( tie, tiny, 10 ), one ) );
+
+        // Cancellation is exact.
+        UNIT_CHECK( add( tie, make( 1025, -10, true ), 10 ).mantissa.empty( ) );
+        UNIT_CHECK( same( subtract( one, make( 3, -1 ), 10 ), make( 1, -1, true ) ) );
+        UNIT_CHECK( compare( make( 3, -1 ), one ) > 0 && compare( make( 1, 0, true ), one ) < 0 );
+        UNIT_CHECK( compare( make( 2 ), make( 1, 1 ) ) == 0 );
+    }
+
+    void quotient_test( )
+    {
+        UnitTestManager::UnitTest test( "quotient_test" );
+
+        // 1/3 and 2/3 both round up in their last place.
+        const BigFloat third = divide( make( 1 ), make( 3 ), 64 );
+        UNIT_CHECK( same( third, make( 0xAAAAAAAAAAAAAAAB, -65 ) ) );
+        UNIT_CHECK( same( divide( make( 2 ), make( 3 ), 4 ), make( 11, -4 ) ) );
+        UNIT_CHECK( same( divide( make( 10 ), make( 4 ), 4 ), make( 5, -1 ) ) );
+
+        bool thrown = false;
+        try {
+            divide( make( 1 ), make( 0 ), 10 );
+        }
+        catch( const std::domain_error & ) {
+            thrown = true;
+        }
+        UNIT_CHECK( thrown );
+
+        // The square root of two to 200 digits, rounded.
+        const string root2 =
+            "14142135623730950488016887242096980785696718753769480731766797379907324784621070388503"
+            "87534327641572735013846230912297024924836055850737212644121497099935831413222665927505"
+            "5927557999505011527820605715";
+        int64_t exponent;
+        const BigFloat root = square_root( make( 2 ), 680 );
+        UNIT_CHECK( to_decimal( root, 200, exponent ) == root2 );
+        UNIT_CHECK( exponent == 0 );
+        UNIT_CHECK( same( square_root( make( 9, 4 ), 10 ), make( 3, 2 ) ) );
+        UNIT_CHECK( same( square_root( make( 2 ), 3 ), make( 3, -1 ) ) );
+    }
+
+    void decimal_test( )
+    {
+        UnitTestManager::UnitTest test( "decimal_test" );
+
+        int64_t exponent;
+        UNIT_CHECK( to_decimal( make( 12345 ), 3, exponent ) == "123" && exponent == 4 );
+        UNIT_CHECK( to_decimal( make( 12350 ), 3, exponent ) == "124" && exponent == 4 );
+        UNIT_CHECK( to_decimal( make( 12250 ), 3, exponent ) == "122" && exponent == 4 );
+        UNIT_CHECK( to_decimal( make( 99999 ), 3, exponent ) == "100" && exponent == 5 );
+        UNIT_CHECK( to_decimal( make( 1, -1 ), 2, exponent ) == "50" && exponent == -1 );
+        UNIT_CHECK( to_decimal( to_bigfloat( 1.0e-300 ), 5, exponent ) == "10000" &&
+                    exponent == -300 );
+
+        UNIT_CHECK( nearest_integer( make( 5, -1 ) ) == natural_t{ 2 } );
+        UNIT_CHECK( nearest_integer( make( 7, -1 ) ) == natural_t{ 4 } );
+        UNIT_CHECK( nearest_integer( make( 11, -2 ) ) == natural_t{ 3 } );
+        UNIT_CHECK( nearest_integer( make( 3, 70 ) ) == shift_left( natural_t{ 3 }, 70 ) );
+        UNIT_CHECK( to_double( make( 1, 5000 ) ) == HUGE_VAL );
+        UNIT_CHECK( to_double( make( 1, -5000, true ) ) == 0.0 );
+    }
+
+    void entity_test( )
+    {
+        UnitTestManager::UnitTest test( "entity_test" );
+
+        namespace display_state = clac::display_state;
+        const int old_precision = display_state::get_precision( );
+        display_state::set_precision( 20 );
+
+        IntegerEntity two{ int64_t{ 2 } };
+        unique_ptr<Entity> big_two{ two.to_bigfloat( ) };
+        unique_ptr<Entity> root{ big_two->sqrt( ) };
+        UNIT_CHECK( root->my_type( ) == BIGFLOAT );
+        UNIT_CHECK( root->display( ) == "1.4142135623730950488" );
+
+        RationalEntity third{ spica::VeryLong( 1 ), spica::VeryLong( 3 ) };
+        unique_ptr<Entity> big_third{ third.to_bigfloat( ) };
+        UNIT_CHECK( big_third->display( ) == "0.33333333333333333333" );
+        unique_ptr<Entity> sum{ big_third->plus( big_two.get( ) ) };
+        UNIT_CHECK( sum->display( ) == "2.3333333333333333333" );
+        unique_ptr<Entity> negative{ big_third->minus( big_two.get( ) ) };
+        UNIT_CHECK( negative->display( ) == "-1.6666666666666666667" );
+
+        FloatEntity tenth{ 0.1 };
+        unique_ptr<Entity> big_tenth{ tenth.to_bigfloat( ) };
+        UNIT_CHECK( big_tenth->display( ) == "0.10000000000000000555" );
+        unique_ptr<Entity> small{ big_tenth->multiply( big_tenth.get( ) ) };
+        unique_ptr<Entity> tiny{ small->sq( ) };
+        unique_ptr<Entity> smaller{ tiny->sq( ) };
+        UNIT_CHECK( smaller->display( ) == "1.0000000000000004441E-08" );
+
+        unique_ptr<Entity> back{ big_tenth->to_float( ) };
+        UNIT_CHECK( back->display( ) == tenth.display( ) );
+        unique_ptr<Entity> rational{ big_tenth->to_rational( ) };
+        UNIT_CHECK( rational->display( ) == "3602879701896397/36028797018963968" );
+        unique_ptr<Entity> rounded{ sum->to_integer( ) };
+        UNIT_CHECK( rounded->display( ) == "2" );
+        unique_ptr<Entity> less{ big_third->is_less( big_two.get( ) ) };
+        UNIT_CHECK( less->display( ) == "1" );
+
+        // A value keeps its digits until it is converted again at the new precision.
+        display_state::set_precision( 5 );
+        UNIT_CHECK( root->display( ) == "1.4142135623730950488" );
+        unique_ptr<Entity> short_root{ root->to_bigfloat( ) };
+        UNIT_CHECK( short_root->display( ) == "1.4142" );
+
+        bool thrown = false;
+        try {
+            unique_ptr<Entity> result{ negative->sqrt( ) };
+        }
+        catch( const Entity::Error & ) {
+            thrown = true;
+        }
+        UNIT_CHECK( thrown );
+
+        display_state::set_precision( old_precision );
+    }
+
+    //
+    // A value with exactly as many digits before the point as the precision has no fraction
+    // digits left to show.
+    //
+    void display_test( )
+    {
+        UnitTestManager::UnitTest test( "display_test" );
+
+        namespace display_state = clac::display_state;
+        const int old_precision = display_state::get_precision( );
+        const display_state::FloatModeType old_mode = display_state::get_display_mode( );
+
+        auto shown = []( int64_t number ) {
+            IntegerEntity integer{ number };
+            unique_ptr<Entity> converted{ integer.to_bigfloat( ) };
+            return converted->display( );
+        };
+
+        display_state::set_display_mode( display_state::FIXED );
+        display_state::set_precision( 3 );
+        UNIT_CHECK( shown( 123 ) == "123.0" );
+        UNIT_CHECK( shown( -999 ) == "-999.0" );
+        UNIT_CHECK( shown( 123000 ) == "1.23E+05" );
+        display_state::set_precision( 17 );
+        UNIT_CHECK( shown( 20154320464656892 ) == "20154320464656892.0" );
+        display_state::set_precision( 50 );
+        IntegerEntity ten{ int64_t{ 10 } };
+        IntegerEntity exponent{ int64_t{ 49 } };
+        unique_ptr<Entity> power{ ten.power( &exponent ) };
+        unique_ptr<Entity> big_power{ power->to_bigfloat( ) };
+        UNIT_CHECK( big_power->display( ) == "1" + string( 49, '0' ) + ".0" );
+
+        display_state::set_display_mode( display_state::ENGINEERING );
+        display_state::set_precision( 3 );
+        UNIT_CHECK( shown( 123 ) == "123.0E+00" );
+        UNIT_CHECK( shown( 123000 ) == "123.0E+03" );
+        UNIT_CHECK( shown( 12300 ) == "12.3E+03" );
+
+        display_state::set_display_mode( old_mode );
+        display_state::set_precision( old_precision );
+    }
+
+}
+
+
+bool bigfloat_tests( )
+{
+    rounding_test( );
+    sum_test( );
+    quotient_test( );
+    decimal_test( );
+    entity_test( );
+    display_test( );
+    return true;
+}
@@ -0,0 +1,192 @@
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// From SpicaCpp
+#include "UnitTestManager.hpp"
+
+// From Clac
+#include "FloatEntity.hpp"
+#include "IntegerEntity.hpp"
+#include "arithmetic.hpp"
+#include "combinatorics.hpp"
+
+// From Check
+#include "u_tests.hpp"
+
+using namespace std;
+using namespace clac::arithmetic;
+
+namespace {
+
+    natural_t number( uint64_t value )
+    {
+        natural_t result{ value };
+        normalize( result );
+        return result;
+    }
+
+    // Compare against multiplying the factors one at a time.
+    void factorial_test( )
+    {
+        UnitTestManager::UnitTest test( "factorial_test" );
+
+        natural_t expected{ 1 };
+        bool agree = true;
+        for( uint64_t n = 0; n <= 1000; ++n ) {
+            if( n > 1 )
+                expected = multiply( expected, natural_t{ n } );
+            agree = agree && ( factorial( n ) == expected );
+        }
+        UNIT_CHECK( agree );
+
+        agree = true;
+        for( uint64_t n = 0; n <= 500; ++n ) {
+            natural_t product{ 1 };
+            for( uint64_t i = n; i >= 2; i -= 2 ) {
+                product = multiply( product, natural_t{ i } );
+            }
+            agree = agree && ( double_factorial( n ) == product );
+        }
+        UNIT_CHECK( agree );
+
+        // 10000! has 35660 digits and ends in 2499 zeros.
+        const string digits = to_decimal( factorial( 10000 ) );
+        UNIT_CHECK( digits.size( ) == 35660 );
+        UNIT_CHECK( digits.find_last_not_of( '0' ) == 35660 - 2499 - 1 );
+    }
+
+    // Compare against Pascal's triangle.
+    void binomial_test( )
+    {
+        UnitTestManager::UnitTest test( "binomial_test" );
+
+        vector<natural_t> row{ natural_t{ 1 } };
+        bool agree = true;
+        for( uint64_t n = 0; n <= 300; ++n ) {
+            for( uint64_t k = 0; k <= n + 1; ++k ) {
+                const natural_t expected = ( k <= n ) ? row[k] : natural_t( );
+                agree = agree && ( binomial( number( n ), k ) == expected );
+            }
+            vector<natural_t> next( n + 2, natural_t{ 1 } );
+            for( uint64_t k = 1; k <= n; ++k ) {
+                next[k] = add( row[k - 1], row[k] );
+            }
+            row = next;
+        }
+        UNIT_CHECK( agree );
+
+        // Both methods for a large top: the prime factorization and the falling product.
+        UNIT_CHECK( binomial( number( 100000 ), 50000 ) ==
+                    divide_exact( factorial( 100000 ), square( factorial( 50000 ) ) ) );
+        UNIT_CHECK( binomial( number( 1000000 ), 3 ) == number( 166666166667000000 ) );
+
+        // A top too large for one limb.
+        const natural_t n = add( shift_left( natural_t{ 1 }, 64 ), natural_t{ 5 } );
+        const natural_t expected =
+            divide_exact( multiply( multiply( n, subtract( n, natural_t{ 1 } ) ),
+                                    subtract( n, natural_t{ 2 } ) ),
+                          natural_t{ 6 } );
+        UNIT_CHECK( binomial( n, 3 ) == expected );
+    }
+
+    void fibonacci_test( )
+    {
+        UnitTestManager::UnitTest test( "fibonacci_test" );
+
+        natural_t f, f_next{ 1 }, l{ 2 }, l_next{ 1 };
+        bool agree = true;
+        for( uint64_t n = 0; n <= 1000; ++n ) {
+            agree = agree && ( fibonacci( n ) == f ) && ( lucas( n ) == l );
+            natural_t sum = add( f, f_next );
+            f = f_next;
+            f_next = sum;
+            sum = add( l, l_next );
+            l = l_next;
+            l_next = sum;
+        }
+        UNIT_CHECK( agree );
+
+        // F(2n) = F(n) L(n).
+        UNIT_CHECK( fibonacci( 200000 ) == multiply( fibonacci( 100000 ), lucas( 100000 ) ) );
+    }
+
+    void entity_test( )
+    {
+        UnitTestManager::UnitTest test( "entity_test" );
+
+        IntegerEntity twenty{ int64_t{ 20 } };
+        unique_ptr<Entity> result{ twenty.factorial( ) };
+        UNIT_CHECK( result->display( ) == "2432902008176640000" );
+        result.reset( twenty.double_factorial( ) );
+        UNIT_CHECK( result->display( ) == "3715891200" );
+
+        IntegerEntity minus_ten{ int64_t{ -10 } };
+        IntegerEntity three{ int64_t{ 3 } };
+        result.reset( twenty.binomial( &three ) );
+        UNIT_CHECK( result->display( ) == "1140" );
+        result.reset( minus_ten.binomial( &three ) );
+        UNIT_CHECK( result->display( ) == "-220" );
+        result.reset( three.binomial( &twenty ) );
+        UNIT_CHECK( result->display( ) == "0" );
+        IntegerEntity huge{ spica::VeryLong( "1180591620717411303424" ) };
+        result.reset( three.binomial( &huge ) );
+        UNIT_CHECK( result->display( ) == "0" );
+
+        result.reset( minus_ten.fibonacci( ) );
+        UNIT_CHECK( result->display( ) == "-55" );
+        result.reset( minus_ten.lucas( ) );
+        UNIT_CHECK( result->display( ) == "123" );
+
+        bool thrown = false;
+        try {
+            result.reset( minus_ten.factorial( ) );
+        }
+        catch( const Entity::Error & ) {
+            thrown = true;
+        }
+        UNIT_CHECK( thrown );
+
+        // Arguments whose factorials are far too large are rejected before any work is done.
+        IntegerEntity large{ int64_t{ 1000000000000000 } };
+        thrown = false;
+        try {
+            result.reset( large.factorial( ) );
+        }
+        catch( const Entity::Error & ) {
+            thrown = true;
+        }
+        UNIT_CHECK( thrown );
+        thrown = false;
+        try {
+            result.reset( large.double_factorial( ) );
+        }
+        catch( const Entity::Error & ) {
+            thrown = true;
+        }
+        UNIT_CHECK( thrown );
+
+        // Floats use the gamma function, with x! = gamma(x + 1).
+        FloatEntity half{ 0.5 };
+        result.reset( half.gamma( ) );
+        UNIT_CHECK( result->display( ) == "1.772" );
+        FloatEntity four_and_a_half{ 4.5 };
+        result.reset( four_and_a_half.factorial( ) );
+        UNIT_CHECK( result->display( ) == "52.343" );
+        FloatEntity hundred{ 100.0 };
+        result.reset( hundred.log_gamma( ) );
+        UNIT_CHECK( result->display( ) == "359.134" );
+    }
+
+}
+
+
+bool combinatorics_tests( )
+{
+    factorial_test( );
+    binomial_test( );
+    fibonacci_test( );
+    entity_test( );
+    return true;
+}
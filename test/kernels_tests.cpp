@@ -0,0 +1,154 @@
+
+#include <cstddef>
+#include <random>
+#include <vector>
+
+// From SpicaCpp
+#include "UnitTestManager.hpp"
+
+// From Clac
+#include "kernels.hpp"
+
+// From Check
+#include "u_tests.hpp"
+
+using namespace std;
+using clac::arithmetic::KernelSet;
+using clac::arithmetic::limb_t;
+
+namespace {
+
+    using Limbs = vector<limb_t>;
+
+    // Random limbs, biased toward the all-ones and zero limbs that exercise long carry chains.
+    Limbs random_limbs( mt19937_64& generator, size_t n )
+    {
+        Limbs result( n );
+        const auto pattern = generator( ) % 4;
+        for( limb_t& limb : result ) {
+            switch( pattern ) {
+            case 0:  limb = ~limb_t{ 0 }; break;
+            case 1:  limb = ( generator( ) % 8 == 0 ) ? generator( ) : ~limb_t{ 0 }; break;
+            case 2:  limb = ( generator( ) % 2 == 0 ) ? 0 : generator( ); break;
+            default: limb = generator( ); break;
+            }
+        }
+        return result;
+    }
+
+    //
+    // Compares every kernel of every supported set with the portable set on the same inputs.
+    // The results must agree limb for limb, including the returned carries.
+    //
+    void bit_exactness_test( )
+    {
+        UnitTestManager::UnitTest test( "bit_exactness_test" );
+
+        const vector<const KernelSet*> sets = clac::arithmetic::supported_kernels( );
+        const KernelSet& portable = *sets.front( );
+        mt19937_64 generator( 20230714 );
+
+        for( size_t s = 1; s < sets.size( ); ++s ) {
+            const KernelSet& tuned = *sets[s];
+            for( int trial = 0; trial < 2000; ++trial ) {
+                const size_t n = generator( ) % 70 + 1;
+                const size_t m = generator( ) % 40 + 1;
+                const Limbs a = random_limbs( generator, n );
+                const Limbs b = random_limbs( generator, n );
+                const Limbs c = random_limbs( generator, m );
+                const limb_t k = random_limbs( generator, 1 )[0];
+                const Limbs initial = random_limbs( generator, n );
+
+                Limbs expected = initial, actual = initial;
+                UNIT_CHECK( portable.add_n( expected.data( ), a.data( ), b.data( ), n ) ==
+                               tuned.add_n( actual.data( ), a.data( ), b.data( ), n ) );
+                UNIT_CHECK( actual == expected );
+
+                UNIT_CHECK( portable.sub_n( expected.data( ), a.data( ), b.data( ), n ) ==
+                               tuned.sub_n( actual.data( ), a.data( ), b.data( ), n ) );
+                UNIT_CHECK( actual == expected );
+
+                UNIT_CHECK( portable.mul_1( expected.data( ), a.data( ), n, k ) ==
+                               tuned.mul_1( actual.data( ), a.data( ), n, k ) );
+                UNIT_CHECK( actual == expected );
+
+                expected = initial;
+                actual   = initial;
+                UNIT_CHECK( portable.addmul_1( expected.data( ), a.data( ), n, k ) ==
+                               tuned.addmul_1( actual.data( ), a.data( ), n, k ) );
+                UNIT_CHECK( actual == expected );
+
+                // In place, as the multiplication algorithms use them.
+                expected = a;
+                actual   = a;
+                UNIT_CHECK( portable.add_n( expected.data( ), expected.data( ), b.data( ), n ) ==
+                               tuned.add_n( actual.data( ), actual.data( ), b.data( ), n ) );
+                UNIT_CHECK( actual == expected );
+                UNIT_CHECK( portable.sub_n( expected.data( ), expected.data( ), b.data( ), n ) ==
+                               tuned.sub_n( actual.data( ), actual.data( ), b.data( ), n ) );
+                UNIT_CHECK( actual == expected );
+
+                Limbs expected_product( n + m ), actual_product( n + m );
+                portable.mul_basecase( expected_product.data( ), a.data( ), n, c.data( ), m );
+                tuned.mul_basecase( actual_product.data( ), a.data( ), n, c.data( ), m );
+                UNIT_CHECK( actual_product == expected_product );
+
+                Limbs expected_square( 2 * n ), actual_square( 2 * n );
+                portable.sqr_basecase( expected_square.data( ), a.data( ), n );
+                tuned.sqr_basecase( actual_square.data( ), a.data( ), n );
+                UNIT_CHECK( actual_square == expected_square );
+
+                UNIT_CHECK( portable.popcount_n( a.data( ), n ) == tuned.popcount_n( a.data( ), n ) );
+            }
+        }
+    }
+
+    // The portable squaring must agree with the portable multiplication.
+    void square_test( )
+    {
+        UnitTestManager::UnitTest test( "square_test" );
+
+        const KernelSet& portable = *clac::arithmetic::supported_kernels( ).front( );
+        mt19937_64 generator( 1 );
+        for( int trial = 0; trial < 500; ++trial ) {
+            const size_t n = generator( ) % 70 + 1;
+            const Limbs a = random_limbs( generator, n );
+            Limbs product( 2 * n ), square( 2 * n );
+            portable.mul_basecase( product.data( ), a.data( ), n, a.data( ), n );
+            portable.sqr_basecase( square.data( ), a.data( ), n );
+            UNIT_CHECK( square == product );
+        }
+    }
+
+    // The set chosen at startup must be one the processor supports, and it can be replaced.
+    void dispatch_test( )
+    {
+        UnitTestManager::UnitTest test( "dispatch_test" );
+
+        const vector<const KernelSet*> sets = clac::arithmetic::supported_kernels( );
+        const KernelSet& original = clac::arithmetic::active_kernels( );
+        UNIT_CHECK( &original == sets.back( ) );
+
+        const limb_t a[] = { ~limb_t{ 0 }, ~limb_t{ 0 } };
+        const limb_t b[] = { 1, 0 };
+        for( const KernelSet* set : sets ) {
+            clac::arithmetic::set_active_kernels( *set );
+            UNIT_CHECK( &clac::arithmetic::active_kernels( ) == set );
+
+            limb_t sum[2];
+            UNIT_CHECK( clac::arithmetic::add_n( sum, a, b, 2 ) == 1 );
+            UNIT_CHECK( sum[0] == 0 && sum[1] == 0 );
+        }
+        clac::arithmetic::set_active_kernels( original );
+    }
+
+}
+
+
+bool kernels_tests( )
+{
+    bit_exactness_test( );
+    square_test( );
+    dispatch_test( );
+    return true;
+}
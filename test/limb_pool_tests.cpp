@@ -0,0 +1,143 @@
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// From SpicaCpp
+#include "UnitTestManager.hpp"
+
+// From Clac
+#include "arithmetic.hpp"
+
+// From Check
+#include "u_tests.hpp"
+
+using namespace std;
+using namespace clac::arithmetic;
+
+namespace {
+
+    //
+    // A freed buffer serves the next request of its size class, whatever size within the class
+    // is asked for, but not a request of another class. Each class keeps a bounded number.
+    //
+    void reuse_test( )
+    {
+        UnitTestManager::UnitTest test( "reuse_test" );
+
+        LimbAllocator allocator;
+        release_pool( );
+        reset_pool_statistics( );
+
+        limb_t *buffer = allocator.allocate( 10 );
+        allocator.deallocate( buffer, 10 );
+        UNIT_CHECK( pool_statistics( ).cached == 1 );
+        UNIT_CHECK( pool_statistics( ).cached_bytes == 16 * sizeof( limb_t ) );
+        limb_t *other = allocator.allocate( 17 );
+        UNIT_CHECK( other != buffer && pool_statistics( ).reused == 0 );
+        limb_t *same = allocator.allocate( 16 );
+        UNIT_CHECK( same == buffer && pool_statistics( ).reused == 1 );
+        UNIT_CHECK( pool_statistics( ).cached == 0 );
+        allocator.deallocate( same, 16 );
+        allocator.deallocate( other, 17 );
+
+        // The buffer is usable over the whole of its class.
+        limb_t *whole = allocator.allocate( 9 );
+        for( size_t i = 0; i < 16; ++i )
+            whole[i] = i;
+        allocator.deallocate( whole, 9 );
+
+        vector<limb_t *> buffers;
+        for( int i = 0; i < 40; ++i )
+            buffers.push_back( allocator.allocate( 100 ) );
+        for( limb_t *b : buffers )
+            allocator.deallocate( b, 100 );
+        const PoolStatistics statistics = pool_statistics( );
+        UNIT_CHECK( statistics.cached < 40 );
+        UNIT_CHECK( statistics.requests == statistics.returned );
+
+        release_pool( );
+        UNIT_CHECK( pool_statistics( ).cached == 0 && pool_statistics( ).cached_bytes == 0 );
+
+        // Values built from pooled buffers are unaffected by the reuse.
+        const natural_t a( 1000, ~limb_t{ 0 } );
+        const natural_t b = multiply( a, a );
+        const natural_t c = multiply( a, a );
+        UNIT_CHECK( b == c && pool_statistics( ).reused > 0 );
+        release_pool( );
+    }
+
+    //
+    // A buffer freed by another thread joins that thread's pool, where it serves the thread's
+    // next request, and leaves the allocating thread's pool untouched.
+    //
+    void thread_test( )
+    {
+        UnitTestManager::UnitTest test( "thread_test" );
+
+        LimbAllocator allocator;
+        release_pool( );
+        reset_pool_statistics( );
+
+        limb_t *buffer = allocator.allocate( 64 );
+        PoolStatistics freeing{ };
+        bool reused = false;
+        thread worker( [&] {
+            LimbAllocator worker_allocator;
+            worker_allocator.deallocate( buffer, 64 );
+            freeing = pool_statistics( );
+            limb_t *next = worker_allocator.allocate( 64 );
+            reused = ( next == buffer );
+            worker_allocator.deallocate( next, 64 );
+        } );
+        worker.join( );
+
+        UNIT_CHECK( freeing.returned == 1 && freeing.cached == 1 );
+        UNIT_CHECK( reused );
+        const PoolStatistics allocating = pool_statistics( );
+        UNIT_CHECK( allocating.requests == 1 && allocating.returned == 0 );
+        UNIT_CHECK( allocating.cached == 0 );
+    }
+
+    //
+    // Requests larger than the largest size class go to operator new and back to operator
+    // delete, and are never cached.
+    //
+    void oversize_test( )
+    {
+        UnitTestManager::UnitTest test( "oversize_test" );
+
+        LimbAllocator allocator;
+        release_pool( );
+        reset_pool_statistics( );
+
+        const size_t largest = 65536;
+        limb_t *buffer = allocator.allocate( largest + 1 );
+        buffer[largest] = 1;
+        allocator.deallocate( buffer, largest + 1 );
+        UNIT_CHECK( pool_statistics( ).cached == 0 && pool_statistics( ).cached_bytes == 0 );
+        limb_t *again = allocator.allocate( largest + 1 );
+        UNIT_CHECK( pool_statistics( ).reused == 0 );
+        allocator.deallocate( again, largest + 1 );
+
+        // The largest class itself is cached.
+        limb_t *pooled = allocator.allocate( largest );
+        allocator.deallocate( pooled, largest );
+        UNIT_CHECK( pool_statistics( ).cached == 1 );
+        UNIT_CHECK( pool_statistics( ).requests == 3 && pool_statistics( ).returned == 3 );
+        release_pool( );
+    }
+
+}
+
+
+bool limb_pool_tests( )
+{
+    // Without the pool every request goes to the heap and there is nothing to check.
+#ifndef CLAC_NO_LIMB_POOL
+    reuse_test( );
+    thread_test( );
+    oversize_test( );
+#endif
+    return true;
+}
@@ -0,0 +1,212 @@
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+// From SpicaCpp
+#include "UnitTestManager.hpp"
+
+// From Clac
+#include "IntegerEntity.hpp"
+#include "arithmetic.hpp"
+#include "prime.hpp"
+
+// From Check
+#include "u_tests.hpp"
+
+using namespace std;
+using namespace clac::arithmetic;
+
+namespace {
+
+    bool trial_division_prime( uint64_t n )
+    {
+        if( n < 2 )
+            return false;
+        for( uint64_t d = 2; d * d <= n; ++d ) {
+            if( n % d == 0 )
+                return false;
+        }
+        return true;
+    }
+
+    natural_t decimal( const char *digits )
+    {
+        return from_decimal( digits );
+    }
+
+    void is_prime_test( )
+    {
+        UnitTestManager::UnitTest test( "is_prime_test" );
+
+        bool agree = true;
+        for( uint64_t n = 0; n < 100000; ++n ) {
+            natural_t number{ n };
+            normalize( number );
+            agree = agree && ( is_prime( number ) == trial_division_prime( n ) );
+        }
+        UNIT_CHECK( agree );
+
+        // Strong pseudoprimes to several bases, and Carmichael numbers.
+        UNIT_CHECK( !is_prime( natural_t{ 3215031751 } ) );
+        UNIT_CHECK( !is_prime( natural_t{ 3825123056546413051 } ) );
+        UNIT_CHECK( !is_prime( natural_t{ 9746347772161 } ) );
+        UNIT_CHECK( is_prime( natural_t{ 18446744073709551557ULL } ) );
+
+        // Above 2^64: the Mersenne prime 2^127 - 1, its neighbor, and a semiprime.
+        const natural_t m127 = subtract( shift_left( natural_t{ 1 }, 127 ), natural_t{ 1 } );
+        UNIT_CHECK( is_prime( m127 ) );
+        UNIT_CHECK( !is_prime( add( m127, natural_t{ 2 } ) ) );
+        const natural_t p = decimal( "18446744073709551629" );
+        UNIT_CHECK( is_prime( p ) );
+        UNIT_CHECK( !is_prime( multiply( p, p ) ) );
+        UNIT_CHECK( !is_prime( multiply( p, m127 ) ) );
+    }
+
+    void next_prime_test( )
+    {
+        UnitTestManager::UnitTest test( "next_prime_test" );
+
+        UNIT_CHECK( next_prime( natural_t( ) ) == natural_t{ 2 } );
+        UNIT_CHECK( next_prime( natural_t{ 2 } ) == natural_t{ 3 } );
+        UNIT_CHECK( next_prime( natural_t{ 65521 } ) == natural_t{ 65537 } );
+        UNIT_CHECK( next_prime( natural_t{ 1000000 } ) == natural_t{ 1000003 } );
+        UNIT_CHECK( next_prime( natural_t{ 18446744073709551557ULL } ) ==
+                    decimal( "18446744073709551629" ) );
+        UNIT_CHECK( next_prime( decimal( "1000000000000000000000000000000" ) ) ==
+                    decimal( "1000000000000000000000000000057" ) );
+    }
+
+    // The factors must be primes in increasing order whose product is the number.
+    bool is_factorization( const natural_t &number, const vector<natural_t> &factors )
+    {
+        natural_t product{ 1 };
+        for( size_t i = 0; i < factors.size( ); ++i ) {
+            if( !is_prime( factors[i] ) )
+                return false;
+            if( i > 0 && compare( factors[i - 1], factors[i] ) > 0 )
+                return false;
+            product = multiply( product, factors[i] );
+        }
+        return product == number;
+    }
+
+    void factor_test( )
+    {
+        UnitTestManager::UnitTest test( "factor_test" );
+
+        UNIT_CHECK( factor( natural_t{ 1 } ).empty( ) );
+        UNIT_CHECK( factor( natural_t{ 360 } ) ==
+                    ( vector<natural_t>{ { 2 }, { 2 }, { 2 }, { 3 }, { 3 }, { 5 } } ) );
+
+        // 2^64 + 1 and 2^128 + 1. The second needs the elliptic curve method.
+        const natural_t f6 = add( shift_left( natural_t{ 1 }, 64 ), natural_t{ 1 } );
+        UNIT_CHECK( factor( f6 ) ==
+                    ( vector<natural_t>{ { 274177 }, { 67280421310721 } } ) );
+        const natural_t f7 = add( shift_left( natural_t{ 1 }, 128 ), natural_t{ 1 } );
+        UNIT_CHECK( factor( f7 ) == ( vector<natural_t>{ { 59649589127497217 },
+                                                         decimal( "5704689200685129054721" ) } ) );
+
+        // A perfect power of a factor above the trial division limit.
+        const natural_t cube = power( natural_t{ 65537 }, 3 );
+        const vector<natural_t> factors = factor( multiply( cube, natural_t{ 9 } ) );
+        UNIT_CHECK( factors.size( ) == 5 && factors[4] == natural_t{ 65537 } );
+
+        mt19937_64 generator( 20 );
+        for( int trial = 0; trial < 10; ++trial ) {
+            natural_t number{ generator( ), generator( ) & 0xFFFFFF };
+            normalize( number );
+            UNIT_CHECK( is_factorization( number, factor( number ) ) );
+        }
+
+        UNIT_CHECK( !request_cancel( ) );
+    }
+
+    // Ranges whose ends fall on every residue modulo 30, and ranges spanning several segments.
+    void sieve_test( )
+    {
+        UnitTestManager::UnitTest test( "sieve_test" );
+
+        const uint64_t limit = 2000000;
+        vector<uint64_t> reference;
+        for( uint64_t n = 0; n <= 200; ++n ) {
+            if( trial_division_prime( n ) )
+                reference.push_back( n );
+        }
+
+        bool agree = true;
+        for( uint64_t low = 0; low <= 61; ++low ) {
+            for( uint64_t high = 0; high <= 200; high += 7 ) {
+                vector<uint64_t> expected;
+                for( uint64_t p : reference ) {
+                    if( low <= p && p <= high )
+                        expected.push_back( p );
+                }
+                agree = agree && ( primes_between( low, high ) == expected );
+            }
+        }
+        UNIT_CHECK( agree );
+
+        const vector<uint64_t> primes = primes_between( 0, limit );
+        UNIT_CHECK( primes.size( ) == 148933 );
+        UNIT_CHECK( primes.back( ) == 1999993 );
+        UNIT_CHECK( prime_count( limit ) == 148933 );
+        UNIT_CHECK( primes_between( 999000, 1001000 ).size( ) == 140 );
+        UNIT_CHECK( primes_between( 1000000000000, 1000000000100 ) ==
+                    ( vector<uint64_t>{ 1000000000039, 1000000000061, 1000000000063,
+                                        1000000000091 } ) );
+        UNIT_CHECK( prime_count( 10000000 ) == 664579 );
+        UNIT_CHECK( prime_count( 1 ) == 0 && prime_count( 5 ) == 3 && prime_count( 7 ) == 4 );
+
+        bool thrown = false;
+        try {
+            prime_count( SIEVE_LIMIT + 1 );
+        }
+        catch( const std::domain_error & ) {
+            thrown = true;
+        }
+        UNIT_CHECK( thrown );
+    }
+
+    void entity_test( )
+    {
+        UnitTestManager::UnitTest test( "entity_test" );
+
+        IntegerEntity number{ int64_t{ -360 } };
+        unique_ptr<Entity> factors{ number.factor( ) };
+        UNIT_CHECK( factors->display( ) == "{ -1 2 2 2 3 3 5 }" );
+        unique_ptr<Entity> prime{ number.is_prime( ) };
+        UNIT_CHECK( prime->display( ) == "0" );
+
+        IntegerEntity seven{ int64_t{ 7 } };
+        unique_ptr<Entity> next{ seven.next_prime( ) };
+        UNIT_CHECK( next->display( ) == "11" );
+        unique_ptr<Entity> seven_prime{ seven.is_prime( ) };
+        UNIT_CHECK( seven_prime->display( ) == "1" );
+
+        IntegerEntity hundred{ int64_t{ 100 } };
+        unique_ptr<Entity> count{ hundred.prime_count( ) };
+        UNIT_CHECK( count->display( ) == "25" );
+        IntegerEntity ninety{ int64_t{ 90 } };
+        unique_ptr<Entity> primes{ ninety.primes( &hundred ) };
+        UNIT_CHECK( primes->my_type( ) == VECTOR && primes->display( ) == "[ 97 ]" );
+        unique_ptr<Entity> copy{ number.primes( &seven ) };
+        unique_ptr<Entity> duplicate{ copy->duplicate( ) };
+        UNIT_CHECK( duplicate->display( ) == "[ 2 3 5 7 ]" );
+        unique_ptr<Entity> empty{ hundred.primes( &ninety ) };
+        UNIT_CHECK( empty->display( ) == "[ ]" );
+    }
+
+}
+
+
+bool prime_tests( )
+{
+    is_prime_test( );
+    next_prime_test( );
+    factor_test( );
+    sieve_test( );
+    entity_test( );
+    return true;
+}
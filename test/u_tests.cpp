@@ -62,6 +62,17 @@ int main( int argc, char **argv )
 
     UnitTestManager::register_suite( IntegerEntity_tests, "IntegerEntity" );
     UnitTestManager::register_suite( FloatEntity_tests,   "FloatEntity"   );
+    UnitTestManager::register_suite( RationalEntity_tests, "RationalEntity" );
+    UnitTestManager::register_suite( kernels_tests,       "kernels"       );
+    UnitTestManager::register_suite( arithmetic_tests,    "arithmetic"    );
+    UnitTestManager::register_suite( SmallVector_tests,   "SmallVector"   );
+    UnitTestManager::register_suite( limb_pool_tests,     "limb_pool"     );
+    UnitTestManager::register_suite( backend_tests,       "backend"       );
+    UnitTestManager::register_suite( BinaryEntity_tests,  "BinaryEntity"  );
+    UnitTestManager::register_suite( ModularEntity_tests, "ModularEntity" );
+    UnitTestManager::register_suite( prime_tests,         "prime"         );
+    UnitTestManager::register_suite( combinatorics_tests, "combinatorics" );
+    UnitTestManager::register_suite( bigfloat_tests,      "bigfloat"      );
 
     UnitTestManager::execute_suites( *output, "Clac Unit Tests" );
     return UnitTestManager::test_status( );
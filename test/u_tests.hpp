@@ -8,6 +8,17 @@
 
 extern bool IntegerEntity_tests( );
 extern bool FloatEntity_tests( );
+extern bool RationalEntity_tests( );
+extern bool kernels_tests( );
+extern bool arithmetic_tests( );
+extern bool SmallVector_tests( );
+extern bool limb_pool_tests( );
+extern bool backend_tests( );
+extern bool BinaryEntity_tests( );
+extern bool ModularEntity_tests( );
+extern bool prime_tests( );
+extern bool combinatorics_tests( );
+extern bool bigfloat_tests( );
 
 #endif
 